@@ -12,6 +12,17 @@ global axk_interrupts_enable
 global axk_halt
 global axk_get_kernel_offset
 global axk_get_kernel_size
+global axk_x86_cpuid
+global axk_x86_read_msr
+global axk_x86_write_msr
+global axk_x86_flush_caches
+global axk_x86_flush_tlb
+global axk_x86_invalidate_page
+global axk_x86_read_timestamp
+global axk_x86_copy_nt
+global axk_x86_outb
+global axk_x86_inb
+global axk_x86_capture_registers
 
 extern axk_kernel_begin
 extern axk_kernel_end
@@ -75,4 +86,205 @@ axk_get_kernel_size:
     mov rax, axk_kernel_end - AXK_VIRTUAL_OFFSET
     mov rcx, axk_kernel_begin
     sub rax, rcx
+    ret
+
+
+axk_x86_cpuid:
+
+    ; Parameters:   eax pointer (rdi), ebx pointer (rsi), ecx pointer (rdx), edx pointer (rcx)
+    ; Returns:      None, all four pointers are written with the instruction output
+
+    push rbx
+    mov r8, rdx
+    mov r9, rcx
+
+    mov eax, dword [rdi]
+    mov ecx, dword [r8]
+    cpuid
+
+    mov dword [rdi], eax
+    mov dword [rsi], ebx
+    mov dword [r8], ecx
+    mov dword [r9], edx
+
+    pop rbx
+    ret
+
+axk_x86_read_msr:
+
+    ; Parameters:   MSR index (edi)
+    ; Returns:      MSR value (rax)
+
+    mov ecx, edi
+    rdmsr
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+axk_x86_write_msr:
+
+    ; Parameters:   MSR index (edi), Value (rsi)
+    ; Returns:      None
+
+    mov ecx, edi
+    mov rax, rsi
+    mov rdx, rsi
+    shr rdx, 32
+    wrmsr
+    ret
+
+axk_x86_flush_caches:
+
+    ; Parameters:   None
+    ; Returns:      None
+
+    wbinvd
+    ret
+
+axk_x86_flush_tlb:
+
+    ; Parameters:   None
+    ; Returns:      None
+
+    mov rax, cr3
+    mov cr3, rax
+    ret
+
+axk_x86_invalidate_page:
+
+    ; Parameters:   Virtual address (rdi)
+    ; Returns:      None
+
+    invlpg [rdi]
+    ret
+
+axk_x86_read_timestamp:
+
+    ; Parameters:   None
+    ; Returns:      Timestamp counter (rax)
+
+    rdtsc
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+axk_x86_copy_nt:
+
+    ; Parameters:   Destination (rdi), Source (rsi), Byte count (rdx)
+    ; Returns:      None
+    ; Copies using non-temporal stores, so the destination isnt pulled into the cache, meant for write-only memory like the framebuffer
+
+    ; Copy single bytes until the destination is 16-byte aligned
+    .head:
+    test rdx, rdx
+    jz .done
+    test dil, 15
+    jz .blocks
+    mov al, byte [rsi]
+    mov byte [rdi], al
+    inc rsi
+    inc rdi
+    dec rdx
+    jmp .head
+
+    ; 64 bytes at a time, loads can be unaligned
+    .blocks:
+    cmp rdx, 64
+    jb .lines
+    movdqu xmm0, [rsi]
+    movdqu xmm1, [rsi + 16]
+    movdqu xmm2, [rsi + 32]
+    movdqu xmm3, [rsi + 48]
+    movntdq [rdi], xmm0
+    movntdq [rdi + 16], xmm1
+    movntdq [rdi + 32], xmm2
+    movntdq [rdi + 48], xmm3
+    add rsi, 64
+    add rdi, 64
+    sub rdx, 64
+    jmp .blocks
+
+    .lines:
+    cmp rdx, 16
+    jb .tail
+    movdqu xmm0, [rsi]
+    movntdq [rdi], xmm0
+    add rsi, 16
+    add rdi, 16
+    sub rdx, 16
+    jmp .lines
+
+    .tail:
+    test rdx, rdx
+    jz .done
+    mov al, byte [rsi]
+    mov byte [rdi], al
+    inc rsi
+    inc rdi
+    dec rdx
+    jmp .tail
+
+    ; Non-temporal stores are weakly ordered, make sure they are visible before returning
+    .done:
+    sfence
+    ret
+
+axk_x86_outb:
+
+    ; Parameters:   Port (di), Value (sil)
+    ; Returns:      None
+
+    mov dx, di
+    mov al, sil
+    out dx, al
+    ret
+
+axk_x86_inb:
+
+    ; Parameters:   Port (di)
+    ; Returns:      Value read from the port (al)
+
+    mov dx, di
+    xor eax, eax
+    in al, dx
+    ret
+
+axk_x86_capture_registers:
+
+    ; Parameters:   Register structure pointer (rdi), see 'axk_crash_registers_t' in axon/kernel/crash.h
+    ; Returns:      None
+    ; rip and rsp are written as the caller sees them (the return address, and the stack pointer from before the call)
+
+    mov qword [rdi], rax
+    mov qword [rdi + 8], rbx
+    mov qword [rdi + 16], rcx
+    mov qword [rdi + 24], rdx
+    mov qword [rdi + 32], rsi
+    mov qword [rdi + 40], rdi
+    mov qword [rdi + 48], rbp
+    lea rax, [rsp + 8]
+    mov qword [rdi + 56], rax
+    mov qword [rdi + 64], r8
+    mov qword [rdi + 72], r9
+    mov qword [rdi + 80], r10
+    mov qword [rdi + 88], r11
+    mov qword [rdi + 96], r12
+    mov qword [rdi + 104], r13
+    mov qword [rdi + 112], r14
+    mov qword [rdi + 120], r15
+
+    mov rax, qword [rsp]
+    mov qword [rdi + 128], rax
+    pushfq
+    pop rax
+    mov qword [rdi + 136], rax
+
+    mov rax, cr0
+    mov qword [rdi + 144], rax
+    mov rax, cr2
+    mov qword [rdi + 152], rax
+    mov rax, cr3
+    mov qword [rdi + 160], rax
+    mov rax, cr4
+    mov qword [rdi + 168], rax
     ret
\ No newline at end of file
@@ -0,0 +1,27 @@
+##########################################################################
+# 	ExpressOS - Axon Kernel
+#	Kernel Symbol Table Generator
+#	2021, Zachary Berry
+##########################################################################
+#
+#	Turns the output of 'nm -n --defined-only' into a NASM source file holding the kernel symbol table (see axon/kernel/ksyms.h)
+#	Only function symbols are kept, the table is sorted by address since 'nm -n' already sorts it
+#
+
+BEGIN {
+	count = 0
+}
+
+$2 ~ /^[tTwW]$/ {
+	address[ count ] = $1
+	name[ count ] = $3
+	count++
+}
+
+END {
+	print "section .axk_ksyms progbits alloc noexec nowrite align=16"
+	for( i = 0; i < count; i++ ) { printf "    dq 0x%s, ksym_%d\n", address[ i ], i }
+
+	print "section .axk_ksyms_str progbits alloc noexec nowrite align=1"
+	for( i = 0; i < count; i++ ) { printf "ksym_%d: db \"%s\", 0\n", i, name[ i ] }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+/*==============================================================
+    Axon Kernel - x86 16550 UART Driver
+    2021, Zachary Berry
+    axon/private/axon/arch_x86/uart16550.h
+==============================================================*/
+
+#pragma once
+#ifdef __x86_64__
+#include "axon/kernel/kernel.h"
+
+/*
+    Constants
+*/
+#define AXK_X86_UART_COM1           0x3F8
+#define AXK_X86_UART_COM2           0x2F8
+#define AXK_X86_UART_BASE_CLOCK     115200U
+
+/*
+    axk_x86_uart_init
+    * Private Function
+    * Sets up a 16550 compatible UART for 8N1 output at 'baud', and registers it as a console sink
+    * The UART is tested in loopback mode first, if nothing answers at 'port', this returns false and no sink is registered
+    * Output is polled, once the transmitter is empty the whole FIFO (16 bytes on a 16550A, one byte otherwise) is
+      filled without checking the status register again
+*/
+bool axk_x86_uart_init( uint16_t port, uint32_t baud );
+
+#endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+/*==============================================================
+    Axon Kernel - x86 Utility Functions
+    2021, Zachary Berry
+    axon/private/axon/arch_x86/util.h
+==============================================================*/
+
+#pragma once
+#ifdef __x86_64__
+#include "axon/kernel/kernel.h"
+
+/*
+    Model-Specific Registers
+*/
+#define AXK_X86_MSR_PAT             0x277
+#define AXK_X86_MSR_GS_BASE         0xC0000101
+#define AXK_X86_MSR_KERNEL_GS_BASE  0xC0000102
+
+/*
+    axk_x86_cpuid
+    * Private Function
+    * Executes the CPUID instruction, 'eax' and 'ecx' are used as the input leaf/sub-leaf
+    * All four registers are overwritten with the output of the instruction
+*/
+void axk_x86_cpuid( uint32_t* eax, uint32_t* ebx, uint32_t* ecx, uint32_t* edx );
+
+/*
+    axk_x86_read_msr
+    * Private Function
+    * Reads a model-specific register
+*/
+uint64_t axk_x86_read_msr( uint32_t msr );
+
+/*
+    axk_x86_write_msr
+    * Private Function
+    * Writes a value to a model-specific register
+*/
+void axk_x86_write_msr( uint32_t msr, uint64_t value );
+
+/*
+    axk_x86_flush_caches
+    * Private Function
+    * Writes back and invalidates all processor caches (wbinvd)
+    * Very slow, only use this when changing memory types
+*/
+void axk_x86_flush_caches( void );
+
+/*
+    axk_x86_flush_tlb
+    * Private Function
+    * Flushes all non-global TLB entries on the current processor by reloading CR3
+*/
+void axk_x86_flush_tlb( void );
+
+/*
+    axk_x86_invalidate_page
+    * Private Function
+    * Flushes the TLB entry (and any cached paging structures) for a single virtual address on the current processor
+*/
+void axk_x86_invalidate_page( uint64_t vaddr );
+
+/*
+    axk_x86_read_timestamp
+    * Private Function
+    * Reads the timestamp counter (rdtsc), not serializing so it can be reordered with nearby instructions
+*/
+uint64_t axk_x86_read_timestamp( void );
+
+/*
+    axk_x86_copy_nt
+    * Private Function
+    * Copies 'count' bytes using non-temporal stores (movntdq), so the destination bypasses the cache
+    * Meant for memory that is only ever written (i.e. the framebuffer), an sfence is issued before returning
+*/
+void axk_x86_copy_nt( void* dest, const void* src, size_t count );
+
+/*
+    axk_x86_outb / axk_x86_inb
+    * Private Functions
+    * Writes/reads a single byte to/from an I/O port
+*/
+void axk_x86_outb( uint16_t port, uint8_t value );
+uint8_t axk_x86_inb( uint16_t port );
+
+struct axk_crash_registers_t;
+
+/*
+    axk_x86_capture_registers
+    * Private Function
+    * Writes the general purpose registers, flags and control registers into 'out_regs'
+    * 'rip' and 'rsp' are the values in the caller, right after this returns
+*/
+void axk_x86_capture_registers( struct axk_crash_registers_t* out_regs );
+
+#endif
@@ -24,4 +24,14 @@ bool axk_basicterminal_init( struct tzero_payload_parameters_t* in_params );
     * This is because, the virtual memory system is going to remove the identity mappings used by UEFI
     * This isnt the cleanest solution.. but for now its functional
 */
-void axk_basicterminal_update_pointers( void );
\ No newline at end of file
+void axk_basicterminal_update_pointers( void );
+
+/*
+    axk_basicterminal_init_shadow
+    * Private Function
+    * Allocates a copy of the screen in system memory, called once the kernel virtual address allocator is running
+    * Afterwards, drawing happens in the shadow buffer and only the changed scanlines are written to the framebuffer, so video memory
+      is never read again (scrolling used to memmove the entire framebuffer)
+    * Until this is called, or if it fails, everything is drawn straight to the framebuffer
+*/
+bool axk_basicterminal_init_shadow( void );
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*==============================================================
+    Axon Kernel - Crash Records (Private Header)
+    2021, Zachary Berry
+    axon/private/axon/kernel/crash_private.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/crash.h"
+
+/*
+    Constants
+    * The stack walk stops at the first frame pointer more than 'AXK_CRASH_STACK_SPAN' bytes above the stack pointer
+*/
+#define AXK_CRASH_STACK_SPAN    0x20000UL
+
+/*
+    axk_crash_init
+    * Private Function
+    * Locks the pages the crash record is written to (see 'AXK_CRASH_RECORD_PHYSICAL'), and reports the record left by the
+      previous boot if there is one
+    * Must be called right after the page allocator is initialized, before anything else can acquire the pages, while the
+      UEFI identity mappings are still in place
+    * If the pages cant be locked, panics wont write a record
+*/
+void axk_crash_init( void );
+
+/*
+    axk_crash_update_pointers
+    * Private Function
+    * Moves the record pointer over to the AXK_KERNEL_VA_PHYSICAL range, before the identity mappings are removed
+*/
+void axk_crash_update_pointers( void );
+
+/*
+    axk_crash_begin
+    * Private Function
+    * Called by 'axk_panic_begin' with the terminal lock held, clears the record, then captures the registers, walks the stack
+      and copies the console history
+*/
+void axk_crash_begin( uint64_t trigger_address );
+
+/*
+    axk_crash_message
+    * Private Function
+    * Adds text to the message in the record, anything past 'AXK_CRASH_MESSAGE_LENGTH' is dropped
+*/
+void axk_crash_message( const char* str, size_t len );
+
+/*
+    axk_crash_set_registers
+    * Private Function
+    * Replaces the captured registers with the state passed to 'axk_panic_set_pstate', and walks the stack again starting from it
+*/
+void axk_crash_set_registers( const struct axk_crash_registers_t* regs );
+
+/*
+    axk_crash_end
+    * Private Function
+    * Writes the checksum and magic number, making the record valid, and writes it back out of the caches
+*/
+void axk_crash_end( void );
\ No newline at end of file
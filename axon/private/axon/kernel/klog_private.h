@@ -0,0 +1,27 @@
+/*==============================================================
+    Axon Kernel - Kernel Log (Private Header)
+    2021, Zachary Berry
+    axon/private/axon/kernel/klog_private.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/klog.h"
+
+struct axk_percpu_t;
+
+/*
+    axk_klog_init_cpu
+    * Private Function
+    * Resets the log ring in a processor's data area, called while setting up the area, before it's published
+*/
+void axk_klog_init_cpu( struct axk_percpu_t* ptr_area );
+
+/*
+    axk_klog_panic_drain
+    * Private Function
+    * Draws every queued message synchronously, so nothing logged before a crash is lost
+    * Called from the panic path, which already holds the terminal lock, so this doesnt take any locks
+      (the processor that was draining might be the one that panicked)
+    * Records that were reserved but never finished (i.e. by a processor that was stopped while writing) end the drain for that ring
+*/
+void axk_klog_panic_drain( void );
\ No newline at end of file
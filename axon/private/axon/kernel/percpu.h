@@ -0,0 +1,110 @@
+/*==============================================================
+    Axon Kernel - Per-CPU Data (Private Header)
+    2021, Zachary Berry
+    axon/private/axon/kernel/percpu.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+#include "axon/system/sysinfo.h"
+#include "axon/library/atomic.h"
+#include "axon/library/rwlock.h"
+#include "axon/memory/memory_private.h"
+#include "axon/memory/kheap.h"
+#include "axon/kernel/klog.h"
+
+struct axk_rcu_head_t;
+
+/*
+    Per-CPU Data Area
+    * Each processor gets one of these, and its GS base register points to it
+    * Fields are reached through the 'AXK_PERCPU_*' macros below, which compile down to a single gs-relative instruction,
+      so theres no processor lookup or array indexing involved
+    * The structure is padded to a cache line boundary, so the areas of two processors never share a line
+    * Anything that is only ever touched by its own processor (allocator magazines, run-queues, interlink queues, etc..) should be added here
+*/
+struct axk_percpu_t
+{
+    // Must be the first field, so 'axk_percpu_self' can read it from gs:0
+    struct axk_percpu_t* self;
+    uint32_t cpu_index;
+    uint32_t apic_id;
+
+    // Statistics counter slots (see sysinfo.c), other processors only ever read these
+    struct axk_atomic_uint64_t counters[ AXK_COUNTER_CAPACITY ] __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+    // RCU state (see rcu.c), writers poll 'rcu_quiescent' so it gets its own cache line
+    struct axk_atomic_uint64_t rcu_quiescent __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+    struct axk_rcu_head_t* rcu_pending_head;
+    struct axk_rcu_head_t* rcu_pending_tail;
+
+    // Reader-writer lock reader counts (see rwlock.c), indexed by the slot each lock took when it was created
+    struct axk_atomic_uint32_t rwlock_readers[ AXK_RWLOCK_PERCPU_SLOTS ] __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+    // Object cache magazines (see kheap.c), indexed by cache
+    struct axk_kcache_magazine_t kcache_magazines[ AXK_KCACHE_MAX ];
+
+    // Kernel log ring (see klog.c), written by this processor and emptied by whichever processor drains the log
+    struct axk_klog_ring_t klog __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+/*
+    Accessor Macros
+    * '_field_' is a scalar member of 'struct axk_percpu_t', the offset of the field is encoded directly in a single gs-relative instruction
+    * 'AXK_PERCPU_ADD' also accepts array elements with a variable index (i.e. 'counters[ index ].val'), the offset is then passed in a register
+    * 'AXK_PERCPU_ADD' is one read-modify-write instruction, so it cant be torn by an interrupt on the same processor
+    * These are only safe while the caller cant be moved to another processor between the access and using the result
+*/
+#define AXK_PERCPU_OFFSET( _field_ )    __builtin_offsetof( struct axk_percpu_t, _field_ )
+#define __AXK_PERCPU_TYPE( _field_ )    __typeof__( ( (struct axk_percpu_t*) 0 )->_field_ )
+
+#define AXK_PERCPU_READ( _field_ ) \
+    ({ __AXK_PERCPU_TYPE( _field_ ) __val; __asm__ volatile( "mov %%gs:%c1, %0" : "=r"( __val ) : "i"( AXK_PERCPU_OFFSET( _field_ ) ) ); __val; })
+
+#define AXK_PERCPU_WRITE( _field_, _val_ ) \
+    __asm__ volatile( "mov %0, %%gs:%c1" : : "r"( (__AXK_PERCPU_TYPE( _field_ ))( _val_ ) ), "i"( AXK_PERCPU_OFFSET( _field_ ) ) : "memory" )
+
+#define AXK_PERCPU_ADD( _field_, _diff_ ) \
+    __asm__ volatile( "add %0, %%gs:(%1)" : : "r"( (__AXK_PERCPU_TYPE( _field_ ))( _diff_ ) ), "r"( (uint64_t) AXK_PERCPU_OFFSET( _field_ ) ) : "memory" )
+
+/*
+    axk_percpu_self
+    * Private Function
+    * Gets a normal pointer to the current processor's data area, for fields that are too large for the accessor macros
+*/
+static inline struct axk_percpu_t* axk_percpu_self( void )
+{
+    return AXK_PERCPU_READ( self );
+}
+
+/*
+    axk_percpu_init_bsp
+    * Private Function
+    * Sets up the data area for the bootstrap processor and loads its GS base
+    * Must be called before anything uses per-cpu data, including the system counters
+*/
+void axk_percpu_init_bsp( void );
+
+/*
+    axk_percpu_init_ap
+    * Private Function
+    * Allocates and zeroes a data area for an application processor, and loads the GS base of the calling processor with it
+    * Must be called on the processor being initialized, once the kernel address space allocator is available
+*/
+bool axk_percpu_init_ap( uint32_t cpu_index, uint32_t apic_id );
+
+/*
+    axk_percpu_get
+    * Private Function
+    * Gets the data area of another processor, returns NULL if the processor hasnt been initialized
+*/
+struct axk_percpu_t* axk_percpu_get( uint32_t cpu_index );
+
+/*
+    axk_percpu_ready
+    * Private Function
+    * Checks if the calling processor has loaded its own data area, the accessor macros and 'axk_percpu_self' are only safe once this returns true
+    * Reads the GS base MSR, so code that runs often should only use this on paths that can run before the area is loaded
+*/
+bool axk_percpu_ready( void );
\ No newline at end of file
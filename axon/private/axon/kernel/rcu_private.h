@@ -0,0 +1,18 @@
+/*==============================================================
+    Axon Kernel - Read-Copy-Update (Private Header)
+    2021, Zachary Berry
+    axon/private/axon/kernel/rcu_private.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/rcu.h"
+#include "axon/kernel/percpu.h"
+
+
+/*
+    axk_rcu_init_cpu
+    * Private Function
+    * Marks a new processor as already quiescent for the current grace period, so a writer doesnt wait on a processor that cant hold any pointers yet
+    * Called while setting up the processor's data area, before it's published
+*/
+void axk_rcu_init_cpu( struct axk_percpu_t* ptr_area );
\ No newline at end of file
@@ -8,6 +8,23 @@
 #include "axon/kernel/kernel.h"
 #include "axon/kernel/boot_params.h"
 
+/*
+    Constants
+*/
+#define AXK_KCACHE_MAGAZINE_SIZE    15
+
+/*
+    axk_kcache_magazine_t (Structure)
+    * A stack of free objects for one cache, owned by a single processor (see percpu.h)
+    * Sized to fill two cache lines exactly
+*/
+struct axk_kcache_magazine_t
+{
+    uint64_t count;
+    void* objects[ AXK_KCACHE_MAGAZINE_SIZE ];
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
 
 /*
     axk_page_allocator_init
@@ -48,3 +65,53 @@ uint64_t axk_page_reclaim( uint8_t target_state );
 */
 void axk_kmap_init( struct tzero_payload_parameters_t* in_params );
 
+/*
+    axk_va_allocator_init
+    * Private Function
+    * Initializes the kernel virtual address allocator, must be called after the kernel memory map is initialized
+*/
+void axk_va_allocator_init( void );
+
+/*
+    axk_kheap_init
+    * Private Function
+    * Creates the kernel heap size class caches, must be called after the virtual address allocator is initialized
+*/
+void axk_kheap_init( void );
+
+/*
+    axk_kheap_pool_init
+    * Private Function
+    * Initializes the pool used for heap allocations too large for the size class caches
+*/
+void axk_kheap_pool_init( void );
+
+/*
+    axk_kheap_pool_alloc
+    * Private Function
+    * Allocates a block from the heap pool, using segregated free lists (TLSF) so finding a block takes constant time
+*/
+void* axk_kheap_pool_alloc( uint64_t size );
+
+/*
+    axk_kheap_pool_free
+    * Private Function
+    * Releases a block back to the heap pool, its immediately merged with any free neighbours
+*/
+void axk_kheap_pool_free( void* ptr );
+
+/*
+    axk_kheap_pool_resize
+    * Private Function
+    * Tries to resize a block from the heap pool without moving it
+    * Shrinking always works, growing only works if the block directly after is free and large enough
+    * Returns false if the block couldnt be resized, in which case its left unchanged
+*/
+bool axk_kheap_pool_resize( void* ptr, uint64_t new_size );
+
+/*
+    axk_kheap_pool_size
+    * Private Function
+    * Gets the usable size of a block from the heap pool
+*/
+uint64_t axk_kheap_pool_size( void* ptr );
@@ -0,0 +1,26 @@
+/*==============================================================
+    Axon Kernel - CPU Features & Dispatch (Private Header)
+    2021, Zachary Berry
+    axon/private/axon/system/cpu_features_private.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+#include "axon/system/cpu_features.h"
+
+/*
+    axk_cpu_features_init
+    * Private Function
+    * Detects the processor features, and points every dispatch slot at its best candidate
+    * Called once on the BSP, as early in boot as possible, before any other processors are started
+*/
+void axk_cpu_features_init( void );
+
+/*
+    axk_dispatch_resolve
+    * Private Function
+    * Points every slot in a candidate table at its best usable candidate, given the set of 'AXK_CPU_FEATURE_*' flags in 'features'
+    * A candidate is usable if all of its features are present, the highest priority wins, and ties go to the first one in the table
+    * Returns the number of slots that were patched, 'axk_cpu_features_init' calls this with the '.axk_dispatch' section
+*/
+uint32_t axk_dispatch_resolve( const struct axk_dispatch_candidate_t* begin, const struct axk_dispatch_candidate_t* end, uint64_t features );
\ No newline at end of file
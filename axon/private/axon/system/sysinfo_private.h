@@ -31,30 +31,35 @@ void axk_counters_init( void );
 */
 void axk_sysinfo_write( uint32_t index, uint32_t sub_index, void* ptr_data, uint64_t data_size );
 
+/*
+    axk_counter_register
+    * Private Function
+    * Allocates a new counter index, starting at zero, indices below 'AXK_COUNTER_BUILTIN_COUNT' are always registered
+    * Fails once 'AXK_COUNTER_CAPACITY' counters exist, counters cant be unregistered
+*/
+bool axk_counter_register( uint32_t* out_index );
+
 /*
     axk_counter_increment
     * Private Function
-    * Increments a system-wide counter
-    * Atomic
-    * Returns the new value
+    * Adds to the current processor's slot of a counter
+    * Not a locked instruction, but safe against interrupts on the same processor
 */
-uint64_t axk_counter_increment( uint32_t index, uint64_t diff );
+void axk_counter_increment( uint32_t index, uint64_t diff );
 
 /*
     axk_counter_decrement
     * Private Function
-    * Decrements a system-wide counter
-    * Atomic
-    * Returns the new value
+    * Subtracts from the current processor's slot of a counter
+    * Individual slots may wrap, only the sum read by 'axk_counter_read' is meaningful
 */
-uint64_t axk_counter_decrement( uint32_t index, uint64_t diff );
+void axk_counter_decrement( uint32_t index, uint64_t diff );
 
 /*
     axk_counter_write
     * Private Function
-    * Writes a new value to a system-wide counter
-    * Atomic
+    * Writes a new value to a system-wide counter, by clearing every other processor's slot
+    * Increments running concurrently on other processors may be lost, meant for initialization
     * Returns the input value
 */
 uint64_t axk_counter_write( uint32_t index, uint64_t value );
-
@@ -166,6 +166,17 @@ void axk_basicterminal_printh32( uint32_t num, bool b_leading_zeros );
 */
 void axk_basicterminal_printh64( uint64_t num, bool b_leading_zeros );
 
+/*
+    axk_basicterminal_printf
+    * Private Function
+    * Formats a string with libk 'vsnprintf' into a stack buffer, and prints it with a single call to 'axk_basicterminal_prints'
+    * Output longer than 'BASIC_TERMINAL_PRINTF_MAX' characters is truncated
+    * This is for use ONLY before a proper video driver is loaded in the boot process
+    * NOTE: Can only be used in 'console' mode
+*/
+#define BASIC_TERMINAL_PRINTF_MAX 255
+void axk_basicterminal_printf( const char* fmt, ... ) __attribute__((format( printf, 1, 2 )));
+
 /*
     axk_basicterminal_draw_text
     * Private Function
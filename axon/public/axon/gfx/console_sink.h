@@ -0,0 +1,55 @@
+/*==============================================================
+    Axon Kernel - Console Sinks
+    2021, Zachary Berry
+    axon/public/axon/gfx/console_sink.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Console Sinks
+    * Everything printed through the basic terminal (and the panic message) is also copied to each registered sink,
+      so there is a text copy of the console somewhere other than the framebuffer (i.e. a serial port)
+    * Sinks are written while the basic terminal lock is held, so a sink doesnt need its own lock, but it must not print
+      through the basic terminal itself
+    * The write function must work from the panic path, so it can't allocate memory or wait on interrupts
+*/
+
+/*
+    Constants
+*/
+#define AXK_CONSOLE_MAX_SINKS       4
+#define AXK_CONSOLE_HISTORY_SIZE    4096
+
+/*
+    axk_console_sink_t (Structure)
+    * 'fn_write' receives the text exactly as it was printed, it isnt null terminated
+*/
+struct axk_console_sink_t
+{
+    const char* name;
+    void( *fn_write )( struct axk_console_sink_t* self, const char* str, size_t len );
+    void* context;
+};
+
+/*
+    axk_console_register_sink
+    * Adds a sink, the structure must stay valid forever since sinks cant be removed
+    * Returns false if 'AXK_CONSOLE_MAX_SINKS' are already registered
+*/
+bool axk_console_register_sink( struct axk_console_sink_t* sink );
+
+/*
+    axk_console_write
+    * Passes text to every registered sink, called by the basic terminal and panic system with the terminal lock held
+    * The last 'AXK_CONSOLE_HISTORY_SIZE' bytes are also kept in memory, even if there are no sinks
+*/
+void axk_console_write( const char* str, size_t len );
+
+/*
+    axk_console_copy_history
+    * Copies up to 'size' of the most recently written bytes into 'out_buffer', oldest first, and returns the number of bytes copied
+    * The output isnt null terminated. The terminal lock must be held, so the history isnt written at the same time
+*/
+size_t axk_console_copy_history( char* out_buffer, size_t size );
\ No newline at end of file
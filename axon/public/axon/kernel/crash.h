@@ -0,0 +1,117 @@
+/*==============================================================
+    Axon Kernel - Crash Records
+    2021, Zachary Berry
+    axon/public/axon/kernel/crash.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Crash Records
+    * When the kernel panics, a record of the crash (registers, a stack trace, the message and the end of the console output) is
+      written to a few physical pages that are reserved at boot, along with the text panic screen
+    * The pages are always at 'AXK_CRASH_RECORD_PHYSICAL', and memory isnt cleared on a warm reboot, so the next boot can find the
+      record and report it
+    * Records are checked with a magic number, size and checksum before they are trusted, the firmware is free to use the memory
+      in between boots
+*/
+
+/*
+    Constants
+*/
+#define AXK_CRASH_MAGIC             0x504D5544484B5841UL    // "AXKHDUMP"
+#define AXK_CRASH_MAGIC_REPORTED    0x54525052484B5841UL    // "AXKHRPRT", a valid record that was already reported
+#define AXK_CRASH_VERSION           1U
+#define AXK_CRASH_RECORD_PAGES      2UL
+
+/*
+    AXK_CRASH_RECORD_PHYSICAL
+    * Physical address of the crash record, 0x6000 to 0x7FFF
+    * It sits right below the processor init page at 0x8000, and the page allocator never puts its page list below 0x9000, so
+      nothing else in the kernel uses it
+    * UEFI hands out memory from the top of the highest range down, so the firmware and bootloader are very unlikely to allocate
+      it, and since the address doesnt depend on the memory map, the next boot looks in the same place even if the map changed
+    * If the firmware reports the pages as anything but available memory, they arent reserved and panics wont write a record
+*/
+#define AXK_CRASH_RECORD_PHYSICAL   0x6000UL
+#define AXK_CRASH_MAX_FRAMES        32
+#define AXK_CRASH_SYMBOL_LENGTH     48
+#define AXK_CRASH_MESSAGE_LENGTH    512
+#define AXK_CRASH_LOG_LENGTH        4096
+
+/*
+    axk_crash_registers_t (Structure)
+    * Register state at the time of the panic, the layout is relied on by 'axk_x86_capture_registers'
+    * If the panic came from an exception handler, it can pass the interrupted state in with 'axk_panic_set_pstate'
+*/
+struct axk_crash_registers_t
+{
+    uint64_t rax;
+    uint64_t rbx;
+    uint64_t rcx;
+    uint64_t rdx;
+    uint64_t rsi;
+    uint64_t rdi;
+    uint64_t rbp;
+    uint64_t rsp;
+    uint64_t r8;
+    uint64_t r9;
+    uint64_t r10;
+    uint64_t r11;
+    uint64_t r12;
+    uint64_t r13;
+    uint64_t r14;
+    uint64_t r15;
+    uint64_t rip;
+    uint64_t rflags;
+    uint64_t cr0;
+    uint64_t cr2;
+    uint64_t cr3;
+    uint64_t cr4;
+};
+
+/*
+    axk_crash_frame_t (Structure)
+    * One return address from the stack walk
+    * The symbol name is copied in, so the record can still be read after the kernel image changes
+*/
+struct axk_crash_frame_t
+{
+    uint64_t address;
+    uint64_t offset;
+    char symbol[ AXK_CRASH_SYMBOL_LENGTH ];
+};
+
+/*
+    axk_crash_record_t (Structure)
+    * 'checksum' covers everything after itself, so the magic number can be changed without invalidating the record
+    * 'log_tail' is the last 'log_length' bytes written to the console, oldest first, it isnt null terminated
+    * 'timestamp' is the raw timestamp counter
+*/
+struct axk_crash_record_t
+{
+    uint64_t magic;
+    uint64_t checksum;
+    uint32_t version;
+    uint32_t size;
+    uint64_t timestamp;
+    uint64_t trigger_address;
+    uint32_t cpu_index;
+    uint32_t frame_count;
+    uint32_t message_length;
+    uint32_t log_length;
+
+    struct axk_crash_registers_t registers;
+    struct axk_crash_frame_t frames[ AXK_CRASH_MAX_FRAMES ];
+    char message[ AXK_CRASH_MESSAGE_LENGTH ];
+    char log_tail[ AXK_CRASH_LOG_LENGTH ];
+};
+
+/*
+    axk_crash_get_previous
+    * Gets the crash record left behind by the last boot
+    * Returns NULL if there wasnt one, or the reserved pages couldnt be set up
+    * The record is only valid until the next panic, which overwrites it
+*/
+const struct axk_crash_record_t* axk_crash_get_previous( void );
\ No newline at end of file
@@ -19,6 +19,8 @@
 */
 #define AXK_KERNEL_VA_PHYSICAL  0xFFFF800000000000UL
 #define AXK_KERNEL_VA_HEAP      0xFFFFC00000000000UL
+#define AXK_KERNEL_VA_POOL      0xFFFFC80000000000UL
+#define AXK_KERNEL_VA_SLAB      0xFFFFD00000000000UL
 #define AXK_KERNEL_VA_SHARED    0xFFFFE00000000000UL
 #define AXK_KERNEL_VA_IMAGE     0xFFFFFFFF80000000UL
 
@@ -34,6 +36,9 @@
 #define AXK_HUGE_PAGE_SIZE  0x200000UL
 #endif
 
+#define AXK_MAX_CPUS            64
+#define AXK_CACHE_LINE_SIZE     64
+
 #define AXK_PROCESS_INVALID     0UL
 #define AXK_PROCESS_KERNEL      1UL
 
@@ -86,4 +91,12 @@ uint64_t axk_get_kernel_offset( void );
     axk_get_kernel_size
     * Gets the size of the kernel image in bytes
 */
-uint64_t axk_get_kernel_size( void );
\ No newline at end of file
+uint64_t axk_get_kernel_size( void );
+
+/*
+    axk_get_cpu_index
+    * Gets the index of the processor this code is running on, in the range [0, AXK_MAX_CPUS)
+    * Read from the per-cpu data area, so this is a single instruction and doesnt touch the local APIC
+    * The result is only stable while the caller cant be moved to another processor (i.e. interrupts disabled, or no scheduler yet)
+*/
+uint32_t axk_get_cpu_index( void );
\ No newline at end of file
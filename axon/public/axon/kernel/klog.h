@@ -0,0 +1,67 @@
+/*==============================================================
+    Axon Kernel - Kernel Log
+    2021, Zachary Berry
+    axon/public/axon/kernel/klog.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+#include "axon/library/atomic.h"
+
+/*
+    Kernel Log
+    * Logging through 'axk_klog' doesnt draw anything, each processor has a fixed-size ring of binary records, and the caller only
+      copies the format string pointer and the raw arguments into the next free record
+    * The records are formatted and drawn to the basic terminal later by 'axk_klog_drain' (from the idle loop), in timestamp order
+    * Reserving a record is a single compare-exchange, so logging is safe from interrupts and never waits on a lock
+    * If the ring is full, the message is dropped and counted, and the count is printed the next time the log is drained
+*/
+
+/*
+    Constants
+*/
+#define AXK_KLOG_RING_SIZE      256
+#define AXK_KLOG_MAX_ARGS       5
+
+/*
+    axk_klog_record_t (Structure)
+    * A single message waiting to be drawn, 'seq' is set to the ring position plus one once the record is fully written
+*/
+struct axk_klog_record_t
+{
+    struct axk_atomic_uint64_t seq;
+    const char* fmt;
+    uint64_t timestamp;
+    uint64_t args[ AXK_KLOG_MAX_ARGS ];
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+/*
+    axk_klog_ring_t (Structure)
+    * Per-processor message ring, stored in the processor's data area
+    * 'head' is the next position handed out to a writer, 'tail' is the next position to be drawn, and only the drain moves it
+*/
+struct axk_klog_ring_t
+{
+    struct axk_atomic_uint64_t head;
+    struct axk_atomic_uint64_t dropped;
+    struct axk_atomic_uint64_t tail __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+    struct axk_klog_record_t records[ AXK_KLOG_RING_SIZE ];
+};
+
+/*
+    axk_klog
+    * Queues a message on the current processor's log ring
+    * Takes the same formats as libk 'snprintf', the arguments are captured with 'vsnprintf_capture' and formatted by the drain
+    * At most 'AXK_KLOG_MAX_ARGS' arguments are captured (a '*' width or precision counts as one), any more are printed as zero
+    * 'fmt' and any string passed for %s must stay valid until the message is drawn, so they should be string literals
+    * Before the processor's data area is setup, the message is drawn immediately instead
+*/
+void axk_klog( const char* fmt, ... ) __attribute__((format( printf, 1, 2 )));
+
+/*
+    axk_klog_drain
+    * Draws every queued message from every processor to the basic terminal, oldest first
+    * Takes the terminal lock, if another processor is already draining the log, this returns immediately
+*/
+void axk_klog_drain( void );
\ No newline at end of file
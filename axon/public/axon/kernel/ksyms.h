@@ -0,0 +1,32 @@
+/*==============================================================
+    Axon Kernel - Kernel Symbol Table
+    2021, Zachary Berry
+    axon/public/axon/kernel/ksyms.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Kernel Symbol Table
+    * The kernel is linked twice, the function symbols from the first link are written out as a table (sorted by address) and
+      linked into the '.axk_ksyms' section of the final image. Nothing before that section moves, so the addresses match
+    * Only function symbols are included
+*/
+
+/*
+    axk_ksym_t (Structure)
+*/
+struct axk_ksym_t
+{
+    uint64_t address;
+    const char* name;
+};
+
+/*
+    axk_ksyms_lookup
+    * Finds the function containing 'address', the closest symbol at or below it
+    * Returns the symbol name and writes the distance from the start of the symbol to 'out_offset' (if not NULL)
+    * Returns NULL if the address is below the first symbol, or past the end of the kernel image text
+*/
+const char* axk_ksyms_lookup( uint64_t address, uint64_t* out_offset );
\ No newline at end of file
@@ -32,6 +32,7 @@ __attribute__((noreturn, noinline)) void axk_panic( const char* str );
        - axk_panic_set_pstate   (Indicate processor information structure to display on the panic screen)
     * Then, this sequence MUST be terminated by a call to 'axk_panic_end'!!!!
     * This function call will stop the other processors and start displaying the static portions of the panic screen
+    * A crash record is also started (see axon/kernel/crash.h), it isnt valid until 'axk_panic_end'
 */
 __attribute__((noinline)) void axk_panic_begin( void );
 
@@ -59,6 +60,8 @@ void axk_panic_printh( uint64_t num, bool b_leading_zeros );
 /*
     axk_panic_set_pstate
     * After calling 'axk_panic_begin', this function can be called to display processor state on the panic screen
+    * 'pstate' points to a 'struct axk_crash_registers_t' (see axon/kernel/crash.h), it replaces the registers in the crash record,
+      and the stack trace is taken from it instead
     * Once all 'print' (and set_pstate) function calls are complete, the CALLER must call 'axk_panic_end'
 */
 void axk_panic_set_pstate( void* pstate );
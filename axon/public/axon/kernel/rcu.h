@@ -0,0 +1,92 @@
+/*==============================================================
+    Axon Kernel - Read-Copy-Update
+    2021, Zachary Berry
+    axon/public/axon/kernel/rcu.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+#include "axon/library/atomic.h"
+
+/*
+    Quiescent-State Based RCU
+    * For read-mostly tables (handler tables, process lists, etc..), readers take no lock and write nothing to shared memory
+    * Writers build a new copy, publish it with 'axk_rcu_assign', and free the old copy once every processor has passed a quiescent state
+    * A quiescent state is any point where a processor holds no RCU protected pointers, each processor reports them by calling
+      'axk_rcu_quiescent' from points that are known to be outside every read-side section (i.e. the idle loop, and the context
+      switch once there is a scheduler)
+    * An interrupt handler (such as a timer tick) must not report one unless it interrupted user mode or the idle loop, since
+      the interrupted code could be part way through a read-side section
+    * Readers must not block or report a quiescent state while inside a read-side section
+    * Writers still need to serialize with each other, using a normal lock
+*/
+
+/*
+    axk_rcu_head_t (Structure)
+    * Embedded in objects that are freed through 'axk_rcu_call'
+*/
+struct axk_rcu_head_t
+{
+    struct axk_rcu_head_t* next;
+    uint64_t period;
+    void( *fn_callback )( struct axk_rcu_head_t* );
+};
+
+/*
+    axk_rcu_read_lock
+    * Marks the start of a read-side section
+    * Generates no code, only stops the compiler from moving loads out of the section
+*/
+static inline void axk_rcu_read_lock( void )
+{
+    __asm__ volatile( "" ::: "memory" );
+}
+
+/*
+    axk_rcu_read_unlock
+    * Marks the end of a read-side section
+*/
+static inline void axk_rcu_read_unlock( void )
+{
+    __asm__ volatile( "" ::: "memory" );
+}
+
+/*
+    axk_rcu_dereference
+    * Loads an RCU protected pointer from within a read-side section
+*/
+static inline void* axk_rcu_dereference( struct axk_atomic_pointer_t* ptr )
+{
+    return axk_atomic_load_pointer_acquire( ptr );
+}
+
+/*
+    axk_rcu_assign
+    * Publishes a new version of an RCU protected pointer, everything written to the new version beforehand is visible to readers that load it
+*/
+static inline void axk_rcu_assign( struct axk_atomic_pointer_t* ptr, void* value )
+{
+    axk_atomic_store_pointer_release( ptr, value );
+}
+
+/*
+    axk_rcu_quiescent
+    * Reports that the current processor isnt inside a read-side section
+    * Also runs any callbacks queued on this processor, whose grace period has ended
+*/
+void axk_rcu_quiescent( void );
+
+/*
+    axk_rcu_synchronize
+    * Waits until every processor has passed a quiescent state, after which no reader can still hold a pointer that was unpublished before the call
+    * Spins, so this should only be used on slow paths, 'axk_rcu_call' doesnt wait
+    * Must not be called from within a read-side section
+*/
+void axk_rcu_synchronize( void );
+
+/*
+    axk_rcu_call
+    * Queues 'fn_callback' to be run on this processor once every processor has passed a quiescent state
+    * The callback usually frees the object that 'head' is embedded in
+*/
+void axk_rcu_call( struct axk_rcu_head_t* head, void( *fn_callback )( struct axk_rcu_head_t* ) );
\ No newline at end of file
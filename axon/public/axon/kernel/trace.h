@@ -0,0 +1,67 @@
+/*==============================================================
+    Axon Kernel - Boot Trace
+    2021, Zachary Berry
+    axon/public/axon/kernel/trace.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Boot tracing is only compiled in when 'AXK_BOOT_TRACE' is defined (build with 'AXON_BOOT_TRACE=1')
+    Otherwise, 'AXK_TRACE' expands to nothing and the buffers dont exist
+*/
+
+/*
+    Event Identifiers
+    * Boot events are recorded once a step is finished, so the time since the event before it is how long that step took
+*/
+#define AXK_TRACE_NONE                  0
+#define AXK_TRACE_BOOT_ENTRY            1
+#define AXK_TRACE_BOOT_TERMINAL         2
+#define AXK_TRACE_BOOT_PANIC            3
+#define AXK_TRACE_BOOT_UART             4
+#define AXK_TRACE_BOOT_HANDOFF          5
+#define AXK_TRACE_BOOT_CPU_FEATURES     6
+#define AXK_TRACE_BOOT_PERCPU           7
+#define AXK_TRACE_BOOT_COUNTERS         8
+#define AXK_TRACE_BOOT_PAGE_ALLOCATOR   9
+#define AXK_TRACE_BOOT_CRASH            10
+#define AXK_TRACE_BOOT_KMAP             11
+#define AXK_TRACE_BOOT_VA_ALLOCATOR     12
+#define AXK_TRACE_BOOT_KHEAP            13
+#define AXK_TRACE_BOOT_SHADOW           14
+#define AXK_TRACE_EVENT_COUNT           15
+
+#ifdef AXK_BOOT_TRACE
+
+/*
+    Constants
+*/
+#define AXK_TRACE_BUFFER_EVENTS     128
+
+/*
+    axk_trace
+    * Records an event into the buffer of the current processor, without taking any locks
+    * Timestamps are the raw timestamp counter, the counters are assumed to be synchronized across processors
+    * Usable from the first line of the kernel on the bootstrap processor, any processor that hasnt loaded its own per-cpu data
+      yet (including an application processor early in its startup) has its events charged to processor 0
+    * Once a buffer is full, further events are counted as dropped, so the earliest events are always kept
+*/
+void axk_trace( uint32_t event, uint64_t arg_0, uint64_t arg_1 );
+
+/*
+    axk_trace_print_timeline
+    * Prints every recorded event from all processors in timestamp order, with the cycles since the first event and since the
+      event before it, through the basic terminal (and so any console sinks, i.e. the serial port)
+    * Events still being written on other processors are skipped
+*/
+void axk_trace_print_timeline( void );
+
+#define AXK_TRACE( _event_, _arg_0_, _arg_1_ ) axk_trace( ( _event_ ), (uint64_t)( _arg_0_ ), (uint64_t)( _arg_1_ ) )
+
+#else
+
+#define AXK_TRACE( _event_, _arg_0_, _arg_1_ ) ( (void)( 0 ) )
+
+#endif
\ No newline at end of file
@@ -85,7 +85,7 @@ inline bool axk_atomic_load_bool( struct axk_atomic_bool_t* ptr, enum memory_ord
 
 inline bool axk_atomic_exchg_bool( struct axk_atomic_bool_t* ptr, bool in, enum memory_order_t order )
 {
-    return __atomic_exchange_n( &( ptr->val ), &in, __axk_get_gcc_mem_order( order ) );
+    return __atomic_exchange_n( &( ptr->val ), in, __axk_get_gcc_mem_order( order ) );
 }
 
 inline bool axk_atomic_cmpexchg_bool( struct axk_atomic_bool_t* ptr, bool* expected, bool desired, bool is_strong, enum memory_order_t success_order, enum memory_order_t failure_order )
@@ -133,7 +133,7 @@ inline uint32_t axk_atomic_load_uint32( struct axk_atomic_uint32_t* ptr, enum me
 
 inline uint32_t axk_atomic_exchg_uint32( struct axk_atomic_uint32_t* ptr, uint32_t in, enum memory_order_t order )
 {
-    return __atomic_exchange_n( &( ptr->val ), &in, __axk_get_gcc_mem_order( order ) );
+    return __atomic_exchange_n( &( ptr->val ), in, __axk_get_gcc_mem_order( order ) );
 }
 
 inline bool axk_atomic_cmpexchg_uint32( struct axk_atomic_uint32_t* ptr, uint32_t* expected, uint32_t desired, bool is_strong, enum memory_order_t success_order, enum memory_order_t failure_order )
@@ -182,7 +182,7 @@ inline uint64_t axk_atomic_load_uint64( struct axk_atomic_uint64_t* ptr, enum me
 
 inline uint64_t axk_atomic_exchg_uint64( struct axk_atomic_uint64_t* ptr, uint64_t in, enum memory_order_t order )
 {
-    return __atomic_exchange_n( &( ptr->val ), &in, __axk_get_gcc_mem_order( order ) );
+    return __atomic_exchange_n( &( ptr->val ), in, __axk_get_gcc_mem_order( order ) );
 }
 
 inline bool axk_atomic_cmpexchg_uint64( struct axk_atomic_uint64_t* ptr, uint64_t* expected, uint64_t desired, bool is_strong, enum memory_order_t success_order, enum memory_order_t failure_order )
@@ -232,10 +232,103 @@ inline void* axk_atomic_load_pointer( struct axk_atomic_pointer_t* ptr, enum mem
 
 inline void* axk_atomic_exchg_pointer( struct axk_atomic_pointer_t* ptr, void* in, enum memory_order_t order )
 {
-    return __atomic_exchange_n( &( ptr->val ), &in, __axk_get_gcc_mem_order( order ) );
+    return __atomic_exchange_n( &( ptr->val ), in, __axk_get_gcc_mem_order( order ) );
 }
 
 inline bool axk_atomic_cmpexchg_pointer( struct axk_atomic_pointer_t* ptr, void** expected, void* desired, bool is_strong, enum memory_order_t success_order, enum memory_order_t failure_order )
 {
     return __atomic_compare_exchange_n( &( ptr->val ), expected, desired, is_strong, __axk_get_gcc_mem_order( success_order ), __axk_get_gcc_mem_order( failure_order ) );
 }
+
+
+/*
+    Fences
+*/
+
+inline void axk_atomic_thread_fence( enum memory_order_t order )
+{
+    __atomic_thread_fence( __axk_get_gcc_mem_order( order ) );
+}
+
+
+/*
+    Fixed-Order Operations
+    * Same operations as above, but the memory order is part of the function name, so only valid orderings exist
+      (i.e. there is no acquire store) and passing an invalid order is a compile error instead of silently falling back on SEQ_CST
+    * The order is always a constant, so the compiler never needs to resolve it at runtime
+    * Use the weakest order that is correct, on x86 a SEQ_CST store needs a full fence, while relaxed/release stores are a plain 'mov'
+    * Statistics counters and other values nothing else is ordered against should be relaxed
+*/
+#define __AXK_ATOMIC_FIXED_LOAD( _name_, _ty_, _sfx_, _order_ ) \
+    inline _ty_ axk_atomic_load_##_name_##_##_sfx_( struct axk_atomic_##_name_##_t* ptr ) \
+    { return __atomic_load_n( &( ptr->val ), _order_ ); }
+
+#define __AXK_ATOMIC_FIXED_STORE( _name_, _ty_, _sfx_, _order_ ) \
+    inline void axk_atomic_store_##_name_##_##_sfx_( struct axk_atomic_##_name_##_t* ptr, _ty_ in ) \
+    { __atomic_store_n( &( ptr->val ), in, _order_ ); }
+
+#define __AXK_ATOMIC_FIXED_EXCHG( _name_, _ty_, _sfx_, _order_ ) \
+    inline _ty_ axk_atomic_exchg_##_name_##_##_sfx_( struct axk_atomic_##_name_##_t* ptr, _ty_ in ) \
+    { return __atomic_exchange_n( &( ptr->val ), in, _order_ ); }
+
+#define __AXK_ATOMIC_FIXED_CMPEXCHG( _name_, _ty_, _sfx_, _order_, _fail_order_ ) \
+    inline bool axk_atomic_cmpexchg_##_name_##_##_sfx_( struct axk_atomic_##_name_##_t* ptr, _ty_* expected, _ty_ desired ) \
+    { return __atomic_compare_exchange_n( &( ptr->val ), expected, desired, false, _order_, _fail_order_ ); }
+
+#define __AXK_ATOMIC_FIXED_RMW( _op_, _name_, _ty_, _sfx_, _order_ ) \
+    inline _ty_ axk_atomic_##_op_##_##_name_##_##_sfx_( struct axk_atomic_##_name_##_t* ptr, _ty_ in ) \
+    { return __atomic_##_op_( &( ptr->val ), in, _order_ ); }
+
+#define __AXK_ATOMIC_FIXED_COMMON( _name_, _ty_ ) \
+    __AXK_ATOMIC_FIXED_LOAD( _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_LOAD( _name_, _ty_, acquire, __ATOMIC_ACQUIRE ) \
+    __AXK_ATOMIC_FIXED_LOAD( _name_, _ty_, seq_cst, __ATOMIC_SEQ_CST ) \
+    __AXK_ATOMIC_FIXED_STORE( _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_STORE( _name_, _ty_, release, __ATOMIC_RELEASE ) \
+    __AXK_ATOMIC_FIXED_STORE( _name_, _ty_, seq_cst, __ATOMIC_SEQ_CST ) \
+    __AXK_ATOMIC_FIXED_EXCHG( _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_EXCHG( _name_, _ty_, acquire, __ATOMIC_ACQUIRE ) \
+    __AXK_ATOMIC_FIXED_EXCHG( _name_, _ty_, release, __ATOMIC_RELEASE ) \
+    __AXK_ATOMIC_FIXED_EXCHG( _name_, _ty_, acq_rel, __ATOMIC_ACQ_REL ) \
+    __AXK_ATOMIC_FIXED_CMPEXCHG( _name_, _ty_, relaxed, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_CMPEXCHG( _name_, _ty_, acquire, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) \
+    __AXK_ATOMIC_FIXED_CMPEXCHG( _name_, _ty_, release, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_CMPEXCHG( _name_, _ty_, acq_rel, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+
+#define __AXK_ATOMIC_FIXED_INTEGER( _name_, _ty_ ) \
+    __AXK_ATOMIC_FIXED_COMMON( _name_, _ty_ ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_add, _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_add, _name_, _ty_, acquire, __ATOMIC_ACQUIRE ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_add, _name_, _ty_, release, __ATOMIC_RELEASE ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_add, _name_, _ty_, seq_cst, __ATOMIC_SEQ_CST ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_sub, _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_sub, _name_, _ty_, acquire, __ATOMIC_ACQUIRE ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_sub, _name_, _ty_, release, __ATOMIC_RELEASE ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_sub, _name_, _ty_, seq_cst, __ATOMIC_SEQ_CST ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_and, _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_and, _name_, _ty_, release, __ATOMIC_RELEASE ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_or, _name_, _ty_, relaxed, __ATOMIC_RELAXED ) \
+    __AXK_ATOMIC_FIXED_RMW( fetch_or, _name_, _ty_, acquire, __ATOMIC_ACQUIRE )
+
+// 'bool' is itself a macro, so these have to be listed out instead of going through '__AXK_ATOMIC_FIXED_COMMON'
+__AXK_ATOMIC_FIXED_LOAD( bool, bool, relaxed, __ATOMIC_RELAXED )
+__AXK_ATOMIC_FIXED_LOAD( bool, bool, acquire, __ATOMIC_ACQUIRE )
+__AXK_ATOMIC_FIXED_LOAD( bool, bool, seq_cst, __ATOMIC_SEQ_CST )
+__AXK_ATOMIC_FIXED_STORE( bool, bool, relaxed, __ATOMIC_RELAXED )
+__AXK_ATOMIC_FIXED_STORE( bool, bool, release, __ATOMIC_RELEASE )
+__AXK_ATOMIC_FIXED_STORE( bool, bool, seq_cst, __ATOMIC_SEQ_CST )
+__AXK_ATOMIC_FIXED_EXCHG( bool, bool, relaxed, __ATOMIC_RELAXED )
+__AXK_ATOMIC_FIXED_EXCHG( bool, bool, acquire, __ATOMIC_ACQUIRE )
+__AXK_ATOMIC_FIXED_EXCHG( bool, bool, release, __ATOMIC_RELEASE )
+__AXK_ATOMIC_FIXED_EXCHG( bool, bool, acq_rel, __ATOMIC_ACQ_REL )
+__AXK_ATOMIC_FIXED_CMPEXCHG( bool, bool, relaxed, __ATOMIC_RELAXED, __ATOMIC_RELAXED )
+__AXK_ATOMIC_FIXED_CMPEXCHG( bool, bool, acquire, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE )
+__AXK_ATOMIC_FIXED_CMPEXCHG( bool, bool, release, __ATOMIC_RELEASE, __ATOMIC_RELAXED )
+__AXK_ATOMIC_FIXED_CMPEXCHG( bool, bool, acq_rel, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE )
+__AXK_ATOMIC_FIXED_COMMON( pointer, void* )
+__AXK_ATOMIC_FIXED_INTEGER( uint32, uint32_t )
+__AXK_ATOMIC_FIXED_INTEGER( uint64, uint64_t )
+
+inline void axk_atomic_fence_acquire( void )    { __atomic_thread_fence( __ATOMIC_ACQUIRE ); }
+inline void axk_atomic_fence_release( void )    { __atomic_thread_fence( __ATOMIC_RELEASE ); }
+inline void axk_atomic_fence_seq_cst( void )    { __atomic_thread_fence( __ATOMIC_SEQ_CST ); }
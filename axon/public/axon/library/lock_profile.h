@@ -0,0 +1,67 @@
+/*==============================================================
+    Axon Kernel - Lock Contention Profiler
+    2021, Zachary Berry
+    axon/public/axon/library/lock_profile.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Lock profiling is only compiled in when 'AXK_LOCK_PROFILE' is defined (build with 'AXON_LOCK_PROFILE=1')
+    Otherwise, none of this exists and the locks have zero overhead
+*/
+#ifdef AXK_LOCK_PROFILE
+
+/*
+    Constants
+*/
+#define AXK_LOCK_PROFILE_MAX_SITES      256
+#define AXK_LOCK_PROFILE_MAX_REPORT     32
+
+/*
+    axk_lock_stats_t (Structure)
+    * Profiling data for a single lock, or a single call site
+    * All times are in processor timestamp counter cycles
+*/
+struct axk_lock_stats_t
+{
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t spin_cycles;
+    uint64_t max_hold_cycles;
+};
+
+/*
+    axk_lock_profile_timestamp
+    * Reads the processor timestamp counter, used to time spinning and holding
+*/
+uint64_t axk_lock_profile_timestamp( void );
+
+/*
+    axk_lock_profile_record
+    * Called by the lock implementations when a lock is released, adds the acquisition to the stats for the call site that acquired it
+    * Call sites are tracked in a fixed size table, if it fills up new sites are counted in 'dropped' instead
+*/
+void axk_lock_profile_record( void* site, uint64_t spin_cycles, uint64_t hold_cycles, bool b_contended );
+
+/*
+    axk_lock_profile_get_site
+    * Reads the stats recorded for a call site
+*/
+bool axk_lock_profile_get_site( void* site, struct axk_lock_stats_t* out_stats );
+
+/*
+    axk_lock_profile_dump
+    * Prints the 'count' call sites with the most cycles spent spinning to the basic terminal
+    * The addresses printed are the return addresses of the lock acquire calls
+*/
+void axk_lock_profile_dump( uint32_t count );
+
+/*
+    axk_lock_profile_reset
+    * Clears all recorded call site stats
+*/
+void axk_lock_profile_reset( void );
+
+#endif
@@ -0,0 +1,68 @@
+/*==============================================================
+    Axon Kernel - MCS Queue Lock Library
+    2021, Zachary Berry
+    axon/public/axon/library/mcslock.h
+==============================================================*/
+
+#pragma once
+#include "axon/library/spinlock.h"
+
+
+/*
+    axk_mcslock_node_t (Structure)
+    * Queue entry for a single waiter/holder of an MCS lock
+    * Provided by the caller (usually on the stack), and must stay valid from acquire until release
+    * Each waiter spins on its own node, so a release only touches the cache line of the next waiter
+*/
+struct axk_mcslock_node_t
+{
+    struct axk_atomic_pointer_t next;
+    struct axk_atomic_bool_t locked;
+    uint64_t rflags;
+
+    #ifdef AXK_LOCK_PROFILE
+    void* hold_site;
+    uint64_t hold_begin;
+    uint64_t hold_spin_cycles;
+    bool hold_contended;
+    #endif
+};
+
+/*
+    axk_mcslock_t (Structure)
+    * Fair queued spinlock, better suited than 'axk_spinlock_t' for locks that see a lot of contention
+*/
+struct axk_mcslock_t
+{
+    struct axk_atomic_pointer_t tail;
+};
+
+/*
+    axk_mcslock_init
+*/
+void axk_mcslock_init( struct axk_mcslock_t* lock );
+
+/*
+    axk_mcslock_acquire
+    * Disables interrupts, queues 'node' onto the lock and waits until its our turn
+    * The same node must be passed to 'axk_mcslock_release'
+*/
+void axk_mcslock_acquire( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node );
+
+/*
+    axk_mcslock_acquire_at
+    * Same as 'axk_mcslock_acquire', but the lock profiler charges the acquisition to 'site' instead of the caller
+    * Like 'axk_spinlock_acquire_at', functions that wrap an MCS lock pass their own return address
+*/
+void axk_mcslock_acquire_at( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node, void* site );
+
+/*
+    axk_mcslock_release
+    * Passes the lock to the next queued node (if any) and restores the interrupt state from before the lock was acquired
+*/
+void axk_mcslock_release( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node );
+
+/*
+    axk_mcslock_is_locked
+*/
+bool axk_mcslock_is_locked( struct axk_mcslock_t* lock );
@@ -35,6 +35,7 @@ struct axk_rbtree_t
     uint64_t elem_size;
     void( *fn_finalize )( void* );
     void( *fn_copy )( void*, void* );
+    struct axk_allocator_t* allocator;
 };
 
 /*
@@ -86,6 +87,15 @@ void* axk_rbtree_read_iterator( struct axk_rbtree_iterator_t* in_iter );
 */
 void axk_rbtree_create( struct axk_rbtree_t* in_handle, uint64_t elem_size, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) );
 
+/*
+    axk_rbtree_create_with_allocator
+    * Creates a new rbtree container, that gets its nodes from 'allocator' instead of the kernel heap
+    * Passing NULL for 'allocator' is the same as calling 'axk_rbtree_create'
+    * The allocator must outlive the tree, and copies made with 'axk_rbtree_copy' use the same allocator
+    * For more information see 'axk_rbtree_create'
+*/
+void axk_rbtree_create_with_allocator( struct axk_rbtree_t* in_handle, uint64_t elem_size, struct axk_allocator_t* allocator, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) );
+
 /*
     axk_rbtree_destroy
     * Destroys an rbtree that the specified handle points to
@@ -0,0 +1,85 @@
+/*==============================================================
+    Axon Kernel - Reader-Writer Lock Library
+    2021, Zachary Berry
+    axon/public/axon/library/rwlock.h
+==============================================================*/
+
+#pragma once
+#include "axon/library/spinlock.h"
+
+
+/*
+    Constants
+    * Each lock takes one of 'AXK_RWLOCK_PERCPU_SLOTS' reader count slots in every processor's data area, so readers on different
+      processors never write to the same cache line
+    * Locks created before the per-cpu data areas exist, or once every slot is taken, count their readers in the lock itself instead
+*/
+#define AXK_RWLOCK_PERCPU_SLOTS     64U
+#define AXK_RWLOCK_NO_SLOT          0xFFFFFFFFU
+
+/*
+    axk_rwlock_t (Structure)
+    * Spinning reader-writer lock for structures that are read far more often than they are written
+    * Any number of readers can hold the lock at once, writers get exclusive access
+    * Writer-preferring: once a writer is waiting, new readers hold off until all waiting writers are done
+    * Readers only touch their own processor's count (see 'slot'), writers add up the count from every processor
+*/
+struct axk_rwlock_t
+{
+    struct axk_atomic_uint32_t readers;
+    struct axk_atomic_uint32_t writers;
+    uint32_t slot;
+    struct axk_spinlock_t writer_lock;
+    uint64_t rflags;
+};
+
+/*
+    axk_rwlock_init
+    * Takes a per-cpu reader count slot if one is free, which is returned by 'axk_rwlock_destroy'
+*/
+void axk_rwlock_init( struct axk_rwlock_t* lock );
+
+/*
+    axk_rwlock_destroy
+    * Returns the lock's per-cpu reader count slot, the lock must not be held
+*/
+void axk_rwlock_destroy( struct axk_rwlock_t* lock );
+
+/*
+    axk_rwlock_acquire_read
+    * Disables interrupts, and waits until there are no active or waiting writers
+    * Returns the previous interrupt state, which must be passed to 'axk_rwlock_release_read'
+    * Since multiple readers hold the lock at once, the interrupt state cant be stored in the lock like the other lock types
+*/
+uint64_t axk_rwlock_acquire_read( struct axk_rwlock_t* lock );
+
+/*
+    axk_rwlock_acquire_read_at
+    * Same as 'axk_rwlock_acquire_read', but the lock profiler charges the wait to 'site' instead of the caller (see 'axk_spinlock_acquire_at')
+    * Readers share the lock, so only the time spent waiting to get in is profiled, not how long they hold it
+*/
+uint64_t axk_rwlock_acquire_read_at( struct axk_rwlock_t* lock, void* site );
+
+/*
+    axk_rwlock_release_read
+*/
+void axk_rwlock_release_read( struct axk_rwlock_t* lock, uint64_t rflags );
+
+/*
+    axk_rwlock_acquire_write
+    * Disables interrupts, and waits for exclusive access
+    * The previous interrupt state is restored when the lock is released
+*/
+void axk_rwlock_acquire_write( struct axk_rwlock_t* lock );
+
+/*
+    axk_rwlock_acquire_write_at
+    * Same as 'axk_rwlock_acquire_write', but the lock profiler charges the acquisition to 'site' instead of the caller
+    * Waiting for readers to drain out counts as spin time, the same as waiting for another writer
+*/
+void axk_rwlock_acquire_write_at( struct axk_rwlock_t* lock, void* site );
+
+/*
+    axk_rwlock_release_write
+*/
+void axk_rwlock_release_write( struct axk_rwlock_t* lock );
@@ -0,0 +1,50 @@
+/*==============================================================
+    Axon Kernel - Sequence Lock Library
+    2021, Zachary Berry
+    axon/public/axon/library/seqlock.h
+==============================================================*/
+
+#pragma once
+#include "axon/library/spinlock.h"
+
+
+/*
+    axk_seqlock_t (Structure)
+    * Sequence lock for small, frequently read structures (i.e. the clock sync point)
+    * Readers never write to shared memory, they read the sequence before and after copying the data out, and retry if a writer was active
+    * Writers are serialized with a spinlock, and bump the sequence to an odd value while updating
+    * Data protected by a seqlock must not contain pointers that readers follow, since they can see a torn copy before retrying
+*/
+struct axk_seqlock_t
+{
+    struct axk_atomic_uint32_t sequence;
+    struct axk_spinlock_t writer_lock;
+};
+
+/*
+    axk_seqlock_init
+*/
+void axk_seqlock_init( struct axk_seqlock_t* lock );
+
+/*
+    axk_seqlock_read_begin
+    * Waits for any active writer to finish, and returns the sequence number to pass to 'axk_seqlock_read_retry'
+*/
+uint32_t axk_seqlock_read_begin( struct axk_seqlock_t* lock );
+
+/*
+    axk_seqlock_read_retry
+    * Returns true if a writer modified the data since 'axk_seqlock_read_begin', in which case the read has to be done again
+*/
+bool axk_seqlock_read_retry( struct axk_seqlock_t* lock, uint32_t sequence );
+
+/*
+    axk_seqlock_write_begin
+    * Disables interrupts, and takes exclusive write access
+*/
+void axk_seqlock_write_begin( struct axk_seqlock_t* lock );
+
+/*
+    axk_seqlock_write_end
+*/
+void axk_seqlock_write_end( struct axk_seqlock_t* lock );
@@ -6,15 +6,43 @@
 
 #pragma once
 #include "axon/library/atomic.h"
+#include "axon/library/lock_profile.h"
 #include "axon/kernel/kernel.h"
 
 
+/*
+    axk_spinlock_t (Structure)
+    * Ticket spinlock, waiters are granted the lock in the order they arrived
+    * Each waiter takes a ticket from 'next' and spins until 'owner' reaches it, so the lock cant be stolen
+      out from under a processor thats been waiting longer
+*/
 struct axk_spinlock_t
 {
-    struct axk_atomic_flag_t flag;
+    struct axk_atomic_uint32_t next;
+    struct axk_atomic_uint32_t owner;
     uint64_t rflags;
+
+    #ifdef AXK_LOCK_PROFILE
+    struct axk_lock_stats_t stats;
+    void* hold_site;
+    uint64_t hold_begin;
+    uint64_t hold_spin_cycles;
+    bool hold_contended;
+    #endif
 };
 
+/*
+    axk_spin_pause
+    * Hint to the processor that were in a spin-wait loop
+    * Saves power, and avoids the memory order mis-speculation penalty when the lock is finally released
+*/
+static inline void axk_spin_pause( void )
+{
+    #ifdef __x86_64__
+    __asm__ volatile( "pause" ::: "memory" );
+    #endif
+}
+
 /*
     axk_spinlock_init
 */
@@ -22,11 +50,21 @@ void axk_spinlock_init( struct axk_spinlock_t* lock );
 
 /*
     axk_spinlock_acquire
+    * Disables interrupts, and waits until this processors ticket is up
+    * The previous interrupt state is restored when the lock is released
 */
 void axk_spinlock_acquire( struct axk_spinlock_t* lock );
 
+/*
+    axk_spinlock_acquire_at
+    * Same as 'axk_spinlock_acquire', but the lock profiler charges the acquisition to 'site' instead of the caller
+    * Functions that wrap a spinlock pass their own return address, so the stats land on whoever called the wrapper
+*/
+void axk_spinlock_acquire_at( struct axk_spinlock_t* lock, void* site );
+
 /*
     axk_spinlock_release
+    * Passes the lock to the next waiter (if any) and restores the interrupt state from before the lock was acquired
 */
 void axk_spinlock_release( struct axk_spinlock_t* lock );
 
@@ -34,3 +72,19 @@ void axk_spinlock_release( struct axk_spinlock_t* lock );
     axk_spinlock_is_locked
 */
 bool axk_spinlock_is_locked( struct axk_spinlock_t* lock );
+
+#ifdef AXK_LOCK_PROFILE
+/*
+    axk_spinlock_acquire_waited_at
+    * Same as 'axk_spinlock_acquire_at', for wrappers that wait on something of their own right before taking the lock
+    * The profiler counts the spin time from 'wait_begin' (read with 'axk_lock_profile_timestamp'), and counts the acquisition
+      as contended if 'b_waited' is set, even if the lock itself was free
+*/
+void axk_spinlock_acquire_waited_at( struct axk_spinlock_t* lock, void* site, uint64_t wait_begin, bool b_waited );
+
+/*
+    axk_spinlock_get_stats
+    * Gets the profiling data for a single lock, across all call sites
+*/
+void axk_spinlock_get_stats( struct axk_spinlock_t* lock, struct axk_lock_stats_t* out_stats );
+#endif
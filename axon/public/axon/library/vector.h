@@ -6,6 +6,7 @@
 
 #pragma once
 #include "axon/kernel/kernel.h"
+#include "axon/memory/allocator.h"
 
 
 /*
@@ -23,6 +24,7 @@ struct axk_vector_t
     uint8_t growth_factor;
     void( *fn_finalize )( void* );
     void( *fn_copy )( void*, void* );
+    struct axk_allocator_t* allocator;
 };
 
 /*
@@ -48,6 +50,15 @@ void axk_vector_create( struct axk_vector_t* in_handle, uint64_t elem_size, void
 */
 void axk_vector_create_with_capacity( struct axk_vector_t* in_handle, uint64_t elem_size, uint64_t in_capacity, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) );
 
+/*
+    axk_vector_create_with_allocator
+    * Initializes a vector with a specified starting capacity, that gets its buffer from 'allocator' instead of the kernel heap
+    * Passing NULL for 'allocator' is the same as calling 'axk_vector_create_with_capacity'
+    * The allocator must outlive the vector, and copies made with 'axk_vector_copy' use the same allocator
+    * For more information see 'axk_vector_create'
+*/
+void axk_vector_create_with_allocator( struct axk_vector_t* in_handle, uint64_t elem_size, uint64_t in_capacity, struct axk_allocator_t* allocator, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) );
+
 /*
     axk_vector_destroy
     * Destroys a vector that the specified handle points to
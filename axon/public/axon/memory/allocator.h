@@ -0,0 +1,24 @@
+/*==============================================================
+    Axon Kernel - Allocator Interface
+    2021, Zachary Berry
+    axon/public/axon/memory/allocator.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+
+/*
+    axk_allocator_t (Structure)
+    * Lets containers get their memory from somewhere other than the kernel heap (i.e. an arena)
+    * 'fn_alloc' returns NULL on failure, and zeroes the memory if 'b_clear' is true
+    * 'fn_free' can be a no-op, for allocators that release everything at once
+    * 'context' is passed through to both functions as-is
+    * Containers take a pointer to one of these, where NULL means the kernel heap
+*/
+struct axk_allocator_t
+{
+    void*( *fn_alloc )( void* context, size_t size, bool b_clear );
+    void( *fn_free )( void* context, void* ptr );
+    void* context;
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+/*==============================================================
+    Axon Kernel - Arena Allocator
+    2021, Zachary Berry
+    axon/public/axon/memory/arena.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+#include "axon/memory/allocator.h"
+
+
+/*
+    Constants
+*/
+#define AXK_ARENA_DEFAULT_CHUNK_SIZE    0x10000UL
+#define AXK_ARENA_DEFAULT_ALIGN         16UL
+
+/*
+    axk_arena_t (Structure)
+    * A bump allocator, for work that makes lots of small allocations which are all released together (i.e. parsing firmware tables during boot)
+    * Memory comes from chunks allocated from the kernel virtual address allocator, and allocating is just moving an offset forward,
+      so there is no locking and no per-allocation overhead
+    * Individual allocations cant be freed, instead the arena is rewound to a mark, or reset entirely
+    * Arenas arent thread safe, each one should only be used by a single thread at a time
+    * Be sure to initialize with 'axk_arena_create' and release with 'axk_arena_destroy'
+*/
+struct axk_arena_chunk_t;
+
+struct axk_arena_t
+{
+    struct axk_arena_chunk_t* first;
+    struct axk_arena_chunk_t* current;
+    uint64_t offset;
+    uint64_t chunk_size;
+    struct axk_allocator_t allocator;
+};
+
+/*
+    axk_arena_mark_t (Structure)
+    * A position within an arena, from 'axk_arena_mark'
+*/
+struct axk_arena_mark_t
+{
+    struct axk_arena_chunk_t* chunk;
+    uint64_t offset;
+};
+
+/*
+    axk_arena_create
+    * Initializes an arena, 'chunk_size' is rounded up to the page size, or zero to use 'AXK_ARENA_DEFAULT_CHUNK_SIZE'
+    * No memory is allocated until the first allocation is made
+*/
+void axk_arena_create( struct axk_arena_t* arena, uint64_t chunk_size );
+
+/*
+    axk_arena_destroy
+    * Releases all chunks owned by the arena, every pointer allocated from it becomes invalid
+*/
+void axk_arena_destroy( struct axk_arena_t* arena );
+
+/*
+    axk_arena_alloc
+    * Allocates 'size' bytes from the arena, aligned to 'align' (zero for 'AXK_ARENA_DEFAULT_ALIGN', otherwise a power of two up to the page size)
+    * Allocations larger than the chunk size get a chunk of their own, and later allocations keep using the space left in the current chunk
+    * That chunk is only reused once the arena is rewound to a mark taken in an earlier chunk, or reset
+    * The memory is NOT zeroed, returns NULL if out of memory
+*/
+void* axk_arena_alloc( struct axk_arena_t* arena, uint64_t size, uint64_t align );
+
+/*
+    axk_arena_mark
+    * Gets the current position of the arena, which can be passed to 'axk_arena_rewind' later on
+*/
+struct axk_arena_mark_t axk_arena_mark( struct axk_arena_t* arena );
+
+/*
+    axk_arena_rewind
+    * Releases everything allocated since 'mark' was taken, marks taken after 'mark' become invalid
+    * Chunks arent freed, they are kept around and reused by later allocations
+*/
+void axk_arena_rewind( struct axk_arena_t* arena, struct axk_arena_mark_t mark );
+
+/*
+    axk_arena_reset
+    * Releases everything allocated from the arena, but keeps its chunks around to be reused
+*/
+void axk_arena_reset( struct axk_arena_t* arena );
+
+/*
+    axk_arena_allocator
+    * Gets an allocator interface for the arena, to pass to containers (i.e. 'axk_vector_create_with_allocator')
+    * Frees through this interface do nothing, the memory is only released when the arena is rewound, reset or destroyed
+*/
+struct axk_allocator_t* axk_arena_allocator( struct axk_arena_t* arena );
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap Profiler
+    2021, Zachary Berry
+    axon/public/axon/memory/heap_profile.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Heap profiling is only compiled in when 'AXK_HEAP_PROFILE' is defined (build with 'AXON_HEAP_PROFILE=1')
+    Otherwise, none of this exists and heap blocks carry no extra header
+*/
+#ifdef AXK_HEAP_PROFILE
+
+/*
+    Constants
+*/
+#define AXK_HEAP_PROFILE_MAX_SITES      512
+#define AXK_HEAP_PROFILE_MAX_REPORT     32
+#define AXK_HEAP_PROFILE_BUCKETS        16
+#define AXK_HEAP_PROFILE_HEADER_SIZE    16UL
+
+/*
+    axk_heap_profile_tag_t (Structure)
+    * Placed in front of every heap block while profiling, so a free can be charged back to the site that made the allocation
+    * 16 bytes, so blocks keep 16 byte alignment
+*/
+struct axk_heap_profile_tag_t
+{
+    void* site;
+    uint64_t size;
+};
+
+/*
+    axk_heap_stats_t (Structure)
+    * Profiling data for a single call site
+    * 'histogram[ i ]' counts allocations of up to (16 << i) bytes, the last bucket also counts everything larger
+*/
+struct axk_heap_stats_t
+{
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t live_count;
+    uint64_t live_bytes;
+    uint64_t histogram[ AXK_HEAP_PROFILE_BUCKETS ];
+};
+
+/*
+    axk_heap_snapshot_t (Structure)
+    * A copy of the live counts for every site at one point in time, to be compared against a later snapshot
+    * Fairly large (~16KB), so dont put it on the stack
+*/
+struct axk_heap_snapshot_entry_t
+{
+    void* site;
+    uint64_t allocations;
+    uint64_t live_count;
+    uint64_t live_bytes;
+};
+
+struct axk_heap_snapshot_t
+{
+    uint32_t count;
+    struct axk_heap_snapshot_entry_t entries[ AXK_HEAP_PROFILE_MAX_SITES ];
+};
+
+/*
+    axk_heap_profile_on_alloc
+    * Called by the kernel heap for every allocation, fills out the tag in front of the block and charges it to 'site'
+*/
+void axk_heap_profile_on_alloc( struct axk_heap_profile_tag_t* tag, void* site, uint64_t size );
+
+/*
+    axk_heap_profile_on_free
+    * Called by the kernel heap for every free, removes the block from the live stats of the site that allocated it
+*/
+void axk_heap_profile_on_free( struct axk_heap_profile_tag_t* tag );
+
+/*
+    axk_heap_profile_get_site
+    * Reads the stats recorded for a call site
+*/
+bool axk_heap_profile_get_site( void* site, struct axk_heap_stats_t* out_stats );
+
+/*
+    axk_heap_profile_snapshot
+    * Copies the current live counts of every site into 'out_snapshot'
+*/
+void axk_heap_profile_snapshot( struct axk_heap_snapshot_t* out_snapshot );
+
+/*
+    axk_heap_profile_diff
+    * Prints the 'count' sites whose live bytes grew the most between two snapshots to the basic terminal
+    * Sites that keep growing across snapshots taken in a steady state are likely leaks
+*/
+void axk_heap_profile_diff( struct axk_heap_snapshot_t* before, struct axk_heap_snapshot_t* after, uint32_t count );
+
+/*
+    axk_heap_profile_dump
+    * Prints the 'count' sites holding the most live bytes to the basic terminal, along with their size histograms
+    * The addresses printed are the return addresses of the allocation calls
+*/
+void axk_heap_profile_dump( uint32_t count );
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap
+    2021, Zachary Berry
+    axon/public/axon/memory/kheap.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+
+/*
+    Constants
+*/
+#define AXK_KCACHE_MAX              32
+#define AXK_KHEAP_MIN_CLASS_SIZE    16UL
+#define AXK_KHEAP_MAX_CLASS_SIZE    4096UL
+#define AXK_KHEAP_MAX_POOL_SIZE     0x80000UL
+
+/*
+    axk_kcache_t (Structure)
+    * An object cache, hands out fixed size objects carved from slabs
+    * Each processor keeps a small magazine of free objects for every cache, so most allocations and frees dont touch any shared state
+    * The size classes used by 'axk_kheap_alloc' are caches as well
+*/
+struct axk_kcache_t;
+
+/*
+    axk_kcache_create
+    * Creates a new object cache, for objects of 'size' bytes, aligned to 'align' (zero for the default alignment, otherwise a power of two)
+    * If 'fn_ctor' isnt NULL, each object is constructed once when its slab is created, and objects must be freed back to the cache
+      in their constructed state, so allocations skip the setup work entirely
+    * Caches cant be destroyed, and at most 'AXK_KCACHE_MAX' can exist (including the heap size classes)
+    * Returns NULL on failure
+*/
+struct axk_kcache_t* axk_kcache_create( const char* name, uint64_t size, uint64_t align, void( *fn_ctor )( void* ) );
+
+/*
+    axk_kcache_alloc
+    * Allocates an object from a cache, returns NULL if out of memory
+*/
+void* axk_kcache_alloc( struct axk_kcache_t* cache );
+
+/*
+    axk_kcache_free
+    * Returns an object to the cache it was allocated from
+*/
+void axk_kcache_free( struct axk_kcache_t* cache, void* ptr );
+
+/*
+    axk_kheap_alloc
+    * Allocates a block of kernel memory
+    * Sizes up to 'AXK_KHEAP_MAX_CLASS_SIZE' are rounded up to a power of two, and come from the matching size class cache
+    * Sizes up to 'AXK_KHEAP_MAX_POOL_SIZE' come from a shared pool with segregated free lists, which grows in 2MB chunks
+    * Anything larger gets its own range from the kernel virtual address allocator
+    * 'b_clear' zeroes the returned memory
+*/
+void* axk_kheap_alloc( size_t size, bool b_clear );
+
+/*
+    axk_kheap_realloc
+    * Resizes a block from 'axk_kheap_alloc', in place when possible, otherwise the contents are copied to a new block (up to the smaller of the two sizes)
+    * Pool blocks shrink in place, and grow in place when the memory directly after them is free
+    * Large blocks (their own range) shrink in place, and grow in place when the address space directly after them is free
+    * Slab objects that already fit the new size, without wasting more than half, are returned as-is
+    * A block that changes tier (i.e. a large block shrinking down to the pool size) is always moved
+    * If 'b_clear' is true, any memory past the end of the old block is zeroed
+    * Returns NULL on failure, in which case the original block is left untouched
+*/
+void* axk_kheap_realloc( void* ptr, size_t new_size, bool b_clear );
+
+/*
+    axk_kheap_alloc_caller / axk_kheap_realloc_caller
+    * Same as 'axk_kheap_alloc' and 'axk_kheap_realloc', but when heap profiling is enabled the block is charged to 'site'
+      instead of the return address of the call
+    * Used by wrappers (i.e. libk malloc) so the profile shows who called the wrapper
+*/
+void* axk_kheap_alloc_caller( size_t size, bool b_clear, void* site );
+void* axk_kheap_realloc_caller( void* ptr, size_t new_size, bool b_clear, void* site );
+
+/*
+    axk_kheap_free
+    * Releases a block from 'axk_kheap_alloc', NULL is ignored
+*/
+void axk_kheap_free( void* ptr );
+
+/*
+    axk_kheap_size
+    * Gets the usable size of a block from 'axk_kheap_alloc', which can be larger than the size requested
+*/
+size_t axk_kheap_size( void* ptr );
@@ -6,7 +6,7 @@
 
 #pragma once
 #include "axon/kernel/kernel.h"
-#include "axon/library/spinlock.h"
+#include "axon/library/rwlock.h"
 
 
 /*
@@ -18,6 +18,7 @@
 #define AXK_MAP_FLAG_GLOBAL         0x04
 #define AXK_MAP_FLAG_NO_CACHE       0x08
 #define AXK_MAP_FLAG_KERNEL_ONLY    0x10
+#define AXK_MAP_FLAG_WRITE_COMBINE  0x20
 
 /*
     axk_memory_map_t (Structure)
@@ -25,7 +26,7 @@
 */
 struct axk_memory_map_t
 {
-    struct axk_spinlock_t lock;
+    struct axk_rwlock_t lock;
     uint32_t process_id;
 
     #ifdef __x86_64__
@@ -64,9 +65,24 @@ void axk_memory_map_lock( struct axk_memory_map_t* in_map );
 */
 void axk_memory_map_unlock( struct axk_memory_map_t* in_map );
 
+/*
+    axk_memory_map_lock_read
+    * Locks the memory map for reading only, multiple processors can hold a read lock at the same time
+    * Use this instead of 'axk_memory_map_lock' when only calling 'axk_memory_map_translate' or 'axk_memory_map_search'
+    * Returns the previous interrupt state, which has to be passed to 'axk_memory_map_unlock_read'
+*/
+uint64_t axk_memory_map_lock_read( struct axk_memory_map_t* in_map );
+
+/*
+    axk_memory_map_unlock_read
+    * Releases a read lock on the memory map
+*/
+void axk_memory_map_unlock_read( struct axk_memory_map_t* in_map, uint64_t state );
+
 /*
     axk_memory_map_add
     * Adds a memory map entry, optionally allowing overwriting
+    * 'AXK_MAP_FLAG_WRITE_COMBINE' is meant for MMIO like framebuffers, its ignored if 'AXK_MAP_FLAG_NO_CACHE' is set or the processor doesnt support it
     * If 'out_page_id' is NULL, then overwriting is not allowed, and if theres an existing entry, this call will fail
     * If 'out_page_id' is NOT NULL, then overwriting IS allowed, and the overwritten page ID will be written to 'out_page_id'
     * 'in_vaddr' must be page aligned
@@ -86,7 +102,7 @@ bool axk_memory_map_remove( struct axk_memory_map_t* in_map, uint64_t in_vaddr,
     * Translate a virtual memory address using a memory map
     * Also returns the flags associated with the page
 */
-bool axk_memory_map_translate( struct axk_memory_map_t* in_map, uint64_t in_addr, uint64_t* out_addr, uint32_t* out_flags );
+bool axk_memory_map_translate( struct axk_memory_map_t* in_map, uint64_t in_vaddr, uint64_t* out_addr, uint32_t* out_flags );
 
 /*
     axk_memory_map_search
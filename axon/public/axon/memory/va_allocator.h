@@ -0,0 +1,64 @@
+/*==============================================================
+    Axon Kernel - Kernel Virtual Address Allocator
+    2021, Zachary Berry
+    axon/public/axon/memory/va_allocator.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+
+/*
+    Constants
+*/
+#define AXK_VA_REGION_HEAP          0x00
+#define AXK_VA_REGION_SHARED        0x01
+#define AXK_VA_REGION_SLAB          0x02
+#define AXK_VA_REGION_POOL          0x03
+#define AXK_VA_REGION_MAX_INDEX     0x03
+
+#define AXK_VA_FLAG_NONE            0x00
+#define AXK_VA_FLAG_CLEAR           0x01
+#define AXK_VA_FLAG_RESERVE_ONLY    0x02
+
+/*
+    axk_va_alloc
+    * Allocates a range of kernel virtual address space from one of the kernel regions (AXK_VA_REGION_*)
+    * 'size' is rounded up to the page size, and 'align' must be zero (page aligned) or a power of two
+    * Each range is followed by an unmapped guard page, so running off the end of a buffer faults instead of corrupting the next one
+    * Unless 'AXK_VA_FLAG_RESERVE_ONLY' is specified, the range is backed by physical pages from the page allocator, these
+      pages dont need to be physically contiguous
+    * If 'AXK_VA_FLAG_RESERVE_ONLY' is specified, only the address range is reserved, and the caller is responsible for mapping it
+    * 'AXK_VA_FLAG_CLEAR' zeroes the backing pages before returning
+*/
+bool axk_va_alloc( uint8_t region, uint64_t size, uint64_t align, uint32_t flags, uint64_t* out_addr );
+
+/*
+    axk_va_free
+    * Releases a range previously returned by 'axk_va_alloc'
+    * Any pages still mapped in the range are unmapped, if the range was backed by this allocator, the physical pages are released as well
+    * 'addr' must be the exact address returned by 'axk_va_alloc', otherwise the call will fail
+*/
+bool axk_va_free( uint64_t addr );
+
+/*
+    axk_va_resize
+    * Changes the size of a range previously returned by 'axk_va_alloc' without moving it, 'new_size' is rounded up to the page size
+    * Growing takes the free address space directly after the range, the old guard page becomes part of the range and a new one
+      is placed after it, the new pages are backed the same way as 'axk_va_alloc' ('AXK_VA_FLAG_CLEAR' zeroes them)
+    * Shrinking unmaps the pages past the new end (releasing them if the range is backed by this allocator), and returns them as free address space
+    * Returns false if the range wasnt found, or the space after it isnt free, the range is left unchanged in that case
+*/
+bool axk_va_resize( uint64_t addr, uint64_t new_size, uint32_t flags );
+
+/*
+    axk_va_size
+    * Gets the usable size (in bytes) of a range previously returned by 'axk_va_alloc', not including the guard page
+*/
+bool axk_va_size( uint64_t addr, uint64_t* out_size );
+
+/*
+    axk_va_available
+    * Gets the number of bytes of address space that are still free in a region
+*/
+uint64_t axk_va_available( uint8_t region );
@@ -0,0 +1,67 @@
+/*==============================================================
+    Axon Kernel - CPU Features & Dispatch
+    2021, Zachary Berry
+    axon/public/axon/system/cpu_features.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Constants
+    * Feature flags are only reported when the feature is actually usable, i.e. the AVX flags also require the register state to
+      be enabled in XCR0
+    * libk/arch_x86/string.asm has its own copy of some of these, keep them in sync
+*/
+#define AXK_CPU_FEATURE_SSE3        0x0001UL
+#define AXK_CPU_FEATURE_SSSE3       0x0002UL
+#define AXK_CPU_FEATURE_SSE41       0x0004UL
+#define AXK_CPU_FEATURE_SSE42       0x0008UL
+#define AXK_CPU_FEATURE_POPCNT      0x0010UL
+#define AXK_CPU_FEATURE_AVX         0x0020UL
+#define AXK_CPU_FEATURE_AVX2        0x0040UL
+#define AXK_CPU_FEATURE_AVX512F     0x0080UL
+#define AXK_CPU_FEATURE_BMI1        0x0100UL
+#define AXK_CPU_FEATURE_ERMS        0x0200UL
+#define AXK_CPU_FEATURE_FSRM        0x0400UL
+#define AXK_CPU_FEATURE_BMI2        0x0800UL
+#define AXK_CPU_FEATURE_LZCNT       0x1000UL
+#define AXK_CPU_FEATURE_CLZERO      0x2000UL
+
+/*
+    axk_dispatch_candidate_t (Structure)
+    * An alternative implementation for a dispatch slot, a slot is just a function pointer that starts out pointing at a baseline
+      implementation which works on any processor
+    * Once the processor features are detected during boot, each slot is pointed at the highest priority candidate whose
+      required features are all present, so calls through the slot cost a single indirect call, and nothing is checked afterwards
+    * Candidates live in their own linker section, create them with 'AXK_DISPATCH_CANDIDATE'
+*/
+struct axk_dispatch_candidate_t
+{
+    void** slot;
+    void* fn;
+    uint64_t features;
+    uint64_t priority;
+};
+
+/*
+    AXK_DISPATCH_CANDIDATE
+    * Registers 'fn' as a candidate for the function pointer '_slot_', used when all of the '_features_' flags are present
+    * Must be used at file scope
+*/
+#define AXK_DISPATCH_CANDIDATE( _slot_, _fn_, _features_, _priority_ ) \
+    static const struct axk_dispatch_candidate_t __attribute__(( used, section( ".axk_dispatch" ) )) axk_dispatch_candidate_##_fn_ = \
+    { (void**)( &( _slot_ ) ), (void*)( _fn_ ), ( _features_ ), ( _priority_ ) }
+
+/*
+    axk_cpu_get_features
+    * Gets the set of 'AXK_CPU_FEATURE_*' flags supported by the processor
+    * Returns zero if called before the features are detected
+*/
+uint64_t axk_cpu_get_features( void );
+
+/*
+    axk_cpu_has_features
+    * Checks if all of the specified 'AXK_CPU_FEATURE_*' flags are supported by the processor
+*/
+bool axk_cpu_has_features( uint64_t features );
\ No newline at end of file
@@ -22,7 +22,8 @@
 #define AXK_COUNTER_KERNEL_PAGES        0x02
 #define AXK_COUNTER_USER_PAGES          0x03
 #define AXK_COUNTER_EXT_CLOCK_TICKS     0x04
-#define AXK_COUNTER_MAX_INDEX           0x04
+#define AXK_COUNTER_BUILTIN_COUNT       0x05
+#define AXK_COUNTER_CAPACITY            0x40
 
 // Other Constants...
 #define AXK_PROCESSOR_TYPE_NORMAL       0x00
@@ -85,7 +86,8 @@ bool axk_sysinfo_query( uint32_t index, uint32_t sub_index, void* out_data, uint
 
 /*
     axk_counter_read
-    * Reads a system-wide atomic counter
-    * If the counter index is invalid, returns 0UL
+    * Reads a system-wide counter, by summing the value each processor has accumulated
+    * Not a snapshot, updates made while the sum is being taken may or may not be included
+    * If the counter index is invalid (or not registered), returns 0UL
 */
 uint64_t axk_counter_read( uint32_t index );
\ No newline at end of file
@@ -9,9 +9,16 @@
 #include "axon/kernel/boot_params.h"
 #include "axon/gfx/basic_terminal_private.h"
 #include "axon/kernel/panic_private.h"
+#include "axon/kernel/percpu.h"
+#include "axon/kernel/klog.h"
+#include "axon/kernel/rcu.h"
+#include "axon/kernel/crash_private.h"
+#include "axon/kernel/trace.h"
+#include "axon/system/cpu_features_private.h"
 #include "axon/system/sysinfo_private.h"
 #include "axon/memory/memory_private.h"
 #include "axon/memory/page_allocator.h"
+#include "axon/arch_x86/uart16550.h"
 
 uint64_t page_test[ 100 ];
 
@@ -26,6 +33,8 @@ uint64_t page_test[ 100 ];
 */
 void axk_x86_main( struct tzero_payload_parameters_t* generic_params, struct tzero_x86_payload_parameters_t* x86_params )
 {
+    AXK_TRACE( AXK_TRACE_BOOT_ENTRY, generic_params, x86_params );
+
     // Initialize the basic terminal system, so we can print to console
     if( !axk_basicterminal_init( generic_params ) )
     {
@@ -33,33 +42,86 @@ void axk_x86_main( struct tzero_payload_parameters_t* generic_params, struct tze
         axk_halt();
     }
 
+    AXK_TRACE( AXK_TRACE_BOOT_TERMINAL, 0, 0 );
+
     // Initialize panic spin-lock
     axk_panic_init();
+    AXK_TRACE( AXK_TRACE_BOOT_PANIC, 0, 0 );
+
+    // If there is a serial port, copy all console output to it as well (i.e. 'qemu -serial stdio')
+    axk_x86_uart_init( AXK_X86_UART_COM1, 115200U );
+    AXK_TRACE( AXK_TRACE_BOOT_UART, 0, 0 );
 
     // Indicate we are ready to take control of the system, this call also will write the memory map into our parameter structure
     generic_params->fn_on_success();
+    AXK_TRACE( AXK_TRACE_BOOT_HANDOFF, generic_params->memory_map.count, 0 );
 
     // Print a header message
     axk_basicterminal_clear();
     axk_basicterminal_prints( "Axon: System control transferred from bootloader, initializing kernel... \n\n" );
 
+    // Detect processor features, and switch libk/kernel routines over to the best implementations for this processor
+    axk_cpu_features_init();
+    AXK_TRACE( AXK_TRACE_BOOT_CPU_FEATURES, 0, 0 );
+
+    // Setup the per-cpu data area for this processor, the counters are stored there
+    axk_percpu_init_bsp();
+    AXK_TRACE( AXK_TRACE_BOOT_PERCPU, 0, 0 );
+
     // Next, initialize system counters so we can keep track of various statistics during system runtime
     axk_counters_init();
+    AXK_TRACE( AXK_TRACE_BOOT_COUNTERS, 0, 0 );
 
     // Initialize the physical memory system
     axk_page_allocator_init( generic_params );
+    AXK_TRACE( AXK_TRACE_BOOT_PAGE_ALLOCATOR, axk_page_count(), 0 );
+
+    // Reserve the crash record pages before anything else takes them, and report the last crash if there was one
+    // The report is drawn directly, so draw the messages queued so far first, to keep the boot messages in order
+    axk_klog_drain();
+    axk_crash_init();
+    AXK_TRACE( AXK_TRACE_BOOT_CRASH, axk_crash_get_previous() != NULL, 0 );
 
     // Initiailize the memory map 
     axk_kmap_init( generic_params );
+    AXK_TRACE( AXK_TRACE_BOOT_KMAP, 0, 0 );
 
     // Now, we need to update the parameter structures since the UEFI mappings are now gone
     AXK_FIX_PTR( generic_params, struct tzero_payload_parameters_t* );
     AXK_FIX_PTR( x86_params, struct tzero_x86_payload_parameters_t* );
     AXK_FIX_PTR( generic_params->memory_map.list, struct tzero_memory_entry_t* );
     AXK_FIX_PTR( generic_params->available_resolutions, struct tzero_resolution_t* );
-    
 
-    while( 1 ) { __asm__( "hlt" ); }
+    // Initialize the kernel virtual address allocator, so we can start handing out ranges in the heap and shared regions
+    axk_va_allocator_init();
+    AXK_TRACE( AXK_TRACE_BOOT_VA_ALLOCATOR, 0, 0 );
+
+    // Create the kernel heap caches, after this malloc/free and the object caches are usable
+    axk_kheap_init();
+    AXK_TRACE( AXK_TRACE_BOOT_KHEAP, 0, 0 );
+
+    // Move the terminal over to a shadow buffer in system memory, so it stops reading from video memory
+    bool b_shadow = axk_basicterminal_init_shadow();
+    if( !b_shadow )
+    {
+        axk_klog( "Basic Terminal: Failed to allocate a shadow buffer, drawing directly to the framebuffer\n" );
+    }
+
+    AXK_TRACE( AXK_TRACE_BOOT_SHADOW, b_shadow, 0 );
+
+#ifdef AXK_BOOT_TRACE
+    axk_klog_drain();
+    axk_trace_print_timeline();
+#endif
+
+    // Idle loop, draw any queued log messages before halting
+    // An idle processor holds no RCU protected pointers, so every pass is a quiescent state, which also runs any RCU callbacks that are due
+    while( 1 )
+    {
+        axk_klog_drain();
+        axk_rcu_quiescent();
+        __asm__( "hlt" );
+    }
 }
 
 #endif
\ No newline at end of file
@@ -10,8 +10,11 @@
 #include "axon/memory/memory_private.h"
 #include "axon/gfx/basic_terminal_private.h"
 #include "axon/kernel/panic.h"
+#include "axon/kernel/klog.h"
+#include "axon/kernel/crash_private.h"
 #include "axon/kernel/boot_params.h"
 #include "axon/memory/page_allocator.h"
+#include "axon/arch_x86/util.h"
 
 
 /*
@@ -19,6 +22,7 @@
 */
 static struct axk_memory_map_t g_kernel_map;
 static bool g_init;
+static bool g_pat_wc;
 
 /*
     Externs
@@ -44,6 +48,46 @@ extern char axk_pml4;
 #define PAGE_MAP_ENTRY_2MB_MASK         0xFFFFFFFE00000UL
 #define PAGE_MAP_ENTRY_1GB_MASK         0xFFFFFC0000000UL
 
+// We reprogram PAT entry 1 (PWT=1, PCD=0, PAT=0) from write-through to write-combining, the rest keep their power-on types
+// Since only the PWT bit is needed to select it, this works the same way for 4KB and 2MB page entries
+#define PAGE_MAP_ENTRY_WRITE_COMBINE    PAGE_MAP_ENTRY_WRITE_THROUGH
+
+#define PAT_TYPE_UC                     0x00UL
+#define PAT_TYPE_WC                     0x01UL
+#define PAT_TYPE_WT                     0x04UL
+#define PAT_TYPE_WB                     0x06UL
+#define PAT_TYPE_UC_MINUS               0x07UL
+#define PAT_VALUE                       ( PAT_TYPE_WB | ( PAT_TYPE_WC << 8 ) | ( PAT_TYPE_UC_MINUS << 16 ) | ( PAT_TYPE_UC << 24 ) | \
+                                          ( PAT_TYPE_WB << 32 ) | ( PAT_TYPE_WT << 40 ) | ( PAT_TYPE_UC_MINUS << 48 ) | ( PAT_TYPE_UC << 56 ) )
+
+// The bootstrap code maps the first 2GB of physical memory as write-back for the kernel image (see entry.asm)
+// We cant give the direct mapping of any of that memory a different type, since the two mappings would conflict
+#define KERNEL_IMAGE_WINDOW_SIZE        0x80000000UL
+
+
+/*
+    _pat_init
+    * Programs the page attribute table on the current processor, so 'AXK_MAP_FLAG_WRITE_COMBINE' can be used
+    * If the processor doesnt support PAT, write-combining requests fall back on the default memory type
+*/
+static void _pat_init( void )
+{
+    uint32_t eax, ebx, ecx, edx;
+    eax = 0x01; ebx = 0x00; ecx = 0x00; edx = 0x00;
+    axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+
+    g_pat_wc = AXK_CHECK_FLAG( edx, 1U << 16 );
+    if( !g_pat_wc ) { return; }
+
+    // Nothing should be using the entry we are changing yet, but flush anyway so there are no stale lines/translations of the old type
+    uint64_t rflags = axk_interrupts_disable();
+    axk_x86_flush_caches();
+    axk_x86_write_msr( AXK_X86_MSR_PAT, PAT_VALUE );
+    axk_x86_flush_caches();
+    axk_x86_flush_tlb();
+    axk_interrupts_restore( rflags );
+}
+
 
 /*
     Function Implementations
@@ -55,11 +99,15 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
     g_init = true;
 
     // Setup the kernel memory map, so we can modify it
-    axk_spinlock_init( &( g_kernel_map.lock ) );
+    axk_rwlock_init( &( g_kernel_map.lock ) );
 
+    // The map functions expect the physical address of the PML4, but until the UEFI mappings are gone we edit it through the kernel image mapping
     g_kernel_map.process_id     = AXK_PROCESS_KERNEL;
-    g_kernel_map.pml4           = (void*)( &axk_pml4 );
-    uint64_t* pml4_table        = (uint64_t*)( g_kernel_map.pml4 );
+    g_kernel_map.pml4           = (uint64_t*)( (uint64_t)( &axk_pml4 ) - AXK_KERNEL_VA_IMAGE );
+    uint64_t* pml4_table        = (uint64_t*)( &axk_pml4 );
+
+    // Setup the page attribute table, so the framebuffer can be mapped as write-combining
+    _pat_init();
 
     // Map all physical memory to the high kernel address space
     // We want to include MMIO mapped memory as well!
@@ -78,6 +126,7 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
 
     uint64_t max_huge_pages     = ( max_address + ( AXK_HUGE_PAGE_SIZE - 1UL ) ) / AXK_HUGE_PAGE_SIZE;
     uint64_t active_counter     = 0UL;
+    uint64_t wc_counter         = 0UL;
 
     for( uint64_t i = 0; i < max_huge_pages; i++ )
     {
@@ -85,7 +134,8 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
         uint64_t page_begin     = i * AXK_HUGE_PAGE_SIZE;
         uint64_t page_end       = page_begin + AXK_HUGE_PAGE_SIZE;
 
-        bool b_active = false;
+        bool b_active   = false;
+        bool b_ram      = false;
         for( uint32_t i = 0; i < in_params->memory_map.count; i++ )
         {
             uint64_t base_addr = in_params->memory_map.list[ i ].base_address;
@@ -96,8 +146,14 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
                 ( end_addr > page_begin && end_addr <= page_end ) ||
                 ( base_addr <= page_begin && end_addr >= page_end ) )
             {
+                // Keep scanning, we need to know if any part of this page is actual system memory
                 b_active = true;
-                break;
+                if( in_params->memory_map.list[ i ].type != TZERO_MEMORY_MAPPED_IO &&
+                    in_params->memory_map.list[ i ].type != TZERO_MEMORY_RESERVED )
+                {
+                    b_ram = true;
+                    break;
+                }
             }
             else if( base_addr > page_end )
             {
@@ -107,17 +163,28 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
         }
 
         // Check if this page is part of the framebuffer
+        bool b_framebuffer = false;
         if( ( framebuffer_begin >= page_begin && framebuffer_begin < page_end ) ||
             ( framebuffer_end > page_begin && framebuffer_end <= page_end ) ||
             ( framebuffer_begin <= page_begin && framebuffer_end >= page_end ) )
         {
-            b_active = true;
+            b_active        = true;
+            b_framebuffer   = true;
         }
 
         // Skip pages not backed by memory or IO
         if( !b_active ) { continue; }
         active_counter++;
 
+        // Framebuffer pages are mapped write-combining, so pixel writes get batched into full bus transactions instead of going out one at a time
+        // We only do this when the huge page doesnt share any system memory, and isnt also mapped by the kernel image window
+        uint64_t mem_type = 0UL;
+        if( b_framebuffer && !b_ram && g_pat_wc && page_begin >= KERNEL_IMAGE_WINDOW_SIZE )
+        {
+            mem_type = PAGE_MAP_ENTRY_WRITE_COMBINE;
+            wc_counter++;
+        }
+
         // Now, lets calculate the virtual address were mapping the physical page to, and determine the index for each level of page table
         uint64_t virt_addr = ( i * AXK_HUGE_PAGE_SIZE ) + AXK_KERNEL_VA_PHYSICAL;
         uint32_t pml4_index  = (uint32_t)( ( virt_addr & 0x0000FF8000000000UL ) >> 39 );
@@ -166,12 +233,13 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
         }
 
         // Write the PDT entry
-        pdt_table[ pdt_index ] = ( ( i * AXK_HUGE_PAGE_SIZE ) | PAGE_MAP_MEM_ENTRY_HUGE | PAGE_MAP_ENTRY_PRESENT | PAGE_MAP_ENTRY_WRITABLE );
+        pdt_table[ pdt_index ] = ( ( i * AXK_HUGE_PAGE_SIZE ) | PAGE_MAP_MEM_ENTRY_HUGE | PAGE_MAP_ENTRY_PRESENT | PAGE_MAP_ENTRY_WRITABLE | mem_type );
     }
 
     // Update pointers in systems already initialized, because were going to remove the identity mapped UEFI mappings
     axk_basicterminal_update_pointers();
     axk_page_allocator_update_pointers();
+    axk_crash_update_pointers();
     
     // And now we can get rid of the UEFI mappings, since the pages it uses arent managed by the page allocator system, we can simply clear the PML4 entries
     for( uint32_t i = 0; i < 256; i++ )
@@ -179,13 +247,8 @@ void axk_kmap_init( struct tzero_payload_parameters_t* in_params )
         pml4_table[ i ] = 0x00UL;
     }
 
-    axk_basicterminal_prints( "Memory Map: Initialized kernel memory map manager! Physical Memory Range: " );
-    axk_basicterminal_printh64( AXK_KERNEL_VA_PHYSICAL, true );
-    axk_basicterminal_prints( " to " );
-    axk_basicterminal_printh64( AXK_KERNEL_VA_PHYSICAL + ( max_huge_pages * AXK_HUGE_PAGE_SIZE ), true );
-    axk_basicterminal_prints( "\tActive Pages (2MB): " );
-    axk_basicterminal_printu64( active_counter );
-    axk_basicterminal_printnl();
+    axk_klog( "Memory Map: Initialized kernel memory map manager! Physical Memory Range: 0x%016lX to 0x%016lX\tActive Pages (2MB): %lu\tWrite-Combining Pages (2MB): %lu\n",
+        AXK_KERNEL_VA_PHYSICAL, AXK_KERNEL_VA_PHYSICAL + ( max_huge_pages * AXK_HUGE_PAGE_SIZE ), active_counter, wc_counter );
 }
 
 
@@ -194,7 +257,7 @@ bool axk_memory_map_create( struct axk_memory_map_t* in_map, uint32_t process_id
     if( in_map == NULL || process_id == AXK_PROCESS_INVALID ) { return false; }
 
     // Setup the lock and process identifier
-    axk_spinlock_init( &( in_map->lock ) );
+    axk_rwlock_init( &( in_map->lock ) );
     in_map->process_id = process_id;
 
     // Allocate a page for the PML4
@@ -234,7 +297,7 @@ void axk_memory_map_destroy( struct axk_memory_map_t* in_map )
                 {
                     for( uint32_t pdt_index = 0; pdt_index < 512; pdt_index++ )
                     {
-                        uint64_t pdt_entry = ( (uint64_t*)( ( pdpt_entry & PAGE_MAP_ENTRY_4KB_MASK ) + AXK_KERNEL_VA_PHYSICAL )[ pdt_index ];
+                        uint64_t pdt_entry = ( (uint64_t*)( ( pdpt_entry & PAGE_MAP_ENTRY_4KB_MASK ) + AXK_KERNEL_VA_PHYSICAL ) )[ pdt_index ];
                         if( AXK_CHECK_FLAG( pdt_entry, PAGE_MAP_ENTRY_PRESENT ) )
                         {
                             uint64_t pt_addr = ( pdt_entry & PAGE_MAP_ENTRY_4KB_MASK ) / AXK_PAGE_SIZE;
@@ -254,21 +317,34 @@ void axk_memory_map_destroy( struct axk_memory_map_t* in_map )
 
     // Finally, release PML4
     uint64_t pml4_addr = (uint64_t)( in_map->pml4 ) / AXK_PAGE_SIZE;
-    axk_page_release( 1UL, pml4_addr, AXK_PAGE_FLAG_NONE );
+    axk_page_release( 1UL, &pml4_addr, AXK_PAGE_FLAG_NONE );
 
     in_map->pml4 = NULL;
+    axk_rwlock_destroy( &( in_map->lock ) );
 }
 
 
 void axk_memory_map_lock( struct axk_memory_map_t* in_map )
 {
-    if( in_map != NULL ) { axk_spinlock_acquire( &( in_map->lock ) ); }
+    if( in_map != NULL ) { axk_rwlock_acquire_write_at( &( in_map->lock ), __builtin_return_address( 0 ) ); }
 }
 
 
 void axk_memory_map_unlock( struct axk_memory_map_t* in_map )
 {
-    if( in_map != NULL ) { axk_spinlock_release( &( in_map->lock ) ); }
+    if( in_map != NULL ) { axk_rwlock_release_write( &( in_map->lock ) ); }
+}
+
+
+uint64_t axk_memory_map_lock_read( struct axk_memory_map_t* in_map )
+{
+    return( in_map != NULL ? axk_rwlock_acquire_read_at( &( in_map->lock ), __builtin_return_address( 0 ) ) : 0UL );
+}
+
+
+void axk_memory_map_unlock_read( struct axk_memory_map_t* in_map, uint64_t state )
+{
+    if( in_map != NULL ) { axk_rwlock_release_read( &( in_map->lock ), state ); }
 }
 
 
@@ -338,6 +414,7 @@ bool axk_memory_map_add( struct axk_memory_map_t* in_map, uint64_t in_vaddr, uin
     }
 
     // Check if we are overwriting an existing entry
+    bool b_overwrite = false;
     if( AXK_CHECK_FLAG( pt[ pt_index ], PAGE_MAP_ENTRY_PRESENT ) )
     {
         if( out_page_id == NULL )
@@ -351,6 +428,7 @@ bool axk_memory_map_add( struct axk_memory_map_t* in_map, uint64_t in_vaddr, uin
         }
 
         *out_page_id = ( pt[ pt_index ] & PAGE_MAP_ENTRY_4KB_MASK ) / AXK_PAGE_SIZE;
+        b_overwrite = true;
     }
 
     // Now, we can write the mapping in the page table, lets translate the flags to x86-specific versions of the flags
@@ -360,9 +438,13 @@ bool axk_memory_map_add( struct axk_memory_map_t* in_map, uint64_t in_vaddr, uin
     if( AXK_CHECK_FLAG( flags, AXK_MAP_FLAG_NO_EXEC ) )         { pt_entry |= PAGE_MAP_ENTRY_EXEC_DISABLE; }
     if( AXK_CHECK_FLAG( flags, AXK_MAP_FLAG_GLOBAL ) )          { pt_entry |= PAGE_MAP_MEM_ENTRY_GLOBAL; }
     if( AXK_CHECK_FLAG( flags, AXK_MAP_FLAG_NO_CACHE ) )        { pt_entry |= PAGE_MAP_ENTRY_DISABLE_CACHE; }
+    else if( AXK_CHECK_FLAG( flags, AXK_MAP_FLAG_WRITE_COMBINE ) && g_pat_wc ) { pt_entry |= PAGE_MAP_ENTRY_WRITE_COMBINE; }
     if( AXK_CHECK_FLAG( flags, AXK_MAP_FLAG_KERNEL_ONLY ) )     { pt_entry |= PAGE_MAP_ENTRY_KERNEL_ONLY; }
 
     pt[ pt_index ] = pt_entry;
+
+    // The kernel map is always active, so if we replaced a mapping we need to drop the stale translation
+    if( b_overwrite && in_map == &g_kernel_map ) { axk_x86_invalidate_page( in_vaddr ); }
     return true;
 }
 
@@ -404,6 +486,10 @@ bool axk_memory_map_remove( struct axk_memory_map_t* in_map, uint64_t in_vaddr,
     *out_page_id    = ( pt[ pt_index ] & PAGE_MAP_ENTRY_4KB_MASK ) / AXK_PAGE_SIZE;
     pt[ pt_index ]  = 0x00UL;
 
+    // The kernel map is always active, so invalidate the translation right away
+    // This also drops any cached paging structures for this address, in case we free the page tables below
+    if( in_map == &g_kernel_map ) { axk_x86_invalidate_page( in_vaddr ); }
+
     // We need to go through, and check if any of the page tables are empty and can be released
     // Loop through the PT, and if there are any remaining entries, then end the function
     for( uint32_t i = 0; i < 512; i++ )
@@ -470,13 +556,14 @@ static inline uint64_t _parse_flags( uint64_t entry )
     if( AXK_CHECK_FLAG( entry, PAGE_MAP_ENTRY_EXEC_DISABLE ) )      { ret |= AXK_MAP_FLAG_NO_EXEC; }
     if( AXK_CHECK_FLAG( entry, PAGE_MAP_MEM_ENTRY_GLOBAL ) )        { ret |= AXK_MAP_FLAG_GLOBAL; }
     if( AXK_CHECK_FLAG( entry, PAGE_MAP_ENTRY_DISABLE_CACHE ) )     { ret |= AXK_MAP_FLAG_NO_CACHE; }
+    else if( AXK_CHECK_FLAG( entry, PAGE_MAP_ENTRY_WRITE_COMBINE ) ) { ret |= AXK_MAP_FLAG_WRITE_COMBINE; }
     if( AXK_CHECK_FLAG( entry, PAGE_MAP_ENTRY_KERNEL_ONLY ) )       { ret |= AXK_MAP_FLAG_KERNEL_ONLY; }
 
     return ret;
 }
 
 
-bool axk_memory_map_translate( struct axk_memory_map_t* in_map, uint64_t in_addr, uint64_t* out_addr, uint32_t* out_flags )
+bool axk_memory_map_translate( struct axk_memory_map_t* in_map, uint64_t in_vaddr, uint64_t* out_addr, uint32_t* out_flags )
 {
     // Validate the parameters
     if( in_map == NULL || in_map->pml4 == NULL ) { return false; }
@@ -606,11 +693,11 @@ bool axk_memory_map_copy( struct axk_memory_map_t* src_map, struct axk_memory_ma
     uint64_t* dst_pt    = NULL;
 
     // Quickly lookup the source mapping
-    if( !AXK_CHECK_FLAG( src_pml4[ src_pml4_index ] ) ) { return false; }
+    if( !AXK_CHECK_FLAG( src_pml4[ src_pml4_index ], PAGE_MAP_ENTRY_PRESENT ) ) { return false; }
     src_pdpt = (uint64_t*)( ( src_pml4[ src_pml4_index ] & PAGE_MAP_ENTRY_4KB_MASK ) + AXK_KERNEL_VA_PHYSICAL );
     if( !AXK_CHECK_FLAG( src_pdpt[ src_pdpt_index ], PAGE_MAP_ENTRY_PRESENT ) ) { return false; }
     src_pdt = (uint64_t*)( ( src_pdpt[ src_pdpt_index ] & PAGE_MAP_ENTRY_4KB_MASK ) + AXK_KERNEL_VA_PHYSICAL );
-    if( !AXK_CHECK_FLAG( src_pdt[ src_pdt_index ], PAGE_MAP_ENTRY_4KB_MASK ) ) { return false; }
+    if( !AXK_CHECK_FLAG( src_pdt[ src_pdt_index ], PAGE_MAP_ENTRY_PRESENT ) ) { return false; }
     src_pt = (uint64_t*)( ( src_pdt[ src_pdt_index ] & PAGE_MAP_ENTRY_4KB_MASK ) + AXK_KERNEL_VA_PHYSICAL );
     if( !AXK_CHECK_FLAG( src_pt[ src_pt_index ], PAGE_MAP_ENTRY_PRESENT ) ) { return false; }
     
@@ -675,4 +762,10 @@ bool axk_memory_map_copy_range( struct axk_memory_map_t* src_map, struct axk_mem
 }
 
 
+struct axk_memory_map_t* axk_kmap_get( void )
+{
+    return &g_kernel_map;
+}
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*==============================================================
+    Axon Kernel - x86 16550 UART Driver
+    2021, Zachary Berry
+    axon/source/arch_x86/uart16550.c
+==============================================================*/
+#ifdef __x86_64__
+
+#include "axon/arch_x86/uart16550.h"
+#include "axon/arch_x86/util.h"
+#include "axon/gfx/console_sink.h"
+
+/*
+    Registers (offset from the base port)
+*/
+#define UART_REG_DATA               0
+#define UART_REG_INTERRUPT_ENABLE   1
+#define UART_REG_DIVISOR_LOW        0
+#define UART_REG_DIVISOR_HIGH       1
+#define UART_REG_FIFO_CONTROL       2
+#define UART_REG_INTERRUPT_ID       2
+#define UART_REG_LINE_CONTROL       3
+#define UART_REG_MODEM_CONTROL      4
+#define UART_REG_LINE_STATUS        5
+
+#define UART_LINE_STATUS_THR_EMPTY  0x20
+#define UART_LOOPBACK_TEST_VALUE    0xAE
+#define UART_FIFO_SIZE              16U
+
+/*
+    State
+*/
+struct uart_state_t
+{
+    uint16_t port;
+    uint32_t fifo_size;
+    bool b_pending_lf;
+};
+
+static struct uart_state_t g_uart;
+static struct axk_console_sink_t g_uart_sink;
+
+
+/*
+    _uart_write
+    * Private Function
+    * Console sink write function, translates '\n' to "\r\n"
+    * Waits once for the transmitter to empty, then writes a full FIFO worth of bytes before checking again
+*/
+static void _uart_write( struct axk_console_sink_t* self, const char* str, size_t len )
+{
+    struct uart_state_t* uart = (struct uart_state_t*)( self->context );
+    size_t index = 0UL;
+
+    while( index < len || uart->b_pending_lf )
+    {
+        while( ( axk_x86_inb( uart->port + UART_REG_LINE_STATUS ) & UART_LINE_STATUS_THR_EMPTY ) == 0 )
+        {
+            __asm__ volatile( "pause" );
+        }
+
+        for( uint32_t room = uart->fifo_size; room > 0U; room-- )
+        {
+            // The '\n' of a "\r\n" pair might not fit in the same batch as the '\r'
+            if( uart->b_pending_lf )
+            {
+                axk_x86_outb( uart->port + UART_REG_DATA, '\n' );
+                uart->b_pending_lf = false;
+                continue;
+            }
+
+            if( index >= len ) { break; }
+
+            char c = str[ index++ ];
+            if( c == '\n' )
+            {
+                axk_x86_outb( uart->port + UART_REG_DATA, '\r' );
+                uart->b_pending_lf = true;
+            }
+            else
+            {
+                axk_x86_outb( uart->port + UART_REG_DATA, (uint8_t)( c ) );
+            }
+        }
+    }
+}
+
+
+bool axk_x86_uart_init( uint16_t port, uint32_t baud )
+{
+    if( baud == 0U || baud > AXK_X86_UART_BASE_CLOCK ) { return false; }
+    uint32_t divisor = AXK_X86_UART_BASE_CLOCK / baud;
+
+    // Polled only, so interrupts stay off
+    axk_x86_outb( port + UART_REG_INTERRUPT_ENABLE, 0x00 );
+
+    // Set the baud rate divisor, then 8 data bits, no parity, one stop bit
+    axk_x86_outb( port + UART_REG_LINE_CONTROL, 0x80 );
+    axk_x86_outb( port + UART_REG_DIVISOR_LOW, (uint8_t)( divisor & 0xFFU ) );
+    axk_x86_outb( port + UART_REG_DIVISOR_HIGH, (uint8_t)( ( divisor >> 8 ) & 0xFFU ) );
+    axk_x86_outb( port + UART_REG_LINE_CONTROL, 0x03 );
+
+    // Enable and clear the FIFOs
+    axk_x86_outb( port + UART_REG_FIFO_CONTROL, 0xC7 );
+
+    // Make sure something is actually there, by sending a byte to ourselves in loopback mode
+    axk_x86_outb( port + UART_REG_MODEM_CONTROL, 0x1E );
+    axk_x86_outb( port + UART_REG_DATA, UART_LOOPBACK_TEST_VALUE );
+    if( axk_x86_inb( port + UART_REG_DATA ) != UART_LOOPBACK_TEST_VALUE )
+    {
+        return false;
+    }
+
+    // Back to normal operation (DTR, RTS, OUT1 and OUT2 set)
+    axk_x86_outb( port + UART_REG_MODEM_CONTROL, 0x0F );
+
+    // Both FIFO bits in the interrupt ID register are only set on a 16550A (or newer) with a working FIFO
+    g_uart.port             = port;
+    g_uart.fifo_size        = ( ( axk_x86_inb( port + UART_REG_INTERRUPT_ID ) & 0xC0 ) == 0xC0 ) ? UART_FIFO_SIZE : 1U;
+    g_uart.b_pending_lf     = false;
+
+    g_uart_sink.name        = "uart16550";
+    g_uart_sink.fn_write    = _uart_write;
+    g_uart_sink.context     = &g_uart;
+
+    return axk_console_register_sink( &g_uart_sink );
+}
+
+#endif
\ No newline at end of file
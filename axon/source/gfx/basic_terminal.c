@@ -6,6 +6,16 @@
 
 #include "axon/gfx/basic_terminal.h"
 #include "axon/library/spinlock.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/gfx/console_sink.h"
+#include "stdio.h"
+
+#ifdef __x86_64__
+#include "axon/arch_x86/util.h"
+#define _copy_to_framebuffer( _dest_, _src_, _count_ ) axk_x86_copy_nt( _dest_, _src_, _count_ )
+#else
+#define _copy_to_framebuffer( _dest_, _src_, _count_ ) memcpy( _dest_, _src_, _count_ )
+#endif
 
 /*
     Constants
@@ -24,19 +34,207 @@ static struct axk_psf1_t g_font;
 
 static uint32_t g_pos_x     = BASIC_TERMINAL_BORDER_SIZE;
 static uint32_t g_pos_y     = BASIC_TERMINAL_BORDER_SIZE;
-static uint8_t g_fg_r       = 255;
-static uint8_t g_fg_g       = 255;
-static uint8_t g_fg_b       = 255;
-static uint8_t g_bg_r       = 0;
-static uint8_t g_bg_g       = 0;
-static uint8_t g_bg_b       = 0;
+static uint32_t g_fg_pixel  = 0xFFFFFFFFU;
+static uint32_t g_bg_pixel  = 0U;
 
 static enum axk_basicterminal_mode_t g_mode = BASIC_TERMINAL_MODE_CONSOLE;
 static struct axk_spinlock_t g_lock;
 
+// Every possible row of glyph pixels (one bit per pixel), pre-rendered in the framebuffer format with the current colors
+static uint32_t g_row_cache[ 256 ][ BASIC_TERMINAL_FONT_WIDTH ];
+static bool g_row_cache_dirty = true;
+
+// Converts a color into the framebuffer format, selected in 'axk_basicterminal_init' so the format is never checked while drawing
+// Bitmask formats go through a lookup table per channel, built once from the channel widths and shifts
+static uint32_t _pack_bgrx( uint8_t r, uint8_t g, uint8_t b );
+static uint32_t( *g_fn_pack )( uint8_t r, uint8_t g, uint8_t b ) = _pack_bgrx;
+static uint32_t g_bitmask_lut[ 3 ][ 256 ];
+
+// Copy of the screen in system memory, once allocated all drawing goes here and only the changed area is copied to the framebuffer
+// The rows are used as a ring, 'g_shadow_top' is the row shown at the top of the screen, so scrolling only has to move it
+static uint8_t* g_shadow        = NULL;
+static uint32_t g_shadow_top    = 0U;
+static uint32_t g_dirty_min_x   = 0xFFFFFFFFU;
+static uint32_t g_dirty_min_y   = 0xFFFFFFFFU;
+static uint32_t g_dirty_max_x   = 0U;
+static uint32_t g_dirty_max_y   = 0U;
+
 extern char _binary_data_fonts_basic_terminal_psf_start;
 extern char _binary_data_fonts_basic_terminal_psf_end;
 
+/*
+    _scale_channel
+    * Private Function
+    * Converts an 8-bit color channel to a channel of 'width' bits
+*/
+static uint32_t _scale_channel( uint8_t value, uint8_t width )
+{
+    return width >= 8 ? ( (uint32_t)( value ) << ( width - 8 ) ) : ( (uint32_t)( value ) >> ( 8 - width ) );
+}
+
+
+/*
+    _pack_rgbx / _pack_bgrx / _pack_bitmask
+    * Private Functions
+    * Converts a color into a pixel value, one for each framebuffer format
+*/
+static uint32_t _pack_rgbx( uint8_t r, uint8_t g, uint8_t b )
+{
+    return (uint32_t)( r ) | ( (uint32_t)( g ) << 8 ) | ( (uint32_t)( b ) << 16 );
+}
+
+static uint32_t _pack_bgrx( uint8_t r, uint8_t g, uint8_t b )
+{
+    return (uint32_t)( b ) | ( (uint32_t)( g ) << 8 ) | ( (uint32_t)( r ) << 16 );
+}
+
+static uint32_t _pack_bitmask( uint8_t r, uint8_t g, uint8_t b )
+{
+    return g_bitmask_lut[ 0 ][ r ] | g_bitmask_lut[ 1 ][ g ] | g_bitmask_lut[ 2 ][ b ];
+}
+
+
+/*
+    _select_format
+    * Private Function
+    * Picks the pack function for the framebuffer format, building the bitmask lookup tables if theyre needed
+*/
+static void _select_format( void )
+{
+    struct tzero_resolution_t* res = &( g_framebuffer.resolution );
+    switch( res->mode )
+    {
+        case PIXEL_FORMAT_RGBX_32:
+        g_fn_pack = _pack_rgbx;
+        break;
+
+        case PIXEL_FORMAT_BGRX_32:
+        g_fn_pack = _pack_bgrx;
+        break;
+
+        default:
+        {
+            for( uint32_t value = 0; value < 256; value++ )
+            {
+                g_bitmask_lut[ 0 ][ value ] = _scale_channel( (uint8_t)( value ), res->red_bit_width ) << res->red_shift;
+                g_bitmask_lut[ 1 ][ value ] = _scale_channel( (uint8_t)( value ), res->green_bit_width ) << res->green_shift;
+                g_bitmask_lut[ 2 ][ value ] = _scale_channel( (uint8_t)( value ), res->blue_bit_width ) << res->blue_shift;
+            }
+
+            g_fn_pack = _pack_bitmask;
+            break;
+        }
+    }
+}
+
+
+/*
+    _build_row_cache
+    * Private Function
+    * Renders every possible glyph row with the current foreground and background colors
+    * Rebuilt the next time text is printed after the colors change
+*/
+static void _build_row_cache( void )
+{
+    for( uint32_t bits = 0; bits < 256; bits++ )
+    {
+        for( uint32_t x = 0; x < BASIC_TERMINAL_FONT_WIDTH; x++ )
+        {
+            g_row_cache[ bits ][ x ] = ( ( bits & ( 0b10000000 >> x ) ) != 0 ) ? g_fg_pixel : g_bg_pixel;
+        }
+    }
+
+    g_row_cache_dirty = false;
+}
+
+
+/*
+    _line_ptr
+    * Private Function
+    * Gets the address of the first pixel of screen row 'y', in the shadow buffer if there is one, otherwise in the framebuffer
+*/
+static inline uint8_t* _line_ptr( uint32_t y )
+{
+    uint64_t line_pitch = g_framebuffer.resolution.pixels_per_scanline * 4UL;
+    if( g_shadow == NULL )
+    {
+        return (uint8_t*)( g_framebuffer.phys_addr ) + ( line_pitch * y );
+    }
+
+    uint32_t row = y + g_shadow_top;
+    if( row >= g_framebuffer.resolution.height ) { row -= g_framebuffer.resolution.height; }
+
+    return g_shadow + ( line_pitch * row );
+}
+
+
+/*
+    _mark_dirty
+    * Private Function
+    * Grows the dirty rectangle to include the given area, so its copied out on the next flush
+*/
+static inline void _mark_dirty( uint32_t x, uint32_t y, uint32_t w, uint32_t h )
+{
+    if( g_shadow == NULL ) { return; }
+
+    if( x < g_dirty_min_x )         { g_dirty_min_x = x; }
+    if( y < g_dirty_min_y )         { g_dirty_min_y = y; }
+    if( x + w > g_dirty_max_x )     { g_dirty_max_x = x + w; }
+    if( y + h > g_dirty_max_y )     { g_dirty_max_y = y + h; }
+}
+
+
+/*
+    _flush
+    * Private Function
+    * Copies the dirty rectangle from the shadow buffer to the framebuffer, one scanline at a time with non-temporal stores
+    * Called at the end of each public drawing function
+*/
+static void _flush( void )
+{
+    if( g_shadow == NULL || g_dirty_min_x >= g_dirty_max_x || g_dirty_min_y >= g_dirty_max_y ) { return; }
+
+    uint32_t line_pixels    = g_framebuffer.resolution.pixels_per_scanline;
+    uint64_t line_pitch     = line_pixels * 4UL;
+
+    // Widen the columns out to 16 bytes (4 pixels) on both sides, so the stores stay aligned
+    uint32_t min_x = g_dirty_min_x & ~3U;
+    uint32_t max_x = ( g_dirty_max_x + 3U ) & ~3U;
+    uint32_t max_y = g_dirty_max_y;
+
+    if( max_x > line_pixels ) { max_x = line_pixels; }
+    if( max_y > g_framebuffer.resolution.height ) { max_y = g_framebuffer.resolution.height; }
+
+    for( uint32_t y = g_dirty_min_y; y < max_y; y++ )
+    {
+        _copy_to_framebuffer( (uint8_t*)( g_framebuffer.phys_addr ) + ( line_pitch * y ) + ( min_x * 4UL ),
+            _line_ptr( y ) + ( min_x * 4UL ), ( max_x - min_x ) * 4UL );
+    }
+
+    g_dirty_min_x = 0xFFFFFFFFU;
+    g_dirty_min_y = 0xFFFFFFFFU;
+    g_dirty_max_x = 0U;
+    g_dirty_max_y = 0U;
+}
+
+
+/*
+    _clear_lines
+    * Private Function
+    * Zeroes 'count' screen rows starting at row 'y'
+*/
+static void _clear_lines( uint32_t y, uint32_t count )
+{
+    uint64_t line_pitch = g_framebuffer.resolution.pixels_per_scanline * 4UL;
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        memset( _line_ptr( y + i ), 0, line_pitch );
+    }
+
+    _mark_dirty( 0U, y, g_framebuffer.resolution.width, count );
+}
+
+
 /*
     Functions
 */
@@ -56,6 +254,12 @@ bool axk_basicterminal_init( struct tzero_payload_parameters_t* in_params )
     // Find the start of the data section
     g_font.glyph_data   = (uint8_t*)( &_binary_data_fonts_basic_terminal_psf_start + sizeof( struct axk_psf1_header_t ) );
     g_mode              = BASIC_TERMINAL_MODE_CONSOLE;
+    g_row_cache_dirty   = true;
+
+    // Resolve the pixel format, and convert the default colors (white on black)
+    _select_format();
+    g_fg_pixel = g_fn_pack( 255, 255, 255 );
+    g_bg_pixel = g_fn_pack( 0, 0, 0 );
 
     // Initialize spin lock
     axk_spinlock_init( &g_lock );
@@ -73,6 +277,32 @@ void axk_basicterminal_update_pointers( void )
 }
 
 
+bool axk_basicterminal_init_shadow( void )
+{
+    if( g_shadow != NULL ) { return true; }
+
+    uint64_t size = g_framebuffer.resolution.pixels_per_scanline * 4UL * g_framebuffer.resolution.height;
+    uint64_t addr = 0UL;
+
+    if( size == 0UL || !axk_va_alloc( AXK_VA_REGION_HEAP, size, 0UL, AXK_VA_FLAG_NONE, &addr ) )
+    {
+        return false;
+    }
+
+    // Start off with whatever is on the screen right now, this is the only time we ever read from the framebuffer
+    memcpy( (void*)( addr ), (void*)( g_framebuffer.phys_addr ), size );
+
+    g_shadow_top    = 0U;
+    g_dirty_min_x   = 0xFFFFFFFFU;
+    g_dirty_min_y   = 0xFFFFFFFFU;
+    g_dirty_max_x   = 0U;
+    g_dirty_max_y   = 0U;
+    g_shadow        = (uint8_t*)( addr );
+
+    return true;
+}
+
+
 enum axk_basicterminal_mode_t axk_basicterminal_get_mode( void )
 {
     return g_mode;
@@ -91,7 +321,7 @@ void axk_basicterminal_set_mode( enum axk_basicterminal_mode_t in_mode )
 
 void axk_basicterminal_lock( void )
 {
-    axk_spinlock_acquire( &g_lock );
+    axk_spinlock_acquire_at( &g_lock, __builtin_return_address( 0 ) );
 }
 
 
@@ -103,13 +333,15 @@ void axk_basicterminal_unlock( void )
 
 void axk_basicterminal_set_fg( uint8_t r, uint8_t g, uint8_t b )
 {
-    g_fg_r = r; g_fg_g = g; g_fg_b = b;
+    g_fg_pixel = g_fn_pack( r, g, b );
+    g_row_cache_dirty = true;
 }
 
 
 void axk_basicterminal_set_bg( uint8_t r, uint8_t g, uint8_t b )
 {
-    g_bg_r = r; g_bg_g = g; g_bg_b = b;
+    g_bg_pixel = g_fn_pack( r, g, b );
+    g_row_cache_dirty = true;
 }
 
 
@@ -161,7 +393,9 @@ void axk_basicterminal_get_text_size_n( const char* str, size_t count, uint32_t*
 }
 
 
-void _print_word( const char* str, size_t count )
+static void _newline( void );
+
+static void _print_word( const char* str, size_t count )
 {
     // First, determine the size of the word and if it can fit on the current line
     if( str == NULL || count == 0UL ) { return; }
@@ -176,100 +410,37 @@ void _print_word( const char* str, size_t count )
     bool b_split_word = ( word_sz >= ( screen_w - BASIC_TERMINAL_BORDER_SIZE - BASIC_TERMINAL_BORDER_SIZE ) / 4U );
     if( !b_split_word && ( g_pos_x + word_sz > ( screen_w - BASIC_TERMINAL_BORDER_SIZE ) ) )
     {
-        axk_basicterminal_printnl();
+        _newline();
     }
 
     // Now, the position should be accurate, and we should have enough room to print
+    if( g_row_cache_dirty ) { _build_row_cache(); }
+
     uint32_t glyph_count = g_font.header.mode == 1 ? 512 : 256;
+
     for( size_t index = 0; index < count; index++ )
     {
         if( b_split_word && ( g_pos_x + 8 + BASIC_TERMINAL_CHAR_EXTRA_WIDTH ) > ( screen_w - BASIC_TERMINAL_BORDER_SIZE ) )
         {
-            axk_basicterminal_printnl();
+            _newline();
         }
 
-        char c = str[ index ];
+        uint32_t c = (uint32_t)( (uint8_t)( str[ index ] ) );
         if( c >= glyph_count )
         {
-            c = (char)( 0 );
+            c = 0U;
         }
 
-        // Now, loop through the pixels affected by this letter being printed (including any padding), and determine if its foreground or background
-        uint8_t* gdata = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * (uint32_t)( c ) );
-        uint8_t* fline = (uint8_t*)( g_framebuffer.phys_addr ) + ( g_framebuffer.resolution.pixels_per_scanline * 4U * g_pos_y );
+        // Each row of the glyph is one byte, so copy the matching pre-rendered row straight into the screen
+        uint8_t* gdata = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * c );
 
-        for( uint32_t y = 0; y < 16; y++ )
+        for( uint32_t y = 0; y < BASIC_TERMINAL_FONT_HEIGHT; y++ )
         {
-            for( uint32_t x = 0; x < 8; x++ )
-            {
-                uint32_t xoff   = ( x + g_pos_x ) * 4U;
-                bool b_fg       = ( ( *gdata & ( 0b10000000 >> x ) ) != 0 );
-
-                // Check for common modes we can have optimized algorithms for better rendering performance
-                if( g_framebuffer.resolution.mode == PIXEL_FORMAT_RGBX_32 )
-                {
-                    fline[ xoff + 0U ] = b_fg ? g_fg_r : g_bg_r;
-                    fline[ xoff + 1U ] = b_fg ? g_fg_g : g_bg_g;
-                    fline[ xoff + 2U ] = b_fg ? g_fg_b : g_bg_b;
-                }
-                else if( g_framebuffer.resolution.mode == PIXEL_FORMAT_BGRX_32 )
-                {
-                    fline[ xoff + 0U ] = b_fg ? g_fg_b : g_bg_b;
-                    fline[ xoff + 1U ] = b_fg ? g_fg_g : g_bg_g;
-                    fline[ xoff + 2U ] = b_fg ? g_fg_r : g_bg_r;
-                }
-                else
-                {
-                    // First, lets do the red channel
-                    uint32_t pixel      = 0x00000000U;
-                    uint8_t r_bit_diff  = 8 - g_framebuffer.resolution.red_bit_width;
-
-                    if( r_bit_diff == 0 )
-                    {
-                        pixel |= ( ( b_fg ? g_fg_r : g_bg_r ) << g_framebuffer.resolution.red_shift );
-                    }
-                    else
-                    {
-                        uint8_t divisor = 1;
-                        for( uint8_t i = 0; i < r_bit_diff; i++ ) { divisor *= 2; }
-                        pixel |= ( (uint32_t)( ( b_fg ? g_fg_r : g_bg_r ) / divisor ) << g_framebuffer.resolution.red_shift );
-                    }
-
-                    // Green channel
-                    uint8_t g_bit_diff = 8 - g_framebuffer.resolution.green_bit_width;
-                    if( g_bit_diff == 0 )
-                    {
-                        pixel |= ( ( b_fg ? g_fg_g : g_bg_g ) << g_framebuffer.resolution.green_shift );
-                    }
-                    else
-                    {
-                        uint8_t divisor = 1;
-                        for( uint8_t i = 0; i < g_bit_diff; i++ ) { divisor *= 2; }
-                        pixel |= ( (uint32_t)( ( b_fg ? g_fg_g : g_bg_g ) / divisor ) << g_framebuffer.resolution.green_shift );
-                    }
-
-                    // Blue channel
-                    uint8_t b_bit_diff = 8 - g_framebuffer.resolution.blue_bit_width;
-                    if( b_bit_diff == 0 )
-                    {
-                        pixel |= ( ( b_fg ? g_fg_b : g_bg_b ) << g_framebuffer.resolution.blue_shift );
-                    }
-                    else
-                    {
-                        uint8_t divisor = 1;
-                        for( uint8_t i = 0; i < b_bit_diff; i++ ) { divisor *= 2; }
-                        pixel |= ( (uint32_t)( ( b_fg ? g_fg_b : g_bg_b ) / divisor ) << g_framebuffer.resolution.blue_shift );
-                    }
-
-                    // Write the pixel 
-                    *( (uint32_t*)( fline + xoff ) ) = pixel;
-                }
-            }
-
-            gdata++;
-            fline += ( g_framebuffer.resolution.pixels_per_scanline * 4U );
+            memcpy( _line_ptr( g_pos_y + y ) + ( g_pos_x * 4U ), g_row_cache[ gdata[ y ] ], sizeof( g_row_cache[ 0 ] ) );
         }
 
+        _mark_dirty( g_pos_x, g_pos_y, BASIC_TERMINAL_FONT_WIDTH, BASIC_TERMINAL_FONT_HEIGHT );
+
         g_pos_x += 8 + BASIC_TERMINAL_CHAR_EXTRA_WIDTH;
 
     }
@@ -277,7 +448,11 @@ void _print_word( const char* str, size_t count )
 
 void axk_basicterminal_prints( const char* str )
 {
-    if( str == NULL || g_mode != BASIC_TERMINAL_MODE_CONSOLE ) { return; }
+    if( str == NULL ) { return; }
+
+    // Sinks get a copy of the text regardless of the mode
+    axk_console_write( str, strlen( str ) );
+    if( g_mode != BASIC_TERMINAL_MODE_CONSOLE ) { return; }
     
     size_t start_word   = 0UL;
     size_t index        = 0UL;
@@ -317,7 +492,7 @@ void axk_basicterminal_prints( const char* str )
 
             if( is_end ) { break; }
             if( is_tab ) { _print_word( "    ", 4 ); }
-            if( is_nl ) { axk_basicterminal_printnl(); }
+            if( is_nl ) { _newline(); }
 
             // The next word is assumed to start on the next character after the current space character
             start_word = index + 1UL;
@@ -325,13 +500,19 @@ void axk_basicterminal_prints( const char* str )
 
         index++;
     }
+
+    _flush();
 }
 
 
-void axk_basicterminal_printnl( void )
+/*
+    _newline
+    * Private Function
+    * Moves to the start of the next line, scrolling the text up if were at the bottom of the screen
+    * With the shadow buffer, scrolling rotates the ring of rows instead of moving any pixels, the whole screen is flushed afterwards
+*/
+static void _newline( void )
 {
-    if( g_mode != BASIC_TERMINAL_MODE_CONSOLE ) { return; }
-
     uint32_t screen_w = g_framebuffer.resolution.width;
     uint32_t screen_h = g_framebuffer.resolution.height;
 
@@ -341,16 +522,28 @@ void axk_basicterminal_printnl( void )
     if( ( g_pos_y + ( 16 + BASIC_TERMINAL_CHAR_EXTRA_HEIGHT ) * 2U ) > ( screen_h - BASIC_TERMINAL_BORDER_SIZE ) )
     {
         // We need to take all existing text and scroll up a line
-        // So, were going to copy all screen data 
-        uint32_t line_pitch     = g_framebuffer.resolution.pixels_per_scanline * 4UL;
-        uint32_t needed_lines   = ( ( ( 16 + BASIC_TERMINAL_CHAR_EXTRA_HEIGHT ) * 2U ) + g_pos_y ) - ( screen_h - BASIC_TERMINAL_BORDER_SIZE );
-        uint32_t source_y       = ( BASIC_TERMINAL_BORDER_SIZE + needed_lines );
-        uint32_t dest_y         = BASIC_TERMINAL_BORDER_SIZE;
-        uint32_t copy_count     = ( 16 - ( BASIC_TERMINAL_BORDER_SIZE * 2 ) ) - needed_lines;
-
-        memmove( (void*)( (uint8_t*)( g_framebuffer.phys_addr ) + ( dest_y * line_pitch ) ),
-            (void*)( (uint8_t*)( g_framebuffer.phys_addr ) + ( source_y * line_pitch ) ),
-            copy_count * line_pitch );
+        uint32_t needed_lines = ( ( ( 16 + BASIC_TERMINAL_CHAR_EXTRA_HEIGHT ) * 2U ) + g_pos_y ) - ( screen_h - BASIC_TERMINAL_BORDER_SIZE );
+
+        if( g_shadow != NULL )
+        {
+            // Rotate the ring, then blank the rows that wrapped around to the bottom, and the top border (which now holds the end of a line)
+            g_shadow_top = ( g_shadow_top + needed_lines ) % screen_h;
+            _clear_lines( screen_h - needed_lines, needed_lines );
+            _clear_lines( 0U, BASIC_TERMINAL_BORDER_SIZE );
+            _mark_dirty( 0U, 0U, screen_w, screen_h );
+        }
+        else
+        {
+            // No shadow buffer yet, so copy the text area up within the framebuffer
+            uint64_t line_pitch     = g_framebuffer.resolution.pixels_per_scanline * 4UL;
+            uint32_t source_y       = ( BASIC_TERMINAL_BORDER_SIZE + needed_lines );
+            uint32_t dest_y         = BASIC_TERMINAL_BORDER_SIZE;
+            uint32_t copy_count     = ( screen_h - BASIC_TERMINAL_BORDER_SIZE ) - source_y;
+
+            memmove( (void*)( (uint8_t*)( g_framebuffer.phys_addr ) + ( dest_y * line_pitch ) ),
+                (void*)( (uint8_t*)( g_framebuffer.phys_addr ) + ( source_y * line_pitch ) ),
+                copy_count * line_pitch );
+        }
         
         // Now, we can adjust the current Y position to be at the bottom of the shifted text
         g_pos_y = ( g_pos_y + 16 + BASIC_TERMINAL_CHAR_EXTRA_HEIGHT ) - needed_lines;
@@ -360,6 +553,16 @@ void axk_basicterminal_printnl( void )
         g_pos_y += ( 16 + BASIC_TERMINAL_CHAR_EXTRA_HEIGHT );
     }
 }
+
+
+void axk_basicterminal_printnl( void )
+{
+    axk_console_write( "\n", 1UL );
+    if( g_mode != BASIC_TERMINAL_MODE_CONSOLE ) { return; }
+
+    _newline();
+    _flush();
+}
  
 
 void axk_basicterminal_printtab( void )
@@ -569,149 +772,162 @@ void axk_basicterminal_printh64( uint64_t num, bool b_leading_zeros )
 }
 
 
+void axk_basicterminal_printf( const char* fmt, ... )
+{
+    if( fmt == NULL || g_mode != BASIC_TERMINAL_MODE_CONSOLE ) { return; }
+
+    char str_data[ BASIC_TERMINAL_PRINTF_MAX + 1 ];
+    va_list args;
+
+    va_start( args, fmt );
+    vsnprintf( str_data, sizeof( str_data ), fmt, args );
+    va_end( args );
+
+    axk_basicterminal_prints( str_data );
+}
+
+
 void axk_basicterminal_clear( void )
 {
     g_pos_x = BASIC_TERMINAL_BORDER_SIZE;
     g_pos_y = BASIC_TERMINAL_BORDER_SIZE;
 
     // Clear the framebuffer
-    memset( (void*)g_framebuffer.phys_addr, 0, g_framebuffer.size );
+    if( g_shadow != NULL )
+    {
+        g_shadow_top = 0U;
+        _clear_lines( 0U, g_framebuffer.resolution.height );
+        _flush();
+    }
+    else
+    {
+        memset( (void*)g_framebuffer.phys_addr, 0, g_framebuffer.size );
+    }
 }
 
 
-static inline void _draw_pixel( uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b )
+/*
+    _fill_row
+    * Private Function
+    * Writes 'count' copies of a pixel value in a row, with 'rep stosd' on x86
+*/
+static inline void _fill_row( uint32_t* dest, uint32_t value, uint32_t count )
+{
+#ifdef __x86_64__
+    uint64_t count_reg = count;
+    __asm__ volatile( "rep stosl" : "+D"( dest ), "+c"( count_reg ) : "a"( value ) : "memory" );
+#else
+    for( uint32_t i = 0; i < count; i++ ) { dest[ i ] = value; }
+#endif
+}
+
+
+/*
+    _fill_rect
+    * Private Function
+    * Fills a rectangle with a pixel value, one row-wide fill per line, clipped to the screen
+*/
+static void _fill_rect( uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t value )
 {
     if( x >= g_framebuffer.resolution.width || y >= g_framebuffer.resolution.height ) { return; }
 
-    // Find address of this pixel in the framebuffer
-    uint8_t* pixel = (uint8_t*)( g_framebuffer.phys_addr + ( g_framebuffer.resolution.pixels_per_scanline * 4U * y ) + ( x * 4U ) );
-    switch( g_framebuffer.resolution.mode )
+    if( (uint64_t)( x ) + (uint64_t)( w ) > (uint64_t)( g_framebuffer.resolution.width ) ) { w = g_framebuffer.resolution.width - x; }
+    if( (uint64_t)( y ) + (uint64_t)( h ) > (uint64_t)( g_framebuffer.resolution.height ) ) { h = g_framebuffer.resolution.height - y; }
+    if( w == 0U || h == 0U ) { return; }
+
+    for( uint32_t row = 0; row < h; row++ )
     {
-        case PIXEL_FORMAT_RGBX_32:
-        {
-            pixel[ 0 ] = r;
-            pixel[ 1 ] = g;
-            pixel[ 2 ] = b;
-            break;
-        }
+        _fill_row( (uint32_t*)( _line_ptr( y + row ) + ( x * 4U ) ), value, w );
+    }
 
-        case PIXEL_FORMAT_BGRX_32:
-        {
-            pixel[ 0 ] = b;
-            pixel[ 1 ] = g;
-            pixel[ 2 ] = r;
-            break;
-        }
+    _mark_dirty( x, y, w, h );
+}
 
-        default:
-        {
-            // First, lets do the red channel
-            uint32_t data      = 0x00000000U;
-            uint8_t r_bit_diff  = 8 - g_framebuffer.resolution.red_bit_width;
 
-            if( r_bit_diff == 0 )
-            {
-                data |= ( (uint32_t)( r ) << g_framebuffer.resolution.red_shift );
-            }
-            else
-            {
-                uint8_t divisor = 1;
-                for( uint8_t i = 0; i < r_bit_diff; i++ ) { divisor *= 2; }
-                data |= ( (uint32_t)( r / divisor ) << g_framebuffer.resolution.red_shift );
-            }
+static inline void _draw_pixel( uint32_t x, uint32_t y, uint32_t value )
+{
+    if( x >= g_framebuffer.resolution.width || y >= g_framebuffer.resolution.height ) { return; }
 
-            // Green channel
-            uint8_t g_bit_diff = 8 - g_framebuffer.resolution.green_bit_width;
-            if( g_bit_diff == 0 )
-            {
-                data |= ( (uint32_t)( g ) << g_framebuffer.resolution.green_shift );
-            }
-            else
-            {
-                uint8_t divisor = 1;
-                for( uint8_t i = 0; i < g_bit_diff; i++ ) { divisor *= 2; }
-                data |= ( (uint32_t)( g / divisor ) << g_framebuffer.resolution.green_shift );
-            }
+    *( (uint32_t*)( _line_ptr( y ) + ( x * 4U ) ) ) = value;
+    _mark_dirty( x, y, 1U, 1U );
+}
 
-            // Blue channel
-            uint8_t b_bit_diff = 8 - g_framebuffer.resolution.blue_bit_width;
-            if( b_bit_diff == 0 )
-            {
-                data |= ( (uint32_t)( b ) << g_framebuffer.resolution.blue_shift );
-            }
-            else
+
+/*
+    _draw_glyph
+    * Private Function
+    * Draws a single character at (x, y) for the graphics mode functions, rows at or past 'max_y' are skipped and columns are clipped to the screen
+    * Opaque glyphs copy rows from the row cache, transparent glyphs only write the foreground pixels
+*/
+static void _draw_glyph( char c, uint32_t x, uint32_t y, uint32_t max_y, bool b_transparent_bg )
+{
+    if( x >= g_framebuffer.resolution.width || y >= g_framebuffer.resolution.height ) { return; }
+
+    uint32_t glyph_count    = g_font.header.mode == 1 ? 512 : 256;
+    uint32_t index          = (uint32_t)( (uint8_t)( c ) );
+    if( index >= glyph_count ) { index = 0U; }
+
+    uint8_t* gdata = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * index );
+
+    uint32_t columns    = g_framebuffer.resolution.width - x;
+    uint32_t rows       = BASIC_TERMINAL_FONT_HEIGHT;
+    if( columns > BASIC_TERMINAL_FONT_WIDTH ) { columns = BASIC_TERMINAL_FONT_WIDTH; }
+    if( max_y > g_framebuffer.resolution.height ) { max_y = g_framebuffer.resolution.height; }
+    if( y + rows > max_y ) { rows = ( max_y > y ) ? max_y - y : 0U; }
+
+    for( uint32_t row = 0; row < rows; row++ )
+    {
+        uint32_t* line = (uint32_t*)( _line_ptr( y + row ) + ( x * 4U ) );
+
+        if( b_transparent_bg )
+        {
+            for( uint32_t col = 0; col < columns; col++ )
             {
-                uint8_t divisor = 1;
-                for( uint8_t i = 0; i < b_bit_diff; i++ ) { divisor *= 2; }
-                data |= ( (uint32_t)( b / divisor ) << g_framebuffer.resolution.blue_shift );
+                if( ( gdata[ row ] & ( 0b10000000 >> col ) ) != 0 ) { line[ col ] = g_fg_pixel; }
             }
-
-            // Write the pixel 
-            *( (uint32_t*)( pixel ) ) = data;
-            break;
+        }
+        else
+        {
+            memcpy( line, g_row_cache[ gdata[ row ] ], columns * 4U );
         }
     }
+
+    _mark_dirty( x, y, columns, rows );
 }
 
 
 void axk_basicterminal_draw_text( const char* str, uint32_t in_x, uint32_t in_y, bool b_transparent_bg )
 {
     if( g_mode != BASIC_TERMINAL_MODE_GRAPHICS || str == NULL || in_x >= g_framebuffer.resolution.width || in_y >= g_framebuffer.resolution.height ) { return; }
+    if( g_row_cache_dirty ) { _build_row_cache(); }
 
     size_t str_sz = strlen( str );
 
     for( size_t i = 0; i < str_sz; i++ )
     {
-        char c = str[ i ];
-
-        // Now, loop through the pixels affected by this letter being printed (including any padding), and determine if its foreground or background
-        uint8_t* gdata = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * (uint32_t)( c ) );
-        for( uint32_t y = 0; y < 16; y++ )
-        {
-            for( uint32_t x = 0; x < 8; x++ )
-            {
-                bool b_fg = ( ( *gdata & ( 0b10000000 >> x ) ) != 0 );
-                if( !b_fg && b_transparent_bg ) { continue; }
-
-                _draw_pixel( x + in_x, y + in_y, b_fg ? g_fg_r : g_bg_r, b_fg ? g_fg_g : g_bg_g, b_fg ? g_fg_b : g_bg_g );
-            }
-
-            gdata++;
-        }
-
+        _draw_glyph( str[ i ], in_x, in_y, in_y + BASIC_TERMINAL_FONT_HEIGHT, b_transparent_bg );
         in_x += 8 + BASIC_TERMINAL_CHAR_EXTRA_WIDTH;
     }
+
+    _flush();
 }
 
 
 void axk_basicterminal_draw_text_n( const char* str, size_t n, uint32_t in_x, uint32_t in_y, bool b_transparent_bg )
 {
     if( g_mode != BASIC_TERMINAL_MODE_GRAPHICS || str == NULL || in_x >= g_framebuffer.resolution.width || in_y >= g_framebuffer.resolution.height ) { return; }
+    if( g_row_cache_dirty ) { _build_row_cache(); }
 
     size_t str_sz = strlen( str );
     str_sz = str_sz > n ? n : str_sz;
 
     for( size_t i = 0; i < str_sz; i++ )
     {
-        char c = str[ i ];
-
-        // Now, loop through the pixels affected by this letter being printed (including any padding), and determine if its foreground or background
-        uint8_t* gdata = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * (uint32_t)( c ) );
-        for( uint32_t y = 0; y < 16; y++ )
-        {
-            for( uint32_t x = 0; x < 8; x++ )
-            {
-                bool b_fg = ( ( *gdata & ( 0b10000000 >> x ) ) != 0 );
-                if( !b_fg && b_transparent_bg ) { continue; }
-
-                _draw_pixel( x + in_x, y + in_y, b_fg ? g_fg_r : g_bg_r, b_fg ? g_fg_g : g_bg_g, b_fg ? g_fg_b : g_bg_g );
-            }
-
-            gdata++;
-        }
-
+        _draw_glyph( str[ i ], in_x, in_y, in_y + BASIC_TERMINAL_FONT_HEIGHT, b_transparent_bg );
         in_x += 8 + BASIC_TERMINAL_CHAR_EXTRA_WIDTH;
     }
+
+    _flush();
 }
 
 
@@ -725,22 +941,16 @@ void axk_basicterminal_draw_text_box( const char* str, uint32_t in_x, uint32_t i
     // First, draw the background if desired
     if( !b_transparent_bg )
     {
-        for( uint32_t y = in_y; y < max_y; y++ )
-        {
-            for( uint32_t x = in_x; x < max_x; x++ )
-            {
-                _draw_pixel( x, y, g_bg_r, g_bg_g, g_bg_b );
-            }
-        }
+        _fill_rect( in_x, in_y, in_w, in_h, g_bg_pixel );
     }
 
     // Next, we want to loop through each character in the string, drawing each inside of the text box
     // If we dont have enough room left on the line, we go to the next line
     // Ensure we dont overdraw past the end of the box, we can draw partial characters though
     // Once the current line position is totally past the bottom of the text box, we will break
-    if( str == NULL ) { return; }
+    if( str == NULL ) { _flush(); return; }
     size_t str_len = strlen( str );
-    if( str_len == 0UL ) { return; }
+    if( str_len == 0UL ) { _flush(); return; }
 
     uint32_t line = in_y;
     uint32_t xpos = in_x;
@@ -756,27 +966,15 @@ void axk_basicterminal_draw_text_box( const char* str, uint32_t in_x, uint32_t i
             continue;
         }
 
-        // Draw the next character
+        // Draw the next character, only the foreground since the background was already filled
         // TODO: We should instead draw word-by-word, unless the word is very large, then we go character by character
-        char c = str[ str_index++ ];
-        uint8_t* char_data = (uint8_t*)( g_font.glyph_data ) + ( g_font.header.glyph_sz * (uint32_t)( c ) );
-        for( uint32_t y = 0; y < BASIC_TERMINAL_FONT_HEIGHT; y++ )
-        {
-            if( ( line + y ) >= max_y ) { break; }
-            for( uint32_t x = 0; x < BASIC_TERMINAL_FONT_WIDTH; x++ )
-            {
-                if( ( *char_data & ( 0b10000000 >> x ) ) != 0 )
-                {
-                    _draw_pixel( xpos + x, line + y, g_fg_r, g_fg_g, g_fg_b );
-                }
-            }
-
-            char_data++;
-        }
+        _draw_glyph( str[ str_index++ ], xpos, line, max_y, true );
 
         // Increment x-position
         xpos += ( BASIC_TERMINAL_FONT_WIDTH + BASIC_TERMINAL_CHAR_EXTRA_WIDTH );
     }
+
+    _flush();
 }
 
 
@@ -856,7 +1054,8 @@ void axk_basicterminal_draw_hex( uint64_t num, bool b_leading_zeros, uint32_t x,
 
 void axk_basicterminal_draw_pixel( uint32_t x, uint32_t y )
 {
-    _draw_pixel( x, y, g_fg_r, g_fg_g, g_fg_b );
+    _draw_pixel( x, y, g_fg_pixel );
+    _flush();
 }
 
 
@@ -864,21 +1063,32 @@ void axk_basicterminal_draw_box( uint32_t x, uint32_t y, uint32_t w, uint32_t h,
 {
     if( g_mode != BASIC_TERMINAL_MODE_GRAPHICS || x >= g_framebuffer.resolution.width || y >= g_framebuffer.resolution.height ) { return; }
 
-    // To draw an outlined box, lets start by filling the rectangle with foreground color
+    // The box is filled with the foreground color, and outlined with the background color
     uint32_t end_y = ( (uint64_t)( y ) + (uint64_t)( h ) >= (uint64_t)( g_framebuffer.resolution.height ) ? g_framebuffer.resolution.height : y + h );
     uint32_t end_x = ( (uint64_t)( x ) + (uint64_t)( w ) >= (uint64_t)( g_framebuffer.resolution.width ) ? g_framebuffer.resolution.width : x + w );
     uint32_t fixed_w = end_x - x;
 
-    for( uint32_t py = y; py < end_y; py++ )
-    {
-        // Check for horizontal outlines
-        bool b_horizontal_outline = ( ( py < ( y + outline_width ) ) || ( py >= ( end_y - outline_width ) ) );
+    // Rows covered by the top and bottom outlines
+    uint32_t inner_top      = ( end_y - y > outline_width ) ? y + outline_width : end_y;
+    uint32_t inner_bottom   = ( end_y - y > outline_width ) ? end_y - outline_width : y;
+    if( inner_bottom < inner_top ) { inner_bottom = inner_top; }
 
-        for( uint32_t px = 0; px < fixed_w; px++ )
-        {
-            // Check for vertical outlines
-            bool b_outline = ( b_horizontal_outline || ( px < outline_width ) || ( px >= ( w - outline_width ) ) );
-            _draw_pixel( px + x, py, b_outline ? g_bg_r : g_fg_r, b_outline ? g_bg_g : g_fg_g, b_outline ? g_bg_b : g_fg_b );
-        }
+    _fill_rect( x, y, fixed_w, inner_top - y, g_bg_pixel );
+    _fill_rect( x, inner_bottom, fixed_w, end_y - inner_bottom, g_bg_pixel );
+
+    // The rows in between have an outline on each side, the right outline is placed using the unclipped width
+    if( inner_bottom > inner_top )
+    {
+        uint32_t inner_left     = outline_width < fixed_w ? outline_width : fixed_w;
+        uint32_t inner_right    = w > outline_width ? w - outline_width : 0U;
+        if( inner_right > fixed_w ) { inner_right = fixed_w; }
+        if( inner_right < inner_left ) { inner_right = inner_left; }
+
+        uint32_t inner_h = inner_bottom - inner_top;
+        _fill_rect( x, inner_top, inner_left, inner_h, g_bg_pixel );
+        _fill_rect( x + inner_left, inner_top, inner_right - inner_left, inner_h, g_fg_pixel );
+        _fill_rect( x + inner_right, inner_top, fixed_w - inner_right, inner_h, g_bg_pixel );
     }
-}   
\ No newline at end of file
+
+    _flush();
+}
\ No newline at end of file
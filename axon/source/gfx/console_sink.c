@@ -0,0 +1,84 @@
+/*==============================================================
+    Axon Kernel - Console Sinks
+    2021, Zachary Berry
+    axon/source/gfx/console_sink.c
+==============================================================*/
+
+#include "axon/gfx/console_sink.h"
+#include "axon/library/atomic.h"
+
+/*
+    State
+    * Sinks are only ever added, 'g_sink_count' is released after the new entry is written, so writers never see an empty slot
+*/
+static struct axk_console_sink_t* g_sinks[ AXK_CONSOLE_MAX_SINKS ];
+static struct axk_atomic_uint32_t g_sink_count;
+
+/*
+    History
+    * A ring of the last bytes written, 'g_history_total' counts every byte ever written, so the write position is the total modulo the size
+*/
+static char g_history[ AXK_CONSOLE_HISTORY_SIZE ];
+static uint64_t g_history_total;
+
+
+bool axk_console_register_sink( struct axk_console_sink_t* sink )
+{
+    if( sink == NULL || sink->fn_write == NULL ) { return false; }
+
+    uint32_t count = axk_atomic_load_uint32_relaxed( &g_sink_count );
+    if( count >= AXK_CONSOLE_MAX_SINKS ) { return false; }
+
+    g_sinks[ count ] = sink;
+    axk_atomic_store_uint32_release( &g_sink_count, count + 1U );
+
+    return true;
+}
+
+
+void axk_console_write( const char* str, size_t len )
+{
+    if( str == NULL || len == 0UL ) { return; }
+
+    // Only the end of the string can still be in the history afterwards
+    const char* history_src = str;
+    size_t history_len      = len;
+    if( history_len > AXK_CONSOLE_HISTORY_SIZE )
+    {
+        history_src     += history_len - AXK_CONSOLE_HISTORY_SIZE;
+        history_len     = AXK_CONSOLE_HISTORY_SIZE;
+    }
+
+    size_t pos      = (size_t)( ( g_history_total + ( len - history_len ) ) % AXK_CONSOLE_HISTORY_SIZE );
+    size_t first    = AXK_CONSOLE_HISTORY_SIZE - pos;
+    if( first > history_len ) { first = history_len; }
+
+    memcpy( g_history + pos, history_src, first );
+    memcpy( g_history, history_src + first, history_len - first );
+    g_history_total += len;
+
+    uint32_t count = axk_atomic_load_uint32_acquire( &g_sink_count );
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        g_sinks[ i ]->fn_write( g_sinks[ i ], str, len );
+    }
+}
+
+
+size_t axk_console_copy_history( char* out_buffer, size_t size )
+{
+    if( out_buffer == NULL || size == 0UL ) { return 0UL; }
+
+    size_t count = ( g_history_total < AXK_CONSOLE_HISTORY_SIZE ) ? (size_t)( g_history_total ) : AXK_CONSOLE_HISTORY_SIZE;
+    if( count > size ) { count = size; }
+
+    // Start 'count' bytes behind the write position
+    size_t pos      = (size_t)( ( g_history_total - count ) % AXK_CONSOLE_HISTORY_SIZE );
+    size_t first    = AXK_CONSOLE_HISTORY_SIZE - pos;
+    if( first > count ) { first = count; }
+
+    memcpy( out_buffer, g_history + pos, first );
+    memcpy( out_buffer + first, g_history, count - first );
+
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+/*==============================================================
+    Axon Kernel - Crash Records
+    2021, Zachary Berry
+    axon/source/kernel/crash.c
+==============================================================*/
+
+#include "axon/kernel/crash_private.h"
+#include "axon/kernel/ksyms.h"
+#include "axon/kernel/percpu.h"
+#include "axon/memory/page_allocator.h"
+#include "axon/gfx/basic_terminal.h"
+#include "axon/gfx/console_sink.h"
+
+#ifdef __x86_64__
+#include "axon/arch_x86/util.h"
+#endif
+
+_Static_assert( sizeof( struct axk_crash_record_t ) <= AXK_CRASH_RECORD_PAGES * AXK_PAGE_SIZE, "Crash record doesnt fit in the reserved pages" );
+
+/*
+    State
+*/
+static struct axk_crash_record_t* g_record  = NULL;
+static bool g_b_previous                    = false;
+
+
+/*
+    _checksum
+    * Private Function
+    * FNV-1a over everything after the checksum field
+*/
+static uint64_t _checksum( const struct axk_crash_record_t* record )
+{
+    const uint8_t* data = (const uint8_t*)( record );
+    uint64_t hash       = 0xCBF29CE484222325UL;
+
+    for( size_t i = offsetof( struct axk_crash_record_t, version ); i < sizeof( struct axk_crash_record_t ); i++ )
+    {
+        hash ^= (uint64_t)( data[ i ] );
+        hash *= 0x100000001B3UL;
+    }
+
+    return hash;
+}
+
+
+/*
+    _is_valid
+    * Private Function
+    * Checks if a record (that was just sitting in memory) can be trusted
+*/
+static bool _is_valid( const struct axk_crash_record_t* record )
+{
+    return( record->magic == AXK_CRASH_MAGIC &&
+        record->version == AXK_CRASH_VERSION &&
+        record->size == (uint32_t)( sizeof( struct axk_crash_record_t ) ) &&
+        record->frame_count <= AXK_CRASH_MAX_FRAMES &&
+        record->message_length <= AXK_CRASH_MESSAGE_LENGTH &&
+        record->log_length <= AXK_CRASH_LOG_LENGTH &&
+        record->checksum == _checksum( record ) );
+}
+
+
+/*
+    _add_frame
+    * Private Function
+    * Appends a return address to the record, along with the symbol it falls in
+*/
+static void _add_frame( struct axk_crash_record_t* record, uint64_t address )
+{
+    struct axk_crash_frame_t* frame = record->frames + record->frame_count++;
+    frame->address  = address;
+    frame->offset   = 0UL;
+
+    const char* symbol = axk_ksyms_lookup( address, &( frame->offset ) );
+    size_t len = 0UL;
+
+    if( symbol != NULL )
+    {
+        while( len < AXK_CRASH_SYMBOL_LENGTH - 1UL && symbol[ len ] != '\0' ) { len++; }
+        memcpy( frame->symbol, symbol, len );
+    }
+
+    frame->symbol[ len ] = '\0';
+}
+
+
+/*
+    _walk_stack
+    * Private Function
+    * Follows the frame pointer chain, each frame holds the callers frame pointer, followed by the return address
+    * Every frame pointer is checked before its read, since a corrupt stack is a likely reason for the panic. They have to be
+      aligned, above the last one, and within 'AXK_CRASH_STACK_SPAN' of the stack pointer
+*/
+static void _walk_stack( struct axk_crash_record_t* record, uint64_t rip, uint64_t rbp, uint64_t rsp )
+{
+    uint64_t image_begin    = axk_get_kernel_offset();
+    uint64_t image_end      = image_begin + axk_get_kernel_size();
+
+    record->frame_count = 0U;
+    _add_frame( record, rip );
+
+    uint64_t frame = rbp;
+    while( record->frame_count < AXK_CRASH_MAX_FRAMES )
+    {
+        if( ( frame & 0x07UL ) != 0UL || frame < rsp || frame - rsp >= AXK_CRASH_STACK_SPAN ) { break; }
+
+        const uint64_t* frame_data  = (const uint64_t*)( frame );
+        uint64_t next_frame         = frame_data[ 0 ];
+        uint64_t return_address     = frame_data[ 1 ];
+
+        // The outermost frame returns into the bootloader (or nowhere)
+        if( return_address < image_begin || return_address >= image_end ) { break; }
+        _add_frame( record, return_address );
+
+        if( next_frame <= frame ) { break; }
+        frame = next_frame;
+    }
+}
+
+
+void axk_crash_init( void )
+{
+    // Always the same address, so the next boot finds the record no matter what the memory map looks like
+    uint64_t record_addr = AXK_CRASH_RECORD_PHYSICAL;
+    uint64_t page_list[ AXK_CRASH_RECORD_PAGES ];
+
+    for( uint64_t i = 0; i < AXK_CRASH_RECORD_PAGES; i++ )
+    {
+        page_list[ i ] = ( record_addr / AXK_PAGE_SIZE ) + i;
+    }
+
+    if( !axk_page_lock( AXK_CRASH_RECORD_PAGES, page_list, AXK_PROCESS_KERNEL, AXK_PAGE_TYPE_OTHER, AXK_PAGE_FLAG_NONE ) )
+    {
+        axk_basicterminal_prints( "Crash Record: Failed to reserve pages for the crash record, panics wont be saved\n" );
+        return;
+    }
+
+    // The identity mappings are still in place, so the physical address can be used directly for now
+    g_record = (struct axk_crash_record_t*)( record_addr );
+    if( !_is_valid( g_record ) )
+    {
+        axk_basicterminal_printf( "Crash Record: Reserved at physical address 0x%016lX\n", record_addr );
+        return;
+    }
+
+    g_b_previous = true;
+    axk_basicterminal_printf( "Crash Record: The previous boot panicked on processor %u, called from 0x%016lX\nCrash Record: Message: %.*s\n",
+        g_record->cpu_index, g_record->trigger_address, (int)( g_record->message_length ), g_record->message );
+
+    for( uint32_t i = 0; i < g_record->frame_count; i++ )
+    {
+        struct axk_crash_frame_t* frame = g_record->frames + i;
+        axk_basicterminal_printf( "Crash Record:   #%u 0x%016lX %s+0x%lX\n", i, frame->address, frame->symbol[ 0 ] == '\0' ? "??" : frame->symbol, frame->offset );
+    }
+
+    // Still valid, but it shouldnt be reported again on the next boot
+    g_record->magic = AXK_CRASH_MAGIC_REPORTED;
+}
+
+
+void axk_crash_update_pointers( void )
+{
+    if( g_record != NULL && (uint64_t)( g_record ) < AXK_KERNEL_VA_PHYSICAL )
+    {
+        g_record = (struct axk_crash_record_t*)( (uint64_t)( g_record ) + AXK_KERNEL_VA_PHYSICAL );
+    }
+}
+
+
+const struct axk_crash_record_t* axk_crash_get_previous( void )
+{
+    return g_b_previous ? g_record : NULL;
+}
+
+
+__attribute__((noinline)) void axk_crash_begin( uint64_t trigger_address )
+{
+    struct axk_crash_record_t* record = g_record;
+    if( record == NULL ) { return; }
+
+    memset( record, 0, sizeof( struct axk_crash_record_t ) );
+    record->version         = AXK_CRASH_VERSION;
+    record->size            = (uint32_t)( sizeof( struct axk_crash_record_t ) );
+    record->trigger_address = trigger_address;
+    record->cpu_index       = axk_percpu_ready() ? axk_get_cpu_index() : 0U;
+
+#ifdef __x86_64__
+    record->timestamp = axk_x86_read_timestamp();
+
+    // This frame stays valid while the stack is walked, so the trace starts here
+    axk_x86_capture_registers( &( record->registers ) );
+    _walk_stack( record, record->registers.rip, record->registers.rbp, record->registers.rsp );
+#endif
+
+    record->log_length = (uint32_t)( axk_console_copy_history( record->log_tail, AXK_CRASH_LOG_LENGTH ) );
+}
+
+
+void axk_crash_message( const char* str, size_t len )
+{
+    struct axk_crash_record_t* record = g_record;
+    if( record == NULL || str == NULL ) { return; }
+
+    size_t room = AXK_CRASH_MESSAGE_LENGTH - record->message_length;
+    if( len > room ) { len = room; }
+
+    memcpy( record->message + record->message_length, str, len );
+    record->message_length += (uint32_t)( len );
+}
+
+
+void axk_crash_set_registers( const struct axk_crash_registers_t* regs )
+{
+    struct axk_crash_record_t* record = g_record;
+    if( record == NULL || regs == NULL ) { return; }
+
+    record->registers = *regs;
+    _walk_stack( record, regs->rip, regs->rbp, regs->rsp );
+}
+
+
+void axk_crash_end( void )
+{
+    struct axk_crash_record_t* record = g_record;
+    if( record == NULL ) { return; }
+
+    record->checksum    = _checksum( record );
+    record->magic       = AXK_CRASH_MAGIC;
+
+#ifdef __x86_64__
+    // A warm reset isnt guaranteed to write back the caches first
+    axk_x86_flush_caches();
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*==============================================================
+    Axon Kernel - Kernel Log
+    2021, Zachary Berry
+    axon/source/kernel/klog.c
+==============================================================*/
+
+#include "axon/kernel/klog_private.h"
+#include "axon/kernel/percpu.h"
+#include "axon/gfx/basic_terminal.h"
+#include "stdio.h"
+#include <stdarg.h>
+
+#ifdef __x86_64__
+#include "axon/arch_x86/util.h"
+#endif
+
+/*
+    State
+    * Messages are drawn immediately on any processor that hasnt loaded its data area yet (see 'axk_percpu_ready')
+*/
+static struct axk_atomic_flag_t g_drain_flag;
+
+/*
+    _render
+    * Private Function
+    * Formats a record with libk 'snprintf_captured' and prints it to the basic terminal, the caller must hold the terminal lock
+    * Output longer than 'BASIC_TERMINAL_PRINTF_MAX' characters is truncated, the same as 'axk_basicterminal_printf'
+*/
+static void _render( const struct axk_klog_record_t* record )
+{
+    char str_data[ BASIC_TERMINAL_PRINTF_MAX + 1 ];
+    snprintf_captured( str_data, sizeof( str_data ), record->fmt, record->args, AXK_KLOG_MAX_ARGS );
+    axk_basicterminal_prints( str_data );
+}
+
+
+/*
+    _drain_rings
+    * Private Function
+    * Draws the queued records from every ring, always picking the oldest record at the front of any ring
+*/
+static void _drain_rings( void )
+{
+    // Report dropped messages first, they were dropped because the ring was full of older messages
+    for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+    {
+        struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+        if( ptr_area == NULL ) { continue; }
+
+        uint64_t dropped = axk_atomic_exchg_uint64_relaxed( &( ptr_area->klog.dropped ), 0UL );
+        if( dropped > 0UL )
+        {
+            struct axk_klog_record_t notice;
+            notice.fmt          = "Kernel Log: %lu messages dropped on processor %lu, the ring was full\n";
+            notice.args[ 0 ]    = dropped;
+            notice.args[ 1 ]    = (uint64_t)( cpu );
+            _render( &notice );
+        }
+    }
+
+    while( true )
+    {
+        struct axk_klog_ring_t* oldest_ring         = NULL;
+        struct axk_klog_record_t* oldest_record     = NULL;
+        uint64_t oldest_tail                        = 0UL;
+
+        for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+        {
+            struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+            if( ptr_area == NULL ) { continue; }
+
+            // Only the drain moves the tail, so it can be read relaxed
+            // The acquire on 'seq' makes the rest of the record visible
+            struct axk_klog_ring_t* ring        = &( ptr_area->klog );
+            uint64_t tail                       = axk_atomic_load_uint64_relaxed( &( ring->tail ) );
+            struct axk_klog_record_t* record    = ring->records + ( tail % AXK_KLOG_RING_SIZE );
+
+            if( axk_atomic_load_uint64_acquire( &( record->seq ) ) != tail + 1UL ) { continue; }
+            if( oldest_record == NULL || record->timestamp < oldest_record->timestamp )
+            {
+                oldest_ring     = ring;
+                oldest_record   = record;
+                oldest_tail     = tail;
+            }
+        }
+
+        if( oldest_record == NULL ) { break; }
+        _render( oldest_record );
+
+        // Release, so we're done reading the record before a writer is allowed to reuse it
+        axk_atomic_store_uint64_release( &( oldest_ring->tail ), oldest_tail + 1UL );
+    }
+}
+
+
+void axk_klog_init_cpu( struct axk_percpu_t* ptr_area )
+{
+    struct axk_klog_ring_t* ring = &( ptr_area->klog );
+
+    axk_atomic_store_uint64_relaxed( &( ring->head ), 0UL );
+    axk_atomic_store_uint64_relaxed( &( ring->tail ), 0UL );
+    axk_atomic_store_uint64_relaxed( &( ring->dropped ), 0UL );
+
+    for( uint32_t i = 0; i < AXK_KLOG_RING_SIZE; i++ )
+    {
+        axk_atomic_store_uint64_relaxed( &( ring->records[ i ].seq ), 0UL );
+    }
+}
+
+
+void axk_klog( const char* fmt, ... )
+{
+    if( fmt == NULL ) { return; }
+
+    struct axk_klog_record_t local_record;
+    struct axk_klog_record_t* record    = &local_record;
+    struct axk_klog_ring_t* ring        = NULL;
+    uint64_t pos                        = 0UL;
+
+    if( axk_percpu_ready() )
+    {
+        // Reserve the next record, if we get moved to another processor part way through, we just write into its ring instead
+        // Acquire on the tail, so the drain is finished reading a record before we overwrite it
+        ring    = &( axk_percpu_self()->klog );
+        pos     = axk_atomic_load_uint64_relaxed( &( ring->head ) );
+
+        do
+        {
+            if( pos - axk_atomic_load_uint64_acquire( &( ring->tail ) ) >= AXK_KLOG_RING_SIZE )
+            {
+                axk_atomic_fetch_add_uint64_relaxed( &( ring->dropped ), 1UL );
+                return;
+            }
+
+        } while( !axk_atomic_cmpexchg_uint64_relaxed( &( ring->head ), &pos, pos + 1UL ) );
+
+        record = ring->records + ( pos % AXK_KLOG_RING_SIZE );
+    }
+
+    record->fmt = fmt;
+#ifdef __x86_64__
+    record->timestamp = axk_x86_read_timestamp();
+#else
+    record->timestamp = 0UL;
+#endif
+
+    // Capture the arguments, the format tells libk how large each one is, anything it didnt fill in is printed as zero
+    va_list arg_list;
+    va_start( arg_list, fmt );
+
+    size_t arg_count = vsnprintf_capture( fmt, arg_list, record->args, AXK_KLOG_MAX_ARGS );
+    for( size_t i = arg_count; i < AXK_KLOG_MAX_ARGS; i++ ) { record->args[ i ] = 0UL; }
+
+    va_end( arg_list );
+
+    if( ring == NULL )
+    {
+        // No data area yet, so just draw it right now
+        axk_basicterminal_lock();
+        _render( record );
+        axk_basicterminal_unlock();
+        return;
+    }
+
+    // Publish the record, release so the drain sees everything written above once it sees the sequence number
+    axk_atomic_store_uint64_release( &( record->seq ), pos + 1UL );
+}
+
+
+void axk_klog_drain( void )
+{
+    if( axk_percpu_get( 0U ) == NULL ) { return; }
+    if( axk_atomic_test_and_set_flag( &g_drain_flag, MEMORY_ORDER_ACQUIRE ) ) { return; }
+
+    axk_basicterminal_lock();
+    _drain_rings();
+    axk_basicterminal_unlock();
+
+    axk_atomic_clear_flag( &g_drain_flag, MEMORY_ORDER_RELEASE );
+}
+
+
+void axk_klog_panic_drain( void )
+{
+    if( axk_percpu_get( 0U ) == NULL ) { return; }
+    _drain_rings();
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*==============================================================
+    Axon Kernel - Kernel Symbol Table
+    2021, Zachary Berry
+    axon/source/kernel/ksyms.c
+==============================================================*/
+
+#include "axon/kernel/ksyms.h"
+
+/*
+    Linker Symbols
+    * The table is empty during the first link, so lookups just fail until the final image
+*/
+extern const struct axk_ksym_t axk_ksyms_begin[];
+extern const struct axk_ksym_t axk_ksyms_end[];
+extern const uint8_t axk_text_end[];
+
+
+const char* axk_ksyms_lookup( uint64_t address, uint64_t* out_offset )
+{
+    uint64_t count = (uint64_t)( axk_ksyms_end - axk_ksyms_begin );
+    if( count == 0UL || address < axk_ksyms_begin[ 0 ].address || address >= (uint64_t)( axk_text_end ) ) { return NULL; }
+
+    // Find the last symbol with an address at or below the target
+    uint64_t low    = 0UL;
+    uint64_t high   = count - 1UL;
+
+    while( low < high )
+    {
+        uint64_t mid = low + ( ( high - low + 1UL ) / 2UL );
+        if( axk_ksyms_begin[ mid ].address <= address )
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1UL;
+        }
+    }
+
+    if( out_offset != NULL ) { *out_offset = address - axk_ksyms_begin[ low ].address; }
+    return axk_ksyms_begin[ low ].name;
+}
\ No newline at end of file
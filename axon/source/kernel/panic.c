@@ -7,7 +7,11 @@
 #include "axon/kernel/panic.h"
 #include "axon/kernel/kernel.h"
 #include "axon/gfx/basic_terminal.h"
+#include "axon/kernel/klog_private.h"
+#include "axon/kernel/crash_private.h"
+#include "axon/gfx/console_sink.h"
 #include "axon/library/spinlock.h"
+#include "stdio.h"
 
 /*
     State
@@ -73,6 +77,17 @@ __attribute__((noinline)) void axk_panic_begin( void )
     // Call arch-specific function to stop all other processors
     //axk_panic_helper();
 
+    // Draw anything still sitting in the log rings before the panic screen takes over the terminal
+    axk_klog_panic_drain();
+
+    // Start the crash record while the console history still ends with the log, before the panic text is added to it
+    axk_crash_begin( ret_addr );
+
+    // The sinks only get text, so they get a short header in place of the panic screen
+    char str_sink_header[ 96 ];
+    int sink_header_len = snprintf( str_sink_header, sizeof( str_sink_header ), "\n*** Axon Kernel Panic ***\nTriggered from: 0x%016lX\nMessage: ", ret_addr );
+    axk_console_write( str_sink_header, (size_t)( sink_header_len ) );
+
     // Switch the terminal over to graphics mode
     axk_basicterminal_set_mode( BASIC_TERMINAL_MODE_GRAPHICS );
 
@@ -185,7 +200,13 @@ void _panic_print_newline( void )
 void axk_panic_prints( const char* str )
 {
     // Ensure we are in an actual panic state before writing to the screen
-    if( !b_panicing || message_x == 0U || message_y == 0U || message_w == 0U || message_h == 0U ) { return; }
+    if( !b_panicing || str == NULL ) { return; }
+
+    size_t len = strlen( str );
+    axk_console_write( str, len );
+    axk_crash_message( str, len );
+
+    if( message_x == 0U || message_y == 0U || message_w == 0U || message_h == 0U ) { return; }
 
     // We are going to loop through the string, word by word, and print within the provided box
     size_t start_word   = 0UL;
@@ -359,10 +380,13 @@ void axk_panic_printh( uint64_t num, bool b_leading_zeros )
 void axk_panic_set_pstate( void* pstate )
 {
     ptr_pstate = pstate;
+    if( b_panicing ) { axk_crash_set_registers( (const struct axk_crash_registers_t*)( pstate ) ); }
 }
 
 
 __attribute__((noreturn)) void axk_panic_end( void )
 {
+    axk_console_write( "\n", 1UL );
+    axk_crash_end();
     axk_halt();
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*==============================================================
+    Axon Kernel - Per-CPU Data
+    2021, Zachary Berry
+    axon/source/kernel/percpu.c
+==============================================================*/
+
+#include "axon/kernel/percpu.h"
+#include "axon/kernel/rcu_private.h"
+#include "axon/kernel/klog_private.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/library/atomic.h"
+
+#ifdef __x86_64__
+#include "axon/arch_x86/util.h"
+#endif
+
+/*
+    State
+*/
+static struct axk_percpu_t g_bsp_area;
+static struct axk_atomic_pointer_t g_areas[ AXK_MAX_CPUS ];
+
+
+/*
+    _load_area
+    * Private Function
+    * Points the current processor's GS base at a data area
+*/
+static void _load_area( struct axk_percpu_t* ptr_area )
+{
+    axk_rcu_init_cpu( ptr_area );
+    axk_klog_init_cpu( ptr_area );
+
+#ifdef __x86_64__
+    // Until there is a user-mode, 'swapgs' should never be executed, but both are loaded so it would be harmless
+    axk_x86_write_msr( AXK_X86_MSR_GS_BASE, (uint64_t) ptr_area );
+    axk_x86_write_msr( AXK_X86_MSR_KERNEL_GS_BASE, (uint64_t) ptr_area );
+#endif
+
+    // Release, so a processor that finds this area in the table also sees it initialized
+    axk_atomic_store_pointer_release( g_areas + ptr_area->cpu_index, (void*) ptr_area );
+}
+
+
+void axk_percpu_init_bsp( void )
+{
+    AXK_ZERO_MEM( g_bsp_area );
+    g_bsp_area.self         = &g_bsp_area;
+    g_bsp_area.cpu_index    = 0U;
+
+#ifdef __x86_64__
+    uint32_t eax = 0x01U, ebx = 0U, ecx = 0U, edx = 0U;
+    axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+    g_bsp_area.apic_id = ( ebx >> 24 ) & 0xFFU;
+#endif
+
+    _load_area( &g_bsp_area );
+}
+
+
+bool axk_percpu_init_ap( uint32_t cpu_index, uint32_t apic_id )
+{
+    if( cpu_index == 0U || cpu_index >= AXK_MAX_CPUS ) { return false; }
+    if( axk_percpu_get( cpu_index ) != NULL ) { return false; }
+
+    // Areas come straight from the kernel heap region, so they start zeroed and page (so also cache line) aligned
+    uint64_t addr = 0UL;
+    if( !axk_va_alloc( AXK_VA_REGION_HEAP, sizeof( struct axk_percpu_t ), 0UL, AXK_VA_FLAG_CLEAR, &addr ) ) { return false; }
+
+    struct axk_percpu_t* ptr_area = (struct axk_percpu_t*) addr;
+    ptr_area->self          = ptr_area;
+    ptr_area->cpu_index     = cpu_index;
+    ptr_area->apic_id       = apic_id;
+
+    _load_area( ptr_area );
+    return true;
+}
+
+
+struct axk_percpu_t* axk_percpu_get( uint32_t cpu_index )
+{
+    if( cpu_index >= AXK_MAX_CPUS ) { return NULL; }
+    return (struct axk_percpu_t*) axk_atomic_load_pointer_acquire( g_areas + cpu_index );
+}
+
+
+bool axk_percpu_ready( void )
+{
+    // Nothing is published until the bootstrap processor's GS base is loaded, so this skips the MSR read that early in boot
+    if( axk_percpu_get( 0U ) == NULL ) { return false; }
+
+#ifdef __x86_64__
+    // Application processors start with a zero GS base, and it stays zero until '_load_area' writes it
+    return( axk_x86_read_msr( AXK_X86_MSR_GS_BASE ) != 0UL );
+#else
+    return true;
+#endif
+}
+
+
+uint32_t axk_get_cpu_index( void )
+{
+    return AXK_PERCPU_READ( cpu_index );
+}
\ No newline at end of file
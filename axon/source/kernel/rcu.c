@@ -0,0 +1,107 @@
+/*==============================================================
+    Axon Kernel - Read-Copy-Update
+    2021, Zachary Berry
+    axon/source/kernel/rcu.c
+==============================================================*/
+
+#include "axon/kernel/rcu_private.h"
+#include "axon/kernel/percpu.h"
+#include "axon/library/spinlock.h"
+
+/*
+    State
+    * 'g_period' is the most recently started grace period, each processor stores the last period it observed while quiescent in its
+      data area, so a period has ended once every processor has stored a value at least as large
+*/
+static struct axk_atomic_uint64_t g_period;
+
+
+void axk_rcu_init_cpu( struct axk_percpu_t* ptr_area )
+{
+    axk_atomic_store_uint64_relaxed( &( ptr_area->rcu_quiescent ), axk_atomic_load_uint64_acquire( &g_period ) );
+    ptr_area->rcu_pending_head  = NULL;
+    ptr_area->rcu_pending_tail  = NULL;
+}
+
+/*
+    _completed_period
+    * Private Function
+    * Finds the newest grace period that every processor has passed through
+*/
+static uint64_t _completed_period( void )
+{
+    uint64_t completed = UINT64_MAX;
+    for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+    {
+        struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+        if( ptr_area == NULL ) { continue; }
+
+        uint64_t observed = axk_atomic_load_uint64_acquire( &( ptr_area->rcu_quiescent ) );
+        if( observed < completed ) { completed = observed; }
+    }
+
+    return completed;
+}
+
+
+void axk_rcu_quiescent( void )
+{
+    // Release, so every read this processor made from a read-side section happens before the writer sees this period as passed
+    struct axk_percpu_t* ptr_area = axk_percpu_self();
+    axk_atomic_store_uint64_release( &( ptr_area->rcu_quiescent ), axk_atomic_load_uint64_acquire( &g_period ) );
+
+    // Callbacks are queued in order of period, so we only need to check from the front until we find one that hasnt ended
+    if( ptr_area->rcu_pending_head == NULL ) { return; }
+    uint64_t completed = _completed_period();
+
+    while( true )
+    {
+        // The list is also modified by 'axk_rcu_call', which can run from an interrupt
+        uint64_t rflags = axk_interrupts_disable();
+        struct axk_rcu_head_t* ptr_head = ptr_area->rcu_pending_head;
+        if( ptr_head == NULL || ptr_head->period > completed )
+        {
+            axk_interrupts_restore( rflags );
+            break;
+        }
+
+        ptr_area->rcu_pending_head = ptr_head->next;
+        if( ptr_area->rcu_pending_head == NULL ) { ptr_area->rcu_pending_tail = NULL; }
+        axk_interrupts_restore( rflags );
+
+        ptr_head->fn_callback( ptr_head );
+    }
+}
+
+
+void axk_rcu_synchronize( void )
+{
+    // Start a new grace period, this is sequentially consistent so it cant be reordered with the caller unpublishing the old version
+    uint64_t target = axk_atomic_fetch_add_uint64_seq_cst( &g_period, 1UL ) + 1UL;
+
+    // The calling processor isnt in a read-side section, so it can report itself right away
+    axk_rcu_quiescent();
+
+    while( _completed_period() < target )
+    {
+        axk_spin_pause();
+    }
+}
+
+
+void axk_rcu_call( struct axk_rcu_head_t* head, void( *fn_callback )( struct axk_rcu_head_t* ) )
+{
+    head->next          = NULL;
+    head->fn_callback   = fn_callback;
+
+    // The period is taken with interrupts disabled, so the list stays sorted even if an interrupt handler queues a callback as well
+    uint64_t rflags = axk_interrupts_disable();
+    struct axk_percpu_t* ptr_area = axk_percpu_self();
+    head->period = axk_atomic_fetch_add_uint64_seq_cst( &g_period, 1UL ) + 1UL;
+
+    if( ptr_area->rcu_pending_tail == NULL ) { ptr_area->rcu_pending_head = head; }
+    else { ptr_area->rcu_pending_tail->next = head; }
+    ptr_area->rcu_pending_tail = head;
+
+    axk_interrupts_restore( rflags );
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+/*==============================================================
+    Axon Kernel - Boot Trace
+    2021, Zachary Berry
+    axon/source/kernel/trace.c
+==============================================================*/
+
+#include "axon/kernel/trace.h"
+
+#ifdef AXK_BOOT_TRACE
+#include "axon/kernel/percpu.h"
+#include "axon/library/atomic.h"
+#include "axon/gfx/basic_terminal.h"
+#include "axon/arch_x86/util.h"
+
+
+/*
+    Buffer Structures
+    * Each processor only writes to its own buffer, slots are reserved with an atomic add so an interrupt on the same processor
+      cant take the same slot, then 'event' is released once the rest of the slot is written
+    * 'count' keeps going up once the buffer is full, anything past the end of the buffer was dropped
+*/
+struct axk_trace_event_t
+{
+    uint64_t timestamp;
+    struct axk_atomic_uint32_t event;
+    uint32_t cpu_index;
+    uint64_t arg[ 2 ];
+};
+
+struct axk_trace_buffer_t
+{
+    struct axk_atomic_uint32_t count;
+    struct axk_trace_event_t events[ AXK_TRACE_BUFFER_EVENTS ];
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+/*
+    State
+    * Static, so tracing works before there is any memory allocation (or even per-cpu data)
+*/
+static struct axk_trace_buffer_t g_buffers[ AXK_MAX_CPUS ];
+
+static const char* g_event_names[ AXK_TRACE_EVENT_COUNT ] =
+{
+    "none",
+    "entry",
+    "terminal",
+    "panic",
+    "uart",
+    "handoff",
+    "cpu_features",
+    "percpu",
+    "counters",
+    "page_allocator",
+    "crash",
+    "kmap",
+    "va_allocator",
+    "kheap",
+    "shadow"
+};
+
+
+void axk_trace( uint32_t event, uint64_t arg_0, uint64_t arg_1 )
+{
+    uint64_t timestamp  = axk_x86_read_timestamp();
+    uint32_t cpu_index  = axk_percpu_ready() ? axk_get_cpu_index() : 0U;
+
+    struct axk_trace_buffer_t* buffer = g_buffers + cpu_index;
+    uint32_t index = axk_atomic_fetch_add_uint32_relaxed( &( buffer->count ), 1U );
+
+    if( index >= AXK_TRACE_BUFFER_EVENTS ) { return; }
+
+    struct axk_trace_event_t* slot = buffer->events + index;
+    slot->timestamp = timestamp;
+    slot->cpu_index = cpu_index;
+    slot->arg[ 0 ]  = arg_0;
+    slot->arg[ 1 ]  = arg_1;
+
+    axk_atomic_store_uint32_release( &( slot->event ), event );
+}
+
+
+void axk_trace_print_timeline( void )
+{
+    // Merge the buffers by timestamp, each buffer is already in order
+    uint32_t cursors[ AXK_MAX_CPUS ];
+    uint32_t counts[ AXK_MAX_CPUS ];
+    uint32_t total      = 0U;
+    uint32_t dropped    = 0U;
+
+    for( uint32_t i = 0; i < AXK_MAX_CPUS; i++ )
+    {
+        uint32_t count = axk_atomic_load_uint32_relaxed( &( g_buffers[ i ].count ) );
+
+        cursors[ i ]    = 0U;
+        counts[ i ]     = ( count > AXK_TRACE_BUFFER_EVENTS ) ? AXK_TRACE_BUFFER_EVENTS : count;
+        total           += counts[ i ];
+        dropped         += count - counts[ i ];
+    }
+
+    axk_basicterminal_printf( "Boot Trace: %u events (%u dropped), columns are cpu, cycles since the first event, cycles since the last event, event, args\n", total, dropped );
+
+    uint64_t first_timestamp    = 0UL;
+    uint64_t last_timestamp     = 0UL;
+    bool b_first                = true;
+
+    while( true )
+    {
+        struct axk_trace_event_t* next = NULL;
+        uint32_t next_cpu = 0U;
+
+        for( uint32_t i = 0; i < AXK_MAX_CPUS; i++ )
+        {
+            if( cursors[ i ] >= counts[ i ] ) { continue; }
+
+            struct axk_trace_event_t* candidate = g_buffers[ i ].events + cursors[ i ];
+            if( next == NULL || candidate->timestamp < next->timestamp )
+            {
+                next        = candidate;
+                next_cpu    = i;
+            }
+        }
+
+        if( next == NULL ) { break; }
+        cursors[ next_cpu ]++;
+
+        // The slot was reserved, but the event isnt finished yet
+        uint32_t event = axk_atomic_load_uint32_acquire( &( next->event ) );
+        if( event == AXK_TRACE_NONE ) { continue; }
+
+        if( b_first )
+        {
+            first_timestamp = next->timestamp;
+            last_timestamp  = next->timestamp;
+            b_first         = false;
+        }
+
+        axk_basicterminal_printf( "Boot Trace: %2u %14lu +%12lu %-16s 0x%lX 0x%lX\n", next->cpu_index, next->timestamp - first_timestamp,
+            next->timestamp - last_timestamp, event < AXK_TRACE_EVENT_COUNT ? g_event_names[ event ] : "unknown", next->arg[ 0 ], next->arg[ 1 ] );
+
+        last_timestamp = next->timestamp;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*==============================================================
+    Axon Kernel - Lock Contention Profiler
+    2021, Zachary Berry
+    axon/source/library/lock_profile.c
+==============================================================*/
+
+#include "axon/library/lock_profile.h"
+
+#ifdef AXK_LOCK_PROFILE
+#include "axon/library/atomic.h"
+#include "axon/gfx/basic_terminal.h"
+#include "axon/arch_x86/util.h"
+
+
+/*
+    Site Structure
+    * The table is updated from inside the lock functions, so it cant use any locks itself
+*/
+struct axk_lock_site_t
+{
+    struct axk_atomic_pointer_t site;
+    struct axk_atomic_uint64_t acquisitions;
+    struct axk_atomic_uint64_t contended;
+    struct axk_atomic_uint64_t spin_cycles;
+    struct axk_atomic_uint64_t max_hold_cycles;
+};
+
+/*
+    State
+*/
+static struct axk_lock_site_t g_sites[ AXK_LOCK_PROFILE_MAX_SITES ];
+static struct axk_atomic_uint64_t g_dropped;
+
+
+static struct axk_lock_site_t* _find_site( void* site, bool b_insert )
+{
+    // Open addressing, the low bits of a return address dont tell us much so drop them before hashing
+    uint32_t index = (uint32_t)( ( ( (uint64_t)( site ) >> 2 ) * 0x9E3779B97F4A7C15UL ) >> 56 ) % AXK_LOCK_PROFILE_MAX_SITES;
+
+    for( uint32_t i = 0; i < AXK_LOCK_PROFILE_MAX_SITES; i++ )
+    {
+        struct axk_lock_site_t* entry = g_sites + ( ( index + i ) % AXK_LOCK_PROFILE_MAX_SITES );
+        void* existing = axk_atomic_load_pointer_acquire( &( entry->site ) );
+
+        if( existing == site ) { return entry; }
+        if( existing == NULL )
+        {
+            if( !b_insert ) { return NULL; }
+
+            // Try and claim this slot, if we lose the race check what the winner put here
+            if( axk_atomic_cmpexchg_pointer_acq_rel( &( entry->site ), &existing, site ) || existing == site )
+            {
+                return entry;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+uint64_t axk_lock_profile_timestamp( void )
+{
+    return axk_x86_read_timestamp();
+}
+
+
+void axk_lock_profile_record( void* site, uint64_t spin_cycles, uint64_t hold_cycles, bool b_contended )
+{
+    struct axk_lock_site_t* entry = _find_site( site, true );
+    if( entry == NULL )
+    {
+        axk_atomic_fetch_add_uint64_relaxed( &g_dropped, 1UL );
+        return;
+    }
+
+    // These are just statistics, nothing is ordered against them
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->acquisitions ), 1UL );
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->spin_cycles ), spin_cycles );
+    if( b_contended ) { axk_atomic_fetch_add_uint64_relaxed( &( entry->contended ), 1UL ); }
+
+    uint64_t max_hold = axk_atomic_load_uint64_relaxed( &( entry->max_hold_cycles ) );
+    while( hold_cycles > max_hold )
+    {
+        if( axk_atomic_cmpexchg_uint64_relaxed( &( entry->max_hold_cycles ), &max_hold, hold_cycles ) ) { break; }
+    }
+}
+
+
+bool axk_lock_profile_get_site( void* site, struct axk_lock_stats_t* out_stats )
+{
+    struct axk_lock_site_t* entry = _find_site( site, false );
+    if( entry == NULL || out_stats == NULL ) { return false; }
+
+    out_stats->acquisitions     = axk_atomic_load_uint64_relaxed( &( entry->acquisitions ) );
+    out_stats->contended        = axk_atomic_load_uint64_relaxed( &( entry->contended ) );
+    out_stats->spin_cycles      = axk_atomic_load_uint64_relaxed( &( entry->spin_cycles ) );
+    out_stats->max_hold_cycles  = axk_atomic_load_uint64_relaxed( &( entry->max_hold_cycles ) );
+
+    return true;
+}
+
+
+void axk_lock_profile_dump( uint32_t count )
+{
+    if( count > AXK_LOCK_PROFILE_MAX_REPORT ) { count = AXK_LOCK_PROFILE_MAX_REPORT; }
+
+    // Select the top sites by spin cycles first, printing acquires the terminal lock which adds its own entry to the table
+    uint32_t top[ AXK_LOCK_PROFILE_MAX_REPORT ];
+    uint32_t top_count = 0U;
+
+    while( top_count < count )
+    {
+        uint64_t best_cycles    = 0UL;
+        uint32_t best_index     = AXK_LOCK_PROFILE_MAX_SITES;
+
+        for( uint32_t i = 0; i < AXK_LOCK_PROFILE_MAX_SITES; i++ )
+        {
+            if( axk_atomic_load_pointer_acquire( &( g_sites[ i ].site ) ) == NULL ) { continue; }
+
+            // Skip sites we already picked
+            bool b_picked = false;
+            for( uint32_t j = 0; j < top_count; j++ ) { if( top[ j ] == i ) { b_picked = true; break; } }
+            if( b_picked ) { continue; }
+
+            uint64_t cycles = axk_atomic_load_uint64_relaxed( &( g_sites[ i ].spin_cycles ) );
+            if( best_index == AXK_LOCK_PROFILE_MAX_SITES || cycles > best_cycles )
+            {
+                best_cycles = cycles;
+                best_index  = i;
+            }
+        }
+
+        if( best_index == AXK_LOCK_PROFILE_MAX_SITES ) { break; }
+        top[ top_count++ ] = best_index;
+    }
+
+    axk_basicterminal_lock();
+    axk_basicterminal_prints( "Lock Profile: Top " );
+    axk_basicterminal_printu32( top_count );
+    axk_basicterminal_prints( " call sites by spin time (Dropped Records: " );
+    axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &g_dropped ) );
+    axk_basicterminal_prints( ")\n" );
+
+    for( uint32_t i = 0; i < top_count; i++ )
+    {
+        struct axk_lock_site_t* entry = g_sites + top[ i ];
+
+        axk_basicterminal_prints( "\t" );
+        axk_basicterminal_printh64( (uint64_t)( axk_atomic_load_pointer_relaxed( &( entry->site ) ) ), true );
+        axk_basicterminal_prints( "  Acquired: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->acquisitions ) ) );
+        axk_basicterminal_prints( "  Contended: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->contended ) ) );
+        axk_basicterminal_prints( "  Spin Cycles: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->spin_cycles ) ) );
+        axk_basicterminal_prints( "  Max Hold Cycles: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->max_hold_cycles ) ) );
+        axk_basicterminal_printnl();
+    }
+
+    axk_basicterminal_unlock();
+}
+
+
+void axk_lock_profile_reset( void )
+{
+    // Only the counters are cleared, clearing the keys could break the probe chains of sites being recorded right now
+    for( uint32_t i = 0; i < AXK_LOCK_PROFILE_MAX_SITES; i++ )
+    {
+        axk_atomic_store_uint64_relaxed( &( g_sites[ i ].acquisitions ), 0UL );
+        axk_atomic_store_uint64_relaxed( &( g_sites[ i ].contended ), 0UL );
+        axk_atomic_store_uint64_relaxed( &( g_sites[ i ].spin_cycles ), 0UL );
+        axk_atomic_store_uint64_relaxed( &( g_sites[ i ].max_hold_cycles ), 0UL );
+    }
+
+    axk_atomic_store_uint64_relaxed( &g_dropped, 0UL );
+}
+
+#endif
\ No newline at end of file
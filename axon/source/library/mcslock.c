@@ -0,0 +1,112 @@
+/*==============================================================
+    Axon Kernel - MCS Queue Lock Implementation
+    2021, Zachary Berry
+    axon/source/library/mcslock.c
+==============================================================*/
+
+#include "axon/library/mcslock.h"
+
+
+void axk_mcslock_init( struct axk_mcslock_t* lock )
+{
+    axk_atomic_store_pointer_release( &( lock->tail ), NULL );
+}
+
+/*
+    _acquire
+    * Private Function
+    * Shared by both acquire functions, inlined so 'axk_mcslock_acquire' doesnt pay for an extra call
+*/
+static inline __attribute__((always_inline)) void _acquire( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node, void* site )
+{
+    // Disable interrupts and get a copy of RFLAGS
+    uint64_t rflags = axk_interrupts_disable();
+
+    #ifdef AXK_LOCK_PROFILE
+    uint64_t spin_begin = axk_lock_profile_timestamp();
+    #endif
+
+    axk_atomic_store_pointer_relaxed( &( node->next ), NULL );
+    axk_atomic_store_bool_relaxed( &( node->locked ), true );
+
+    // Add ourself to the end of the queue, if there was nobody in front of us, we own the lock
+    struct axk_mcslock_node_t* prev = (struct axk_mcslock_node_t*) axk_atomic_exchg_pointer_acq_rel( &( lock->tail ), node );
+    if( prev != NULL )
+    {
+        // Link behind the previous node, and wait for it to hand the lock over to us
+        axk_atomic_store_pointer_release( &( prev->next ), node );
+        while( axk_atomic_load_bool_acquire( &( node->locked ) ) )
+        {
+            axk_spin_pause();
+        }
+    }
+
+    // Store RFLAGS in the node
+    node->rflags = rflags;
+
+    #ifdef AXK_LOCK_PROFILE
+    node->hold_site         = site;
+    node->hold_begin        = axk_lock_profile_timestamp();
+    node->hold_spin_cycles  = node->hold_begin - spin_begin;
+    node->hold_contended    = ( prev != NULL );
+    #else
+    (void)( site );
+    #endif
+}
+
+void axk_mcslock_acquire( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node )
+{
+    _acquire( lock, node, __builtin_return_address( 0 ) );
+}
+
+void axk_mcslock_acquire_at( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node, void* site )
+{
+    _acquire( lock, node, site );
+}
+
+void axk_mcslock_release( struct axk_mcslock_t* lock, struct axk_mcslock_node_t* node )
+{
+    // Read back the old RFLAGS into a local
+    uint64_t rflags = node->rflags;
+
+    #ifdef AXK_LOCK_PROFILE
+    // The node belongs to the caller, so its still valid after the lock is handed off, we record the stats afterwards
+    uint64_t hold_cycles = axk_lock_profile_timestamp() - node->hold_begin;
+    #endif
+
+    struct axk_mcslock_node_t* next = (struct axk_mcslock_node_t*) axk_atomic_load_pointer_acquire( &( node->next ) );
+    if( next == NULL )
+    {
+        // If were still the tail, nobody is waiting and we can just clear the lock
+        void* expected = (void*) node;
+        if( axk_atomic_cmpexchg_pointer_release( &( lock->tail ), &expected, NULL ) )
+        {
+            #ifdef AXK_LOCK_PROFILE
+            axk_lock_profile_record( node->hold_site, node->hold_spin_cycles, hold_cycles, node->hold_contended );
+            #endif
+
+            axk_interrupts_restore( rflags );
+            return;
+        }
+
+        // Another processor swapped itself in as the tail, but hasnt linked itself to us yet
+        while( ( next = (struct axk_mcslock_node_t*) axk_atomic_load_pointer_acquire( &( node->next ) ) ) == NULL )
+        {
+            axk_spin_pause();
+        }
+    }
+
+    axk_atomic_store_bool_release( &( next->locked ), false );
+
+    #ifdef AXK_LOCK_PROFILE
+    axk_lock_profile_record( node->hold_site, node->hold_spin_cycles, hold_cycles, node->hold_contended );
+    #endif
+
+    // Restore previous interrupt state
+    axk_interrupts_restore( rflags );
+}
+
+bool axk_mcslock_is_locked( struct axk_mcslock_t* lock )
+{
+    return( axk_atomic_load_pointer_acquire( &( lock->tail ) ) != NULL );
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*==============================================================
+    Axon Kernel - Reader-Writer Lock Implementation
+    2021, Zachary Berry
+    axon/source/library/rwlock.c
+==============================================================*/
+
+#include "axon/library/rwlock.h"
+#include "axon/kernel/percpu.h"
+
+_Static_assert( AXK_RWLOCK_PERCPU_SLOTS == 64U, "The reader count slots are tracked with a single 64-bit mask" );
+
+/*
+    State
+    * Bit N of 'g_used_slots' is set while a lock owns slot N of 'rwlock_readers' in every per-cpu data area
+*/
+static struct axk_atomic_uint64_t g_used_slots;
+
+
+/*
+    _take_slot
+    * Private Function
+    * Claims a free reader count slot, returns 'AXK_RWLOCK_NO_SLOT' if the per-cpu data areas dont exist yet, or every slot is in use
+    * A slot is only returned once every count in it is back to zero, so the new owner starts from zero as well
+*/
+static uint32_t _take_slot( void )
+{
+    if( axk_percpu_get( 0U ) == NULL ) { return AXK_RWLOCK_NO_SLOT; }
+
+    uint64_t used = axk_atomic_load_uint64_relaxed( &g_used_slots );
+    while( used != UINT64_MAX )
+    {
+        uint32_t slot = (uint32_t) __builtin_ctzl( ~used );
+        if( axk_atomic_cmpexchg_uint64_acq_rel( &g_used_slots, &used, used | ( 1UL << slot ) ) )
+        {
+            return slot;
+        }
+    }
+
+    return AXK_RWLOCK_NO_SLOT;
+}
+
+
+/*
+    _reader_count
+    * Private Function
+    * Gets the count a reader on this processor registers in, the caller must have interrupts disabled
+*/
+static inline struct axk_atomic_uint32_t* _reader_count( struct axk_rwlock_t* lock )
+{
+    return( lock->slot == AXK_RWLOCK_NO_SLOT ? &( lock->readers ) : axk_percpu_self()->rwlock_readers + lock->slot );
+}
+
+
+/*
+    _count_readers
+    * Private Function
+    * Adds up the reader counts from every processor, these loads pair with the reader registering and then checking 'writers'
+*/
+static uint32_t _count_readers( struct axk_rwlock_t* lock )
+{
+    if( lock->slot == AXK_RWLOCK_NO_SLOT ) { return axk_atomic_load_uint32_seq_cst( &( lock->readers ) ); }
+
+    uint32_t total = 0U;
+    for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+    {
+        struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+        if( ptr_area == NULL ) { continue; }
+
+        total += axk_atomic_load_uint32_seq_cst( ptr_area->rwlock_readers + lock->slot );
+    }
+
+    return total;
+}
+
+
+void axk_rwlock_init( struct axk_rwlock_t* lock )
+{
+    axk_spinlock_init( &( lock->writer_lock ) );
+    axk_atomic_store_uint32_relaxed( &( lock->readers ), 0U );
+    lock->slot = _take_slot();
+    axk_atomic_store_uint32_release( &( lock->writers ), 0U );
+}
+
+void axk_rwlock_destroy( struct axk_rwlock_t* lock )
+{
+    if( lock->slot == AXK_RWLOCK_NO_SLOT ) { return; }
+
+    axk_atomic_fetch_and_uint64_release( &g_used_slots, ~( 1UL << lock->slot ) );
+    lock->slot = AXK_RWLOCK_NO_SLOT;
+}
+
+uint64_t axk_rwlock_acquire_read( struct axk_rwlock_t* lock )
+{
+    return axk_rwlock_acquire_read_at( lock, __builtin_return_address( 0 ) );
+}
+
+uint64_t axk_rwlock_acquire_read_at( struct axk_rwlock_t* lock, void* site )
+{
+    // Interrupts stay disabled until the matching release, so the reader cant move to another processor and always decrements the count it incremented
+    uint64_t rflags = axk_interrupts_disable();
+    struct axk_atomic_uint32_t* count = _reader_count( lock );
+
+    #ifdef AXK_LOCK_PROFILE
+    uint64_t spin_begin = axk_lock_profile_timestamp();
+    bool b_contended    = false;
+    #else
+    (void)( site );
+    #endif
+
+    while( true )
+    {
+        // Wait for any active or waiting writers first, so we dont bounce the reader count around while they hold the lock
+        while( axk_atomic_load_uint32_relaxed( &( lock->writers ) ) != 0U )
+        {
+            #ifdef AXK_LOCK_PROFILE
+            b_contended = true;
+            #endif
+
+            axk_spin_pause();
+        }
+
+        // Register as a reader, and then check again in case a writer showed up in between
+        // Both of these need to be sequentially consistent, pairing with the writer incrementing 'writers' and then reading the counts
+        axk_atomic_fetch_add_uint32_seq_cst( count, 1U );
+        if( axk_atomic_load_uint32_seq_cst( &( lock->writers ) ) == 0U )
+        {
+            break;
+        }
+
+        axk_atomic_fetch_sub_uint32_release( count, 1U );
+    }
+
+    #ifdef AXK_LOCK_PROFILE
+    // There is nowhere to keep a hold start time for each reader, so readers are recorded with a hold time of zero
+    axk_lock_profile_record( site, axk_lock_profile_timestamp() - spin_begin, 0UL, b_contended );
+    #endif
+
+    return rflags;
+}
+
+void axk_rwlock_release_read( struct axk_rwlock_t* lock, uint64_t rflags )
+{
+    axk_atomic_fetch_sub_uint32_release( _reader_count( lock ), 1U );
+    axk_interrupts_restore( rflags );
+}
+
+void axk_rwlock_acquire_write( struct axk_rwlock_t* lock )
+{
+    axk_rwlock_acquire_write_at( lock, __builtin_return_address( 0 ) );
+}
+
+void axk_rwlock_acquire_write_at( struct axk_rwlock_t* lock, void* site )
+{
+    // Interrupts have to be off before we announce ourself, otherwise a reader in an interrupt handler on this processor would spin forever
+    uint64_t rflags = axk_interrupts_disable();
+
+    axk_atomic_fetch_add_uint32_seq_cst( &( lock->writers ), 1U );
+
+    #ifdef AXK_LOCK_PROFILE
+    uint64_t drain_begin    = axk_lock_profile_timestamp();
+    bool b_drain_contended  = false;
+    #endif
+
+    // Wait for the readers that got in before us to drain out, no new reader can get in while 'writers' is non-zero, so this
+    // doesnt need the writer lock, and any writer ahead of us has already waited for the same readers
+    while( _count_readers( lock ) != 0U )
+    {
+        #ifdef AXK_LOCK_PROFILE
+        b_drain_contended = true;
+        #endif
+
+        axk_spin_pause();
+    }
+
+    // The writer lock profiles the drain as part of its own spin time
+    #ifdef AXK_LOCK_PROFILE
+    axk_spinlock_acquire_waited_at( &( lock->writer_lock ), site, drain_begin, b_drain_contended );
+    #else
+    axk_spinlock_acquire_at( &( lock->writer_lock ), site );
+    #endif
+
+    lock->rflags = rflags;
+}
+
+void axk_rwlock_release_write( struct axk_rwlock_t* lock )
+{
+    uint64_t rflags = lock->rflags;
+
+    axk_spinlock_release( &( lock->writer_lock ) );
+    axk_atomic_fetch_sub_uint32_release( &( lock->writers ), 1U );
+
+    axk_interrupts_restore( rflags );
+}
\ No newline at end of file
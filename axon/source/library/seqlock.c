@@ -0,0 +1,52 @@
+/*==============================================================
+    Axon Kernel - Sequence Lock Implementation
+    2021, Zachary Berry
+    axon/source/library/seqlock.c
+==============================================================*/
+
+#include "axon/library/seqlock.h"
+
+
+void axk_seqlock_init( struct axk_seqlock_t* lock )
+{
+    axk_spinlock_init( &( lock->writer_lock ) );
+    axk_atomic_store_uint32_release( &( lock->sequence ), 0U );
+}
+
+uint32_t axk_seqlock_read_begin( struct axk_seqlock_t* lock )
+{
+    // An odd sequence means a writer is in the middle of an update
+    uint32_t sequence = axk_atomic_load_uint32_acquire( &( lock->sequence ) );
+    while( ( sequence & 1U ) != 0U )
+    {
+        axk_spin_pause();
+        sequence = axk_atomic_load_uint32_acquire( &( lock->sequence ) );
+    }
+
+    return sequence;
+}
+
+bool axk_seqlock_read_retry( struct axk_seqlock_t* lock, uint32_t sequence )
+{
+    // Ensure the reads of the protected data complete before we check the sequence again
+    axk_atomic_fence_acquire();
+    return( axk_atomic_load_uint32_relaxed( &( lock->sequence ) ) != sequence );
+}
+
+void axk_seqlock_write_begin( struct axk_seqlock_t* lock )
+{
+    axk_spinlock_acquire_at( &( lock->writer_lock ), __builtin_return_address( 0 ) );
+
+    // Ensure the odd sequence is visible before any of the writes to the protected data
+    uint32_t sequence = axk_atomic_load_uint32_relaxed( &( lock->sequence ) );
+    axk_atomic_store_uint32_relaxed( &( lock->sequence ), sequence + 1U );
+    axk_atomic_fence_release();
+}
+
+void axk_seqlock_write_end( struct axk_seqlock_t* lock )
+{
+    uint32_t sequence = axk_atomic_load_uint32_relaxed( &( lock->sequence ) );
+    axk_atomic_store_uint32_release( &( lock->sequence ), sequence + 1U );
+
+    axk_spinlock_release( &( lock->writer_lock ) );
+}
\ No newline at end of file
@@ -6,36 +6,112 @@
 
 #include "axon/library/spinlock.h"
 
+/*
+    SPIN_BEGIN
+    * Timestamp the profiler starts counting spin time from, without the profiler there is nothing to time
+*/
+#ifdef AXK_LOCK_PROFILE
+#define SPIN_BEGIN()    axk_lock_profile_timestamp()
+#else
+#define SPIN_BEGIN()    0UL
+#endif
+
 
 void axk_spinlock_init( struct axk_spinlock_t* lock )
 {
-    axk_atomic_clear_flag( &( lock->flag ), MEMORY_ORDER_SEQ_CST );
+    #ifdef AXK_LOCK_PROFILE
+    memset( &( lock->stats ), 0, sizeof( lock->stats ) );
+    #endif
+
+    axk_atomic_store_uint32_relaxed( &( lock->next ), 0U );
+    axk_atomic_store_uint32_release( &( lock->owner ), 0U );
 }
 
-void axk_spinlock_acquire( struct axk_spinlock_t* lock )
+/*
+    _acquire
+    * Private Function
+    * Shared by the acquire functions, inlined so 'axk_spinlock_acquire' doesnt pay for an extra call
+    * The profiler counts spinning from 'spin_begin', and 'b_contended' is passed in for callers that already waited on something else
+*/
+static inline __attribute__((always_inline)) void _acquire( struct axk_spinlock_t* lock, void* site, uint64_t spin_begin, bool b_contended )
 {
     // Disable interrupts and get a copy of RFLAGS
     uint64_t rflags = axk_interrupts_disable();
 
-    // Wait to acquire the lock
-    while( axk_atomic_test_and_set_flag( &( lock->flag ), MEMORY_ORDER_SEQ_CST ) )
+    #ifndef AXK_LOCK_PROFILE
+    (void)( spin_begin );
+    (void)( b_contended );
+    #endif
+
+    // Take a ticket, the ordering is provided by the acquire load of 'owner' below
+    uint32_t ticket = axk_atomic_fetch_add_uint32_relaxed( &( lock->next ), 1U );
+
+    // Wait for our turn, waiters only read 'owner' so the cache line stays shared until the holder releases
+    while( axk_atomic_load_uint32_acquire( &( lock->owner ) ) != ticket )
     {
-        #ifdef _X86_64_
-        __asm__( "pause" );
+        #ifdef AXK_LOCK_PROFILE
+        b_contended = true;
         #endif
+
+        axk_spin_pause();
     }
 
     // Store RFLAGS in the structure
     lock->rflags = rflags;
+
+    #ifdef AXK_LOCK_PROFILE
+    lock->hold_site         = site;
+    lock->hold_begin        = axk_lock_profile_timestamp();
+    lock->hold_spin_cycles  = lock->hold_begin - spin_begin;
+    lock->hold_contended    = b_contended;
+    #else
+    (void)( site );
+    #endif
+}
+
+void axk_spinlock_acquire( struct axk_spinlock_t* lock )
+{
+    _acquire( lock, __builtin_return_address( 0 ), SPIN_BEGIN(), false );
+}
+
+void axk_spinlock_acquire_at( struct axk_spinlock_t* lock, void* site )
+{
+    _acquire( lock, site, SPIN_BEGIN(), false );
+}
+
+#ifdef AXK_LOCK_PROFILE
+void axk_spinlock_acquire_waited_at( struct axk_spinlock_t* lock, void* site, uint64_t wait_begin, bool b_waited )
+{
+    _acquire( lock, site, wait_begin, b_waited );
 }
+#endif
 
 void axk_spinlock_release( struct axk_spinlock_t* lock )
 {
     // Read back the old RFLAGS into a local
     uint64_t rflags = lock->rflags;
 
-    // Release the lock
-    axk_atomic_clear_flag( &( lock->flag ), MEMORY_ORDER_SEQ_CST );
+    #ifdef AXK_LOCK_PROFILE
+    // Only the holder touches the per-lock stats, so they dont need to be atomic
+    uint64_t hold_cycles = axk_lock_profile_timestamp() - lock->hold_begin;
+    void* site = lock->hold_site;
+    uint64_t spin_cycles = lock->hold_spin_cycles;
+    bool b_contended = lock->hold_contended;
+
+    lock->stats.acquisitions++;
+    lock->stats.spin_cycles += spin_cycles;
+    if( b_contended ) { lock->stats.contended++; }
+    if( hold_cycles > lock->stats.max_hold_cycles ) { lock->stats.max_hold_cycles = hold_cycles; }
+    #endif
+
+    // Hand the lock to the next ticket, only the holder writes 'owner' so a plain increment is fine
+    uint32_t owner = axk_atomic_load_uint32_relaxed( &( lock->owner ) );
+    axk_atomic_store_uint32_release( &( lock->owner ), owner + 1U );
+
+    #ifdef AXK_LOCK_PROFILE
+    // Record the call site after releasing, so the table update doesnt count towards anyone elses spin time
+    axk_lock_profile_record( site, spin_cycles, hold_cycles, b_contended );
+    #endif
 
     // Restore previous interrupt state
     axk_interrupts_restore( rflags );
@@ -43,5 +119,15 @@ void axk_spinlock_release( struct axk_spinlock_t* lock )
 
 bool axk_spinlock_is_locked( struct axk_spinlock_t* lock )
 {
-    return axk_atomic_test_flag( &( lock->flag ), MEMORY_ORDER_SEQ_CST );
-}
\ No newline at end of file
+    return( axk_atomic_load_uint32_acquire( &( lock->owner ) ) != axk_atomic_load_uint32_relaxed( &( lock->next ) ) );
+}
+
+#ifdef AXK_LOCK_PROFILE
+void axk_spinlock_get_stats( struct axk_spinlock_t* lock, struct axk_lock_stats_t* out_stats )
+{
+    // Read the stats while holding the lock, so we dont get a torn copy
+    axk_spinlock_acquire( lock );
+    memcpy( out_stats, &( lock->stats ), sizeof( struct axk_lock_stats_t ) );
+    axk_spinlock_release( lock );
+}
+#endif
\ No newline at end of file
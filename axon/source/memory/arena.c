@@ -0,0 +1,225 @@
+/*==============================================================
+    Axon Kernel - Arena Allocator
+    2021, Zachary Berry
+    axon/source/memory/arena.c
+==============================================================*/
+
+#include "axon/memory/arena.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/kernel/panic.h"
+
+/*
+    Chunk Structure
+    * Placed at the start of each chunk, chunks are linked in the order they are used, so everything after the current
+      chunk is free and can be reused after a rewind
+    * A chunk made for a single oversized allocation is linked right before the current chunk instead, so the free space
+      left in the current chunk is still used by the allocations that come after it
+*/
+struct axk_arena_chunk_t
+{
+    struct axk_arena_chunk_t* next;
+    uint64_t size;
+};
+
+/*
+    Constants
+*/
+#define CHUNK_HEADER_SIZE   ( ( sizeof( struct axk_arena_chunk_t ) + 15UL ) & ~15UL )
+#define ALIGN_UP( _val_, _align_ )  ( ( ( _val_ ) + ( _align_ ) - 1UL ) & ~( ( _align_ ) - 1UL ) )
+
+/*
+    _new_chunk
+    * Private Function
+    * Allocates a chunk large enough for an allocation of 'size' bytes with alignment 'align'
+*/
+static struct axk_arena_chunk_t* _new_chunk( struct axk_arena_t* arena, uint64_t size, uint64_t align )
+{
+    if( size > UINT64_MAX - CHUNK_HEADER_SIZE - align - AXK_PAGE_SIZE ) { return NULL; }
+
+    uint64_t chunk_size = ALIGN_UP( CHUNK_HEADER_SIZE + size + align, AXK_PAGE_SIZE );
+    if( chunk_size < arena->chunk_size ) { chunk_size = arena->chunk_size; }
+
+    uint64_t addr = 0UL;
+    if( !axk_va_alloc( AXK_VA_REGION_HEAP, chunk_size, 0UL, AXK_VA_FLAG_NONE, &addr ) ) { return NULL; }
+
+    struct axk_arena_chunk_t* chunk = (struct axk_arena_chunk_t*)( addr );
+    chunk->next = NULL;
+    chunk->size = chunk_size;
+
+    return chunk;
+}
+
+/*
+    _alloc_from
+    * Private Function
+    * Bumps the arena offset within 'chunk', returns NULL if the allocation doesnt fit
+*/
+static void* _alloc_from( struct axk_arena_t* arena, struct axk_arena_chunk_t* chunk, uint64_t offset, uint64_t size, uint64_t align )
+{
+    uint64_t start = ALIGN_UP( offset, align );
+    if( start > chunk->size || size > chunk->size - start ) { return NULL; }
+
+    arena->current  = chunk;
+    arena->offset   = start + size;
+
+    return (void*)( (uint8_t*)( chunk ) + start );
+}
+
+/*
+    _link_before
+    * Private Function
+    * Links 'chunk' into the arena's list, right before 'target'
+*/
+static void _link_before( struct axk_arena_t* arena, struct axk_arena_chunk_t* chunk, struct axk_arena_chunk_t* target )
+{
+    struct axk_arena_chunk_t** link = &( arena->first );
+    while( *link != target ) { link = &( ( *link )->next ); }
+
+    chunk->next = target;
+    *link       = chunk;
+}
+
+/*
+    Allocator Interface Functions
+*/
+static void* _interface_alloc( void* context, size_t size, bool b_clear )
+{
+    void* ret = axk_arena_alloc( (struct axk_arena_t*)( context ), size, 0UL );
+    if( ret != NULL && b_clear ) { memset( ret, 0, size ); }
+
+    return ret;
+}
+
+
+static void _interface_free( void* context, void* ptr )
+{
+    // Arena memory is only released by rewinding or resetting
+    (void)( context );
+    (void)( ptr );
+}
+
+
+/*
+    Function Implementations
+*/
+void axk_arena_create( struct axk_arena_t* arena, uint64_t chunk_size )
+{
+    if( arena == NULL ) { axk_panic( "Arena: attempt to create an arena with a NULL handle" ); }
+
+    arena->first        = NULL;
+    arena->current      = NULL;
+    arena->offset       = 0UL;
+    arena->chunk_size   = ALIGN_UP( chunk_size == 0UL ? AXK_ARENA_DEFAULT_CHUNK_SIZE : chunk_size, AXK_PAGE_SIZE );
+
+    arena->allocator.fn_alloc   = _interface_alloc;
+    arena->allocator.fn_free    = _interface_free;
+    arena->allocator.context    = (void*)( arena );
+}
+
+
+void axk_arena_destroy( struct axk_arena_t* arena )
+{
+    if( arena == NULL ) { return; }
+
+    struct axk_arena_chunk_t* chunk = arena->first;
+    while( chunk != NULL )
+    {
+        struct axk_arena_chunk_t* next = chunk->next;
+        axk_va_free( (uint64_t)( chunk ) );
+        chunk = next;
+    }
+
+    arena->first    = NULL;
+    arena->current  = NULL;
+    arena->offset   = 0UL;
+}
+
+
+void* axk_arena_alloc( struct axk_arena_t* arena, uint64_t size, uint64_t align )
+{
+    if( arena == NULL || size == 0UL ) { return NULL; }
+    if( align == 0UL ) { align = AXK_ARENA_DEFAULT_ALIGN; }
+    if( ( align & ( align - 1UL ) ) != 0UL || align > AXK_PAGE_SIZE ) { return NULL; }
+
+    // Fast path, the allocation fits in the current chunk
+    struct axk_arena_chunk_t* current = arena->current;
+    if( current != NULL )
+    {
+        void* ret = _alloc_from( arena, current, arena->offset, size, align );
+        if( ret != NULL ) { return ret; }
+
+        // After a rewind or reset, the chunks past the current one are empty and can be reused
+        if( current->next != NULL )
+        {
+            ret = _alloc_from( arena, current->next, CHUNK_HEADER_SIZE, size, align );
+            if( ret != NULL ) { return ret; }
+        }
+    }
+
+    // Otherwise, we need a new chunk
+    struct axk_arena_chunk_t* chunk = _new_chunk( arena, size, align );
+    if( chunk == NULL ) { return NULL; }
+
+    // An allocation that doesnt fit in a normal sized chunk fills its own chunk, so we keep bumping through the current one
+    // Its linked behind the current chunk, so its treated as in use until the arena is rewound to an earlier chunk or reset
+    if( current != NULL && chunk->size > arena->chunk_size )
+    {
+        _link_before( arena, chunk, current );
+        return (void*)( (uint8_t*)( chunk ) + ALIGN_UP( CHUNK_HEADER_SIZE, align ) );
+    }
+
+    // A normal chunk is linked right after the current one and becomes the current chunk, so rewinding still works
+    if( current == NULL )
+    {
+        chunk->next     = arena->first;
+        arena->first    = chunk;
+    }
+    else
+    {
+        chunk->next     = current->next;
+        current->next   = chunk;
+    }
+
+    return _alloc_from( arena, chunk, CHUNK_HEADER_SIZE, size, align );
+}
+
+
+struct axk_arena_mark_t axk_arena_mark( struct axk_arena_t* arena )
+{
+    struct axk_arena_mark_t ret;
+    ret.chunk   = arena->current;
+    ret.offset  = arena->offset;
+
+    return ret;
+}
+
+
+void axk_arena_rewind( struct axk_arena_t* arena, struct axk_arena_mark_t mark )
+{
+    if( arena == NULL ) { return; }
+
+    // A mark taken before the first allocation is the same as a reset
+    if( mark.chunk == NULL )
+    {
+        axk_arena_reset( arena );
+        return;
+    }
+
+    arena->current  = mark.chunk;
+    arena->offset   = mark.offset;
+}
+
+
+void axk_arena_reset( struct axk_arena_t* arena )
+{
+    if( arena == NULL ) { return; }
+
+    arena->current  = arena->first;
+    arena->offset   = CHUNK_HEADER_SIZE;
+}
+
+
+struct axk_allocator_t* axk_arena_allocator( struct axk_arena_t* arena )
+{
+    return arena == NULL ? NULL : &( arena->allocator );
+}
\ No newline at end of file
@@ -0,0 +1,279 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap Profiler
+    2021, Zachary Berry
+    axon/source/memory/heap_profile.c
+==============================================================*/
+
+#include "axon/memory/heap_profile.h"
+
+#ifdef AXK_HEAP_PROFILE
+#include "axon/library/atomic.h"
+#include "axon/gfx/basic_terminal.h"
+
+
+/*
+    Site Structure
+    * The table is updated from inside the heap, so it cant allocate or take any locks itself
+*/
+struct axk_heap_site_t
+{
+    struct axk_atomic_pointer_t site;
+    struct axk_atomic_uint64_t allocations;
+    struct axk_atomic_uint64_t frees;
+    struct axk_atomic_uint64_t live_count;
+    struct axk_atomic_uint64_t live_bytes;
+    struct axk_atomic_uint64_t histogram[ AXK_HEAP_PROFILE_BUCKETS ];
+};
+
+/*
+    State
+*/
+static struct axk_heap_site_t g_sites[ AXK_HEAP_PROFILE_MAX_SITES ];
+static struct axk_heap_site_t g_overflow;
+
+
+static struct axk_heap_site_t* _find_site( void* site, bool b_insert )
+{
+    // Same hashing as the lock profiler, the low bits of a return address dont tell us much
+    uint32_t index = (uint32_t)( ( ( (uint64_t)( site ) >> 2 ) * 0x9E3779B97F4A7C15UL ) >> 55 ) % AXK_HEAP_PROFILE_MAX_SITES;
+
+    for( uint32_t i = 0; i < AXK_HEAP_PROFILE_MAX_SITES; i++ )
+    {
+        struct axk_heap_site_t* entry = g_sites + ( ( index + i ) % AXK_HEAP_PROFILE_MAX_SITES );
+        void* existing = axk_atomic_load_pointer_acquire( &( entry->site ) );
+
+        if( existing == site ) { return entry; }
+        if( existing == NULL )
+        {
+            if( !b_insert ) { return NULL; }
+            if( axk_atomic_cmpexchg_pointer_acq_rel( &( entry->site ), &existing, site ) || existing == site )
+            {
+                return entry;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+static inline uint32_t _bucket_index( uint64_t size )
+{
+    if( size <= 16UL ) { return 0U; }
+
+    uint32_t bucket = (uint32_t)( 64 - __builtin_clzl( size - 1UL ) ) - 4U;
+    return( bucket < AXK_HEAP_PROFILE_BUCKETS ? bucket : AXK_HEAP_PROFILE_BUCKETS - 1U );
+}
+
+
+void axk_heap_profile_on_alloc( struct axk_heap_profile_tag_t* tag, void* site, uint64_t size )
+{
+    // If the table is full, the allocation is still tracked, just under a single shared entry
+    struct axk_heap_site_t* entry = _find_site( site, true );
+    if( entry == NULL ) { entry = &g_overflow; }
+
+    tag->site = site;
+    tag->size = size;
+
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->allocations ), 1UL );
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->live_count ), 1UL );
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->live_bytes ), size );
+    axk_atomic_fetch_add_uint64_relaxed( entry->histogram + _bucket_index( size ), 1UL );
+}
+
+
+void axk_heap_profile_on_free( struct axk_heap_profile_tag_t* tag )
+{
+    struct axk_heap_site_t* entry = _find_site( tag->site, false );
+    if( entry == NULL ) { entry = &g_overflow; }
+
+    axk_atomic_fetch_add_uint64_relaxed( &( entry->frees ), 1UL );
+    axk_atomic_fetch_sub_uint64_relaxed( &( entry->live_count ), 1UL );
+    axk_atomic_fetch_sub_uint64_relaxed( &( entry->live_bytes ), tag->size );
+}
+
+
+bool axk_heap_profile_get_site( void* site, struct axk_heap_stats_t* out_stats )
+{
+    struct axk_heap_site_t* entry = _find_site( site, false );
+    if( entry == NULL || out_stats == NULL ) { return false; }
+
+    out_stats->allocations  = axk_atomic_load_uint64_relaxed( &( entry->allocations ) );
+    out_stats->frees        = axk_atomic_load_uint64_relaxed( &( entry->frees ) );
+    out_stats->live_count   = axk_atomic_load_uint64_relaxed( &( entry->live_count ) );
+    out_stats->live_bytes   = axk_atomic_load_uint64_relaxed( &( entry->live_bytes ) );
+
+    for( uint32_t i = 0; i < AXK_HEAP_PROFILE_BUCKETS; i++ )
+    {
+        out_stats->histogram[ i ] = axk_atomic_load_uint64_relaxed( entry->histogram + i );
+    }
+
+    return true;
+}
+
+
+void axk_heap_profile_snapshot( struct axk_heap_snapshot_t* out_snapshot )
+{
+    if( out_snapshot == NULL ) { return; }
+    out_snapshot->count = 0U;
+
+    for( uint32_t i = 0; i < AXK_HEAP_PROFILE_MAX_SITES; i++ )
+    {
+        void* site = axk_atomic_load_pointer_acquire( &( g_sites[ i ].site ) );
+        if( site == NULL ) { continue; }
+
+        struct axk_heap_snapshot_entry_t* out_entry = out_snapshot->entries + ( out_snapshot->count++ );
+        out_entry->site             = site;
+        out_entry->allocations      = axk_atomic_load_uint64_relaxed( &( g_sites[ i ].allocations ) );
+        out_entry->live_count       = axk_atomic_load_uint64_relaxed( &( g_sites[ i ].live_count ) );
+        out_entry->live_bytes       = axk_atomic_load_uint64_relaxed( &( g_sites[ i ].live_bytes ) );
+    }
+}
+
+
+static struct axk_heap_snapshot_entry_t* _snapshot_find( struct axk_heap_snapshot_t* snapshot, void* site )
+{
+    for( uint32_t i = 0; i < snapshot->count; i++ )
+    {
+        if( snapshot->entries[ i ].site == site ) { return snapshot->entries + i; }
+    }
+
+    return NULL;
+}
+
+
+void axk_heap_profile_diff( struct axk_heap_snapshot_t* before, struct axk_heap_snapshot_t* after, uint32_t count )
+{
+    if( before == NULL || after == NULL ) { return; }
+    if( count > AXK_HEAP_PROFILE_MAX_REPORT ) { count = AXK_HEAP_PROFILE_MAX_REPORT; }
+
+    // Work out the growth of each site in 'after', sites that dont appear in 'before' started from zero
+    int64_t growth[ AXK_HEAP_PROFILE_MAX_REPORT ];
+    uint32_t top[ AXK_HEAP_PROFILE_MAX_REPORT ];
+    uint32_t top_count = 0U;
+
+    for( uint32_t i = 0; i < after->count; i++ )
+    {
+        struct axk_heap_snapshot_entry_t* old_entry = _snapshot_find( before, after->entries[ i ].site );
+        int64_t delta = (int64_t)( after->entries[ i ].live_bytes - ( old_entry != NULL ? old_entry->live_bytes : 0UL ) );
+        if( delta <= 0L ) { continue; }
+
+        // Insertion into the sorted top list
+        uint32_t pos = top_count;
+        while( pos > 0U && growth[ pos - 1U ] < delta ) { pos--; }
+        if( pos >= count ) { continue; }
+
+        uint32_t last = top_count < count ? top_count : count - 1U;
+        for( uint32_t j = last; j > pos; j-- )
+        {
+            growth[ j ]     = growth[ j - 1U ];
+            top[ j ]        = top[ j - 1U ];
+        }
+
+        growth[ pos ]   = delta;
+        top[ pos ]      = i;
+        if( top_count < count ) { top_count++; }
+    }
+
+    axk_basicterminal_lock();
+    axk_basicterminal_prints( "Heap Profile: Top " );
+    axk_basicterminal_printu32( top_count );
+    axk_basicterminal_prints( " call sites by live bytes growth\n" );
+
+    for( uint32_t i = 0; i < top_count; i++ )
+    {
+        struct axk_heap_snapshot_entry_t* entry     = after->entries + top[ i ];
+        struct axk_heap_snapshot_entry_t* old_entry = _snapshot_find( before, entry->site );
+
+        axk_basicterminal_prints( "\t" );
+        axk_basicterminal_printh64( (uint64_t)( entry->site ), true );
+        axk_basicterminal_prints( "  Grew By: " );
+        axk_basicterminal_printu64( (uint64_t)( growth[ i ] ) );
+        axk_basicterminal_prints( " bytes  Live Blocks: " );
+        axk_basicterminal_printu64( old_entry != NULL ? old_entry->live_count : 0UL );
+        axk_basicterminal_prints( " -> " );
+        axk_basicterminal_printu64( entry->live_count );
+        axk_basicterminal_prints( "  New Allocations: " );
+        axk_basicterminal_printu64( entry->allocations - ( old_entry != NULL ? old_entry->allocations : 0UL ) );
+        axk_basicterminal_printnl();
+    }
+
+    axk_basicterminal_unlock();
+}
+
+
+void axk_heap_profile_dump( uint32_t count )
+{
+    if( count > AXK_HEAP_PROFILE_MAX_REPORT ) { count = AXK_HEAP_PROFILE_MAX_REPORT; }
+
+    // Select the top sites by live bytes before printing, since the terminal could allocate
+    uint32_t top[ AXK_HEAP_PROFILE_MAX_REPORT ];
+    uint32_t top_count = 0U;
+
+    while( top_count < count )
+    {
+        uint64_t best_bytes     = 0UL;
+        uint32_t best_index     = AXK_HEAP_PROFILE_MAX_SITES;
+
+        for( uint32_t i = 0; i < AXK_HEAP_PROFILE_MAX_SITES; i++ )
+        {
+            if( axk_atomic_load_pointer_acquire( &( g_sites[ i ].site ) ) == NULL ) { continue; }
+
+            bool b_picked = false;
+            for( uint32_t j = 0; j < top_count; j++ ) { if( top[ j ] == i ) { b_picked = true; break; } }
+            if( b_picked ) { continue; }
+
+            uint64_t bytes = axk_atomic_load_uint64_relaxed( &( g_sites[ i ].live_bytes ) );
+            if( best_index == AXK_HEAP_PROFILE_MAX_SITES || bytes > best_bytes )
+            {
+                best_bytes  = bytes;
+                best_index  = i;
+            }
+        }
+
+        if( best_index == AXK_HEAP_PROFILE_MAX_SITES ) { break; }
+        top[ top_count++ ] = best_index;
+    }
+
+    axk_basicterminal_lock();
+    axk_basicterminal_prints( "Heap Profile: Top " );
+    axk_basicterminal_printu32( top_count );
+    axk_basicterminal_prints( " call sites by live bytes (Untracked Live Bytes: " );
+    axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( g_overflow.live_bytes ) ) );
+    axk_basicterminal_prints( ")\n" );
+
+    for( uint32_t i = 0; i < top_count; i++ )
+    {
+        struct axk_heap_site_t* entry = g_sites + top[ i ];
+
+        axk_basicterminal_prints( "\t" );
+        axk_basicterminal_printh64( (uint64_t)( axk_atomic_load_pointer_relaxed( &( entry->site ) ) ), true );
+        axk_basicterminal_prints( "  Live Bytes: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->live_bytes ) ) );
+        axk_basicterminal_prints( "  Live Blocks: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->live_count ) ) );
+        axk_basicterminal_prints( "  Allocations: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->allocations ) ) );
+        axk_basicterminal_prints( "  Frees: " );
+        axk_basicterminal_printu64( axk_atomic_load_uint64_relaxed( &( entry->frees ) ) );
+        axk_basicterminal_printnl();
+
+        // Histogram, only the non-empty buckets are printed as 'max size: count'
+        axk_basicterminal_prints( "\t\tSizes:" );
+        for( uint32_t b = 0; b < AXK_HEAP_PROFILE_BUCKETS; b++ )
+        {
+            uint64_t hits = axk_atomic_load_uint64_relaxed( entry->histogram + b );
+            if( hits == 0UL ) { continue; }
+
+            axk_basicterminal_prints( b == AXK_HEAP_PROFILE_BUCKETS - 1U ? "  >" : "  <=" );
+            axk_basicterminal_printu64( b == AXK_HEAP_PROFILE_BUCKETS - 1U ? ( 16UL << ( b - 1U ) ) : ( 16UL << b ) );
+            axk_basicterminal_prints( ": " );
+            axk_basicterminal_printu64( hits );
+        }
+        axk_basicterminal_printnl();
+    }
+
+    axk_basicterminal_unlock();
+}
+
+#endif
\ No newline at end of file
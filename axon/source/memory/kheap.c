@@ -0,0 +1,563 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap
+    2021, Zachary Berry
+    axon/source/memory/kheap.c
+==============================================================*/
+
+#include "axon/memory/kheap.h"
+#include "axon/memory/memory_private.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/memory/heap_profile.h"
+#include "axon/kernel/percpu.h"
+#include "axon/kernel/panic.h"
+#include "axon/kernel/klog.h"
+#include "axon/library/spinlock.h"
+#include "axon/library/atomic.h"
+
+/*
+    Constants
+*/
+#define SLAB_SIZE               0x10000UL
+#define CLASS_COUNT             9
+#define DEFAULT_ALIGN           16UL
+#define MAGAZINE_BATCH          ( AXK_KCACHE_MAGAZINE_SIZE / 2 )
+#define MAX_EMPTY_SLABS         1UL
+
+#define SLAB_LIST_PARTIAL       0
+#define SLAB_LIST_FULL          1
+#define SLAB_LIST_EMPTY         2
+
+/*
+    Slab Structure
+    * Placed at the start of each slab, slabs are aligned to their size so the header of any object is found by masking its address
+*/
+struct axk_slab_t
+{
+    struct axk_kcache_t* cache;
+    struct axk_slab_t* prev;
+    struct axk_slab_t* next;
+    void* free_list;
+    uint32_t free_count;
+    uint32_t list;
+};
+
+/*
+    Cache Structure
+    * Free objects inside a slab are linked through a pointer stored at 'link_offset', for caches with a constructor this is placed
+      after the object, so linking an object never overwrites its constructed state
+*/
+struct axk_kcache_t
+{
+    struct axk_spinlock_t lock;
+    const char* name;
+    uint32_t index;
+    uint32_t objects_per_slab;
+    uint64_t object_size;
+    uint64_t stride;
+    uint64_t first_offset;
+    uint64_t link_offset;
+    uint64_t empty_count;
+    void( *fn_ctor )( void* );
+    struct axk_slab_t* lists[ 3 ];
+};
+
+/*
+    State
+*/
+static struct axk_kcache_t g_caches[ AXK_KCACHE_MAX ];
+static struct axk_atomic_uint32_t g_cache_count;
+static struct axk_kcache_t* g_classes[ CLASS_COUNT ];
+
+static const char* g_class_names[ CLASS_COUNT ] =
+{
+    "kheap-16", "kheap-32", "kheap-64", "kheap-128", "kheap-256", "kheap-512", "kheap-1024", "kheap-2048", "kheap-4096"
+};
+
+
+/*
+    Helper Functions
+*/
+static inline uint64_t _round_up( uint64_t value, uint64_t align )
+{
+    return( ( value + ( align - 1UL ) ) & ~( align - 1UL ) );
+}
+
+
+static inline uint32_t _class_index( uint64_t size )
+{
+    // 16 bytes is the smallest class, every class after is the next power of two
+    if( size <= AXK_KHEAP_MIN_CLASS_SIZE ) { return 0U; }
+    return (uint32_t)( 64 - __builtin_clzl( size - 1UL ) ) - 4U;
+}
+
+
+static inline void** _link( struct axk_kcache_t* cache, void* obj )
+{
+    return (void**)( (uint8_t*)( obj ) + cache->link_offset );
+}
+
+
+static inline struct axk_slab_t* _slab_of( void* obj )
+{
+    return (struct axk_slab_t*)( (uint64_t)( obj ) & ~( SLAB_SIZE - 1UL ) );
+}
+
+
+static inline bool _is_slab_address( uint64_t addr )
+{
+    return( addr >= AXK_KERNEL_VA_SLAB && addr < AXK_KERNEL_VA_SHARED );
+}
+
+
+static inline bool _is_pool_address( uint64_t addr )
+{
+    return( addr >= AXK_KERNEL_VA_POOL && addr < AXK_KERNEL_VA_SLAB );
+}
+
+/*
+    Slab List Functions
+    * Must hold the cache lock
+*/
+static void _list_push( struct axk_kcache_t* cache, struct axk_slab_t* slab, uint32_t list )
+{
+    slab->list = list;
+    slab->prev = NULL;
+    slab->next = cache->lists[ list ];
+
+    if( slab->next != NULL ) { slab->next->prev = slab; }
+    cache->lists[ list ] = slab;
+
+    if( list == SLAB_LIST_EMPTY ) { cache->empty_count++; }
+}
+
+
+static void _list_remove( struct axk_kcache_t* cache, struct axk_slab_t* slab )
+{
+    if( slab->prev != NULL ) { slab->prev->next = slab->next; }
+    else { cache->lists[ slab->list ] = slab->next; }
+    if( slab->next != NULL ) { slab->next->prev = slab->prev; }
+
+    if( slab->list == SLAB_LIST_EMPTY ) { cache->empty_count--; }
+}
+
+
+static void _list_move( struct axk_kcache_t* cache, struct axk_slab_t* slab, uint32_t list )
+{
+    if( slab->list == list ) { return; }
+
+    _list_remove( cache, slab );
+    _list_push( cache, slab, list );
+}
+
+/*
+    _slab_create
+    * Private Function
+    * Gets a new slab from the virtual address allocator, and builds its free list
+    * Called without the cache lock held, since this can be slow
+*/
+static struct axk_slab_t* _slab_create( struct axk_kcache_t* cache )
+{
+    uint64_t addr = 0UL;
+    if( !axk_va_alloc( AXK_VA_REGION_SLAB, SLAB_SIZE, SLAB_SIZE, AXK_VA_FLAG_NONE, &addr ) ) { return NULL; }
+
+    struct axk_slab_t* slab = (struct axk_slab_t*)( addr );
+    slab->cache         = cache;
+    slab->prev          = NULL;
+    slab->next          = NULL;
+    slab->free_list     = NULL;
+    slab->free_count    = cache->objects_per_slab;
+
+    // Build the list back to front, so objects are handed out in address order
+    for( uint32_t i = cache->objects_per_slab; i > 0U; i-- )
+    {
+        void* obj = (void*)( addr + cache->first_offset + ( (uint64_t)( i - 1U ) * cache->stride ) );
+        if( cache->fn_ctor != NULL ) { cache->fn_ctor( obj ); }
+
+        *_link( cache, obj )    = slab->free_list;
+        slab->free_list         = obj;
+    }
+
+    return slab;
+}
+
+/*
+    _magazine_refill
+    * Private Function
+    * Moves up to half a magazine of objects from the cache's slabs into a processor's magazine
+    * Interrupts must be disabled, so the magazine stays owned by this processor
+*/
+static bool _magazine_refill( struct axk_kcache_t* cache, struct axk_kcache_magazine_t* magazine )
+{
+    axk_spinlock_acquire( &( cache->lock ) );
+
+    while( magazine->count < MAGAZINE_BATCH )
+    {
+        // Prefer partially used slabs, so empty slabs can be given back
+        struct axk_slab_t* slab = cache->lists[ SLAB_LIST_PARTIAL ];
+        if( slab == NULL ) { slab = cache->lists[ SLAB_LIST_EMPTY ]; }
+        if( slab == NULL )
+        {
+            axk_spinlock_release( &( cache->lock ) );
+            slab = _slab_create( cache );
+            axk_spinlock_acquire( &( cache->lock ) );
+
+            if( slab == NULL ) { break; }
+            _list_push( cache, slab, SLAB_LIST_EMPTY );
+        }
+
+        while( magazine->count < MAGAZINE_BATCH && slab->free_count > 0U )
+        {
+            void* obj                                   = slab->free_list;
+            slab->free_list                             = *_link( cache, obj );
+            magazine->objects[ magazine->count++ ]      = obj;
+            slab->free_count--;
+        }
+
+        _list_move( cache, slab, slab->free_count == 0U ? SLAB_LIST_FULL : SLAB_LIST_PARTIAL );
+    }
+
+    axk_spinlock_release( &( cache->lock ) );
+    return( magazine->count > 0UL );
+}
+
+/*
+    _magazine_flush
+    * Private Function
+    * Returns the oldest half of a full magazine back to the slabs they came from, keeping the most recently freed (and likely cached) objects
+    * Interrupts must be disabled
+*/
+static void _magazine_flush( struct axk_kcache_t* cache, struct axk_kcache_magazine_t* magazine )
+{
+    struct axk_slab_t* release_list = NULL;
+    axk_spinlock_acquire( &( cache->lock ) );
+
+    for( uint64_t i = 0; i < MAGAZINE_BATCH; i++ )
+    {
+        void* obj                   = magazine->objects[ i ];
+        struct axk_slab_t* slab     = _slab_of( obj );
+
+        *_link( cache, obj )    = slab->free_list;
+        slab->free_list         = obj;
+        slab->free_count++;
+
+        if( slab->free_count < cache->objects_per_slab )
+        {
+            _list_move( cache, slab, SLAB_LIST_PARTIAL );
+        }
+        else if( cache->empty_count < MAX_EMPTY_SLABS )
+        {
+            _list_move( cache, slab, SLAB_LIST_EMPTY );
+        }
+        else
+        {
+            // Already keeping enough empty slabs around, give this one back once the lock is released
+            _list_remove( cache, slab );
+            slab->next      = release_list;
+            release_list    = slab;
+        }
+    }
+
+    axk_spinlock_release( &( cache->lock ) );
+
+    magazine->count -= MAGAZINE_BATCH;
+    memmove( magazine->objects, magazine->objects + MAGAZINE_BATCH, magazine->count * sizeof( void* ) );
+
+    while( release_list != NULL )
+    {
+        struct axk_slab_t* next = release_list->next;
+        axk_va_free( (uint64_t)( release_list ) );
+        release_list = next;
+    }
+}
+
+
+/*
+    Object Cache Functions
+*/
+struct axk_kcache_t* axk_kcache_create( const char* name, uint64_t size, uint64_t align, void( *fn_ctor )( void* ) )
+{
+    if( align == 0UL ) { align = DEFAULT_ALIGN; }
+    if( size == 0UL || ( align & ( align - 1UL ) ) != 0UL || align > AXK_PAGE_SIZE ) { return NULL; }
+
+    // Objects need enough room for the free list link, which goes after the object if theres a constructor
+    uint64_t link_offset    = fn_ctor != NULL ? _round_up( size, sizeof( void* ) ) : 0UL;
+    uint64_t stride         = link_offset + sizeof( void* );
+    if( stride < size ) { stride = size; }
+    stride = _round_up( stride, align );
+
+    uint64_t first_offset   = _round_up( sizeof( struct axk_slab_t ), align );
+    if( first_offset + stride > SLAB_SIZE ) { return NULL; }
+
+    // Claim a slot, the slot index is also the index of the cache's magazine in each processor's data area
+    uint32_t index = axk_atomic_load_uint32_relaxed( &g_cache_count );
+    do
+    {
+        if( index >= AXK_KCACHE_MAX ) { return NULL; }
+    }
+    while( !axk_atomic_cmpexchg_uint32_relaxed( &g_cache_count, &index, index + 1U ) );
+
+    struct axk_kcache_t* cache = g_caches + index;
+    memset( cache, 0, sizeof( struct axk_kcache_t ) );
+    axk_spinlock_init( &( cache->lock ) );
+
+    cache->name                 = name;
+    cache->index                = index;
+    cache->object_size          = size;
+    cache->stride               = stride;
+    cache->first_offset         = first_offset;
+    cache->link_offset          = link_offset;
+    cache->objects_per_slab     = (uint32_t)( ( SLAB_SIZE - first_offset ) / stride );
+    cache->fn_ctor              = fn_ctor;
+
+    return cache;
+}
+
+
+void* axk_kcache_alloc( struct axk_kcache_t* cache )
+{
+    // With interrupts disabled, nothing else can touch this processor's magazine, so the fast path needs no lock or atomic
+    uint64_t rflags = axk_interrupts_disable();
+    struct axk_kcache_magazine_t* magazine = axk_percpu_self()->kcache_magazines + cache->index;
+
+    void* ret = NULL;
+    if( magazine->count > 0UL || _magazine_refill( cache, magazine ) )
+    {
+        ret = magazine->objects[ --magazine->count ];
+    }
+
+    axk_interrupts_restore( rflags );
+    return ret;
+}
+
+
+void axk_kcache_free( struct axk_kcache_t* cache, void* ptr )
+{
+    if( ptr == NULL ) { return; }
+    if( !_is_slab_address( (uint64_t)( ptr ) ) || _slab_of( ptr )->cache != cache )
+    {
+        axk_panic( "Kernel Heap: attempt to free an object to the wrong cache" );
+    }
+
+    uint64_t rflags = axk_interrupts_disable();
+    struct axk_kcache_magazine_t* magazine = axk_percpu_self()->kcache_magazines + cache->index;
+
+    if( magazine->count == AXK_KCACHE_MAGAZINE_SIZE ) { _magazine_flush( cache, magazine ); }
+    magazine->objects[ magazine->count++ ] = ptr;
+
+    axk_interrupts_restore( rflags );
+}
+
+
+/*
+    Kernel Heap Functions
+*/
+void axk_kheap_init( void )
+{
+    axk_kheap_pool_init();
+
+    for( uint32_t i = 0; i < CLASS_COUNT; i++ )
+    {
+        // Each class is aligned to its own size, so power of two allocations are naturally aligned
+        uint64_t size   = AXK_KHEAP_MIN_CLASS_SIZE << i;
+        g_classes[ i ]  = axk_kcache_create( g_class_names[ i ], size, size, NULL );
+
+        if( g_classes[ i ] == NULL )
+        {
+            axk_panic( "Kernel Heap: Failed to create size class caches" );
+        }
+    }
+
+    axk_klog( "Kernel Heap: Initialized successfully. Size classes from %lu to %lu bytes\n", AXK_KHEAP_MIN_CLASS_SIZE, AXK_KHEAP_MAX_CLASS_SIZE );
+}
+
+
+static void* _heap_alloc( size_t size, bool b_clear )
+{
+    if( size == 0UL ) { return NULL; }
+
+    if( size <= AXK_KHEAP_MAX_CLASS_SIZE )
+    {
+        struct axk_kcache_t* cache = g_classes[ _class_index( size ) ];
+        void* ret = axk_kcache_alloc( cache );
+
+        if( ret != NULL && b_clear ) { memset( ret, 0, cache->object_size ); }
+        return ret;
+    }
+
+    // Medium allocations are packed together in the pool, instead of each using whole pages and a guard page
+    if( size <= AXK_KHEAP_MAX_POOL_SIZE )
+    {
+        void* ret = axk_kheap_pool_alloc( size );
+        if( ret != NULL && b_clear ) { memset( ret, 0, size ); }
+        return ret;
+    }
+
+    // Large allocations get their own range, with a guard page after it
+    uint64_t addr = 0UL;
+    if( !axk_va_alloc( AXK_VA_REGION_HEAP, size, 0UL, b_clear ? AXK_VA_FLAG_CLEAR : AXK_VA_FLAG_NONE, &addr ) ) { return NULL; }
+
+    return (void*)( addr );
+}
+
+
+static size_t _heap_size( void* ptr )
+{
+    if( ptr == NULL ) { return 0UL; }
+    if( _is_slab_address( (uint64_t)( ptr ) ) ) { return _slab_of( ptr )->cache->object_size; }
+    if( _is_pool_address( (uint64_t)( ptr ) ) ) { return axk_kheap_pool_size( ptr ); }
+
+    uint64_t size = 0UL;
+    return axk_va_size( (uint64_t)( ptr ), &size ) ? size : 0UL;
+}
+
+
+static void _heap_free( void* ptr )
+{
+    if( ptr == NULL ) { return; }
+
+    uint64_t addr = (uint64_t)( ptr );
+    if( _is_slab_address( addr ) )
+    {
+        axk_kcache_free( _slab_of( ptr )->cache, ptr );
+    }
+    else if( _is_pool_address( addr ) )
+    {
+        axk_kheap_pool_free( ptr );
+    }
+    else if( addr < AXK_KERNEL_VA_HEAP || addr >= AXK_KERNEL_VA_SLAB || !axk_va_free( addr ) )
+    {
+        axk_panic( "Kernel Heap: attempt to free with an invalid address" );
+    }
+}
+
+
+static void* _heap_realloc( void* ptr, size_t new_size, bool b_clear )
+{
+    if( ptr == NULL ) { return _heap_alloc( new_size, b_clear ); }
+    if( new_size == 0UL )
+    {
+        _heap_free( ptr );
+        return NULL;
+    }
+
+    uint64_t addr       = (uint64_t)( ptr );
+    size_t old_size     = _heap_size( ptr );
+
+    if( _is_pool_address( addr ) )
+    {
+        // Pool blocks can shrink by splitting, or grow into a free block directly after them
+        if( new_size <= AXK_KHEAP_MAX_POOL_SIZE && axk_kheap_pool_resize( ptr, new_size ) )
+        {
+            if( b_clear && new_size > old_size ) { memset( (uint8_t*)( ptr ) + old_size, 0, new_size - old_size ); }
+            return ptr;
+        }
+    }
+    else if( _is_slab_address( addr ) )
+    {
+        // Slab objects cant change size, but if the object already fits and isnt more than twice as large as needed, keep it
+        // Otherwise the new size belongs in another class (or tier), so moving it is the only option
+        if( new_size <= old_size && new_size > ( old_size / 2UL ) ) { return ptr; }
+    }
+    else if( new_size > AXK_KHEAP_MAX_POOL_SIZE )
+    {
+        // Large ranges grow into the free address space after them, and shrink by releasing the pages past the new end
+        // The new pages are all past the end of the old block, so 'AXK_VA_FLAG_CLEAR' covers everything 'b_clear' needs
+        if( axk_va_resize( addr, new_size, b_clear ? AXK_VA_FLAG_CLEAR : AXK_VA_FLAG_NONE ) ) { return ptr; }
+    }
+
+    // Otherwise, fall back to moving the block
+    void* ret = _heap_alloc( new_size, false );
+    if( ret == NULL ) { return NULL; }
+
+    size_t copy_size = old_size < new_size ? old_size : new_size;
+    memcpy( ret, ptr, copy_size );
+    if( b_clear && new_size > copy_size ) { memset( (uint8_t*)( ret ) + copy_size, 0, new_size - copy_size ); }
+
+    _heap_free( ptr );
+    return ret;
+}
+
+
+/*
+    Public Heap Functions
+    * When heap profiling is enabled, each block has a tag in front of it, so the pointer given out is offset from the real block
+*/
+void* axk_kheap_alloc( size_t size, bool b_clear )
+{
+    return axk_kheap_alloc_caller( size, b_clear, __builtin_return_address( 0 ) );
+}
+
+
+void* axk_kheap_alloc_caller( size_t size, bool b_clear, void* site )
+{
+#ifdef AXK_HEAP_PROFILE
+    if( size == 0UL ) { return NULL; }
+
+    struct axk_heap_profile_tag_t* tag = _heap_alloc( size + AXK_HEAP_PROFILE_HEADER_SIZE, b_clear );
+    if( tag == NULL ) { return NULL; }
+
+    axk_heap_profile_on_alloc( tag, site, size );
+    return (void*)( tag + 1 );
+#else
+    (void)( site );
+    return _heap_alloc( size, b_clear );
+#endif
+}
+
+
+void* axk_kheap_realloc( void* ptr, size_t new_size, bool b_clear )
+{
+    return axk_kheap_realloc_caller( ptr, new_size, b_clear, __builtin_return_address( 0 ) );
+}
+
+
+void* axk_kheap_realloc_caller( void* ptr, size_t new_size, bool b_clear, void* site )
+{
+#ifdef AXK_HEAP_PROFILE
+    if( ptr == NULL ) { return axk_kheap_alloc_caller( new_size, b_clear, site ); }
+    if( new_size == 0UL )
+    {
+        axk_kheap_free( ptr );
+        return NULL;
+    }
+
+    // The old block stays charged to its site until we know the resize worked
+    struct axk_heap_profile_tag_t* tag  = (struct axk_heap_profile_tag_t*)( ptr ) - 1;
+    struct axk_heap_profile_tag_t old   = *tag;
+
+    tag = _heap_realloc( tag, new_size + AXK_HEAP_PROFILE_HEADER_SIZE, b_clear );
+    if( tag == NULL ) { return NULL; }
+
+    axk_heap_profile_on_free( &old );
+    axk_heap_profile_on_alloc( tag, site, new_size );
+    return (void*)( tag + 1 );
+#else
+    (void)( site );
+    return _heap_realloc( ptr, new_size, b_clear );
+#endif
+}
+
+
+size_t axk_kheap_size( void* ptr )
+{
+#ifdef AXK_HEAP_PROFILE
+    if( ptr == NULL ) { return 0UL; }
+    return _heap_size( (struct axk_heap_profile_tag_t*)( ptr ) - 1 ) - AXK_HEAP_PROFILE_HEADER_SIZE;
+#else
+    return _heap_size( ptr );
+#endif
+}
+
+
+void axk_kheap_free( void* ptr )
+{
+#ifdef AXK_HEAP_PROFILE
+    if( ptr == NULL ) { return; }
+
+    struct axk_heap_profile_tag_t* tag = (struct axk_heap_profile_tag_t*)( ptr ) - 1;
+    axk_heap_profile_on_free( tag );
+    _heap_free( tag );
+#else
+    _heap_free( ptr );
+#endif
+}
\ No newline at end of file
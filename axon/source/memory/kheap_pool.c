@@ -0,0 +1,410 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap Pool (TLSF)
+    2021, Zachary Berry
+    axon/source/memory/kheap_pool.c
+==============================================================*/
+
+#include "axon/memory/memory_private.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/kernel/panic.h"
+#include "axon/library/spinlock.h"
+
+/*
+    Constants
+    * Free blocks are binned by a first level (power of two) and second level (16 linear steps within that power of two) index
+    * Sizes below 'SMALL_BLOCK_SIZE' all share the first level zero, split into 16 byte steps
+*/
+#define ALIGN_SIZE_LOG2         4
+#define ALIGN_SIZE              ( 1UL << ALIGN_SIZE_LOG2 )
+#define SL_INDEX_COUNT_LOG2     4
+#define SL_INDEX_COUNT          ( 1U << SL_INDEX_COUNT_LOG2 )
+#define FL_INDEX_MAX            22
+#define FL_INDEX_SHIFT          ( SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2 )
+#define FL_INDEX_COUNT          ( FL_INDEX_MAX - FL_INDEX_SHIFT + 1 )
+#define SMALL_BLOCK_SIZE        ( 1UL << FL_INDEX_SHIFT )
+
+#define CHUNK_SIZE              0x200000UL
+#define MAX_FREE_CHUNKS         1UL
+
+#define BLOCK_FLAG_FREE         0x01UL
+#define BLOCK_FLAG_PREV_FREE    0x02UL
+#define BLOCK_FLAG_FIRST        0x04UL
+#define BLOCK_FLAG_MASK         0x0FUL
+
+/*
+    Block Structure
+    * 'size' includes the header, and the low bits hold the block flags (sizes are always a multiple of 16)
+    * 'prev_size' is the boundary tag, only valid when the physically previous block is free, so free can find it and coalesce
+    * The free list links overlay the start of the payload, so they only exist while the block is free
+    * Each chunk ends with a zero sized header that is never free, so coalescing stops at the chunk boundary
+*/
+struct axk_pool_block_t
+{
+    uint64_t prev_size;
+    uint64_t size;
+    struct axk_pool_block_t* next_free;
+    struct axk_pool_block_t* prev_free;
+};
+
+#define BLOCK_HEADER_SIZE       ( 2UL * sizeof( uint64_t ) )
+#define BLOCK_MIN_SIZE          sizeof( struct axk_pool_block_t )
+
+/*
+    State
+*/
+static struct axk_spinlock_t g_lock;
+static uint32_t g_fl_bitmap;
+static uint32_t g_sl_bitmap[ FL_INDEX_COUNT ];
+static struct axk_pool_block_t* g_blocks[ FL_INDEX_COUNT ][ SL_INDEX_COUNT ];
+static uint64_t g_free_chunks;
+
+
+/*
+    Block Helper Functions
+*/
+static inline uint64_t _block_size( struct axk_pool_block_t* block )
+{
+    return( block->size & ~BLOCK_FLAG_MASK );
+}
+
+
+static inline struct axk_pool_block_t* _block_next( struct axk_pool_block_t* block )
+{
+    return (struct axk_pool_block_t*)( (uint8_t*)( block ) + _block_size( block ) );
+}
+
+
+static inline struct axk_pool_block_t* _block_prev( struct axk_pool_block_t* block )
+{
+    return (struct axk_pool_block_t*)( (uint8_t*)( block ) - block->prev_size );
+}
+
+
+static inline void _block_set_size( struct axk_pool_block_t* block, uint64_t size )
+{
+    block->size = size | ( block->size & BLOCK_FLAG_MASK );
+}
+
+
+static inline bool _block_is_whole_chunk( struct axk_pool_block_t* block )
+{
+    return( AXK_CHECK_FLAG( block->size, BLOCK_FLAG_FIRST ) && _block_size( _block_next( block ) ) == 0UL );
+}
+
+/*
+    _mark_free / _mark_used
+    * Updates the block flags, along with the flag and boundary tag in the next block
+*/
+static void _mark_free( struct axk_pool_block_t* block )
+{
+    struct axk_pool_block_t* next = _block_next( block );
+
+    AXK_SET_FLAG( block->size, BLOCK_FLAG_FREE );
+    AXK_SET_FLAG( next->size, BLOCK_FLAG_PREV_FREE );
+    next->prev_size = _block_size( block );
+}
+
+
+static void _mark_used( struct axk_pool_block_t* block )
+{
+    AXK_CLEAR_FLAG( block->size, BLOCK_FLAG_FREE );
+    AXK_CLEAR_FLAG( _block_next( block )->size, BLOCK_FLAG_PREV_FREE );
+}
+
+/*
+    Mapping Functions
+    * '_mapping_insert' gets the bin a block of the given size belongs in
+    * '_mapping_search' rounds the size up to the next bin boundary first, so any block in the resulting bin (or above) is large enough,
+      which is what makes the search a 'good fit' that only needs to look at the first block of a list
+*/
+static void _mapping_insert( uint64_t size, uint32_t* out_fl, uint32_t* out_sl )
+{
+    if( size < SMALL_BLOCK_SIZE )
+    {
+        *out_fl = 0U;
+        *out_sl = (uint32_t)( size / ( SMALL_BLOCK_SIZE / SL_INDEX_COUNT ) );
+    }
+    else
+    {
+        uint32_t fl = 63U - (uint32_t) __builtin_clzl( size );
+        *out_sl     = (uint32_t)( size >> ( fl - SL_INDEX_COUNT_LOG2 ) ) ^ SL_INDEX_COUNT;
+        *out_fl     = fl - ( FL_INDEX_SHIFT - 1U );
+    }
+}
+
+
+static void _mapping_search( uint64_t size, uint32_t* out_fl, uint32_t* out_sl )
+{
+    if( size >= SMALL_BLOCK_SIZE )
+    {
+        uint32_t fl = 63U - (uint32_t) __builtin_clzl( size );
+        size += ( 1UL << ( fl - SL_INDEX_COUNT_LOG2 ) ) - 1UL;
+    }
+
+    _mapping_insert( size, out_fl, out_sl );
+}
+
+/*
+    Free List Functions
+    * Must hold the pool lock
+*/
+static void _insert_free( struct axk_pool_block_t* block )
+{
+    uint32_t fl, sl;
+    _mapping_insert( _block_size( block ), &fl, &sl );
+
+    block->prev_free    = NULL;
+    block->next_free    = g_blocks[ fl ][ sl ];
+    if( block->next_free != NULL ) { block->next_free->prev_free = block; }
+
+    g_blocks[ fl ][ sl ]    = block;
+    g_fl_bitmap             |= ( 1U << fl );
+    g_sl_bitmap[ fl ]       |= ( 1U << sl );
+}
+
+
+static void _remove_free( struct axk_pool_block_t* block )
+{
+    uint32_t fl, sl;
+    _mapping_insert( _block_size( block ), &fl, &sl );
+
+    if( block->prev_free != NULL ) { block->prev_free->next_free = block->next_free; }
+    else { g_blocks[ fl ][ sl ] = block->next_free; }
+    if( block->next_free != NULL ) { block->next_free->prev_free = block->prev_free; }
+
+    if( g_blocks[ fl ][ sl ] == NULL )
+    {
+        g_sl_bitmap[ fl ] &= ~( 1U << sl );
+        if( g_sl_bitmap[ fl ] == 0U ) { g_fl_bitmap &= ~( 1U << fl ); }
+    }
+}
+
+
+static struct axk_pool_block_t* _find_free( uint64_t size )
+{
+    uint32_t fl, sl;
+    _mapping_search( size, &fl, &sl );
+    if( fl >= FL_INDEX_COUNT ) { return NULL; }
+
+    // First look in the same first level list, for a second level list at or above the one we need
+    uint32_t sl_map = g_sl_bitmap[ fl ] & ( ~0U << sl );
+    if( sl_map == 0U )
+    {
+        // Otherwise, the smallest non-empty first level list above, any block in there is large enough
+        uint32_t fl_map = ( fl + 1U < 32U ) ? ( g_fl_bitmap & ( ~0U << ( fl + 1U ) ) ) : 0U;
+        if( fl_map == 0U ) { return NULL; }
+
+        fl      = (uint32_t) __builtin_ctz( fl_map );
+        sl_map  = g_sl_bitmap[ fl ];
+    }
+
+    sl = (uint32_t) __builtin_ctz( sl_map );
+    return g_blocks[ fl ][ sl ];
+}
+
+/*
+    _create_chunk
+    * Private Function
+    * Gets a new chunk from the virtual address allocator and adds it as a single free block
+    * Called without the lock held
+*/
+static struct axk_pool_block_t* _create_chunk( uint64_t min_size )
+{
+    uint64_t chunk_size = min_size + BLOCK_HEADER_SIZE;
+    if( chunk_size < CHUNK_SIZE ) { chunk_size = CHUNK_SIZE; }
+    chunk_size = ( chunk_size + ( AXK_PAGE_SIZE - 1UL ) ) & ~( AXK_PAGE_SIZE - 1UL );
+
+    uint64_t addr = 0UL;
+    if( !axk_va_alloc( AXK_VA_REGION_POOL, chunk_size, 0UL, AXK_VA_FLAG_NONE, &addr ) ) { return NULL; }
+
+    struct axk_pool_block_t* block  = (struct axk_pool_block_t*)( addr );
+    block->prev_size                = 0UL;
+    block->size                     = ( chunk_size - BLOCK_HEADER_SIZE ) | BLOCK_FLAG_FIRST;
+
+    struct axk_pool_block_t* sentinel   = _block_next( block );
+    sentinel->prev_size                 = 0UL;
+    sentinel->size                      = 0UL;
+
+    _mark_free( block );
+    return block;
+}
+
+
+/*
+    Function Implementations
+*/
+void axk_kheap_pool_init( void )
+{
+    axk_spinlock_init( &g_lock );
+
+    g_fl_bitmap     = 0U;
+    g_free_chunks   = 0UL;
+    memset( g_sl_bitmap, 0, sizeof( g_sl_bitmap ) );
+    memset( g_blocks, 0, sizeof( g_blocks ) );
+}
+
+
+void* axk_kheap_pool_alloc( uint64_t size )
+{
+    if( size == 0UL ) { return NULL; }
+
+    uint64_t block_size = ( ( size + ( ALIGN_SIZE - 1UL ) ) & ~( ALIGN_SIZE - 1UL ) ) + BLOCK_HEADER_SIZE;
+    if( block_size < BLOCK_MIN_SIZE ) { block_size = BLOCK_MIN_SIZE; }
+
+    axk_spinlock_acquire( &g_lock );
+
+    struct axk_pool_block_t* block = _find_free( block_size );
+    if( block == NULL )
+    {
+        // Grow the pool by a whole chunk at a time, instead of a page per allocation
+        axk_spinlock_release( &g_lock );
+        struct axk_pool_block_t* chunk = _create_chunk( block_size );
+        axk_spinlock_acquire( &g_lock );
+
+        if( chunk == NULL )
+        {
+            axk_spinlock_release( &g_lock );
+            return NULL;
+        }
+
+        _insert_free( chunk );
+        g_free_chunks++;
+
+        block = _find_free( block_size );
+        if( block == NULL )
+        {
+            axk_spinlock_release( &g_lock );
+            return NULL;
+        }
+    }
+
+    if( _block_is_whole_chunk( block ) ) { g_free_chunks--; }
+    _remove_free( block );
+
+    // Split off the rest of the block if its big enough to be useful
+    uint64_t remaining = _block_size( block ) - block_size;
+    if( remaining >= BLOCK_MIN_SIZE )
+    {
+        _block_set_size( block, block_size );
+
+        struct axk_pool_block_t* rest   = _block_next( block );
+        rest->size                      = remaining;
+
+        _mark_free( rest );
+        _insert_free( rest );
+    }
+
+    _mark_used( block );
+    axk_spinlock_release( &g_lock );
+
+    return (void*)( (uint8_t*)( block ) + BLOCK_HEADER_SIZE );
+}
+
+
+void axk_kheap_pool_free( void* ptr )
+{
+    struct axk_pool_block_t* block = (struct axk_pool_block_t*)( (uint8_t*)( ptr ) - BLOCK_HEADER_SIZE );
+    if( AXK_CHECK_FLAG( block->size, BLOCK_FLAG_FREE ) )
+    {
+        axk_panic( "Kernel Heap: double free detected in the heap pool" );
+    }
+
+    axk_spinlock_acquire( &g_lock );
+
+    // Coalesce with the next block, the chunk sentinel is never free so this cant run off the end
+    struct axk_pool_block_t* next = _block_next( block );
+    if( AXK_CHECK_FLAG( next->size, BLOCK_FLAG_FREE ) )
+    {
+        _remove_free( next );
+        _block_set_size( block, _block_size( block ) + _block_size( next ) );
+    }
+
+    // Coalesce with the previous block, found through the boundary tag, the first block in a chunk never has 'PREV_FREE' set
+    if( AXK_CHECK_FLAG( block->size, BLOCK_FLAG_PREV_FREE ) )
+    {
+        struct axk_pool_block_t* prev = _block_prev( block );
+        _remove_free( prev );
+        _block_set_size( prev, _block_size( prev ) + _block_size( block ) );
+        block = prev;
+    }
+
+    _mark_free( block );
+
+    // If this freed a whole chunk, and we already have enough free chunks, give it back
+    struct axk_pool_block_t* release = NULL;
+    if( _block_is_whole_chunk( block ) )
+    {
+        if( g_free_chunks >= MAX_FREE_CHUNKS ) { release = block; }
+        else { g_free_chunks++; }
+    }
+
+    if( release == NULL ) { _insert_free( block ); }
+    axk_spinlock_release( &g_lock );
+
+    if( release != NULL ) { axk_va_free( (uint64_t)( release ) ); }
+}
+
+
+bool axk_kheap_pool_resize( void* ptr, uint64_t new_size )
+{
+    if( new_size == 0UL ) { return false; }
+
+    uint64_t block_size = ( ( new_size + ( ALIGN_SIZE - 1UL ) ) & ~( ALIGN_SIZE - 1UL ) ) + BLOCK_HEADER_SIZE;
+    if( block_size < BLOCK_MIN_SIZE ) { block_size = BLOCK_MIN_SIZE; }
+
+    struct axk_pool_block_t* block = (struct axk_pool_block_t*)( (uint8_t*)( ptr ) - BLOCK_HEADER_SIZE );
+    axk_spinlock_acquire( &g_lock );
+
+    // To grow, the next block has to be free and large enough to cover the difference, it gets absorbed completely
+    struct axk_pool_block_t* next   = _block_next( block );
+    bool b_next_free                = AXK_CHECK_FLAG( next->size, BLOCK_FLAG_FREE );
+
+    if( block_size > _block_size( block ) )
+    {
+        if( !b_next_free || _block_size( block ) + _block_size( next ) < block_size )
+        {
+            axk_spinlock_release( &g_lock );
+            return false;
+        }
+
+        _remove_free( next );
+        _block_set_size( block, _block_size( block ) + _block_size( next ) );
+        b_next_free = false;
+    }
+
+    // Give back whatever is left over past the new size, if the next block is free it can take any amount, otherwise
+    // the leftover needs to be large enough to become a block of its own
+    uint64_t remaining = _block_size( block ) - block_size;
+    if( b_next_free && remaining > 0UL )
+    {
+        _remove_free( next );
+
+        _block_set_size( block, block_size );
+        struct axk_pool_block_t* rest   = _block_next( block );
+        rest->size                      = remaining + _block_size( next );
+
+        _mark_free( rest );
+        _insert_free( rest );
+    }
+    else if( !b_next_free && remaining >= BLOCK_MIN_SIZE )
+    {
+        _block_set_size( block, block_size );
+        struct axk_pool_block_t* rest   = _block_next( block );
+        rest->size                      = remaining;
+
+        _mark_free( rest );
+        _insert_free( rest );
+    }
+
+    _mark_used( block );
+    axk_spinlock_release( &g_lock );
+
+    return true;
+}
+
+
+uint64_t axk_kheap_pool_size( void* ptr )
+{
+    struct axk_pool_block_t* block = (struct axk_pool_block_t*)( (uint8_t*)( ptr ) - BLOCK_HEADER_SIZE );
+    return( _block_size( block ) - BLOCK_HEADER_SIZE );
+}
\ No newline at end of file
@@ -8,7 +8,8 @@
 #include "axon/memory/page_allocator.h"
 #include "axon/kernel/panic.h"
 #include "axon/gfx/basic_terminal.h"
-#include "axon/library/spinlock.h"
+#include "axon/kernel/klog.h"
+#include "axon/library/mcslock.h"
 
 
 /*
@@ -23,12 +24,13 @@ struct axk_page_info_t
 
 /*
     State
+    * 'g_lock' is only taken by the public functions, which pass their return address to the lock profiler, so the stats show who called them
 */
 static bool g_init              = false;
 static uint8_t* g_page_list     = NULL;
 static uint64_t g_page_count    = 0UL;
 
-static struct axk_spinlock_t g_lock;
+static struct axk_mcslock_t g_lock;
 
 
 /*
@@ -46,7 +48,7 @@ void axk_page_allocator_init( struct tzero_payload_parameters_t* in_params )
     if( g_init ) { return; }
     g_init = true;
 
-    axk_spinlock_init( &g_lock );
+    axk_mcslock_init( &g_lock );
 
     // Determine the total number of pages we need to track state for
     // We do this by finding the highest non-reserved page
@@ -224,13 +226,8 @@ void axk_page_allocator_init( struct tzero_payload_parameters_t* in_params )
     page_info->type         = AXK_PAGE_TYPE_OTHER;
     page_info->process_id   = AXK_PROCESS_INVALID;
 
-    axk_basicterminal_prints( "Page Allocator: Initialized successfully. Total Pages: " );
-    axk_basicterminal_printu64( highest_available_page );
-    axk_basicterminal_prints( ",  Kernel Size: " );
-    axk_basicterminal_printu64( ( kernel_page_count * AXK_PAGE_SIZE ) / 1024UL );
-    axk_basicterminal_prints( "KB  Available Memory: " );
-    axk_basicterminal_printu64( ( ( avail_page_count * AXK_PAGE_SIZE ) / 1024UL ) / 1024UL );
-    axk_basicterminal_prints( "MB\n" );
+    axk_klog( "Page Allocator: Initialized successfully. Total Pages: %lu,  Kernel Size: %luKB  Available Memory: %luMB\n",
+        highest_available_page, ( kernel_page_count * AXK_PAGE_SIZE ) / 1024UL, ( ( avail_page_count * AXK_PAGE_SIZE ) / 1024UL ) / 1024UL );
 }
 
 
@@ -265,7 +262,8 @@ bool axk_page_acquire( uint64_t count, uint64_t* out_page_list, uint32_t process
     uint64_t largest_range_count    = 0UL;
 
     // Acquire lock on the page allocator state
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     for( uint64_t i = 1; i < g_page_count; i++ )
     {
@@ -321,7 +319,7 @@ bool axk_page_acquire( uint64_t count, uint64_t* out_page_list, uint32_t process
     // Check if we didnt find enough consecutive pages
     if( range_count < count )
     {
-        if( b_consecutive ) { return false; }
+        if( b_consecutive ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
 
         // So, lets save the indicies of the pages of the 'largest found range'
         uint64_t range_begin        = largest_range_index;
@@ -353,7 +351,7 @@ bool axk_page_acquire( uint64_t count, uint64_t* out_page_list, uint32_t process
         if( ii < count )
         {
             memset( out_page_list, 0, sizeof( uint64_t ) * count );
-            axk_spinlock_release( &g_lock );
+            axk_mcslock_release( &g_lock, &lock_node );
 
             return false;
         }
@@ -386,7 +384,7 @@ bool axk_page_acquire( uint64_t count, uint64_t* out_page_list, uint32_t process
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -397,18 +395,19 @@ bool axk_page_lock( uint64_t count, uint64_t* in_page_list, uint32_t process, ui
     if( count == 0UL || in_page_list == NULL || process == AXK_PROCESS_INVALID ) { return false; }
 
     // Loop through the list of pages, and check if any are 'unlockable'
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     for( uint64_t i = 0; i < count; i++ )
     {
         uint64_t index = in_page_list[ i ];
-        if( index >= g_page_count ) { axk_spinlock_release( &g_lock ); return false; }
+        if( index >= g_page_count ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
 
         struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( index * 6UL ) );
 
         if( page_info->state != AXK_PAGE_STATE_AVAILABLE )
         {
-            axk_spinlock_release( &g_lock );
+            axk_mcslock_release( &g_lock, &lock_node );
             return false;
         }
     }
@@ -428,7 +427,7 @@ bool axk_page_lock( uint64_t count, uint64_t* in_page_list, uint32_t process, ui
     }
 
     // Release the lock
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -442,20 +441,21 @@ bool axk_page_release( uint64_t count, uint64_t* in_page_list, uint32_t flags )
     bool b_kernel = AXK_CHECK_FLAG( flags, AXK_PAGE_FLAG_KERNEL_REL );
 
     // Acquire lock
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     // Check if all pages are able to be released first
     for( uint64_t i = 0; i < count; i++ )
     {
         uint64_t index = in_page_list[ i ];
-        if( index >= g_page_count ) { axk_spinlock_release( &g_lock ); return false; }
+        if( index >= g_page_count ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
         struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( index * 6UL ) );
 
         // If available or locked, then thats acceptable, but, if its anything else then we will fail
-        if( page_info->state != AXK_PAGE_STATE_LOCKED && page_info->state != AXK_PAGE_STATE_AVAILABLE ) { axk_spinlock_release( &g_lock ); return false; }
+        if( page_info->state != AXK_PAGE_STATE_LOCKED && page_info->state != AXK_PAGE_STATE_AVAILABLE ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
 
         // If the page is a kernel page, and we dont have the 'AXK_PAGE_FLAG_KERNEL_REL' flag then fail
-        if( page_info->process_id == AXK_PROCESS_KERNEL && !b_kernel ) { axk_spinlock_release( &g_lock ); return false; }
+        if( page_info->process_id == AXK_PROCESS_KERNEL && !b_kernel ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
     }
 
     // Loop through each target page in the list, and unlock it
@@ -473,7 +473,7 @@ bool axk_page_release( uint64_t count, uint64_t* in_page_list, uint32_t flags )
     }
 
     // Release the lock
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -485,23 +485,24 @@ bool axk_page_release_s( uint64_t count, uint64_t* in_page_list, uint32_t proces
 
     // Check for any relevant flags
     bool b_kernel = AXK_CHECK_FLAG( flags, AXK_PAGE_FLAG_KERNEL_REL );
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     // Check if the page list is valid
     for( uint64_t i = 0; i < count; i++ )
     {
         uint64_t index = in_page_list[ i ];
-        if( index >= g_page_count ) { axk_spinlock_release( &g_lock ); return false; }
+        if( index >= g_page_count ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
         struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( index * 6UL ) );
 
-        if( page_info->process_id == AXK_PROCESS_KERNEL && process != AXK_PROCESS_KERNEL && !b_kernel ) { axk_spinlock_release( &g_lock ); return false; }
+        if( page_info->process_id == AXK_PROCESS_KERNEL && process != AXK_PROCESS_KERNEL && !b_kernel ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
         if( page_info->state == AXK_PAGE_STATE_LOCKED )
         {
-            if( page_info->process_id != process ) { axk_spinlock_release( &g_lock ); return false; }
+            if( page_info->process_id != process ) { axk_mcslock_release( &g_lock, &lock_node ); return false; }
         }
         else if( page_info->state != AXK_PAGE_STATE_AVAILABLE )
         {
-            axk_spinlock_release( &g_lock );
+            axk_mcslock_release( &g_lock, &lock_node );
             return false;
         }
     }
@@ -517,7 +518,7 @@ bool axk_page_release_s( uint64_t count, uint64_t* in_page_list, uint32_t proces
         page_info->process_id   = AXK_PROCESS_INVALID;
     }
 
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -529,13 +530,14 @@ bool axk_page_status( uint64_t in_page, uint32_t* out_process_id, uint8_t* out_s
     struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( in_page * 6UL ) );
     
     // Acquire spinlock before reading anything
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     if( out_process_id != NULL )    { *out_process_id = page_info->process_id; }
     if( out_state != NULL )         { *out_state = page_info->state; }
     if( out_type != NULL )          { *out_type = page_info->type; }
     
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -549,7 +551,8 @@ bool axk_page_find( uint32_t target_process_id, uint64_t* out_count, uint64_t* o
     *out_count      = 0UL;
     bool b_write    = out_page_list != NULL;
 
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
     for( uint64_t i = 0; i < g_page_count; i++ )
     {
         struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( i * 6UL ) );
@@ -560,7 +563,7 @@ bool axk_page_find( uint32_t target_process_id, uint64_t* out_count, uint64_t* o
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return true;
 }
 
@@ -577,7 +580,8 @@ uint64_t axk_page_reclaim( uint8_t target_state )
     uint64_t ret = 0UL;
     if( target_state != AXK_PAGE_STATE_ACPI && target_state != AXK_PAGE_STATE_BOOTLOADER ) { return ret; }
 
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
     for( uint64_t i = 0; i < g_page_count; i++ )
     {
         struct axk_page_info_t* page_info = (struct axk_page_info_t*)( g_page_list + ( i * 6UL ) );
@@ -591,7 +595,7 @@ uint64_t axk_page_reclaim( uint8_t target_state )
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    axk_mcslock_release( &g_lock, &lock_node );
     return ret;
 }
 
@@ -599,7 +603,8 @@ uint64_t axk_page_reclaim( uint8_t target_state )
 /*
 void axk_page_render_debug( void )
 {
-    axk_spinlock_acquire( &g_lock );
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
 
     // We will draw the state of each page on the screen as a colored bar
     // We will take the total number of pages, and have each represented by a single pixel
@@ -0,0 +1,859 @@
+/*==============================================================
+    Axon Kernel - Kernel Virtual Address Allocator
+    2021, Zachary Berry
+    axon/source/memory/va_allocator.c
+==============================================================*/
+
+#include "axon/memory/memory_private.h"
+#include "axon/memory/va_allocator.h"
+#include "axon/memory/page_allocator.h"
+#include "axon/memory/memory_map.h"
+#include "axon/kernel/panic.h"
+#include "axon/gfx/basic_terminal.h"
+#include "axon/library/mcslock.h"
+
+/*
+    Constants
+*/
+#define EXTENT_RED              0
+#define EXTENT_BLACK            1
+
+#define EXTENT_FLAG_NONE        0x00
+#define EXTENT_FLAG_BACKED      0x01
+
+#define GUARD_SIZE              AXK_PAGE_SIZE
+#define PAGE_BATCH_SIZE         32UL
+
+/*
+    Extent Structure
+    * A node in one of the red-black trees tracking a region, keyed by base address
+    * Free extents store the largest free size found in their subtree in 'max_size', so searching for
+      a large enough range can skip over entire subtrees without visiting them
+    * Used extents include the trailing guard page in 'size'
+*/
+struct axk_va_extent_t
+{
+    uint64_t base;
+    uint64_t size;
+    uint64_t max_size;
+    struct axk_va_extent_t* parent;
+    struct axk_va_extent_t* child[ 2 ];
+    uint8_t color;
+    uint8_t flags;
+};
+
+/*
+    Region Structure
+*/
+struct axk_va_region_t
+{
+    uint64_t begin;
+    uint64_t end;
+    uint64_t free_size;
+    uint8_t page_type;
+    struct axk_va_extent_t* free_root;
+    struct axk_va_extent_t* used_root;
+};
+
+/*
+    State
+    * 'g_lock' is only taken by the public functions, which pass their return address to the lock profiler, so the stats show who called them
+*/
+static bool g_init                                      = false;
+static struct axk_va_region_t g_regions[ AXK_VA_REGION_MAX_INDEX + 1 ];
+static struct axk_va_extent_t* g_extent_pool            = NULL;
+static uint64_t g_extent_pool_count                     = 0UL;
+
+static struct axk_mcslock_t g_lock;
+
+
+/*
+    Extent Pool Functions
+    * Extents are carved out of whole pages accessed through the physical memory mapping, so the allocator
+      never has to call back into itself to get memory for its own bookkeeping
+*/
+static bool _pool_refill( void )
+{
+    uint64_t page;
+    if( !axk_page_acquire( 1UL, &page, AXK_PROCESS_KERNEL, AXK_PAGE_TYPE_OTHER, AXK_PAGE_FLAG_NONE ) ) { return false; }
+
+    struct axk_va_extent_t* list = (struct axk_va_extent_t*)( ( page * AXK_PAGE_SIZE ) + AXK_KERNEL_VA_PHYSICAL );
+    uint64_t count = AXK_PAGE_SIZE / sizeof( struct axk_va_extent_t );
+
+    for( uint64_t i = 0; i < count; i++ )
+    {
+        list[ i ].parent    = g_extent_pool;
+        g_extent_pool       = list + i;
+    }
+
+    g_extent_pool_count += count;
+    return true;
+}
+
+
+static struct axk_va_extent_t* _pool_take( void )
+{
+    struct axk_va_extent_t* ret = g_extent_pool;
+    g_extent_pool = ret->parent;
+    g_extent_pool_count--;
+
+    memset( ret, 0, sizeof( struct axk_va_extent_t ) );
+    return ret;
+}
+
+
+static void _pool_return( struct axk_va_extent_t* in_extent )
+{
+    in_extent->parent   = g_extent_pool;
+    g_extent_pool       = in_extent;
+    g_extent_pool_count++;
+}
+
+
+/*
+    Red-Black Tree Functions
+*/
+static inline uint64_t _max_size( struct axk_va_extent_t* in_node )
+{
+    return in_node == NULL ? 0UL : in_node->max_size;
+}
+
+
+static inline void _update( struct axk_va_extent_t* in_node )
+{
+    uint64_t left   = _max_size( in_node->child[ 0 ] );
+    uint64_t right  = _max_size( in_node->child[ 1 ] );
+    uint64_t max    = in_node->size;
+
+    if( left > max ) { max = left; }
+    if( right > max ) { max = right; }
+    in_node->max_size = max;
+}
+
+
+static void _update_path( struct axk_va_extent_t* in_node )
+{
+    while( in_node != NULL )
+    {
+        _update( in_node );
+        in_node = in_node->parent;
+    }
+}
+
+
+static inline void _replace_child( struct axk_va_extent_t** root, struct axk_va_extent_t* in_old, struct axk_va_extent_t* in_new )
+{
+    if( in_old->parent == NULL ) { *root = in_new; }
+    else { in_old->parent->child[ in_old == in_old->parent->child[ 1 ] ? 1 : 0 ] = in_new; }
+}
+
+
+/*
+    _rotate
+    * Private Function
+    * 'dir' of 0 performs a left rotation (right child moves up), 1 performs a right rotation
+*/
+static void _rotate( struct axk_va_extent_t** root, struct axk_va_extent_t* in_node, int dir )
+{
+    struct axk_va_extent_t* pivot = in_node->child[ 1 - dir ];
+
+    in_node->child[ 1 - dir ] = pivot->child[ dir ];
+    if( pivot->child[ dir ] != NULL ) { pivot->child[ dir ]->parent = in_node; }
+
+    pivot->parent = in_node->parent;
+    _replace_child( root, in_node, pivot );
+
+    pivot->child[ dir ] = in_node;
+    in_node->parent     = pivot;
+
+    // Only these two nodes have different subtrees after the rotation
+    _update( in_node );
+    _update( pivot );
+}
+
+
+static void _insert( struct axk_va_extent_t** root, struct axk_va_extent_t* in_node )
+{
+    // Standard binary search tree insert first
+    struct axk_va_extent_t* parent  = NULL;
+    struct axk_va_extent_t* pos     = *root;
+    int dir = 0;
+
+    while( pos != NULL )
+    {
+        parent  = pos;
+        dir     = in_node->base < pos->base ? 0 : 1;
+        pos     = pos->child[ dir ];
+    }
+
+    in_node->parent     = parent;
+    in_node->child[ 0 ] = NULL;
+    in_node->child[ 1 ] = NULL;
+    in_node->color      = EXTENT_RED;
+
+    if( parent == NULL ) { *root = in_node; }
+    else { parent->child[ dir ] = in_node; }
+
+    _update_path( in_node );
+
+    // Now, rebalance the tree
+    struct axk_va_extent_t* node = in_node;
+    while( node->parent != NULL && node->parent->color == EXTENT_RED )
+    {
+        struct axk_va_extent_t* p   = node->parent;
+        struct axk_va_extent_t* g   = p->parent;
+        int p_dir                   = ( p == g->child[ 1 ] ) ? 1 : 0;
+        struct axk_va_extent_t* u   = g->child[ 1 - p_dir ];
+
+        if( u != NULL && u->color == EXTENT_RED )
+        {
+            p->color    = EXTENT_BLACK;
+            u->color    = EXTENT_BLACK;
+            g->color    = EXTENT_RED;
+            node        = g;
+        }
+        else
+        {
+            if( node == p->child[ 1 - p_dir ] )
+            {
+                _rotate( root, p, p_dir );
+                node    = p;
+                p       = node->parent;
+            }
+
+            p->color = EXTENT_BLACK;
+            g->color = EXTENT_RED;
+            _rotate( root, g, 1 - p_dir );
+        }
+    }
+
+    ( *root )->color = EXTENT_BLACK;
+}
+
+
+static void _erase( struct axk_va_extent_t** root, struct axk_va_extent_t* in_node )
+{
+    struct axk_va_extent_t* child   = NULL;
+    struct axk_va_extent_t* parent  = NULL;
+    uint8_t color                   = EXTENT_BLACK;
+
+    if( in_node->child[ 0 ] != NULL && in_node->child[ 1 ] != NULL )
+    {
+        // Replace the node with its in-order successor
+        struct axk_va_extent_t* next = in_node->child[ 1 ];
+        while( next->child[ 0 ] != NULL ) { next = next->child[ 0 ]; }
+
+        child   = next->child[ 1 ];
+        parent  = next->parent;
+        color   = next->color;
+
+        if( parent == in_node )
+        {
+            parent = next;
+        }
+        else
+        {
+            if( child != NULL ) { child->parent = parent; }
+            parent->child[ 0 ]          = child;
+            next->child[ 1 ]            = in_node->child[ 1 ];
+            in_node->child[ 1 ]->parent = next;
+        }
+
+        next->child[ 0 ]            = in_node->child[ 0 ];
+        in_node->child[ 0 ]->parent = next;
+        next->parent                = in_node->parent;
+        next->color                 = in_node->color;
+        _replace_child( root, in_node, next );
+    }
+    else
+    {
+        child   = in_node->child[ 0 ] != NULL ? in_node->child[ 0 ] : in_node->child[ 1 ];
+        parent  = in_node->parent;
+        color   = in_node->color;
+
+        if( child != NULL ) { child->parent = parent; }
+        _replace_child( root, in_node, child );
+    }
+
+    _update_path( parent );
+
+    // Rebalance if we removed a black node
+    if( color == EXTENT_RED ) { return; }
+
+    while( child != *root && ( child == NULL || child->color == EXTENT_BLACK ) )
+    {
+        int dir                         = ( child == parent->child[ 1 ] ) ? 1 : 0;
+        struct axk_va_extent_t* sibling = parent->child[ 1 - dir ];
+
+        if( sibling->color == EXTENT_RED )
+        {
+            sibling->color  = EXTENT_BLACK;
+            parent->color   = EXTENT_RED;
+            _rotate( root, parent, dir );
+            sibling = parent->child[ 1 - dir ];
+        }
+
+        if( ( sibling->child[ 0 ] == NULL || sibling->child[ 0 ]->color == EXTENT_BLACK ) &&
+            ( sibling->child[ 1 ] == NULL || sibling->child[ 1 ]->color == EXTENT_BLACK ) )
+        {
+            sibling->color  = EXTENT_RED;
+            child           = parent;
+            parent          = child->parent;
+        }
+        else
+        {
+            if( sibling->child[ 1 - dir ] == NULL || sibling->child[ 1 - dir ]->color == EXTENT_BLACK )
+            {
+                sibling->child[ dir ]->color    = EXTENT_BLACK;
+                sibling->color                  = EXTENT_RED;
+                _rotate( root, sibling, 1 - dir );
+                sibling = parent->child[ 1 - dir ];
+            }
+
+            sibling->color  = parent->color;
+            parent->color   = EXTENT_BLACK;
+            if( sibling->child[ 1 - dir ] != NULL ) { sibling->child[ 1 - dir ]->color = EXTENT_BLACK; }
+            _rotate( root, parent, dir );
+
+            child = *root;
+            break;
+        }
+    }
+
+    if( child != NULL ) { child->color = EXTENT_BLACK; }
+}
+
+
+static struct axk_va_extent_t* _find( struct axk_va_extent_t* in_root, uint64_t base )
+{
+    while( in_root != NULL && in_root->base != base )
+    {
+        in_root = in_root->child[ base < in_root->base ? 0 : 1 ];
+    }
+
+    return in_root;
+}
+
+
+static struct axk_va_extent_t* _find_prev( struct axk_va_extent_t* in_root, uint64_t base )
+{
+    // Finds the extent with the highest base address below 'base'
+    struct axk_va_extent_t* ret = NULL;
+    while( in_root != NULL )
+    {
+        if( in_root->base < base )
+        {
+            ret     = in_root;
+            in_root = in_root->child[ 1 ];
+        }
+        else
+        {
+            in_root = in_root->child[ 0 ];
+        }
+    }
+
+    return ret;
+}
+
+
+/*
+    _find_fit
+    * Private Function
+    * Finds the lowest free extent that can hold 'size' bytes starting on an 'align' boundry
+    * Any subtree whose largest extent is too small is skipped entirely
+*/
+static struct axk_va_extent_t* _find_fit( struct axk_va_extent_t* in_node, uint64_t size, uint64_t align, uint64_t* out_base )
+{
+    if( in_node == NULL || in_node->max_size < size ) { return NULL; }
+
+    struct axk_va_extent_t* ret = _find_fit( in_node->child[ 0 ], size, align, out_base );
+    if( ret != NULL ) { return ret; }
+
+    uint64_t aligned_base = ( in_node->base + ( align - 1UL ) ) & ~( align - 1UL );
+    if( in_node->size >= size && aligned_base >= in_node->base && aligned_base - in_node->base <= in_node->size - size )
+    {
+        *out_base = aligned_base;
+        return in_node;
+    }
+
+    return _find_fit( in_node->child[ 1 ], size, align, out_base );
+}
+
+
+/*
+    _release_extent
+    * Private Function
+    * Moves a used extent back into the free tree, merging it with any neighboring free extents
+    * The lock must be held
+*/
+static void _release_extent( struct axk_va_region_t* in_region, struct axk_va_extent_t* in_extent )
+{
+    in_region->free_size += in_extent->size;
+
+    // Check if we can just extend the free extent right before this one
+    struct axk_va_extent_t* merged  = NULL;
+    struct axk_va_extent_t* prev    = _find_prev( in_region->free_root, in_extent->base );
+
+    if( prev != NULL && prev->base + prev->size == in_extent->base )
+    {
+        prev->size  += in_extent->size;
+        merged      = prev;
+        _pool_return( in_extent );
+    }
+    else
+    {
+        in_extent->flags = EXTENT_FLAG_NONE;
+        _insert( &( in_region->free_root ), in_extent );
+        merged = in_extent;
+    }
+
+    // Check if the free extent right after this one can be absorbed
+    struct axk_va_extent_t* next = _find( in_region->free_root, merged->base + merged->size );
+    if( next != NULL )
+    {
+        uint64_t next_size = next->size;
+        _erase( &( in_region->free_root ), next );
+        _pool_return( next );
+
+        merged->size += next_size;
+    }
+
+    _update_path( merged );
+}
+
+
+/*
+    _unmap_range
+    * Private Function
+    * Removes all mappings in a range from the kernel memory map, and optionally releases the pages backing them
+*/
+static void _unmap_range( uint64_t addr, uint64_t page_count, bool b_release )
+{
+    struct axk_memory_map_t* kmap = axk_kmap_get();
+    uint64_t page_batch[ PAGE_BATCH_SIZE ];
+    uint64_t batch_count = 0UL;
+
+    for( uint64_t i = 0; i < page_count; i++ )
+    {
+        uint64_t page;
+
+        axk_memory_map_lock( kmap );
+        bool b_mapped = axk_memory_map_remove( kmap, addr + ( i * AXK_PAGE_SIZE ), &page );
+        axk_memory_map_unlock( kmap );
+
+        if( b_mapped && b_release )
+        {
+            page_batch[ batch_count++ ] = page;
+        }
+
+        if( batch_count == PAGE_BATCH_SIZE || ( i == page_count - 1UL && batch_count > 0UL ) )
+        {
+            if( !axk_page_release_s( batch_count, page_batch, AXK_PROCESS_KERNEL, AXK_PAGE_FLAG_NONE ) )
+            {
+                axk_basicterminal_prints( "[WARNING] VA Allocator: Failed to release pages backing a kernel range!\n" );
+            }
+
+            batch_count = 0UL;
+        }
+    }
+}
+
+
+/*
+    _map_range
+    * Private Function
+    * Backs a range with physical pages, we acquire them in small batches so we dont need a huge list and they dont need to be contiguous
+    * Returns false if we ran out of pages, 'out_count' is set to the number of pages that were mapped either way
+*/
+static bool _map_range( struct axk_va_region_t* in_region, uint64_t addr, uint64_t page_count, bool b_clear, uint64_t* out_count )
+{
+    struct axk_memory_map_t* kmap   = axk_kmap_get();
+    uint64_t page_batch[ PAGE_BATCH_SIZE ];
+    uint32_t page_flags             = b_clear ? AXK_PAGE_FLAG_CLEAR : AXK_PAGE_FLAG_NONE;
+    uint32_t map_flags              = AXK_MAP_FLAG_NO_EXEC | AXK_MAP_FLAG_GLOBAL | AXK_MAP_FLAG_KERNEL_ONLY;
+    uint64_t mapped_count           = 0UL;
+    bool b_failed                   = false;
+
+    while( mapped_count < page_count && !b_failed )
+    {
+        uint64_t batch_count = page_count - mapped_count;
+        if( batch_count > PAGE_BATCH_SIZE ) { batch_count = PAGE_BATCH_SIZE; }
+
+        if( !axk_page_acquire( batch_count, page_batch, AXK_PROCESS_KERNEL, in_region->page_type, page_flags ) )
+        {
+            b_failed = true;
+            break;
+        }
+
+        axk_memory_map_lock( kmap );
+        for( uint64_t i = 0; i < batch_count; i++ )
+        {
+            if( !axk_memory_map_add( kmap, addr + ( mapped_count * AXK_PAGE_SIZE ), page_batch[ i ], NULL, map_flags ) )
+            {
+                // Release the pages from this batch we didnt get to map
+                axk_page_release_s( batch_count - i, page_batch + i, AXK_PROCESS_KERNEL, AXK_PAGE_FLAG_NONE );
+                b_failed = true;
+                break;
+            }
+
+            mapped_count++;
+        }
+        axk_memory_map_unlock( kmap );
+    }
+
+    *out_count = mapped_count;
+    return !b_failed;
+}
+
+
+/*
+    _find_region
+    * Private Function
+    * Gets the region an address belongs to, or NULL if its outside of every region
+*/
+static struct axk_va_region_t* _find_region( uint64_t addr )
+{
+    for( uint8_t i = 0; i <= AXK_VA_REGION_MAX_INDEX; i++ )
+    {
+        if( addr >= g_regions[ i ].begin && addr < g_regions[ i ].end ) { return g_regions + i; }
+    }
+
+    return NULL;
+}
+
+
+/*
+    Function Implementations
+*/
+void axk_va_allocator_init( void )
+{
+    // Guard against this being called twice
+    if( g_init ) { return; }
+    g_init = true;
+
+    axk_mcslock_init( &g_lock );
+    memset( g_regions, 0, sizeof( g_regions ) );
+
+    g_regions[ AXK_VA_REGION_HEAP ].begin       = AXK_KERNEL_VA_HEAP;
+    g_regions[ AXK_VA_REGION_HEAP ].end         = AXK_KERNEL_VA_POOL;
+    g_regions[ AXK_VA_REGION_HEAP ].page_type   = AXK_PAGE_TYPE_HEAP;
+
+    g_regions[ AXK_VA_REGION_POOL ].begin       = AXK_KERNEL_VA_POOL;
+    g_regions[ AXK_VA_REGION_POOL ].end         = AXK_KERNEL_VA_SLAB;
+    g_regions[ AXK_VA_REGION_POOL ].page_type   = AXK_PAGE_TYPE_HEAP;
+
+    g_regions[ AXK_VA_REGION_SLAB ].begin       = AXK_KERNEL_VA_SLAB;
+    g_regions[ AXK_VA_REGION_SLAB ].end         = AXK_KERNEL_VA_SHARED;
+    g_regions[ AXK_VA_REGION_SLAB ].page_type   = AXK_PAGE_TYPE_HEAP;
+
+    g_regions[ AXK_VA_REGION_SHARED ].begin     = AXK_KERNEL_VA_SHARED;
+    g_regions[ AXK_VA_REGION_SHARED ].end       = AXK_KERNEL_VA_IMAGE;
+    g_regions[ AXK_VA_REGION_SHARED ].page_type = AXK_PAGE_TYPE_SHARED;
+
+    if( !_pool_refill() )
+    {
+        axk_panic( "VA Allocator: Failed to acquire a page for extent tracking" );
+    }
+
+    // Each region starts out as a single free extent covering the whole range
+    for( uint8_t i = 0; i <= AXK_VA_REGION_MAX_INDEX; i++ )
+    {
+        struct axk_va_region_t* region = g_regions + i;
+        struct axk_va_extent_t* extent = _pool_take();
+
+        extent->base        = region->begin;
+        extent->size        = region->end - region->begin;
+        region->free_size   = extent->size;
+
+        _insert( &( region->free_root ), extent );
+    }
+
+    axk_basicterminal_prints( "VA Allocator: Initialized successfully. Heap Range: " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_HEAP ].begin, true );
+    axk_basicterminal_prints( " to " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_HEAP ].end, true );
+    axk_basicterminal_prints( "  Pool Range: " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_POOL ].begin, true );
+    axk_basicterminal_prints( " to " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_POOL ].end, true );
+    axk_basicterminal_prints( "  Slab Range: " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_SLAB ].begin, true );
+    axk_basicterminal_prints( " to " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_SLAB ].end, true );
+    axk_basicterminal_prints( "  Shared Range: " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_SHARED ].begin, true );
+    axk_basicterminal_prints( " to " );
+    axk_basicterminal_printh64( g_regions[ AXK_VA_REGION_SHARED ].end, true );
+    axk_basicterminal_printnl();
+}
+
+
+bool axk_va_alloc( uint8_t region, uint64_t size, uint64_t align, uint32_t flags, uint64_t* out_addr )
+{
+    // Validate the parameters
+    if( region > AXK_VA_REGION_MAX_INDEX || size == 0UL || out_addr == NULL || ( align & ( align - 1UL ) ) != 0UL ) { return false; }
+
+    // Anything larger than the region can never fit, and checking before rounding up keeps a huge size from wrapping around
+    struct axk_va_region_t* target = g_regions + region;
+    if( size > target->end - target->begin ) { return false; }
+
+    uint64_t page_count     = ( size + ( AXK_PAGE_SIZE - 1UL ) ) / AXK_PAGE_SIZE;
+    uint64_t total_size     = ( page_count * AXK_PAGE_SIZE ) + GUARD_SIZE;
+    bool b_reserve          = AXK_CHECK_FLAG( flags, AXK_VA_FLAG_RESERVE_ONLY );
+    bool b_clear            = AXK_CHECK_FLAG( flags, AXK_VA_FLAG_CLEAR );
+
+    if( align < AXK_PAGE_SIZE ) { align = AXK_PAGE_SIZE; }
+
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+
+    // Splitting a free extent can take up to two new nodes (one for the allocation, one for the space after it)
+    if( g_extent_pool_count < 2UL && !_pool_refill() )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+        return false;
+    }
+
+    uint64_t base = 0UL;
+    struct axk_va_extent_t* free_extent = _find_fit( target->free_root, total_size, align, &base );
+    if( free_extent == NULL )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+        return false;
+    }
+
+    // Split the free extent, whatever is left before the aligned base stays in the original node
+    uint64_t free_end   = free_extent->base + free_extent->size;
+    uint64_t used_end   = base + total_size;
+
+    if( base == free_extent->base )
+    {
+        if( used_end == free_end )
+        {
+            _erase( &( target->free_root ), free_extent );
+            _pool_return( free_extent );
+        }
+        else
+        {
+            // The ordering of the tree doesnt change, since the new base is still below the next free extent
+            free_extent->base = used_end;
+            free_extent->size = free_end - used_end;
+            _update_path( free_extent );
+        }
+    }
+    else
+    {
+        free_extent->size = base - free_extent->base;
+        _update_path( free_extent );
+
+        if( used_end < free_end )
+        {
+            struct axk_va_extent_t* after = _pool_take();
+            after->base = used_end;
+            after->size = free_end - used_end;
+            _insert( &( target->free_root ), after );
+        }
+    }
+
+    struct axk_va_extent_t* used = _pool_take();
+    used->base  = base;
+    used->size  = total_size;
+    used->flags = b_reserve ? EXTENT_FLAG_NONE : EXTENT_FLAG_BACKED;
+
+    _insert( &( target->used_root ), used );
+    target->free_size -= total_size;
+
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    // Back the range with physical pages
+    if( !b_reserve )
+    {
+        uint64_t mapped_count = 0UL;
+        if( !_map_range( target, base, page_count, b_clear, &mapped_count ) )
+        {
+            _unmap_range( base, mapped_count, true );
+
+            axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+            _erase( &( target->used_root ), used );
+            _release_extent( target, used );
+            axk_mcslock_release( &g_lock, &lock_node );
+
+            return false;
+        }
+    }
+
+    *out_addr = base;
+    return true;
+}
+
+
+bool axk_va_free( uint64_t addr )
+{
+    struct axk_va_region_t* target = _find_region( addr );
+    if( target == NULL ) { return false; }
+
+    // Pull the extent out of the used tree first, so nobody else can free it while were unmapping
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+
+    struct axk_va_extent_t* used = _find( target->used_root, addr );
+    if( used == NULL )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+        return false;
+    }
+
+    _erase( &( target->used_root ), used );
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    // The guard page is never mapped, so we can skip it
+    _unmap_range( used->base, ( used->size - GUARD_SIZE ) / AXK_PAGE_SIZE, AXK_CHECK_FLAG( used->flags, EXTENT_FLAG_BACKED ) );
+
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+    _release_extent( target, used );
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    return true;
+}
+
+
+bool axk_va_resize( uint64_t addr, uint64_t new_size, uint32_t flags )
+{
+    struct axk_va_region_t* target = _find_region( addr );
+    if( target == NULL || new_size == 0UL || new_size > target->end - target->begin ) { return false; }
+
+    uint64_t new_total = ( ( ( new_size + ( AXK_PAGE_SIZE - 1UL ) ) / AXK_PAGE_SIZE ) * AXK_PAGE_SIZE ) + GUARD_SIZE;
+
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+
+    // One spare extent is taken up front, for the space given up by a shrink, or to give the space back if backing a grow fails
+    struct axk_va_extent_t* used = _find( target->used_root, addr );
+    if( used == NULL || ( g_extent_pool_count < 1UL && !_pool_refill() ) )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+        return false;
+    }
+
+    uint64_t old_total  = used->size;
+    bool b_backed       = AXK_CHECK_FLAG( used->flags, EXTENT_FLAG_BACKED );
+
+    if( new_total == old_total )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+        return true;
+    }
+
+    struct axk_va_extent_t* spare = _pool_take();
+
+    if( new_total < old_total )
+    {
+        axk_mcslock_release( &g_lock, &lock_node );
+
+        // The first page past the new end becomes the guard page, so its unmapped along with the rest of the tail
+        _unmap_range( used->base + new_total - GUARD_SIZE, ( old_total - new_total ) / AXK_PAGE_SIZE, b_backed );
+
+        axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+        used->size  = new_total;
+        spare->base = used->base + new_total;
+        spare->size = old_total - new_total;
+        _release_extent( target, spare );
+        axk_mcslock_release( &g_lock, &lock_node );
+
+        return true;
+    }
+
+    // Growing takes the space from the free extent that starts right after the guard page
+    uint64_t grow_size              = new_total - old_total;
+    struct axk_va_extent_t* next    = _find( target->free_root, used->base + old_total );
+
+    if( next == NULL || next->size < grow_size )
+    {
+        _pool_return( spare );
+        axk_mcslock_release( &g_lock, &lock_node );
+        return false;
+    }
+
+    if( next->size == grow_size )
+    {
+        _erase( &( target->free_root ), next );
+        _pool_return( next );
+    }
+    else
+    {
+        // The ordering of the tree doesnt change, since the new base is still below the next free extent
+        next->base += grow_size;
+        next->size -= grow_size;
+        _update_path( next );
+    }
+
+    used->size          = new_total;
+    target->free_size   -= grow_size;
+
+    if( !b_backed )
+    {
+        _pool_return( spare );
+        axk_mcslock_release( &g_lock, &lock_node );
+        return true;
+    }
+
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    // The old guard page is the first of the new pages, the new guard page is the last page we just took, and stays unmapped
+    uint64_t old_end        = used->base + old_total - GUARD_SIZE;
+    uint64_t mapped_count   = 0UL;
+    bool b_mapped           = _map_range( target, old_end, grow_size / AXK_PAGE_SIZE, AXK_CHECK_FLAG( flags, AXK_VA_FLAG_CLEAR ), &mapped_count );
+
+    if( !b_mapped ) { _unmap_range( old_end, mapped_count, true ); }
+
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+    if( b_mapped )
+    {
+        _pool_return( spare );
+    }
+    else
+    {
+        used->size  = old_total;
+        spare->base = used->base + old_total;
+        spare->size = grow_size;
+        _release_extent( target, spare );
+    }
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    return b_mapped;
+}
+
+
+bool axk_va_size( uint64_t addr, uint64_t* out_size )
+{
+    if( out_size == NULL ) { return false; }
+
+    for( uint8_t i = 0; i <= AXK_VA_REGION_MAX_INDEX; i++ )
+    {
+        if( addr >= g_regions[ i ].begin && addr < g_regions[ i ].end )
+        {
+            struct axk_mcslock_node_t lock_node;
+            axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+            struct axk_va_extent_t* used = _find( g_regions[ i ].used_root, addr );
+            if( used != NULL ) { *out_size = used->size - GUARD_SIZE; }
+            axk_mcslock_release( &g_lock, &lock_node );
+
+            return( used != NULL );
+        }
+    }
+
+    return false;
+}
+
+
+uint64_t axk_va_available( uint8_t region )
+{
+    if( region > AXK_VA_REGION_MAX_INDEX ) { return 0UL; }
+
+    struct axk_mcslock_node_t lock_node;
+    axk_mcslock_acquire_at( &g_lock, &lock_node, __builtin_return_address( 0 ) );
+    uint64_t ret = g_regions[ region ].free_size;
+    axk_mcslock_release( &g_lock, &lock_node );
+
+    return ret;
+}
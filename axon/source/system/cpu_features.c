@@ -0,0 +1,142 @@
+/*==============================================================
+    Axon Kernel - CPU Features & Dispatch
+    2021, Zachary Berry
+    axon/source/system/cpu_features.c
+==============================================================*/
+
+#include "axon/system/cpu_features_private.h"
+#include "axon/kernel/klog.h"
+
+#ifdef __x86_64__
+#include "axon/arch_x86/util.h"
+#endif
+
+/*
+    Linker Symbols
+    * Bounds of the '.axk_dispatch' section, which holds every candidate from the kernel and libk
+*/
+extern const struct axk_dispatch_candidate_t axk_dispatch_begin[];
+extern const struct axk_dispatch_candidate_t axk_dispatch_end[];
+
+/*
+    State
+*/
+static uint64_t g_features;
+
+
+#ifdef __x86_64__
+/*
+    _read_xcr0
+    * Private Function
+    * Reads the extended control register that says which register state the OS has enabled, only valid if OSXSAVE is set
+*/
+static uint64_t _read_xcr0( void )
+{
+    uint32_t low, high;
+    __asm__ volatile( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0U ) );
+
+    return ( (uint64_t)( high ) << 32 ) | (uint64_t)( low );
+}
+
+
+/*
+    _detect_features
+    * Private Function
+    * Reads the feature flags from CPUID
+*/
+static uint64_t _detect_features( void )
+{
+    uint64_t ret = 0UL;
+
+    uint32_t eax = 0U, ebx = 0U, ecx = 0U, edx = 0U;
+    axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+    uint32_t max_leaf = eax;
+
+    bool b_avx_state        = false;
+    bool b_avx512_state     = false;
+
+    if( max_leaf >= 0x01U )
+    {
+        eax = 0x01U; ecx = 0U;
+        axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+
+        if( ecx & ( 1U << 0 ) )     { ret |= AXK_CPU_FEATURE_SSE3; }
+        if( ecx & ( 1U << 9 ) )     { ret |= AXK_CPU_FEATURE_SSSE3; }
+        if( ecx & ( 1U << 19 ) )    { ret |= AXK_CPU_FEATURE_SSE41; }
+        if( ecx & ( 1U << 20 ) )    { ret |= AXK_CPU_FEATURE_SSE42; }
+        if( ecx & ( 1U << 23 ) )    { ret |= AXK_CPU_FEATURE_POPCNT; }
+
+        // AVX registers are only usable if the OS enabled their state (SSE, AVX and for AVX-512 the opmask/ZMM state) in XCR0
+        if( ecx & ( 1U << 27 ) )
+        {
+            uint64_t xcr0 = _read_xcr0();
+            b_avx_state     = ( ( xcr0 & 0x06UL ) == 0x06UL );
+            b_avx512_state  = ( ( xcr0 & 0xE6UL ) == 0xE6UL );
+        }
+
+        if( b_avx_state && ( ecx & ( 1U << 28 ) ) ) { ret |= AXK_CPU_FEATURE_AVX; }
+    }
+
+    if( max_leaf >= 0x07U )
+    {
+        eax = 0x07U; ecx = 0U;
+        axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+
+        if( ebx & ( 1U << 3 ) )     { ret |= AXK_CPU_FEATURE_BMI1; }
+        if( ebx & ( 1U << 8 ) )     { ret |= AXK_CPU_FEATURE_BMI2; }
+        if( ebx & ( 1U << 9 ) )     { ret |= AXK_CPU_FEATURE_ERMS; }
+        if( edx & ( 1U << 4 ) )     { ret |= AXK_CPU_FEATURE_FSRM; }
+
+        if( b_avx_state && ( ebx & ( 1U << 5 ) ) )        { ret |= AXK_CPU_FEATURE_AVX2; }
+        if( b_avx512_state && ( ebx & ( 1U << 16 ) ) )    { ret |= AXK_CPU_FEATURE_AVX512F; }
+    }
+
+    // Extended leaves
+    eax = 0x80000000U; ecx = 0U;
+    axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+    uint32_t max_ext_leaf = eax;
+
+    if( max_ext_leaf >= 0x80000001U )
+    {
+        eax = 0x80000001U; ecx = 0U;
+        axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+
+        if( ecx & ( 1U << 5 ) )     { ret |= AXK_CPU_FEATURE_LZCNT; }
+    }
+
+    if( max_ext_leaf >= 0x80000008U )
+    {
+        eax = 0x80000008U; ecx = 0U;
+        axk_x86_cpuid( &eax, &ebx, &ecx, &edx );
+
+        if( ebx & ( 1U << 0 ) )     { ret |= AXK_CPU_FEATURE_CLZERO; }
+    }
+
+    return ret;
+}
+#endif
+
+
+void axk_cpu_features_init( void )
+{
+#ifdef __x86_64__
+    g_features = _detect_features();
+#endif
+
+    // Point each slot at its best candidate
+    uint32_t patch_count = axk_dispatch_resolve( axk_dispatch_begin, axk_dispatch_end, g_features );
+
+    axk_klog( "CPU Features: Detected feature set 0x%016lX, %u dispatch slot(s) patched\n", g_features, patch_count );
+}
+
+
+uint64_t axk_cpu_get_features( void )
+{
+    return g_features;
+}
+
+
+bool axk_cpu_has_features( uint64_t features )
+{
+    return ( g_features & features ) == features;
+}
\ No newline at end of file
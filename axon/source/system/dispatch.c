@@ -0,0 +1,56 @@
+/*==============================================================
+    Axon Kernel - Dispatch Resolution
+    2021, Zachary Berry
+    axon/source/system/dispatch.c
+==============================================================*/
+
+#include "axon/system/cpu_features_private.h"
+
+
+/*
+    _is_usable
+    * Private Function
+    * Checks if every feature a candidate requires is present
+*/
+static inline bool _is_usable( const struct axk_dispatch_candidate_t* candidate, uint64_t features )
+{
+    return ( candidate->features & features ) == candidate->features;
+}
+
+
+/*
+    _is_best_candidate
+    * Private Function
+    * Checks if a usable candidate beats every other usable candidate for the same slot, ties go to the first one in the table
+*/
+static bool _is_best_candidate( const struct axk_dispatch_candidate_t* begin, const struct axk_dispatch_candidate_t* end,
+                                const struct axk_dispatch_candidate_t* candidate, uint64_t features )
+{
+    for( const struct axk_dispatch_candidate_t* other = begin; other < end; other++ )
+    {
+        if( other == candidate || other->slot != candidate->slot ) { continue; }
+        if( !_is_usable( other, features ) ) { continue; }
+
+        if( other->priority > candidate->priority ) { return false; }
+        if( other->priority == candidate->priority && other < candidate ) { return false; }
+    }
+
+    return true;
+}
+
+
+uint32_t axk_dispatch_resolve( const struct axk_dispatch_candidate_t* begin, const struct axk_dispatch_candidate_t* end, uint64_t features )
+{
+    // Slots without a usable candidate keep their baseline implementation
+    uint32_t patch_count = 0U;
+    for( const struct axk_dispatch_candidate_t* candidate = begin; candidate < end; candidate++ )
+    {
+        if( !_is_usable( candidate, features ) ) { continue; }
+        if( !_is_best_candidate( begin, end, candidate, features ) ) { continue; }
+
+        *( candidate->slot ) = candidate->fn;
+        patch_count++;
+    }
+
+    return patch_count;
+}
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "axon/system/sysinfo_private.h"
 #include "axon/system/sysinfo.h"
+#include "axon/kernel/percpu.h"
 //#include "axon/library/rbtree.h"
 #include "axon/library/spinlock.h"
 #include "axon/library/atomic.h"
@@ -26,7 +27,7 @@ struct axk_sysinfo_frame_t
 */
 static struct axk_spinlock_t g_container_lock;
 //static struct axk_rbtree_t g_container;
-static struct axk_atomic_uint64_t g_counters[ AXK_COUNTER_MAX_INDEX + 1 ];
+static struct axk_atomic_uint32_t g_counter_count;
 
 /*
     Initialize System Info State
@@ -46,10 +47,8 @@ bool axk_sysinfo_init( void )
 
 void axk_counters_init( void )
 {
-    for( uint32_t i = 0; i <= AXK_COUNTER_MAX_INDEX; i++ )
-    {
-        axk_atomic_store_uint64( g_counters + i, 0UL, MEMORY_ORDER_SEQ_CST );
-    }
+    // The counter slots live in the per-cpu areas, which are zeroed when created
+    axk_atomic_store_uint32_relaxed( &g_counter_count, AXK_COUNTER_BUILTIN_COUNT );
 }
 
 /*
@@ -101,31 +100,83 @@ bool axk_sysinfo_query( uint32_t index, uint32_t sub_index, void* out_data, uint
 */
 /*
     System Counter Functions
+    * Counters are only statistics, no other memory accesses are ordered against them, so every operation is relaxed
+    * Updates go to the current processor's slot with a plain (non-locked) add, the total is only computed when read
 */
-uint64_t axk_counter_increment( uint32_t index, uint64_t diff )
+bool axk_counter_register( uint32_t* out_index )
+{
+    if( out_index == NULL ) { return false; }
+
+    uint32_t count = axk_atomic_load_uint32_relaxed( &g_counter_count );
+    do
+    {
+        if( count >= AXK_COUNTER_CAPACITY ) { return false; }
+    }
+    while( !axk_atomic_cmpexchg_uint32_relaxed( &g_counter_count, &count, count + 1U ) );
+
+    // The slots were zeroed during init, and nothing can write to an index until its been handed out
+    *out_index = count;
+    return true;
+}
+
+
+static inline bool _is_registered( uint32_t index )
+{
+    return( index < axk_atomic_load_uint32_relaxed( &g_counter_count ) );
+}
+
+
+static inline void _slot_add( uint32_t index, uint64_t diff )
 {
-    if( index > AXK_COUNTER_MAX_INDEX ) { return 0UL; }
-    return( axk_atomic_fetch_add_uint64( g_counters + index, diff, MEMORY_ORDER_SEQ_CST ) + diff );
+    // A single read-modify-write instruction cant be split by an interrupt, and no other processor writes this slot
+    AXK_PERCPU_ADD( counters[ index ].val, diff );
 }
 
 
-uint64_t axk_counter_decrement( uint32_t index, uint64_t diff )
+void axk_counter_increment( uint32_t index, uint64_t diff )
 {
-    if( index > AXK_COUNTER_MAX_INDEX ) { return 0UL; }
-    return( axk_atomic_fetch_sub_uint64( g_counters + index, diff, MEMORY_ORDER_SEQ_CST ) - diff );
+    if( !_is_registered( index ) ) { return; }
+    _slot_add( index, diff );
+}
+
+
+void axk_counter_decrement( uint32_t index, uint64_t diff )
+{
+    if( !_is_registered( index ) ) { return; }
+    _slot_add( index, 0UL - diff );
 }
 
 
 uint64_t axk_counter_write( uint32_t index, uint64_t value )
 {
-    if( index > AXK_COUNTER_MAX_INDEX ) { return 0UL; }
-    axk_atomic_store_uint64( g_counters + index, value, MEMORY_ORDER_SEQ_CST );
+    if( !_is_registered( index ) ) { return 0UL; }
+
+    uint32_t this_cpu = axk_get_cpu_index();
+    for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+    {
+        struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+        if( ptr_area == NULL ) { continue; }
+
+        axk_atomic_store_uint64_relaxed( ptr_area->counters + index, cpu == this_cpu ? value : 0UL );
+    }
+
     return value;
 }
 
 
 uint64_t axk_counter_read( uint32_t index )
 {
-    if( index > AXK_COUNTER_MAX_INDEX ) { return 0UL; }
-    return axk_atomic_load_uint64( g_counters + index, MEMORY_ORDER_SEQ_CST );
+    if( !_is_registered( index ) ) { return 0UL; }
+
+    // Slots are allowed to wrap individually (i.e. decremented on a different processor than incremented), the sum still works out
+    uint64_t total = 0UL;
+    for( uint32_t cpu = 0; cpu < AXK_MAX_CPUS; cpu++ )
+    {
+        struct axk_percpu_t* ptr_area = axk_percpu_get( cpu );
+        if( ptr_area == NULL ) { continue; }
+
+        total += axk_atomic_load_uint64_relaxed( ptr_area->counters + index );
+    }
+
+    return total;
 }
\ No newline at end of file
@@ -156,16 +156,26 @@ void tree_insert_node( struct axk_rbtree_t* t, struct axk_rbtree_node_t* p, stru
 }
 
 
-void node_destroy( struct axk_rbtree_node_t* n, void( *fn_finalize )( void* ) )
+struct axk_rbtree_node_t* node_alloc( struct axk_rbtree_t* t )
+{
+    uint64_t size = sizeof( struct axk_rbtree_node_t ) + t->elem_size;
+    if( t->allocator == NULL ) { return (struct axk_rbtree_node_t*) malloc( size ); }
+
+    return (struct axk_rbtree_node_t*) t->allocator->fn_alloc( t->allocator->context, size, false );
+}
+
+
+void node_destroy( struct axk_rbtree_t* t, struct axk_rbtree_node_t* n )
 {
     if( n != NULL )
     {
-        if( fn_finalize != NULL )
+        if( t->fn_finalize != NULL )
         {
-            fn_finalize( (void*)( (uint8_t*)( n ) + sizeof( struct axk_rbtree_node_t ) ) );
+            t->fn_finalize( (void*)( (uint8_t*)( n ) + sizeof( struct axk_rbtree_node_t ) ) );
         }
 
-        free( n );
+        if( t->allocator == NULL ) { free( n ); }
+        else { t->allocator->fn_free( t->allocator->context, n ); }
     }
 }
 
@@ -199,7 +209,7 @@ void tree_delete( struct axk_rbtree_t* t, struct axk_rbtree_node_t* n )
         t->root     = NULL;
         t->count    = 0UL;
 
-        node_destroy( n, t->fn_finalize );
+        node_destroy( t, n );
         return;
     }
 
@@ -262,7 +272,7 @@ void tree_delete( struct axk_rbtree_t* t, struct axk_rbtree_node_t* n )
         uint8_t dir = node_get_dir_from_parent( n );
         n->parent->child[ dir ] = NULL;
 
-        node_destroy( n, t->fn_finalize );
+        node_destroy( t, n );
         t->count--;
         return;
     }
@@ -286,7 +296,7 @@ void tree_delete( struct axk_rbtree_t* t, struct axk_rbtree_node_t* n )
                 ch->parent = NULL;
             }
 
-            node_destroy( n, t->fn_finalize );
+            node_destroy( t, n );
             t->count--;
             return;
         }
@@ -300,7 +310,7 @@ void tree_delete( struct axk_rbtree_t* t, struct axk_rbtree_node_t* n )
 
     dir = node_get_dir_from_parent( n );
     p->child[ dir ] = NULL;
-    node_destroy( n, t->fn_finalize );
+    node_destroy( t, n );
 
     goto start_loop;
 
@@ -438,6 +448,12 @@ void* axk_rbtree_read_iterator( struct axk_rbtree_iterator_t* in_iter )
 
 
 void axk_rbtree_create( struct axk_rbtree_t* in_handle, uint64_t elem_size, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) )
+{
+    axk_rbtree_create_with_allocator( in_handle, elem_size, NULL, copy_func, finalize_func );
+}
+
+
+void axk_rbtree_create_with_allocator( struct axk_rbtree_t* in_handle, uint64_t elem_size, struct axk_allocator_t* allocator, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) )
 {
     if( in_handle == NULL ) { axk_panic( "Kernel Containers: attempt to create an rbtree with a NULL handle" ); }
     if( elem_size == 0UL )  { axk_panic( "Kernel Containers; attempt to create an rbtree with an invalid element size" ); }
@@ -454,6 +470,7 @@ void axk_rbtree_create( struct axk_rbtree_t* in_handle, uint64_t elem_size, void
     in_handle->elem_size    = elem_size;
     in_handle->fn_copy      = copy_func;
     in_handle->fn_finalize  = finalize_func;
+    in_handle->allocator    = allocator;
 }
 
 
@@ -469,6 +486,7 @@ void axk_rbtree_destroy( struct axk_rbtree_t* in_handle )
         in_handle->elem_size    = 0UL;
         in_handle->fn_finalize  = NULL;
         in_handle->fn_copy      = NULL;
+        in_handle->allocator    = NULL;
     }
 }
 
@@ -481,10 +499,10 @@ void axk_rbtree_copy( struct axk_rbtree_t* source_handle, struct axk_rbtree_t* d
 
     // Recreate the destination tree using the parameters from the source tree
     if( source_handle == NULL ) { return; }
-    axk_rbtree_create( dest_handle, source_handle->elem_size, source_handle->fn_copy, source_handle->fn_finalize );
+    axk_rbtree_create_with_allocator( dest_handle, source_handle->elem_size, source_handle->allocator, source_handle->fn_copy, source_handle->fn_finalize );
 
     // Copy the root node into the destination tree
-    dest_handle->root   = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + source_handle->elem_size );
+    dest_handle->root   = node_alloc( dest_handle );
     dest_handle->count  = 1UL;
 
     node_copy( dest_handle->root, source_handle->root, source_handle->fn_copy, source_handle->elem_size );
@@ -503,7 +521,7 @@ void axk_rbtree_copy( struct axk_rbtree_t* source_handle, struct axk_rbtree_t* d
     AXK_ZERO_MEM( stack );
 
     int max_height = log2_64( source_handle->count );
-    axk_vector_create_with_capacity( &stack, sizeof( void* ), ( max_height <= 1 ? 1UL : (uint64_t)( max_height ) ) * 2UL, NULL, NULL );
+    axk_vector_create_with_allocator( &stack, sizeof( void* ), ( max_height <= 1 ? 1UL : (uint64_t)( max_height ) ) * 2UL, source_handle->allocator, NULL, NULL );
     
     // Push source, then dest node onto the stack
     axk_vector_push_back( &stack, &( source_node ) );
@@ -514,7 +532,7 @@ void axk_rbtree_copy( struct axk_rbtree_t* source_handle, struct axk_rbtree_t* d
         source_node = source_node->child[ DIR_LEFT ];
 
         // Copy the next node
-        dest_node->child[ DIR_LEFT ] = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + source_handle->elem_size );
+        dest_node->child[ DIR_LEFT ] = node_alloc( dest_handle );
         node_copy( dest_node->child[ DIR_LEFT ], source_node, source_handle->fn_copy, source_handle->elem_size );
 
         if( source_node == source_handle->leftmost )
@@ -538,7 +556,7 @@ void axk_rbtree_copy( struct axk_rbtree_t* source_handle, struct axk_rbtree_t* d
         if( source_node->child[ DIR_RIGHT ] != NULL )
         {
             // Copy node to dest tree
-            dest_node->child[ DIR_RIGHT ] = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + source_handle->elem_size );
+            dest_node->child[ DIR_RIGHT ] = node_alloc( dest_handle );
             node_copy( dest_node->child[ DIR_RIGHT ], source_node->child[ DIR_RIGHT ], source_handle->fn_copy, source_handle->elem_size );
 
             if( source_node->child[ DIR_RIGHT ] == source_handle->leftmost )
@@ -563,7 +581,7 @@ void axk_rbtree_copy( struct axk_rbtree_t* source_handle, struct axk_rbtree_t* d
             while( source_node->child[ DIR_LEFT ] != NULL )
             {
                 // Copy this node in
-                dest_node->child[ DIR_LEFT ] = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + source_handle->elem_size );
+                dest_node->child[ DIR_LEFT ] = node_alloc( dest_handle );
                 node_copy( dest_node->child[ DIR_LEFT ], source_node->child[ DIR_LEFT ], source_handle->fn_copy, source_handle->elem_size );
 
                 if( source_node->child[ DIR_LEFT ] == source_handle->leftmost )
@@ -615,7 +633,7 @@ void axk_rbtree_clear( struct axk_rbtree_t* in_handle )
     AXK_ZERO_MEM( stack );
     
     int max_height = log2_64( in_handle->count );
-    axk_vector_create_with_capacity( &stack, sizeof( void* ), ( max_height <= 1 ? 1UL : (uint64_t)( max_height ) ) * 2UL, NULL, NULL );
+    axk_vector_create_with_allocator( &stack, sizeof( void* ), ( max_height <= 1 ? 1UL : (uint64_t)( max_height ) ) * 2UL, in_handle->allocator, NULL, NULL );
     axk_vector_push_back( &stack, &node );
 
     // Navigate as far down left as possible
@@ -653,7 +671,7 @@ void axk_rbtree_clear( struct axk_rbtree_t* in_handle )
                 if( node->parent->child[ DIR_LEFT ] == node )    { node->parent->child[ DIR_LEFT ] = NULL; }
             }
 
-            node_destroy( node, in_handle->fn_finalize );
+            node_destroy( in_handle, node );
             axk_vector_pop_back( &stack );
 
             // Check if we have emptied the stack
@@ -783,7 +801,7 @@ void* axk_rbtree_insert_or_update( struct axk_rbtree_t* in_handle, uint64_t key,
     }
 
     // There wasnt an existing node, so were going to create and insert a new node
-    struct axk_rbtree_node_t* new_node = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + in_handle->elem_size );
+    struct axk_rbtree_node_t* new_node = node_alloc( in_handle );
     new_node->key = key;
     void* ptr_dest = (void*)( (uint8_t*)( new_node ) + sizeof( struct axk_rbtree_node_t ) );
 
@@ -841,7 +859,7 @@ void* axk_rbtree_insert( struct axk_rbtree_t* in_handle, uint64_t key, void* in_
     }
 
     // Create the new node
-    struct axk_rbtree_node_t* new_node = (struct axk_rbtree_node_t*) malloc( sizeof( struct axk_rbtree_node_t ) + in_handle->elem_size );
+    struct axk_rbtree_node_t* new_node = node_alloc( in_handle );
     new_node->key = key;
     void* ptr_dest = (void*)( (uint8_t*)( new_node ) + sizeof( struct axk_rbtree_node_t ) );
 
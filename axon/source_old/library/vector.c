@@ -6,6 +6,7 @@
 
 #include "axon/library/vector.h"
 #include "axon/panic.h"
+#include "axon/memory/kheap.h"
 #include "stdlib.h"
 #include "string.h"
 
@@ -19,6 +20,35 @@
 /*
     Helper Function(s)
 */
+void* buffer_alloc( struct axk_vector_t* in_vec, uint64_t capacity )
+{
+    if( in_vec->allocator == NULL ) { return calloc( capacity, in_vec->elem_size ); }
+    return in_vec->allocator->fn_alloc( in_vec->allocator->context, capacity * in_vec->elem_size, true );
+}
+
+void buffer_free( struct axk_vector_t* in_vec, void* buffer )
+{
+    if( in_vec->allocator == NULL ) { free( buffer ); }
+    else { in_vec->allocator->fn_free( in_vec->allocator->context, buffer ); }
+}
+
+void* buffer_realloc( struct axk_vector_t* in_vec, uint64_t new_capacity )
+{
+    // The kernel heap can usually grow or shrink the buffer in place, and zeroes anything past the old end
+    if( in_vec->allocator == NULL ) { return axk_kheap_realloc( in_vec->buffer, new_capacity * in_vec->elem_size, true ); }
+
+    // Other allocators (i.e. arenas) only alloc and free, so the elements are copied into a new buffer
+    void* new_buffer = buffer_alloc( in_vec, new_capacity );
+    if( new_buffer != NULL && in_vec->buffer != NULL )
+    {
+        uint64_t copy_count = in_vec->elem_count < new_capacity ? in_vec->elem_count : new_capacity;
+        memcpy( new_buffer, in_vec->buffer, copy_count * in_vec->elem_size );
+        buffer_free( in_vec, in_vec->buffer );
+    }
+
+    return new_buffer;
+}
+
 uint64_t calculate_capacity( struct axk_vector_t* in_vec, uint64_t new_count )
 {
     uint64_t count_div      = new_count / 10UL;
@@ -30,20 +60,13 @@ uint64_t calculate_capacity( struct axk_vector_t* in_vec, uint64_t new_count )
 
 uint64_t expand_capacity( struct axk_vector_t* in_vec, uint64_t addtl_count )
 {
-    // Calculate the new vector capacity
-    in_vec->elem_capacity = calculate_capacity( in_vec, addtl_count + in_vec->elem_count );
-
-    // Allocate a new buffer to hold the data
-    void* new_buffer = calloc( in_vec->elem_capacity, in_vec->elem_size );
-
-    // Copy in existing elements
-    if( in_vec->buffer != NULL )
-    {
-        memcpy( new_buffer, in_vec->buffer, in_vec->elem_count * in_vec->elem_size );
-        free( in_vec->buffer );
-    }
+    // Calculate the new vector capacity, and resize the buffer to hold it, the existing elements come along with it
+    uint64_t new_capacity   = calculate_capacity( in_vec, addtl_count + in_vec->elem_count );
+    void* new_buffer        = buffer_realloc( in_vec, new_capacity );
+    if( new_buffer == NULL ) { axk_panic( "Kernel Library: vector failed to grow its buffer" ); }
 
-    in_vec->buffer = new_buffer;
+    in_vec->buffer          = new_buffer;
+    in_vec->elem_capacity   = new_capacity;
     return in_vec->elem_capacity;
 }
 
@@ -68,13 +91,20 @@ void axk_vector_create( struct axk_vector_t* in_handle, uint64_t elem_size, void
     in_handle->elem_capacity    = calculate_capacity( in_handle, 0UL );
     in_handle->fn_finalize      = finalize_func;
     in_handle->fn_copy          = copy_func;
+    in_handle->allocator        = NULL;
 
     // Now, lets create the buffer that actually holds the data
-    in_handle->buffer = calloc( in_handle->elem_capacity, in_handle->elem_size );
+    in_handle->buffer = buffer_alloc( in_handle, in_handle->elem_capacity );
 }
 
 
 void axk_vector_create_with_capacity( struct axk_vector_t* in_handle, uint64_t elem_size, uint64_t in_capacity, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) )
+{
+    axk_vector_create_with_allocator( in_handle, elem_size, in_capacity, NULL, copy_func, finalize_func );
+}
+
+
+void axk_vector_create_with_allocator( struct axk_vector_t* in_handle, uint64_t elem_size, uint64_t in_capacity, struct axk_allocator_t* allocator, void( *copy_func )( void*, void* ), void( *finalize_func )( void* ) )
 {
     // Check if handle already refers to a vector
     if( in_handle->buffer != NULL )
@@ -93,9 +123,10 @@ void axk_vector_create_with_capacity( struct axk_vector_t* in_handle, uint64_t e
     in_handle->elem_capacity    = ( in_capacity < MIN_CAPACITY ? MIN_CAPACITY : in_capacity );
     in_handle->fn_finalize      = finalize_func;
     in_handle->fn_copy          = copy_func;
+    in_handle->allocator        = allocator;
 
     // Now, lets create the buffer that actually holds the data
-    in_handle->buffer = calloc( in_handle->elem_capacity, in_handle->elem_size ); 
+    in_handle->buffer = buffer_alloc( in_handle, in_handle->elem_capacity );
 }
 
 
@@ -112,13 +143,14 @@ void axk_vector_destroy( struct axk_vector_t* in_handle )
         }
     }
 
-    free( in_handle->buffer );
+    buffer_free( in_handle, in_handle->buffer );
 
     in_handle->buffer           = NULL;
     in_handle->elem_count       = 0UL;
     in_handle->elem_capacity    = 0UL;
     in_handle->fn_finalize      = NULL;
     in_handle->fn_copy          = NULL;
+    in_handle->allocator        = NULL;
 }
 
 
@@ -137,7 +169,8 @@ void axk_vector_copy( struct axk_vector_t* dest, struct axk_vector_t* source )
     dest->elem_capacity     = source->elem_capacity;
     dest->elem_size         = source->elem_size;
     dest->growth_factor     = source->growth_factor;
-    dest->buffer            = calloc( dest->elem_capacity, dest->elem_size );
+    dest->allocator         = source->allocator;
+    dest->buffer            = buffer_alloc( dest, dest->elem_capacity );
     dest->fn_finalize       = source->fn_finalize;
     dest->fn_copy           = source->fn_copy;
 
@@ -174,6 +207,7 @@ void axk_vector_move( struct axk_vector_t* dest, struct axk_vector_t* source )
     dest->fn_copy           = source->fn_copy;
     dest->growth_factor     = source->growth_factor;
     dest->buffer            = source->buffer;
+    dest->allocator         = source->allocator;
 
     source->elem_capacity =  0UL;
     source->elem_count      = 0UL;
@@ -182,6 +216,7 @@ void axk_vector_move( struct axk_vector_t* dest, struct axk_vector_t* source )
     source->fn_copy         = NULL;
     source->growth_factor   = 0;
     source->buffer          = NULL;
+    source->allocator       = NULL;
 }
 
 
@@ -198,11 +233,11 @@ void axk_vector_clear( struct axk_vector_t* in_handle )
         }
     }
 
-    free( in_handle->buffer );
+    buffer_free( in_handle, in_handle->buffer );
 
     in_handle->elem_count       = 0UL;
     in_handle->elem_capacity    = calculate_capacity( in_handle, 0UL );
-    in_handle->buffer           = calloc( in_handle->elem_capacity, in_handle->elem_size );
+    in_handle->buffer           = buffer_alloc( in_handle, in_handle->elem_capacity );
 }
 
 
@@ -374,9 +409,9 @@ void axk_vector_shrink( struct axk_vector_t* in_handle )
     uint64_t new_capacity = calculate_capacity( in_handle, in_handle->elem_count );
     if( new_capacity + new_capacity <= in_handle->elem_capacity )
     {
-        void* new_buffer = calloc( new_capacity, in_handle->elem_size );
-        memcpy( new_buffer, in_handle->buffer, in_handle->elem_count * in_handle->elem_size );
-        free( in_handle->buffer );
+        // If the buffer cant be resized, the larger one is still valid, so just keep it
+        void* new_buffer = buffer_realloc( in_handle, new_capacity );
+        if( new_buffer == NULL ) { return; }
 
         in_handle->buffer          = new_buffer;
         in_handle->elem_capacity   = new_capacity;
@@ -7,9 +7,11 @@
 #include "axon/system/interrupts.h"
 #include "axon/system/interrupts_private.h"
 #include "axon/library/spinlock.h"
-#include "axon/memory/atomics.h"
+#include "axon/library/atomic.h"
+#include "axon/kernel/rcu.h"
 #include "axon/panic.h"
 #include "stdlib.h"
+#include "string.h"
 
 /*
     Structures
@@ -17,11 +19,7 @@
 struct axk_interrupt_handler_t
 {
     uint32_t process;
-    struct axk_atomic_pointer_t callback;
-
-    // Even though we use a lock to guard modifications to the list, we still use an atomic pointer
-    // to store the function pointer, because when an interrupt is raised, we dont want to wait for a spinlock
-    // to be acquired when calling an interrupt callback. Although the lock wont be held often, so it might be overkill
+    bool( *callback )( uint8_t );
 };
 
 struct axk_interrupt_external_t
@@ -30,54 +28,141 @@ struct axk_interrupt_external_t
     uint32_t global_interrupt;
 };
 
+/*
+    axk_interrupt_table_t (Structure)
+    * The handler and external routing tables, protected by RCU
+    * A published table is never modified, writers copy it, change the copy and publish that, so raising an interrupt
+      never waits on a lock and never sees a half updated entry
+*/
+struct axk_interrupt_table_t
+{
+    struct axk_rcu_head_t rcu;
+    struct axk_interrupt_handler_t handlers[ AXK_MAX_INTERRUPT_HANDLERS ];
+    uint32_t external_routings_count;
+    struct axk_interrupt_external_t external_routings[];
+};
+
 /*
     State
+    * 'g_write_lock' only serializes writers with each other, readers dont touch it
 */
-static struct axk_interrupt_handler_t g_handlers[ AXK_MAX_INTERRUPT_HANDLERS ];
-static bool g_init = false;
-static struct axk_spinlock_t g_lock;
-static struct axk_interrupt_external_t* g_external_routings;
-static uint32_t g_external_routings_count;
+static struct axk_atomic_pointer_t g_table;
+static struct axk_spinlock_t g_write_lock;
+
 
 /*
-    Function Implementations
+    _table_size
+    * Private Function
+    * Gets the size of a table with 'external_count' external routings
 */
-void axk_interrupts_init_state( void )
+static inline size_t _table_size( uint32_t external_count )
 {
-    // Initialize the spinlocks
-    axk_spinlock_init( &g_lock );
+    return sizeof( struct axk_interrupt_table_t ) + ( sizeof( struct axk_interrupt_external_t ) * (size_t)( external_count ) );
+}
 
-    // Loop through, and initialize handler entries
-    for( uint8_t i = 0; i < AXK_MAX_INTERRUPT_HANDLERS; i++ )
+
+/*
+    _free_table
+    * Private Function
+    * RCU callback, frees a table once no reader can still be using it
+*/
+static void _free_table( struct axk_rcu_head_t* head )
+{
+    free( (void*)( head ) );
+}
+
+
+/*
+    _begin_update
+    * Private Function
+    * Acquires the write lock, and returns a private copy of the current table to modify
+*/
+static struct axk_interrupt_table_t* _begin_update( void )
+{
+    axk_spinlock_acquire( &g_write_lock );
+
+    // Writers are serialized, so the table cant be swapped out from under us while we copy it
+    struct axk_interrupt_table_t* ptr_current   = (struct axk_interrupt_table_t*) axk_atomic_load_pointer_relaxed( &g_table );
+    size_t table_size                           = _table_size( ptr_current->external_routings_count );
+    struct axk_interrupt_table_t* ptr_copy      = (struct axk_interrupt_table_t*) malloc( table_size );
+
+    if( ptr_copy == NULL )
     {
-        g_handlers[ i ].process = AXK_PROCESS_INVALID;
-        axk_atomic_store_pointer( &( g_handlers[ i ].callback ), NULL, MEMORY_ORDER_SEQ_CST );
+        axk_panic( "Interrupts: failed to allocate a copy of the handler table" );
     }
 
-    // Get the list of available external interrupt routings
+    memcpy( ptr_copy, ptr_current, table_size );
+    return ptr_copy;
+}
+
+
+/*
+    _commit_update
+    * Private Function
+    * Publishes the modified copy and releases the write lock, the old table is freed once every processor has moved past it
+*/
+static void _commit_update( struct axk_interrupt_table_t* ptr_copy )
+{
+    struct axk_interrupt_table_t* ptr_old = (struct axk_interrupt_table_t*) axk_atomic_load_pointer_relaxed( &g_table );
+    axk_rcu_assign( &g_table, (void*)( ptr_copy ) );
+    axk_spinlock_release( &g_write_lock );
+
+    axk_rcu_call( &( ptr_old->rcu ), _free_table );
+}
+
+
+/*
+    _cancel_update
+    * Private Function
+    * Throws away the copy without publishing it, and releases the write lock
+*/
+static void _cancel_update( struct axk_interrupt_table_t* ptr_copy )
+{
+    axk_spinlock_release( &g_write_lock );
+    free( ptr_copy );
+}
+
+/*
+    Function Implementations
+*/
+void axk_interrupts_init_state( void )
+{
+    // Initialize the lock
+    axk_spinlock_init( &g_write_lock );
+
+    // Get the list of available external interrupt routings, the table is sized to fit them
     struct axk_interrupt_driver_t* ptr_driver = axk_interrupts_get();
+    uint32_t external_count = ptr_driver->get_available_external_routings( ptr_driver, NULL );
 
-    g_external_routings_count = ptr_driver->get_available_external_routings( ptr_driver, NULL );
-    if( g_external_routings_count == 0U )
+    struct axk_interrupt_table_t* ptr_table = (struct axk_interrupt_table_t*) calloc( 1, _table_size( external_count ) );
+    if( ptr_table == NULL )
     {
-        g_external_routings = NULL;
+        axk_panic( "Interrupts: failed to allocate the handler table" );
     }
-    else
+
+    // Loop through, and initialize handler entries
+    for( uint8_t i = 0; i < AXK_MAX_INTERRUPT_HANDLERS; i++ )
     {
-        g_external_routings     = (struct axk_interrupt_external_t*) calloc( g_external_routings_count, sizeof( struct axk_interrupt_external_t ) );
-        uint32_t* list          = (uint32_t*) calloc( g_external_routings_count, sizeof( uint32_t) );
+        ptr_table->handlers[ i ].process    = AXK_PROCESS_INVALID;
+        ptr_table->handlers[ i ].callback   = NULL;
+    }
 
+    ptr_table->external_routings_count = external_count;
+    if( external_count > 0U )
+    {
+        uint32_t* list = (uint32_t*) calloc( external_count, sizeof( uint32_t) );
         ptr_driver->get_available_external_routings( ptr_driver, list );
 
-        for( uint32_t i = 0; i < g_external_routings_count; i++ )
+        for( uint32_t i = 0; i < external_count; i++ )
         {
-            g_external_routings[ i ].process            = AXK_PROCESS_INVALID;
-            g_external_routings[ i ].global_interrupt   = list[ i ];
+            ptr_table->external_routings[ i ].process            = AXK_PROCESS_INVALID;
+            ptr_table->external_routings[ i ].global_interrupt   = list[ i ];
         }
 
         free( list );
     }
 
+    axk_rcu_assign( &g_table, (void*)( ptr_table ) );
 }
 
 
@@ -89,17 +174,20 @@ void axk_interrupts_invoke( uint8_t vec )
         axk_panic( "Interrupts: interrupt raised with an out-of-bounds interrupt number" );
     }
 
-    // Find the current callback bound to this vector
-    void* vcallback = axk_atomic_load_pointer( &( g_handlers[ vec ].callback ), MEMORY_ORDER_SEQ_CST );
+    // Find the current callback bound to this vector, the table cant be freed while we're still running on it
+    axk_rcu_read_lock();
+    struct axk_interrupt_table_t* ptr_table = (struct axk_interrupt_table_t*) axk_rcu_dereference( &g_table );
+    bool( *fcallback )( uint8_t ) = ptr_table->handlers[ vec ].callback;
     bool b_sent_eoi = false;
 
-    if( vcallback != NULL )
+    if( fcallback != NULL )
     {
         // Invoke the callback
-        bool( *fcallback )(uint8_t) = (bool(*)(uint8_t))( vcallback );
         b_sent_eoi = fcallback( vec );
     }
 
+    axk_rcu_read_unlock();
+
     if( !b_sent_eoi )
     {
         axk_interrupts_signal_eoi();
@@ -112,8 +200,8 @@ bool axk_interrupts_acquire_handler( uint32_t process, bool( *func_ptr )( uint8_
     // Validate parameters
     if( out_vec == NULL || process == AXK_PROCESS_INVALID ) { return false; }
 
-    // Acquire lock
-    axk_spinlock_acquire( &g_lock );
+    // Acquire lock, and copy the table
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
     // Look for an available interrupt handler entry
     struct axk_interrupt_handler_t* ptr_entry = NULL;
@@ -121,9 +209,9 @@ bool axk_interrupts_acquire_handler( uint32_t process, bool( *func_ptr )( uint8_
     
     for( uint8_t i = 0; i < AXK_MAX_INTERRUPT_HANDLERS; i++ )
     {
-        if( g_handlers[ i ].process == AXK_PROCESS_INVALID )
+        if( ptr_table->handlers[ i ].process == AXK_PROCESS_INVALID )
         {
-            ptr_entry   = g_handlers + i;
+            ptr_entry   = ptr_table->handlers + i;
             index       = i;
 
             break;
@@ -136,11 +224,11 @@ bool axk_interrupts_acquire_handler( uint32_t process, bool( *func_ptr )( uint8_
         axk_panic( "Interrupts: ran out of available interrupt handlers" );
     }
 
-    // Update entry and release lock
-    ptr_entry->process = process;
+    // Update entry and publish the new table
+    ptr_entry->process  = process;
+    ptr_entry->callback = func_ptr;
 
-    axk_atomic_store_pointer( &( ptr_entry->callback ), (void*)func_ptr, MEMORY_ORDER_SEQ_CST );
-    axk_spinlock_release( &g_lock );
+    _commit_update( ptr_table );
 
     *out_vec = ( index + AXK_MIN_INTERRUPT_HANDLER );
     return true;
@@ -152,21 +240,21 @@ bool axk_interrupts_lock_handler( uint32_t process, bool( *func_ptr )( uint8_t )
     // Validate parameters
     if( process == AXK_PROCESS_INVALID || vec >= AXK_MAX_INTERRUPT_HANDLERS || vec <= AXK_MIN_INTERRUPT_HANDLER ) { return false; }
 
-    // Acquire lock
-    axk_spinlock_acquire( &g_lock );
+    // Acquire lock, and copy the table
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
     // Check if the target handler is already owned
-    struct axk_interrupt_handler_t* ptr_entry = g_handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
+    struct axk_interrupt_handler_t* ptr_entry = ptr_table->handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
     if( ptr_entry->process != AXK_PROCESS_INVALID ) 
     { 
-        axk_spinlock_release( &g_lock );
+        _cancel_update( ptr_table );
         return false; 
     }
 
-    // Update the entry and relaese the lock
-    ptr_entry->process = process;
-    axk_atomic_store_pointer( &( ptr_entry->callback ), (void*) func_ptr, MEMORY_ORDER_SEQ_CST );
-    axk_spinlock_release( &g_lock );
+    // Update the entry and publish the new table
+    ptr_entry->process  = process;
+    ptr_entry->callback = func_ptr;
+    _commit_update( ptr_table );
 
     return true;
 }
@@ -178,14 +266,13 @@ void axk_interrupts_release_handler( uint8_t vec )
     if( vec >= AXK_MAX_INTERRUPT_HANDLERS || vec < AXK_MIN_INTERRUPT_HANDLER ) { return; }
 
     // Acquire lock while modifying state
-    axk_spinlock_acquire( &g_lock );
-
-    struct axk_interrupt_handler_t* ptr_entry = g_handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
+    struct axk_interrupt_handler_t* ptr_entry = ptr_table->handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
 
     ptr_entry->process      = AXK_PROCESS_INVALID;
-    axk_atomic_store_pointer( &( ptr_entry->callback ), NULL, MEMORY_ORDER_SEQ_CST );
+    ptr_entry->callback     = NULL;
 
-    axk_spinlock_release( &g_lock );
+    _commit_update( ptr_table );
 }
 
 
@@ -195,17 +282,17 @@ bool axk_interrupts_update_handler( uint8_t vec, bool( *func_ptr )( uint8_t ) )
     if( vec >= AXK_MAX_INTERRUPT_HANDLERS || vec < AXK_MIN_INTERRUPT_HANDLER ) { return false; }
 
     // Acquire lock whie modifying state
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
-    struct axk_interrupt_handler_t* ptr_entry = g_handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
+    struct axk_interrupt_handler_t* ptr_entry = ptr_table->handlers + ( vec - AXK_MIN_INTERRUPT_HANDLER );
     if( ptr_entry->process == AXK_PROCESS_INVALID )
     {
-        axk_spinlock_release( &g_lock );
+        _cancel_update( ptr_table );
         return false;
     }
 
-    axk_atomic_store_pointer( &( ptr_entry->callback ), (void*) func_ptr, MEMORY_ORDER_SEQ_CST );
-    axk_spinlock_release( &g_lock );
+    ptr_entry->callback = func_ptr;
+    _commit_update( ptr_table );
 
     return true;
 }
@@ -218,28 +305,33 @@ uint8_t axk_interrupts_release_process_resources( uint32_t process )
     uint8_t count = 0;
 
     // Acuiqre lock to modify state
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
+    bool b_changed = false;
 
     for( uint8_t i = 0; i < AXK_MAX_INTERRUPT_HANDLERS; i++ )
     {
-        if( g_handlers[ i ].process == process )
+        if( ptr_table->handlers[ i ].process == process )
         {
-            g_handlers[ i ].process     = AXK_PROCESS_INVALID;
-            axk_atomic_store_pointer( &( g_handlers[ i ].callback ), NULL, MEMORY_ORDER_SEQ_CST );
+            ptr_table->handlers[ i ].process    = AXK_PROCESS_INVALID;
+            ptr_table->handlers[ i ].callback   = NULL;
 
             count++;
         }
     }
 
-    for( uint32_t i = 0; i < g_external_routings_count; i++ )
+    for( uint32_t i = 0; i < ptr_table->external_routings_count; i++ )
     {
-        if( g_external_routings[ i ].process == process )
+        if( ptr_table->external_routings[ i ].process == process )
         {
-            g_external_routings[ i ].process = AXK_PROCESS_INVALID;
+            ptr_table->external_routings[ i ].process = AXK_PROCESS_INVALID;
+            b_changed = true;
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    // Nothing to publish if the process didnt own anything
+    if( count > 0U || b_changed ) { _commit_update( ptr_table ); }
+    else { _cancel_update( ptr_table ); }
+
     return count;
 }
 
@@ -249,20 +341,21 @@ bool axk_interrupts_get_handler_info( uint8_t vec, bool( **out_func )( uint8_t )
     // Validate parameters
     if( vec >= AXK_MAX_INTERRUPT_HANDLERS || out_func == NULL || out_process == NULL ) { return false; }
 
-    // Acquire lock to read state
-    axk_spinlock_acquire( &g_lock );
+    // Lookups dont modify anything, so they read the current table without taking any lock
+    axk_rcu_read_lock();
+    struct axk_interrupt_table_t* ptr_table = (struct axk_interrupt_table_t*) axk_rcu_dereference( &g_table );
 
-    struct axk_interrupt_handler_t* ptr_entry = g_handlers + vec;
+    struct axk_interrupt_handler_t* ptr_entry = ptr_table->handlers + vec;
     if( ptr_entry->process == AXK_PROCESS_INVALID ) 
     {
-        axk_spinlock_release( &g_lock );
+        axk_rcu_read_unlock();
         return false;
     }
 
-    *out_func       = (bool(*)(uint8_t))( axk_atomic_load_pointer( &( ptr_entry->callback ), MEMORY_ORDER_SEQ_CST ) );
+    *out_func       = ptr_entry->callback;
     *out_process    = ptr_entry->process;
 
-    axk_spinlock_release( &g_lock );
+    axk_rcu_read_unlock();
     return true;
 }
 
@@ -286,31 +379,33 @@ bool axk_interrupts_acquire_external( uint32_t process, struct axk_external_inte
     if( process == AXK_PROCESS_INVALID || routing == NULL ) { return false; }
 
     // Acquire spinlock
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
     // Look for an available external interrupt
     bool b_valid    = false;
 
-    for( uint32_t i = 0; i < g_external_routings_count; i++ )
+    for( uint32_t i = 0; i < ptr_table->external_routings_count; i++ )
     {
-        if( g_external_routings[ i ].process == AXK_PROCESS_INVALID )
+        if( ptr_table->external_routings[ i ].process == AXK_PROCESS_INVALID )
         {
             b_valid                         = true;
-            routing->global_interrupt    = g_external_routings[ i ].global_interrupt;
+            routing->global_interrupt    = ptr_table->external_routings[ i ].global_interrupt;
 
-            g_external_routings[ i ].process = process;
+            ptr_table->external_routings[ i ].process = process;
             break;
         }
     }
 
-    axk_spinlock_release( &g_lock );
     if( !b_valid )
     {
         // DEBUG
+        _cancel_update( ptr_table );
         axk_panic( "Interrupts: Ran out of external interrupt routings" );
         return false;
     }
 
+    _commit_update( ptr_table );
+
     struct axk_interrupt_driver_t* driver = axk_interrupts_get();
     if( !driver->set_external_routing( driver, routing ) )
     {
@@ -326,19 +421,19 @@ bool axk_interrupts_acquire_external_clamped( uint32_t process, struct axk_exter
     if( process == AXK_PROCESS_INVALID || routing == NULL || allowed == NULL || allowed_count == 0U ) { return false; }
 
     // Acquire spinlock to modify state
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
     // Loop through allowed vectors, then find the corresponding entry and check if we can acquire them
     bool b_valid = false;
 
     for( uint32_t i = 0; i < allowed_count; i++ )
     {
-        for( uint32_t j = 0; j < g_external_routings_count; j++ )
+        for( uint32_t j = 0; j < ptr_table->external_routings_count; j++ )
         {
-            if( g_external_routings[ j ].process == AXK_PROCESS_INVALID )
+            if( ptr_table->external_routings[ j ].process == AXK_PROCESS_INVALID )
             {
-                g_external_routings[ j ].process    = process;
-                routing->global_interrupt           = g_external_routings[ j ].global_interrupt;
+                ptr_table->external_routings[ j ].process    = process;
+                routing->global_interrupt                    = ptr_table->external_routings[ j ].global_interrupt;
 
                 b_valid = true;
                 break;
@@ -346,13 +441,15 @@ bool axk_interrupts_acquire_external_clamped( uint32_t process, struct axk_exter
         }
     }
 
-    // Release lock and check for success
-    axk_spinlock_release( &g_lock );
+    // Publish and check for success
     if( !b_valid ) 
     {
+        _cancel_update( ptr_table );
         return false;
     }
 
+    _commit_update( ptr_table );
+
     // Update the external routing in the driver
     struct axk_interrupt_driver_t* driver = axk_interrupts_get();
     if( !driver->set_external_routing( driver, routing ) )
@@ -369,25 +466,27 @@ bool axk_interrupts_lock_external( uint32_t process, struct axk_external_interru
     if( process == AXK_PROCESS_INVALID || routing == NULL ) { return false; }
 
     // Acquire lock
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
     
     bool b_valid = false;
-    for( uint32_t i = 0; i < g_external_routings_count; i++ )
+    for( uint32_t i = 0; i < ptr_table->external_routings_count; i++ )
     {
-        if( g_external_routings[ i ].global_interrupt == routing->global_interrupt )
+        if( ptr_table->external_routings[ i ].global_interrupt == routing->global_interrupt )
         {
-            b_valid                             = true;
-            g_external_routings[ i ].process    = process;
+            b_valid                                     = true;
+            ptr_table->external_routings[ i ].process   = process;
             break;
         }
     }
 
-    axk_spinlock_release( &g_lock );
     if( !b_valid )
     {
+        _cancel_update( ptr_table );
         return false;
     }
 
+    _commit_update( ptr_table );
+
     struct axk_interrupt_driver_t* driver = axk_interrupts_get();
     if( !driver->set_external_routing( driver, routing ) )
     {
@@ -400,23 +499,26 @@ bool axk_interrupts_lock_external( uint32_t process, struct axk_external_interru
 void axk_interrupts_release_external( uint32_t vector )
 {
     // Acquire spinlock
-    axk_spinlock_acquire( &g_lock );
+    struct axk_interrupt_table_t* ptr_table = _begin_update();
 
     // Look for this global interrupt
     struct axk_interrupt_driver_t* driver = axk_interrupts_get();
+    bool b_found = false;
 
-    for( uint32_t i = 0; i < g_external_routings_count; i++ )
+    for( uint32_t i = 0; i < ptr_table->external_routings_count; i++ )
     {
-        if( g_external_routings[ i ].global_interrupt == vector )
+        if( ptr_table->external_routings[ i ].global_interrupt == vector )
         {
             driver->clear_external_routing( driver, vector );
-            g_external_routings[ i ].process = AXK_PROCESS_INVALID;
+            ptr_table->external_routings[ i ].process = AXK_PROCESS_INVALID;
 
+            b_found = true;
             break;
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    if( b_found ) { _commit_update( ptr_table ); }
+    else { _cancel_update( ptr_table ); }
 }
 
 
@@ -433,21 +535,22 @@ bool axk_interrupts_get_external( uint32_t vector, uint32_t* out_process, struct
     // Some of the info needed is from the driver, and some of the info needed is from our state
     if( out_process == NULL || out_routing == NULL ) { return false; }
 
-    // Lock state
-    axk_spinlock_acquire( &g_lock );
+    // We only need to read the table, so no lock is needed
+    axk_rcu_read_lock();
+    struct axk_interrupt_table_t* ptr_table = (struct axk_interrupt_table_t*) axk_rcu_dereference( &g_table );
     
     bool b_valid = false;
-    for( uint32_t i = 0; i < g_external_routings_count; i++ )
+    for( uint32_t i = 0; i < ptr_table->external_routings_count; i++ )
     {
-        if( g_external_routings[ i ].global_interrupt == vector )
+        if( ptr_table->external_routings[ i ].global_interrupt == vector )
         {
-            *out_process = g_external_routings[ i ].process;
+            *out_process = ptr_table->external_routings[ i ].process;
             b_valid = true;
             break;
         }
     }
 
-    axk_spinlock_release( &g_lock );
+    axk_rcu_read_unlock();
 
     if( b_valid )
     {
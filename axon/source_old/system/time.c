@@ -5,7 +5,7 @@
 ==============================================================*/
 
 #include "axon/system/time.h"
-#include "axon/library/spinlock.h"
+#include "axon/library/seqlock.h"
 #include "axon/system/timers.h"
 #include "axon/system/time_private.h"
 #include "axon/system/interrupts.h"
@@ -29,7 +29,7 @@ struct axk_time_sync_point_t
 /*
     State
 */
-static struct axk_spinlock_t g_sync_lock;
+static struct axk_seqlock_t g_sync_lock;
 static struct axk_time_sync_point_t g_sync_point;
 static uint64_t g_sync_history[ 6 ];
 static uint64_t g_utc_offset;
@@ -44,7 +44,7 @@ void axk_time_init( uint64_t ext_tick_period )
 {
     // Setup the initial state
     memset( (void*) g_sync_history, 0, sizeof( uint64_t ) * 6UL );
-    axk_spinlock_init( &g_sync_lock );
+    axk_seqlock_init( &g_sync_lock );
     axk_atomic_store_uint64( &g_last_time, 0UL, MEMORY_ORDER_SEQ_CST );
 
     g_utc_offset        = 0UL;
@@ -70,7 +70,7 @@ void axk_time_ext_tick( void )
         uint64_t new_counter = axk_timer_get_counter_value( ptr_counter );
 
         // Update the system clock
-        axk_spinlock_acquire( &g_sync_lock );
+        axk_seqlock_write_begin( &g_sync_lock );
 
         // Calculate average frequency over the last 6 ticks (0.25s)
         g_sync_history[ 5 ] = g_sync_history[ 4 ];
@@ -92,7 +92,7 @@ void axk_time_ext_tick( void )
         g_sync_point.counter_value  = g_sync_history[ 0 ];
         g_sync_point.since_boot     += g_timer_period;
 
-        axk_spinlock_release( &g_sync_lock );
+        axk_seqlock_write_end( &g_sync_lock );
         axk_counter_increment( AXK_COUNTER_EXT_CLOCK_TICKS, 1UL );
     }
     else if( g_ext_tick_counter == 2UL )
@@ -111,9 +111,11 @@ void axk_time_ext_tick( void )
             axk_panic( "Time: failed to read the persistent hardware clock" );
         }
 
+        axk_seqlock_write_begin( &g_sync_lock );
         g_sync_point.counter_value  = counter_tick;
         g_sync_point.counter_rate   = axk_timer_get_frequency( ptr_counter );
         g_sync_point.since_boot     = 0UL;
+        axk_seqlock_write_end( &g_sync_lock );
 
         // Convert the difference between reading the clock, and the start of the tick to nanoseconds to get a more accurate UTC offset
         g_utc_offset = utc_time.raw - ( ( ( counter_read - counter_tick ) * 1000000000UL ) / g_sync_point.counter_rate );
@@ -136,11 +138,14 @@ uint64_t axk_time_get_since_boot( void )
     // Get the current counter driver
     struct axk_timer_driver_t* ptr_counter = axk_timer_get_counter();
     
-    // Read last sync point
+    // Read last sync point, readers dont take a lock, we just retry if the timer tick updated it while we were copying
     struct axk_time_sync_point_t last_sync;
-    axk_spinlock_acquire( &g_sync_lock );
-    memcpy( (void*)( &last_sync ), (void*)( &g_sync_point ), sizeof( struct axk_time_sync_point_t ) );
-    axk_spinlock_release( &g_sync_lock );
+    uint32_t sequence;
+    do
+    {
+        sequence = axk_seqlock_read_begin( &g_sync_lock );
+        memcpy( (void*)( &last_sync ), (void*)( &g_sync_point ), sizeof( struct axk_time_sync_point_t ) );
+    } while( axk_seqlock_read_retry( &g_sync_lock, sequence ) );
 
     // Calculate the counter change since the last sync point, taking into account wrap around
     uint64_t new_value = ptr_counter->get_counter( ptr_counter );
@@ -0,0 +1,187 @@
+/*==============================================================
+    Axon Kernel - Memory Order Benchmark
+    2021, Zachary Berry
+    axon/test/atomic_bench.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/library/atomic.h"
+#include "axon/library/spinlock.h"
+#include "axon/system/sysinfo.h"
+#include "axon/system/sysinfo_private.h"
+#include "axon/kernel/percpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+    Benchmark
+    * Times the hot paths that were moved off sequentially consistent ordering, next to the sequentially consistent version they replaced
+    * On x86 a SEQ_CST store is an 'xchg' (a full fence) while relaxed/release stores are a plain 'mov', read-modify-writes are
+      'lock'-prefixed either way, so those only gain from the compiler being free to move things around them
+    * Every case runs on one thread, then on every host processor at once, where the shared cases contend for one cache line
+*/
+#define BENCH_OPERATIONS    20000000UL
+
+typedef void( *bench_fn_t )( uint64_t iterations );
+
+struct bench_case_t
+{
+    const char* name;
+    bench_fn_t fn;
+};
+
+static struct axk_atomic_uint64_t g_shared_counter __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static struct axk_atomic_flag_t g_shared_flag __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static struct axk_spinlock_t g_shared_lock __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static uint32_t g_counter_index;
+
+static __thread struct axk_atomic_uint64_t t_counter __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static __thread struct axk_atomic_flag_t t_flag;
+static __thread struct axk_spinlock_t t_lock;
+
+
+static void _counter_add_seq_cst( uint64_t n )      { for( uint64_t i = 0; i < n; i++ ) { axk_atomic_fetch_add_uint64_seq_cst( &g_shared_counter, 1UL ); } }
+static void _counter_add_relaxed( uint64_t n )      { for( uint64_t i = 0; i < n; i++ ) { axk_atomic_fetch_add_uint64_relaxed( &g_shared_counter, 1UL ); } }
+static void _counter_add_percpu( uint64_t n )       { for( uint64_t i = 0; i < n; i++ ) { axk_counter_increment( g_counter_index, 1UL ); } }
+static void _store_seq_cst( uint64_t n )            { for( uint64_t i = 0; i < n; i++ ) { axk_atomic_store_uint64_seq_cst( &t_counter, i ); } }
+static void _store_release( uint64_t n )            { for( uint64_t i = 0; i < n; i++ ) { axk_atomic_store_uint64_release( &t_counter, i ); } }
+
+
+/*
+    _tas_lock_seq_cst
+    * The spinlock before the atomic rework, a sequentially consistent test-and-set and clear, taken without contention
+*/
+static void _tas_lock_seq_cst( uint64_t n )
+{
+    for( uint64_t i = 0; i < n; i++ )
+    {
+        uint64_t rflags = axk_interrupts_disable();
+        while( axk_atomic_test_and_set_flag( &t_flag, MEMORY_ORDER_SEQ_CST ) ) { axk_spin_pause(); }
+        axk_atomic_clear_flag( &t_flag, MEMORY_ORDER_SEQ_CST );
+        axk_interrupts_restore( rflags );
+    }
+}
+
+
+static void _ticket_lock( uint64_t n )
+{
+    for( uint64_t i = 0; i < n; i++ )
+    {
+        axk_spinlock_acquire( &t_lock );
+        axk_spinlock_release( &t_lock );
+    }
+}
+
+
+static void _tas_lock_shared( uint64_t n )
+{
+    for( uint64_t i = 0; i < n; i++ )
+    {
+        while( axk_atomic_test_and_set_flag( &g_shared_flag, MEMORY_ORDER_SEQ_CST ) ) { axk_spin_pause(); }
+        axk_atomic_clear_flag( &g_shared_flag, MEMORY_ORDER_SEQ_CST );
+    }
+}
+
+
+static void _ticket_lock_shared( uint64_t n )
+{
+    for( uint64_t i = 0; i < n; i++ )
+    {
+        axk_spinlock_acquire( &g_shared_lock );
+        axk_spinlock_release( &g_shared_lock );
+    }
+}
+
+
+static const struct bench_case_t g_cases[] =
+{
+    { "counter, shared, fetch_add seq_cst",     _counter_add_seq_cst },
+    { "counter, shared, fetch_add relaxed",     _counter_add_relaxed },
+    { "counter, per-cpu, axk_counter_increment", _counter_add_percpu },
+    { "store, private, seq_cst (xchg)",         _store_seq_cst },
+    { "store, private, release (mov)",          _store_release },
+    { "lock, private, seq_cst test-and-set",    _tas_lock_seq_cst },
+    { "lock, private, ticket acquire/release",  _ticket_lock },
+    { "lock, shared, seq_cst test-and-set",     _tas_lock_shared },
+    { "lock, shared, ticket acquire/release",   _ticket_lock_shared }
+};
+
+#define BENCH_CASE_COUNT ( sizeof( g_cases ) / sizeof( g_cases[ 0 ] ) )
+
+struct bench_thread_t
+{
+    pthread_t thread;
+    uint32_t index;
+    const struct bench_case_t* bench;
+};
+
+static struct axk_atomic_uint32_t g_ready;
+static struct axk_atomic_bool_t g_b_start;
+
+
+static void* _bench_thread( void* param )
+{
+    struct bench_thread_t* self = (struct bench_thread_t*)( param );
+    axk_host_attach_cpu( self->index );
+
+    axk_atomic_fetch_add_uint32_seq_cst( &g_ready, 1U );
+    while( !axk_atomic_load_bool_acquire( &g_b_start ) ) { axk_spin_pause(); }
+
+    self->bench->fn( BENCH_OPERATIONS );
+
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+/*
+    _run
+    * Runs a case on 'thread_count' threads at once, and returns the average time per operation in nanoseconds
+*/
+static double _run( const struct bench_case_t* bench, uint32_t thread_count )
+{
+    static struct bench_thread_t threads[ AXK_MAX_CPUS ];
+
+    axk_atomic_store_uint32_relaxed( &g_ready, 0U );
+    axk_atomic_store_bool_relaxed( &g_b_start, false );
+
+    for( uint32_t i = 0; i < thread_count; i++ )
+    {
+        threads[ i ].index  = i;
+        threads[ i ].bench  = bench;
+        if( pthread_create( &( threads[ i ].thread ), NULL, _bench_thread, threads + i ) != 0 ) { return 0.0; }
+    }
+
+    while( axk_atomic_load_uint32_acquire( &g_ready ) != thread_count ) { sched_yield(); }
+
+    double begin = axk_host_seconds();
+    axk_atomic_store_bool_release( &g_b_start, true );
+    for( uint32_t i = 0; i < thread_count; i++ ) { pthread_join( threads[ i ].thread, NULL ); }
+
+    return ( axk_host_seconds() - begin ) * 1e9 / (double)( BENCH_OPERATIONS );
+}
+
+
+int main( void )
+{
+    uint32_t thread_count = axk_host_cpu_count();
+    if( thread_count > AXK_MAX_CPUS ) { thread_count = AXK_MAX_CPUS; }
+
+    // The counter slots live in the per-cpu areas, so the main thread attaches as processor 0 for setup
+    axk_host_attach_cpu( 0U );
+    axk_counters_init();
+    if( !axk_counter_register( &g_counter_index ) ) { return 1; }
+    axk_spinlock_init( &g_shared_lock );
+    axk_host_detach_cpu();
+
+    printf( "Memory order benchmark, %lu operations per thread, nanoseconds per operation\n", BENCH_OPERATIONS );
+    printf( "%-42s %10s %7u threads\n", "case", "1 thread", thread_count );
+
+    for( uint32_t i = 0; i < BENCH_CASE_COUNT; i++ )
+    {
+        printf( "%-42s %10.2f %15.2f\n", g_cases[ i ].name, _run( g_cases + i, 1U ), _run( g_cases + i, thread_count ) );
+    }
+
+    return 0;
+}
\ No newline at end of file
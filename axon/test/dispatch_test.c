@@ -0,0 +1,140 @@
+/*==============================================================
+    Axon Kernel - Dispatch Resolution Tests
+    2021, Zachary Berry
+    axon/test/dispatch_test.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/system/cpu_features_private.h"
+#include <stdio.h>
+
+/*
+    Candidates
+    * Each test builds a small candidate table in place of the '.axk_dispatch' section, the table order stands in for the
+      section order, and every candidate function just returns its own number so the test can see which one the slot ended up on
+*/
+typedef int( *test_fn_t )( void );
+
+static int _baseline( void )    { return 0; }
+static int _fn_1( void )        { return 1; }
+static int _fn_2( void )        { return 2; }
+static int _fn_3( void )        { return 3; }
+static int _fn_4( void )        { return 4; }
+
+static test_fn_t g_slot_a;
+static test_fn_t g_slot_b;
+static uint32_t g_failures;
+
+#define TEST_CANDIDATE( _slot_, _fn_, _features_, _priority_ ) \
+    { (void**)( &( _slot_ ) ), (void*)( _fn_ ), ( _features_ ), ( _priority_ ) }
+
+#define TEST_TABLE_END( _table_ ) ( ( _table_ ) + ( sizeof( _table_ ) / sizeof( ( _table_ )[ 0 ] ) ) )
+
+
+/*
+    _check
+    * Resets both slots to the baseline, resolves the table with 'features', then checks where each slot points
+*/
+static void _check( const char* name, const struct axk_dispatch_candidate_t* begin, const struct axk_dispatch_candidate_t* end,
+                    uint64_t features, int expected_a, int expected_b, uint32_t expected_count )
+{
+    g_slot_a = _baseline;
+    g_slot_b = _baseline;
+
+    uint32_t count  = axk_dispatch_resolve( begin, end, features );
+    int result_a    = g_slot_a();
+    int result_b    = g_slot_b();
+
+    if( result_a != expected_a || result_b != expected_b || count != expected_count )
+    {
+        printf( "FAIL: %s, features 0x%04lX, expected %d/%d (%u patched), got %d/%d (%u patched)\n",
+            name, features, expected_a, expected_b, expected_count, result_a, result_b, count );
+        g_failures++;
+    }
+}
+
+
+static void _test_priority( void )
+{
+    static const struct axk_dispatch_candidate_t table[] =
+    {
+        TEST_CANDIDATE( g_slot_a, _fn_1, AXK_CPU_FEATURE_SSE42, 1UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_3, AXK_CPU_FEATURE_AVX512F, 3UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_2, AXK_CPU_FEATURE_AVX2, 2UL ),
+    };
+
+    // The highest priority usable candidate wins, no matter where it is in the table
+    _check( "priority, none usable", table, TEST_TABLE_END( table ), 0UL, 0, 0, 0U );
+    _check( "priority, lowest usable", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_SSE42, 1, 0, 1U );
+    _check( "priority, middle usable", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_SSE42 | AXK_CPU_FEATURE_AVX2, 2, 0, 1U );
+    _check( "priority, all usable", table, TEST_TABLE_END( table ), UINT64_MAX, 3, 0, 1U );
+    _check( "priority, only highest usable", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_AVX512F, 3, 0, 1U );
+}
+
+
+static void _test_ties( void )
+{
+    static const struct axk_dispatch_candidate_t table[] =
+    {
+        TEST_CANDIDATE( g_slot_a, _fn_1, AXK_CPU_FEATURE_POPCNT, 2UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_2, AXK_CPU_FEATURE_BMI1, 2UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_3, AXK_CPU_FEATURE_BMI2, 2UL ),
+    };
+
+    // Equal priorities go to the first usable candidate in the table
+    _check( "ties, all usable", table, TEST_TABLE_END( table ), UINT64_MAX, 1, 0, 1U );
+    _check( "ties, first missing", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_BMI1 | AXK_CPU_FEATURE_BMI2, 2, 0, 1U );
+    _check( "ties, last usable", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_BMI2, 3, 0, 1U );
+
+    // The same candidates in the opposite order pick the other one
+    _check( "ties, reversed", table + 1, TEST_TABLE_END( table ), UINT64_MAX, 2, 0, 1U );
+}
+
+
+static void _test_missing_features( void )
+{
+    static const struct axk_dispatch_candidate_t table[] =
+    {
+        TEST_CANDIDATE( g_slot_a, _fn_1, 0UL, 0UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_2, AXK_CPU_FEATURE_AVX2 | AXK_CPU_FEATURE_BMI2, 5UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_3, AXK_CPU_FEATURE_ERMS, 1UL ),
+    };
+
+    // A candidate needs every one of its features, having only some of them isnt enough
+    _check( "missing, none", table, TEST_TABLE_END( table ), 0UL, 1, 0, 1U );
+    _check( "missing, partial", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_AVX2 | AXK_CPU_FEATURE_ERMS, 3, 0, 1U );
+    _check( "missing, complete", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_AVX2 | AXK_CPU_FEATURE_BMI2, 2, 0, 1U );
+}
+
+
+static void _test_slots( void )
+{
+    static const struct axk_dispatch_candidate_t table[] =
+    {
+        TEST_CANDIDATE( g_slot_b, _fn_4, AXK_CPU_FEATURE_FSRM, 1UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_1, AXK_CPU_FEATURE_ERMS, 1UL ),
+        TEST_CANDIDATE( g_slot_b, _fn_3, AXK_CPU_FEATURE_ERMS, 0UL ),
+        TEST_CANDIDATE( g_slot_a, _fn_2, AXK_CPU_FEATURE_FSRM, 2UL ),
+    };
+
+    // Each slot is resolved on its own, a candidate for one slot never competes with another slot's candidates
+    _check( "slots, none usable", table, TEST_TABLE_END( table ), 0UL, 0, 0, 0U );
+    _check( "slots, erms", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_ERMS, 1, 3, 2U );
+    _check( "slots, fsrm", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_FSRM, 2, 4, 2U );
+    _check( "slots, both", table, TEST_TABLE_END( table ), AXK_CPU_FEATURE_ERMS | AXK_CPU_FEATURE_FSRM, 2, 4, 2U );
+
+    // An empty table leaves everything on the baseline
+    _check( "slots, empty table", table, table, UINT64_MAX, 0, 0, 0U );
+}
+
+
+int main( void )
+{
+    _test_priority();
+    _test_ties();
+    _test_missing_features();
+    _test_slots();
+
+    printf( g_failures == 0U ? "dispatch tests passed\n" : "dispatch tests failed\n" );
+    return( g_failures == 0U ? 0 : 1 );
+}
\ No newline at end of file
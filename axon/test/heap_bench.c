@@ -0,0 +1,326 @@
+/*==============================================================
+    Axon Kernel - Kernel Heap Benchmark
+    2021, Zachary Berry
+    axon/test/heap_bench.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "tag_heap/tag_heap.h"
+#include "axon/memory/kheap.h"
+#include "axon/memory/memory_private.h"
+#include "axon/kernel/percpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+    Benchmark
+    * Alloc/free mix: each thread keeps a table of live blocks, and at random either frees one or allocates a new one in its place,
+      mostly small sizes (the slab classes), some medium (the pool) and a few large ones
+    * Vector growth: grows a buffer of 8 byte elements to 1M, stepping the capacity the same way 'axk_vector' does, and counts how
+      often the buffer had to move, the tag heap row moves every time, the same as the vector did before realloc grew in place
+    * Compares the current heap (slab caches, the TLSF pool and whole ranges) with the tag heap it replaced, and the host malloc
+    * The tag heap never reuses a free block that isnt at the end of the heap (the 'b_avail' flag is only set when expanding), so every
+      allocation walks a list that keeps growing, it only runs 'MIX_TAG_OPERATIONS' or the mix would take hours
+    * The current heap gets its memory from a mocked 'axk_va_alloc' (test/host_va.c) that maps host pages with a system call,
+      where the kernel only writes page table entries, so time spent growing the heap is overstated rather than understated
+*/
+#define MIX_LIVE_BLOCKS     1024U
+#define MIX_OPERATIONS      500000U
+#define MIX_TAG_OPERATIONS  5000U
+#define MIX_MAX_THREADS     64U
+#define GROW_ELEMENTS       1000000UL
+#define GROW_SIDE_SIZE      0x6000UL
+
+struct bench_heap_t
+{
+    const char* name;
+    uint32_t mix_operations;
+    void*( *fn_alloc )( size_t size );
+    void*( *fn_realloc )( void* ptr, size_t old_size, size_t new_size );
+    void( *fn_free )( void* ptr );
+};
+
+struct bench_thread_t
+{
+    pthread_t thread;
+    uint32_t index;
+    const struct bench_heap_t* heap;
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+static struct axk_atomic_uint32_t g_ready;
+static struct axk_atomic_bool_t g_b_start;
+
+
+/*
+    Heap Wrappers
+    * The tag heap's own realloc didnt copy (it was a placeholder), so growth goes through alloc, copy and free instead
+*/
+static void* _kheap_alloc( size_t size ) { return axk_kheap_alloc( size, false ); }
+static void* _kheap_realloc( void* ptr, size_t old_size, size_t new_size ) { (void)( old_size ); return axk_kheap_realloc( ptr, new_size, false ); }
+static void _kheap_free( void* ptr ) { axk_kheap_free( ptr ); }
+
+static void* _tag_alloc( size_t size ) { return tag_heap_alloc( size, false ); }
+static void _tag_free( void* ptr ) { tag_heap_free( ptr ); }
+
+static void* _tag_realloc( void* ptr, size_t old_size, size_t new_size )
+{
+    void* ret = tag_heap_alloc( new_size, false );
+    if( ret != NULL && ptr != NULL )
+    {
+        memcpy( ret, ptr, old_size < new_size ? old_size : new_size );
+        tag_heap_free( ptr );
+    }
+
+    return ret;
+}
+
+static void* _host_alloc( size_t size ) { return malloc( size ); }
+static void* _host_realloc( void* ptr, size_t old_size, size_t new_size ) { (void)( old_size ); return realloc( ptr, new_size ); }
+static void _host_free( void* ptr ) { free( ptr ); }
+
+static const struct bench_heap_t g_heaps[] =
+{
+    { "tag heap",       MIX_TAG_OPERATIONS, _tag_alloc,     _tag_realloc,   _tag_free },
+    { "kheap",          MIX_OPERATIONS,     _kheap_alloc,   _kheap_realloc, _kheap_free },
+    { "host malloc",    MIX_OPERATIONS,     _host_alloc,    _host_realloc,  _host_free }
+};
+
+#define BENCH_HEAP_COUNT ( sizeof( g_heaps ) / sizeof( g_heaps[ 0 ] ) )
+
+
+/*
+    The kernel heap reports itself on init, there is no log here
+*/
+void axk_klog( const char* fmt, ... )
+{
+    (void)( fmt );
+}
+
+
+/*
+    _mix_size
+    * 70% from 16 to 256 bytes, 25% up to 4KB, and 5% up to 64KB
+*/
+static size_t _mix_size( uint64_t r )
+{
+    uint64_t pick = r % 100UL;
+    r >>= 8;
+
+    if( pick < 70UL ) { return 16UL + ( r % 241UL ); }
+    if( pick < 95UL ) { return 257UL + ( r % 3840UL ); }
+    return 4097UL + ( r % 61440UL );
+}
+
+
+static void* _mix_thread( void* param )
+{
+    struct bench_thread_t* self = (struct bench_thread_t*)( param );
+    const struct bench_heap_t* heap = self->heap;
+    axk_host_attach_cpu( self->index );
+
+    static __thread void* blocks[ MIX_LIVE_BLOCKS ];
+    memset( blocks, 0, sizeof( blocks ) );
+    uint64_t rand = 0x9E3779B97F4A7C15UL * ( self->index + 1UL );
+
+    axk_atomic_fetch_add_uint32_seq_cst( &g_ready, 1U );
+    while( !axk_atomic_load_bool_acquire( &g_b_start ) ) { axk_spin_pause(); }
+
+    for( uint32_t i = 0; i < heap->mix_operations; i++ )
+    {
+        uint64_t r      = axk_host_rand( &rand );
+        uint32_t slot   = (uint32_t)( r % MIX_LIVE_BLOCKS );
+
+        if( blocks[ slot ] != NULL )
+        {
+            heap->fn_free( blocks[ slot ] );
+            blocks[ slot ] = NULL;
+        }
+        else
+        {
+            blocks[ slot ] = heap->fn_alloc( _mix_size( r >> 16 ) );
+            if( blocks[ slot ] == NULL ) { fprintf( stderr, "%s: out of memory\n", heap->name ); abort(); }
+            *(volatile uint8_t*)( blocks[ slot ] ) = (uint8_t)( i );
+        }
+    }
+
+    for( uint32_t i = 0; i < MIX_LIVE_BLOCKS; i++ )
+    {
+        if( blocks[ i ] != NULL ) { heap->fn_free( blocks[ i ] ); }
+    }
+
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+/*
+    _run_mix
+    * Runs the alloc/free mix on 'thread_count' threads at once, and prints a row
+*/
+static bool _run_mix( const struct bench_heap_t* heap, uint32_t thread_count )
+{
+    static struct bench_thread_t threads[ MIX_MAX_THREADS ];
+
+    uint64_t mapped_before      = 0UL;
+    uint64_t unmapped_before    = 0UL;
+    tag_heap_map_calls( &mapped_before, &unmapped_before );
+    axk_host_va_reset_stats();
+
+    axk_atomic_store_uint32_relaxed( &g_ready, 0U );
+    axk_atomic_store_bool_relaxed( &g_b_start, false );
+
+    // Thread 0 is left for setup, so mix threads start at processor 1
+    for( uint32_t i = 0; i < thread_count; i++ )
+    {
+        threads[ i ].index  = i + 1U;
+        threads[ i ].heap   = heap;
+        if( pthread_create( &( threads[ i ].thread ), NULL, _mix_thread, threads + i ) != 0 ) { return false; }
+    }
+
+    while( axk_atomic_load_uint32_acquire( &g_ready ) != thread_count ) { sched_yield(); }
+
+    double begin = axk_host_seconds();
+    axk_atomic_store_bool_release( &g_b_start, true );
+    for( uint32_t i = 0; i < thread_count; i++ ) { pthread_join( threads[ i ].thread, NULL ); }
+    double elapsed = axk_host_seconds() - begin;
+
+    struct axk_host_va_stats_t va_stats;
+    axk_host_va_stats( &va_stats );
+
+    uint64_t mapped     = 0UL;
+    uint64_t unmapped   = 0UL;
+    tag_heap_map_calls( &mapped, &unmapped );
+
+    uint64_t backing_calls = ( heap->fn_alloc == _tag_alloc ) ? ( mapped - mapped_before ) + ( unmapped - unmapped_before ) :
+        ( heap->fn_alloc == _kheap_alloc ) ? va_stats.allocs + va_stats.frees + va_stats.resizes : 0UL;
+
+    printf( "%7u %12s %10u %10.1f %14lu\n", thread_count, heap->name, heap->mix_operations,
+        elapsed * 1e9 / (double)( (uint64_t)( heap->mix_operations ) * thread_count ), backing_calls );
+    return true;
+}
+
+
+/*
+    _tier_of
+    * Which part of the current heap a block of 'size' bytes comes from
+*/
+static uint32_t _tier_of( size_t size )
+{
+    if( size <= AXK_KHEAP_MAX_CLASS_SIZE ) { return 0U; }
+    if( size <= AXK_KHEAP_MAX_POOL_SIZE ) { return 1U; }
+    return 2U;
+}
+
+
+/*
+    _capacity_for
+    * The capacity 'axk_vector' picks for 'count' elements of 8 bytes (see 'calculate_capacity' in source_old/library/vector.c)
+*/
+static uint64_t _capacity_for( uint64_t count )
+{
+    uint64_t count_div  = count / 10UL;
+    uint64_t growth_div = 60UL / 6UL;
+
+    count_div = count_div < 5UL ? 5UL : ( count_div > 1024UL ? 1024UL : count_div );
+    return ( count_div * growth_div ) + count;
+}
+
+
+/*
+    _run_grow
+    * Grows a buffer to 'GROW_ELEMENTS' elements one push at a time, if 'b_side' is set another medium block is allocated and kept
+      every time the buffer grows, so the memory after the buffer is often taken
+*/
+static bool _run_grow( const struct bench_heap_t* heap, bool b_side )
+{
+    static void* side_blocks[ 4096 ];
+    uint64_t side_count = 0UL;
+
+    uint64_t* buffer    = NULL;
+    uint64_t capacity   = 0UL;
+    uint64_t reallocs   = 0UL;
+    uint64_t moves[ 3 ] = { 0UL, 0UL, 0UL };
+    uint64_t copied     = 0UL;
+
+    double begin = axk_host_seconds();
+
+    for( uint64_t count = 0UL; count < GROW_ELEMENTS; count++ )
+    {
+        if( count == capacity )
+        {
+            uint64_t new_capacity = _capacity_for( count + 1UL );
+            uint64_t* new_buffer = heap->fn_realloc( buffer, capacity * sizeof( uint64_t ), new_capacity * sizeof( uint64_t ) );
+            if( new_buffer == NULL ) { fprintf( stderr, "%s: out of memory\n", heap->name ); return false; }
+
+            // The elements already pushed must have come along
+            if( count > 0UL && ( new_buffer[ 0 ] != 0UL || new_buffer[ count - 1UL ] != count - 1UL ) )
+            {
+                printf( "FAIL: %s lost the buffer contents growing to %lu elements\n", heap->name, new_capacity );
+                return false;
+            }
+
+            reallocs++;
+            if( buffer != NULL && new_buffer != buffer )
+            {
+                moves[ _tier_of( capacity * sizeof( uint64_t ) ) ]++;
+                copied += count * sizeof( uint64_t );
+            }
+
+            buffer      = new_buffer;
+            capacity    = new_capacity;
+
+            if( b_side ) { side_blocks[ side_count++ ] = heap->fn_alloc( GROW_SIDE_SIZE ); }
+        }
+
+        buffer[ count ] = count;
+    }
+
+    double elapsed = axk_host_seconds() - begin;
+
+    heap->fn_free( buffer );
+    for( uint64_t i = 0; i < side_count; i++ ) { heap->fn_free( side_blocks[ i ] ); }
+
+    printf( "%12s %6s %9lu %7lu %7lu %7lu %7lu %11.1f %9.2f\n", heap->name, b_side ? "yes" : "no", reallocs,
+        moves[ 0 ] + moves[ 1 ] + moves[ 2 ], moves[ 0 ], moves[ 1 ], moves[ 2 ], (double)( copied ) / 1048576.0, elapsed * 1e3 );
+    return true;
+}
+
+
+int main( int argc, char** argv )
+{
+    // Defaults to as many threads as there are host processors, pass a count to go beyond that
+    uint32_t host_cpus      = axk_host_cpu_count();
+    uint32_t max_threads    = host_cpus;
+    if( argc > 1 ) { max_threads = (uint32_t)( strtoul( argv[ 1 ], NULL, 10 ) ); }
+    if( max_threads < 1U ) { max_threads = 1U; }
+    if( max_threads > MIX_MAX_THREADS - 1U ) { max_threads = MIX_MAX_THREADS - 1U; }
+
+    // Both heaps share state between processors, so they are set up once, on processor 0
+    axk_host_attach_cpu( 0U );
+    axk_kheap_init();
+    if( !tag_heap_init() ) { printf( "FAIL: the tag heap didnt initialize\n" ); return 1; }
+
+    printf( "Kernel heap alloc/free mix, %u live blocks per thread\n", MIX_LIVE_BLOCKS );
+    printf( "%7s %12s %10s %10s %14s\n", "threads", "heap", "ops", "ns/op", "backing calls" );
+
+    for( uint32_t threads = 1U; threads <= max_threads; threads *= 2U )
+    {
+        for( uint32_t i = 0; i < BENCH_HEAP_COUNT; i++ )
+        {
+            if( !_run_mix( g_heaps + i, threads ) ) { return 1; }
+        }
+    }
+
+    printf( "\nVector growth to %lu elements of 8 bytes, moves are counted by the size the buffer moved from\n", GROW_ELEMENTS );
+    printf( "%12s %6s %9s %7s %7s %7s %7s %11s %9s\n", "heap", "side", "reallocs", "moved", "slab", "pool", "range", "MB copied", "ms" );
+
+    for( uint32_t i = 0; i < BENCH_HEAP_COUNT; i++ )
+    {
+        if( !_run_grow( g_heaps + i, false ) || !_run_grow( g_heaps + i, true ) ) { return 1; }
+    }
+
+    axk_host_detach_cpu();
+    return 0;
+}
\ No newline at end of file
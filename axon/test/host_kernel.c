@@ -0,0 +1,150 @@
+/*==============================================================
+    Axon Kernel - Host Test Support
+    2021, Zachary Berry
+    axon/test/host_kernel.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/kernel/percpu.h"
+#include "axon/kernel/panic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <asm/prctl.h>
+
+/*
+    Optional Hooks
+    * Only called if the test program links the source that defines them, the same as '_load_area' in percpu.c
+*/
+extern void axk_rcu_init_cpu( struct axk_percpu_t* ptr_area ) __attribute__((weak));
+extern void axk_klog_init_cpu( struct axk_percpu_t* ptr_area ) __attribute__((weak));
+
+/*
+    State
+*/
+static struct axk_atomic_pointer_t g_areas[ AXK_MAX_CPUS ];
+static __thread struct axk_percpu_t* g_thread_area;
+
+
+void axk_panic( const char* str )
+{
+    fprintf( stderr, "PANIC: %s\n", str );
+    abort();
+}
+
+
+uint64_t axk_interrupts_disable( void )
+{
+    return 0UL;
+}
+
+
+void axk_interrupts_restore( uint64_t rflags )
+{
+    (void)( rflags );
+}
+
+
+uint64_t axk_interrupts_enable( void )
+{
+    return 0UL;
+}
+
+
+struct axk_percpu_t* axk_percpu_get( uint32_t cpu_index )
+{
+    if( cpu_index >= AXK_MAX_CPUS ) { return NULL; }
+    return (struct axk_percpu_t*) axk_atomic_load_pointer_acquire( g_areas + cpu_index );
+}
+
+
+bool axk_percpu_ready( void )
+{
+    return( g_thread_area != NULL );
+}
+
+
+uint32_t axk_get_cpu_index( void )
+{
+    return AXK_PERCPU_READ( cpu_index );
+}
+
+
+uint32_t axk_host_cpu_count( void )
+{
+    cpu_set_t set;
+    if( sched_getaffinity( 0, sizeof( set ), &set ) != 0 ) { return 1U; }
+
+    int count = CPU_COUNT( &set );
+    return count > 0 ? (uint32_t)( count ) : 1U;
+}
+
+
+struct axk_percpu_t* axk_host_attach_cpu( uint32_t cpu_index )
+{
+    if( cpu_index >= AXK_MAX_CPUS || g_thread_area != NULL ) { return NULL; }
+
+    struct axk_percpu_t* ptr_area = aligned_alloc( AXK_CACHE_LINE_SIZE, sizeof( struct axk_percpu_t ) );
+    if( ptr_area == NULL ) { return NULL; }
+
+    memset( ptr_area, 0, sizeof( struct axk_percpu_t ) );
+    ptr_area->self      = ptr_area;
+    ptr_area->cpu_index = cpu_index;
+
+    if( axk_rcu_init_cpu != NULL ) { axk_rcu_init_cpu( ptr_area ); }
+    if( axk_klog_init_cpu != NULL ) { axk_klog_init_cpu( ptr_area ); }
+
+    // Linux keeps a GS base for every thread, so this is the host version of writing the GS base MSR
+    if( syscall( SYS_arch_prctl, ARCH_SET_GS, (unsigned long)( ptr_area ) ) != 0 )
+    {
+        free( ptr_area );
+        return NULL;
+    }
+
+    // Pin to the matching host processor (wrapping around), so each kernel processor mostly stays on one host processor
+    cpu_set_t allowed;
+    if( sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0 )
+    {
+        uint32_t target = cpu_index % axk_host_cpu_count();
+        for( int cpu = 0; cpu < CPU_SETSIZE; cpu++ )
+        {
+            if( !CPU_ISSET( cpu, &allowed ) ) { continue; }
+            if( target-- != 0U ) { continue; }
+
+            cpu_set_t set;
+            CPU_ZERO( &set );
+            CPU_SET( cpu, &set );
+            pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+            break;
+        }
+    }
+
+    g_thread_area = ptr_area;
+    axk_atomic_store_pointer_release( g_areas + cpu_index, (void*) ptr_area );
+    return ptr_area;
+}
+
+
+void axk_host_detach_cpu( void )
+{
+    struct axk_percpu_t* ptr_area = g_thread_area;
+    if( ptr_area == NULL ) { return; }
+
+    axk_atomic_store_pointer_release( g_areas + ptr_area->cpu_index, NULL );
+    syscall( SYS_arch_prctl, ARCH_SET_GS, 0UL );
+
+    g_thread_area = NULL;
+    free( ptr_area );
+}
+
+
+double axk_host_seconds( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)( ts.tv_sec ) + (double)( ts.tv_nsec ) * 1e-9;
+}
\ No newline at end of file
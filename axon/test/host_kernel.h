@@ -0,0 +1,83 @@
+/*==============================================================
+    Axon Kernel - Host Test Support
+    2021, Zachary Berry
+    axon/test/host_kernel.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Host Builds
+    * The test programs compile kernel sources for the host (see 'test-axon-host' and 'bench-axon-host' in the axon makefile)
+    * 'host_kernel.c' stands in for the architecture functions the sources call (interrupts, processor index, per-cpu lookup),
+      interrupts are never really disabled, so only code that doesnt depend on that for correctness can be tested this way
+    * Each thread acts as one processor, with a real per-cpu data area and its own GS base, so the 'AXK_PERCPU_*' macros work unchanged
+*/
+struct axk_percpu_t;
+
+/*
+    axk_host_attach_cpu
+    * Gives the calling thread a zeroed per-cpu data area for processor 'cpu_index' and points its GS base at it
+    * Also pins the thread to a host processor, spreading the kernel processors over however many the host has
+*/
+struct axk_percpu_t* axk_host_attach_cpu( uint32_t cpu_index );
+
+/*
+    axk_host_detach_cpu
+    * Removes the calling thread's data area from the processor table, and frees it
+*/
+void axk_host_detach_cpu( void );
+
+/*
+    axk_host_cpu_count
+    * Number of processors the host lets this process run on
+*/
+uint32_t axk_host_cpu_count( void );
+
+/*
+    axk_host_seconds
+    * Monotonic time, for the benchmarks
+*/
+double axk_host_seconds( void );
+
+/*
+    axk_host_rand
+    * Small xorshift generator, so runs are repeatable across host C libraries
+*/
+static inline uint64_t axk_host_rand( uint64_t* state )
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/*
+    Virtual Address Allocator
+    * 'host_va.c' implements 'axk_va_alloc' and the rest of 'axon/memory/va_allocator.h' with host mappings placed in the matching
+      region (see 'host_layout.h'), for programs that build the heap
+    * Ranges are handed out from the middle of each region up, the lower half is left for programs that map memory at a region's base themselves
+*/
+struct axk_host_va_stats_t
+{
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t resizes;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+};
+
+/*
+    axk_host_va_stats
+    * Gets the number of calls made and bytes mapped since the last reset
+*/
+void axk_host_va_stats( struct axk_host_va_stats_t* out_stats );
+
+/*
+    axk_host_va_reset_stats
+    * Zeroes the call counts, and sets the peak back to the bytes mapped right now
+*/
+void axk_host_va_reset_stats( void );
\ No newline at end of file
@@ -0,0 +1,28 @@
+/*==============================================================
+    Axon Kernel - Host Address Space Layout
+    2021, Zachary Berry
+    axon/test/host_layout.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Host Layout
+    * Included ahead of every host build source by the makefile ('-include'), the host cant map anything in the upper half, so
+      the kernel regions are moved down into user space, in the same order
+    * The kernel header is pulled in first, so the overrides replace its constants before any kernel source is compiled
+*/
+#undef AXK_KERNEL_VA_PHYSICAL
+#undef AXK_KERNEL_VA_HEAP
+#undef AXK_KERNEL_VA_POOL
+#undef AXK_KERNEL_VA_SLAB
+#undef AXK_KERNEL_VA_SHARED
+#undef AXK_KERNEL_VA_IMAGE
+
+#define AXK_KERNEL_VA_PHYSICAL  0x100000000000UL
+#define AXK_KERNEL_VA_HEAP      0x200000000000UL
+#define AXK_KERNEL_VA_POOL      0x280000000000UL
+#define AXK_KERNEL_VA_SLAB      0x300000000000UL
+#define AXK_KERNEL_VA_SHARED    0x380000000000UL
+#define AXK_KERNEL_VA_IMAGE     0x7F0000000000UL
\ No newline at end of file
@@ -0,0 +1,225 @@
+/*==============================================================
+    Axon Kernel - Host Virtual Address Allocator
+    2021, Zachary Berry
+    axon/test/host_va.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/memory/va_allocator.h"
+#include <pthread.h>
+#include <sys/mman.h>
+
+/*
+    Constants
+    * Ranges are found again on free through a small open addressed table, keyed by address
+*/
+#define RANGE_TABLE_SIZE    0x10000U
+#define RANGE_EMPTY         0UL
+#define RANGE_REMOVED       1UL
+
+struct host_va_range_t
+{
+    uint64_t addr;
+    uint64_t size;
+    int prot;
+};
+
+/*
+    State
+*/
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct host_va_range_t g_ranges[ RANGE_TABLE_SIZE ];
+static uint64_t g_next[ AXK_VA_REGION_MAX_INDEX + 1 ];
+static struct axk_host_va_stats_t g_stats;
+
+static const uint64_t g_region_begin[ AXK_VA_REGION_MAX_INDEX + 1 ] =
+{
+    AXK_KERNEL_VA_HEAP, AXK_KERNEL_VA_SHARED, AXK_KERNEL_VA_SLAB, AXK_KERNEL_VA_POOL
+};
+
+static const uint64_t g_region_end[ AXK_VA_REGION_MAX_INDEX + 1 ] =
+{
+    AXK_KERNEL_VA_POOL, AXK_KERNEL_VA_SHARED + ( AXK_KERNEL_VA_SHARED - AXK_KERNEL_VA_SLAB ), AXK_KERNEL_VA_SHARED, AXK_KERNEL_VA_SLAB
+};
+
+
+/*
+    _find
+    * Private Function
+    * Finds the table slot for 'addr', or the first free slot on its probe sequence, must hold the lock
+*/
+static struct host_va_range_t* _find( uint64_t addr, bool b_insert )
+{
+    uint32_t index = (uint32_t)( ( addr >> 12 ) * 0x9E3779B97F4A7C15UL >> 48 ) & ( RANGE_TABLE_SIZE - 1U );
+    for( uint32_t i = 0; i < RANGE_TABLE_SIZE; i++ )
+    {
+        struct host_va_range_t* ptr_range = g_ranges + ( ( index + i ) & ( RANGE_TABLE_SIZE - 1U ) );
+        if( ptr_range->addr == addr ) { return ptr_range; }
+        if( ptr_range->addr == RANGE_EMPTY ) { return b_insert ? ptr_range : NULL; }
+        if( ptr_range->addr == RANGE_REMOVED && b_insert ) { return ptr_range; }
+    }
+
+    return NULL;
+}
+
+
+bool axk_va_alloc( uint8_t region, uint64_t size, uint64_t align, uint32_t flags, uint64_t* out_addr )
+{
+    if( region > AXK_VA_REGION_MAX_INDEX || size == 0UL || out_addr == NULL ) { return false; }
+    if( align < AXK_PAGE_SIZE ) { align = AXK_PAGE_SIZE; }
+    size = ( size + ( AXK_PAGE_SIZE - 1UL ) ) & ~( AXK_PAGE_SIZE - 1UL );
+
+    pthread_mutex_lock( &g_lock );
+
+    if( g_next[ region ] == 0UL )
+    {
+        g_next[ region ] = g_region_begin[ region ] + ( ( g_region_end[ region ] - g_region_begin[ region ] ) / 2UL );
+    }
+
+    uint64_t addr = ( g_next[ region ] + ( align - 1UL ) ) & ~( align - 1UL );
+    struct host_va_range_t* ptr_range = _find( addr, true );
+
+    // Address space is never reused, the same as a fresh region, so there is no need to track holes
+    int prot = AXK_CHECK_FLAG( flags, AXK_VA_FLAG_RESERVE_ONLY ) ? PROT_NONE : ( PROT_READ | PROT_WRITE );
+    if( ptr_range == NULL || addr + size > g_region_end[ region ] ||
+        mmap( (void*)( addr ), size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0 ) != (void*)( addr ) )
+    {
+        pthread_mutex_unlock( &g_lock );
+        return false;
+    }
+
+    // Anonymous host pages are always zeroed, so 'AXK_VA_FLAG_CLEAR' needs nothing extra
+    ptr_range->addr     = addr;
+    ptr_range->size     = size;
+    ptr_range->prot     = prot;
+    g_next[ region ]    = addr + size + AXK_PAGE_SIZE;
+
+    g_stats.allocs++;
+    g_stats.live_bytes += size;
+    if( g_stats.live_bytes > g_stats.peak_bytes ) { g_stats.peak_bytes = g_stats.live_bytes; }
+
+    pthread_mutex_unlock( &g_lock );
+
+    *out_addr = addr;
+    return true;
+}
+
+
+bool axk_va_free( uint64_t addr )
+{
+    pthread_mutex_lock( &g_lock );
+
+    struct host_va_range_t* ptr_range = ( addr > RANGE_REMOVED ) ? _find( addr, false ) : NULL;
+    if( ptr_range == NULL )
+    {
+        pthread_mutex_unlock( &g_lock );
+        return false;
+    }
+
+    munmap( (void*)( addr ), ptr_range->size );
+
+    g_stats.frees++;
+    g_stats.live_bytes -= ptr_range->size;
+    ptr_range->addr = RANGE_REMOVED;
+    ptr_range->size = 0UL;
+
+    pthread_mutex_unlock( &g_lock );
+    return true;
+}
+
+
+bool axk_va_resize( uint64_t addr, uint64_t new_size, uint32_t flags )
+{
+    (void)( flags );
+    if( new_size == 0UL || addr <= RANGE_REMOVED ) { return false; }
+    new_size = ( new_size + ( AXK_PAGE_SIZE - 1UL ) ) & ~( AXK_PAGE_SIZE - 1UL );
+
+    uint8_t region = 0U;
+    while( region <= AXK_VA_REGION_MAX_INDEX && ( addr < g_region_begin[ region ] || addr >= g_region_end[ region ] ) ) { region++; }
+    if( region > AXK_VA_REGION_MAX_INDEX || new_size > g_region_end[ region ] - addr - AXK_PAGE_SIZE ) { return false; }
+
+    pthread_mutex_lock( &g_lock );
+
+    struct host_va_range_t* ptr_range = _find( addr, false );
+    if( ptr_range == NULL )
+    {
+        pthread_mutex_unlock( &g_lock );
+        return false;
+    }
+
+    uint64_t old_size = ptr_range->size;
+    if( new_size < old_size )
+    {
+        munmap( (void*)( addr + new_size ), old_size - new_size );
+        g_stats.live_bytes -= old_size - new_size;
+    }
+    else if( new_size > old_size )
+    {
+        // The new pages and the guard page after them must all be unmapped, the same as needing a free extent after the range
+        // in the kernel, once mapped the guard page is given back
+        uint64_t grow_size  = new_size - old_size;
+        void* ptr_grow      = (void*)( addr + old_size );
+        if( mmap( ptr_grow, grow_size + AXK_PAGE_SIZE, ptr_range->prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0 ) != ptr_grow )
+        {
+            pthread_mutex_unlock( &g_lock );
+            return false;
+        }
+
+        munmap( (void*)( addr + new_size ), AXK_PAGE_SIZE );
+        if( g_next[ region ] < addr + new_size + AXK_PAGE_SIZE ) { g_next[ region ] = addr + new_size + AXK_PAGE_SIZE; }
+
+        g_stats.live_bytes += grow_size;
+        if( g_stats.live_bytes > g_stats.peak_bytes ) { g_stats.peak_bytes = g_stats.live_bytes; }
+    }
+
+    ptr_range->size = new_size;
+    g_stats.resizes++;
+
+    pthread_mutex_unlock( &g_lock );
+    return true;
+}
+
+
+bool axk_va_size( uint64_t addr, uint64_t* out_size )
+{
+    if( out_size == NULL || addr <= RANGE_REMOVED ) { return false; }
+
+    pthread_mutex_lock( &g_lock );
+    struct host_va_range_t* ptr_range = _find( addr, false );
+    if( ptr_range != NULL ) { *out_size = ptr_range->size; }
+    pthread_mutex_unlock( &g_lock );
+
+    return( ptr_range != NULL );
+}
+
+
+uint64_t axk_va_available( uint8_t region )
+{
+    if( region > AXK_VA_REGION_MAX_INDEX ) { return 0UL; }
+
+    pthread_mutex_lock( &g_lock );
+    uint64_t next = g_next[ region ];
+    if( next == 0UL ) { next = g_region_begin[ region ] + ( ( g_region_end[ region ] - g_region_begin[ region ] ) / 2UL ); }
+    pthread_mutex_unlock( &g_lock );
+
+    return( next < g_region_end[ region ] ? g_region_end[ region ] - next : 0UL );
+}
+
+
+void axk_host_va_stats( struct axk_host_va_stats_t* out_stats )
+{
+    pthread_mutex_lock( &g_lock );
+    *out_stats = g_stats;
+    pthread_mutex_unlock( &g_lock );
+}
+
+
+void axk_host_va_reset_stats( void )
+{
+    pthread_mutex_lock( &g_lock );
+    g_stats.allocs      = 0UL;
+    g_stats.frees       = 0UL;
+    g_stats.resizes     = 0UL;
+    g_stats.peak_bytes  = g_stats.live_bytes;
+    pthread_mutex_unlock( &g_lock );
+}
\ No newline at end of file
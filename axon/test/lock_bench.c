@@ -0,0 +1,202 @@
+/*==============================================================
+    Axon Kernel - Lock Handoff Benchmark
+    2021, Zachary Berry
+    axon/test/lock_bench.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/library/spinlock.h"
+#include "axon/library/mcslock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+    Benchmark
+    * Every thread repeatedly takes the same lock, updates two cache lines of shared data, releases, then does a little
+      private work, so most of the time is spent handing the lock from one processor to the next
+    * Compares the test-and-set lock the kernel used before (as a baseline), the ticket spinlock and the MCS lock
+    * Fairness is the fewest acquisitions any thread got, over the most, 1.0 means every thread got the same share
+    * Thread counts above the number of host processors are oversubscribed, a preempted holder (or next waiter) then stalls
+      everyone behind it, which cant happen in the kernel with interrupts disabled, so those rows arent representative
+*/
+#define BENCH_DURATION          0.25
+#define BENCH_MAX_THREADS       64U
+#define BENCH_PRIVATE_WORK      64U
+
+enum bench_lock_t
+{
+    BENCH_LOCK_TAS      = 0,
+    BENCH_LOCK_TICKET   = 1,
+    BENCH_LOCK_MCS      = 2,
+    BENCH_LOCK_COUNT    = 3
+};
+
+struct bench_thread_t
+{
+    pthread_t thread;
+    uint32_t index;
+    uint64_t acquisitions;
+
+} __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+static const char* g_lock_names[ BENCH_LOCK_COUNT ] = { "tas", "ticket", "mcs" };
+
+static enum bench_lock_t g_lock_type;
+static struct axk_atomic_bool_t g_tas_lock __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static struct axk_spinlock_t g_ticket_lock __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static struct axk_mcslock_t g_mcs_lock __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+static volatile uint64_t g_shared[ 16 ] __attribute__((aligned( AXK_CACHE_LINE_SIZE )));
+
+static struct axk_atomic_uint32_t g_ready;
+static struct axk_atomic_bool_t g_b_start;
+static struct axk_atomic_bool_t g_b_stop;
+
+
+/*
+    _tas_acquire
+    * Same as the spinlock before the ticket lock replaced it, a sequentially consistent test-and-set in a loop
+*/
+static void _tas_acquire( void )
+{
+    while( __atomic_test_and_set( &( g_tas_lock.val ), __ATOMIC_SEQ_CST ) )
+    {
+        axk_spin_pause();
+    }
+}
+
+
+static void _tas_release( void )
+{
+    __atomic_clear( &( g_tas_lock.val ), __ATOMIC_SEQ_CST );
+}
+
+
+static void* _bench_thread( void* param )
+{
+    struct bench_thread_t* self = (struct bench_thread_t*)( param );
+    axk_host_attach_cpu( self->index );
+
+    axk_atomic_fetch_add_uint32_seq_cst( &g_ready, 1U );
+    while( !axk_atomic_load_bool_acquire( &g_b_start ) ) { axk_spin_pause(); }
+
+    uint64_t count = 0UL;
+    uint64_t rand  = 0x9E3779B97F4A7C15UL + self->index;
+
+    while( !axk_atomic_load_bool_relaxed( &g_b_stop ) )
+    {
+        struct axk_mcslock_node_t node;
+        switch( g_lock_type )
+        {
+            case BENCH_LOCK_TAS:    _tas_acquire(); break;
+            case BENCH_LOCK_TICKET: axk_spinlock_acquire( &g_ticket_lock ); break;
+            default:                axk_mcslock_acquire( &g_mcs_lock, &node ); break;
+        }
+
+        g_shared[ 0 ]++;
+        g_shared[ 8 ] += g_shared[ 0 ];
+
+        switch( g_lock_type )
+        {
+            case BENCH_LOCK_TAS:    _tas_release(); break;
+            case BENCH_LOCK_TICKET: axk_spinlock_release( &g_ticket_lock ); break;
+            default:                axk_mcslock_release( &g_mcs_lock, &node ); break;
+        }
+
+        count++;
+
+        // Random amount of private work, so threads dont fall into lock-step
+        uint32_t work = (uint32_t)( axk_host_rand( &rand ) % BENCH_PRIVATE_WORK );
+        for( uint32_t i = 0; i < work; i++ ) { __asm__ volatile( "" ::: "memory" ); }
+    }
+
+    self->acquisitions = count;
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+/*
+    _run
+    * Runs one lock type at one thread count, and prints a row
+*/
+static bool _run( enum bench_lock_t lock_type, uint32_t thread_count )
+{
+    static struct bench_thread_t threads[ BENCH_MAX_THREADS ];
+
+    g_lock_type = lock_type;
+    g_shared[ 0 ] = 0UL;
+    axk_atomic_store_bool_relaxed( &g_tas_lock, false );
+    axk_spinlock_init( &g_ticket_lock );
+    axk_mcslock_init( &g_mcs_lock );
+    axk_atomic_store_uint32_relaxed( &g_ready, 0U );
+    axk_atomic_store_bool_relaxed( &g_b_start, false );
+    axk_atomic_store_bool_seq_cst( &g_b_stop, false );
+
+    for( uint32_t i = 0; i < thread_count; i++ )
+    {
+        threads[ i ].index          = i;
+        threads[ i ].acquisitions   = 0UL;
+        if( pthread_create( &( threads[ i ].thread ), NULL, _bench_thread, threads + i ) != 0 ) { return false; }
+    }
+
+    while( axk_atomic_load_uint32_acquire( &g_ready ) != thread_count ) { sched_yield(); }
+
+    double begin = axk_host_seconds();
+    axk_atomic_store_bool_release( &g_b_start, true );
+
+    struct timespec duration = { 0, (long)( BENCH_DURATION * 1e9 ) };
+    nanosleep( &duration, NULL );
+
+    axk_atomic_store_bool_seq_cst( &g_b_stop, true );
+    double elapsed = axk_host_seconds() - begin;
+
+    uint64_t total  = 0UL;
+    uint64_t min    = UINT64_MAX;
+    uint64_t max    = 0UL;
+
+    for( uint32_t i = 0; i < thread_count; i++ )
+    {
+        pthread_join( threads[ i ].thread, NULL );
+
+        uint64_t count = threads[ i ].acquisitions;
+        total += count;
+        if( count < min ) { min = count; }
+        if( count > max ) { max = count; }
+    }
+
+    if( g_shared[ 0 ] != total )
+    {
+        printf( "FAIL: %s lost updates, %lu acquisitions but the counter is %lu\n", g_lock_names[ lock_type ], total, (uint64_t)( g_shared[ 0 ] ) );
+        return false;
+    }
+
+    printf( "%7u %8s %12.2f %14.1f %10.3f\n", thread_count, g_lock_names[ lock_type ], (double)( total ) / elapsed / 1e6,
+        total > 0UL ? elapsed * 1e9 / (double)( total ) : 0.0, max > 0UL ? (double)( min ) / (double)( max ) : 0.0 );
+    return true;
+}
+
+
+int main( int argc, char** argv )
+{
+    // Defaults to as many threads as there are host processors, pass a count to go beyond that
+    uint32_t host_cpus      = axk_host_cpu_count();
+    uint32_t max_threads    = host_cpus;
+    if( argc > 1 ) { max_threads = (uint32_t)( strtoul( argv[ 1 ], NULL, 10 ) ); }
+    if( max_threads < 2U ) { max_threads = 2U; }
+    if( max_threads > BENCH_MAX_THREADS ) { max_threads = BENCH_MAX_THREADS; }
+
+    printf( "Lock handoff benchmark, %u host processors, up to %u threads\n", host_cpus, max_threads );
+    printf( "%7s %8s %12s %14s %10s\n", "threads", "lock", "Macq/s", "ns/handoff", "fairness" );
+
+    for( uint32_t threads = 2U; threads <= max_threads; threads *= 2U )
+    {
+        if( threads > host_cpus ) { printf( "(oversubscribed)\n" ); }
+        for( uint32_t lock = 0; lock < BENCH_LOCK_COUNT; lock++ )
+        {
+            if( !_run( (enum bench_lock_t)( lock ), threads ) ) { return 1; }
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
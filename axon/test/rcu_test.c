@@ -0,0 +1,292 @@
+/*==============================================================
+    Axon Kernel - Read-Copy-Update Tests
+    2021, Zachary Berry
+    axon/test/rcu_test.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/kernel/rcu.h"
+#include "axon/kernel/percpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+    Stress Test
+    * One thread acts as the writer processor, and keeps publishing new versions of a small table, the rest act as reader processors
+    * Retired versions are poisoned instead of freed, so a reader that still holds one after its grace period ended sees the poison
+    * Readers report a quiescent state between read-side sections, the same as the idle loop in the kernel
+*/
+#define TEST_READERS        6U
+#define TEST_UPDATES        4000U
+#define TEST_SYNC_EVERY     32U
+#define TEST_VALUES         8U
+
+#define VERSION_ALIVE       0xA11FE0A11FE0A11FUL
+#define VERSION_DEAD        0xDEADDEADDEADDEADUL
+
+struct test_version_t
+{
+    struct axk_rcu_head_t rcu;
+    uint64_t magic;
+    uint64_t sequence;
+    uint64_t values[ TEST_VALUES ];
+    struct test_version_t* next_retired;
+};
+
+static struct axk_atomic_pointer_t g_current;
+static struct axk_atomic_bool_t g_b_done;
+static struct axk_atomic_uint32_t g_failures;
+static struct axk_atomic_uint64_t g_callbacks;
+static struct axk_atomic_uint64_t g_reads;
+static struct test_version_t* g_retired;
+
+
+/*
+    _retire
+    * RCU callback, poisons a version once no reader can still be using it
+*/
+static void _retire( struct axk_rcu_head_t* head )
+{
+    struct test_version_t* ptr_version = (struct test_version_t*)( head );
+    ptr_version->magic = VERSION_DEAD;
+    for( uint32_t i = 0; i < TEST_VALUES; i++ ) { ptr_version->values[ i ] = 0UL; }
+
+    // Only the writer's processor runs these callbacks, so the list needs no lock
+    ptr_version->next_retired   = g_retired;
+    g_retired                   = ptr_version;
+    axk_atomic_fetch_add_uint64_relaxed( &g_callbacks, 1UL );
+}
+
+
+static struct test_version_t* _new_version( uint64_t sequence )
+{
+    struct test_version_t* ptr_version = malloc( sizeof( struct test_version_t ) );
+    if( ptr_version == NULL ) { return NULL; }
+
+    ptr_version->magic          = VERSION_ALIVE;
+    ptr_version->sequence       = sequence;
+    ptr_version->next_retired   = NULL;
+    for( uint32_t i = 0; i < TEST_VALUES; i++ ) { ptr_version->values[ i ] = sequence * ( i + 1UL ); }
+
+    return ptr_version;
+}
+
+
+static bool _check_version( struct test_version_t* ptr_version )
+{
+    if( ptr_version->magic != VERSION_ALIVE ) { return false; }
+    for( uint32_t i = 0; i < TEST_VALUES; i++ )
+    {
+        if( ptr_version->values[ i ] != ptr_version->sequence * ( i + 1UL ) ) { return false; }
+    }
+
+    return true;
+}
+
+
+static void* _reader_thread( void* param )
+{
+    uint32_t cpu_index = (uint32_t)( (uintptr_t)( param ) );
+    axk_host_attach_cpu( cpu_index );
+
+    uint64_t rand       = 0x9E3779B97F4A7C15UL * ( cpu_index + 1UL );
+    uint64_t last_seen  = 0UL;
+    uint64_t reads      = 0UL;
+
+    while( !axk_atomic_load_bool_acquire( &g_b_done ) )
+    {
+        axk_rcu_read_lock();
+        struct test_version_t* ptr_version = (struct test_version_t*) axk_rcu_dereference( &g_current );
+
+        bool b_valid = _check_version( ptr_version ) && ptr_version->sequence >= last_seen;
+        uint64_t r = axk_host_rand( &rand );
+        for( uint32_t spin = 0; spin < (uint32_t)( r % 256UL ); spin++ ) { __asm__ volatile( "" ::: "memory" ); }
+
+        // Sometimes give up the host processor while holding the pointer, so the writer gets to run in the middle of
+        // read-side sections even when there are fewer host processors than threads
+        if( ( r >> 8 ) % 64UL == 0UL ) { sched_yield(); }
+        b_valid = b_valid && _check_version( ptr_version );
+
+        last_seen = ptr_version->sequence;
+        axk_rcu_read_unlock();
+
+        if( !b_valid ) { axk_atomic_fetch_add_uint32_relaxed( &g_failures, 1U ); }
+        reads++;
+
+        axk_rcu_quiescent();
+    }
+
+    axk_atomic_fetch_add_uint64_relaxed( &g_reads, reads );
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+/*
+    _writer_thread
+    * Publishes new versions, mostly freeing the old one through 'axk_rcu_call', and sometimes waiting with 'axk_rcu_synchronize'
+*/
+static void* _writer_thread( void* param )
+{
+    (void)( param );
+    axk_host_attach_cpu( 0U );
+
+    uint64_t queued = 0UL;
+    for( uint64_t sequence = 1UL; sequence <= TEST_UPDATES; sequence++ )
+    {
+        struct test_version_t* ptr_new = _new_version( sequence );
+        if( ptr_new == NULL ) { break; }
+
+        struct test_version_t* ptr_old = (struct test_version_t*) axk_atomic_load_pointer_relaxed( &g_current );
+        axk_rcu_assign( &g_current, (void*)( ptr_new ) );
+
+        if( sequence % TEST_SYNC_EVERY == 0UL )
+        {
+            axk_rcu_synchronize();
+            _retire( &( ptr_old->rcu ) );
+        }
+        else
+        {
+            axk_rcu_call( &( ptr_old->rcu ), _retire );
+            queued++;
+        }
+
+        axk_rcu_quiescent();
+    }
+
+    axk_atomic_store_bool_release( &g_b_done, true );
+
+    // Once the readers detach, one more grace period lets every queued callback run
+    while( axk_atomic_load_uint64_relaxed( &g_callbacks ) < TEST_UPDATES )
+    {
+        axk_rcu_synchronize();
+        axk_spin_pause();
+    }
+
+    axk_host_detach_cpu();
+    return (void*)( (uintptr_t)( queued ) );
+}
+
+
+static bool _stress( void )
+{
+    pthread_t writer;
+    pthread_t readers[ TEST_READERS ];
+
+    axk_atomic_store_pointer_release( &g_current, (void*) _new_version( 0UL ) );
+
+    for( uint32_t i = 0; i < TEST_READERS; i++ )
+    {
+        if( pthread_create( readers + i, NULL, _reader_thread, (void*)( (uintptr_t)( i + 1U ) ) ) != 0 ) { return false; }
+    }
+
+    if( pthread_create( &writer, NULL, _writer_thread, NULL ) != 0 ) { return false; }
+
+    void* queued = NULL;
+    pthread_join( writer, &queued );
+    for( uint32_t i = 0; i < TEST_READERS; i++ ) { pthread_join( readers[ i ], NULL ); }
+
+    uint32_t failures   = axk_atomic_load_uint32_relaxed( &g_failures );
+    uint64_t callbacks  = axk_atomic_load_uint64_relaxed( &g_callbacks );
+
+    while( g_retired != NULL )
+    {
+        struct test_version_t* ptr_next = g_retired->next_retired;
+        free( g_retired );
+        g_retired = ptr_next;
+    }
+
+    free( axk_atomic_load_pointer_relaxed( &g_current ) );
+
+    if( failures != 0U || callbacks != TEST_UPDATES )
+    {
+        printf( "FAIL: rcu stress, %u reads saw a retired version, %lu of %u versions retired\n", failures, callbacks, TEST_UPDATES );
+        return false;
+    }
+
+    printf( "rcu stress: %u updates (%lu through axk_rcu_call), %lu reads, no retired version seen\n", TEST_UPDATES,
+        (uint64_t)( (uintptr_t)( queued ) ), axk_atomic_load_uint64_relaxed( &g_reads ) );
+    return true;
+}
+
+
+/*
+    Grace Period Test
+    * A callback queued while another processor hasnt passed a quiescent state must not run, until that processor reports one
+*/
+static struct axk_atomic_uint32_t g_step;
+static struct axk_atomic_uint64_t g_grace_calls;
+
+
+static void _count_call( struct axk_rcu_head_t* head )
+{
+    (void)( head );
+    axk_atomic_fetch_add_uint64_relaxed( &g_grace_calls, 1UL );
+}
+
+
+static void _wait_step( uint32_t step )
+{
+    while( axk_atomic_load_uint32_acquire( &g_step ) != step ) { sched_yield(); }
+}
+
+
+static void* _grace_thread( void* param )
+{
+    (void)( param );
+    axk_host_attach_cpu( 1U );
+
+    axk_atomic_store_uint32_release( &g_step, 1U );
+    _wait_step( 2U );
+
+    axk_rcu_quiescent();
+    axk_atomic_store_uint32_release( &g_step, 3U );
+    _wait_step( 4U );
+
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+static bool _test_grace_period( void )
+{
+    pthread_t thread;
+    struct axk_rcu_head_t head;
+
+    axk_host_attach_cpu( 0U );
+    if( pthread_create( &thread, NULL, _grace_thread, NULL ) != 0 ) { return false; }
+    _wait_step( 1U );
+
+    axk_rcu_call( &head, _count_call );
+    axk_rcu_quiescent();
+    bool b_early = ( axk_atomic_load_uint64_relaxed( &g_grace_calls ) != 0UL );
+
+    axk_atomic_store_uint32_release( &g_step, 2U );
+    _wait_step( 3U );
+
+    axk_rcu_quiescent();
+    bool b_ran = ( axk_atomic_load_uint64_relaxed( &g_grace_calls ) == 1UL );
+
+    axk_atomic_store_uint32_release( &g_step, 4U );
+    pthread_join( thread, NULL );
+    axk_host_detach_cpu();
+
+    if( b_early || !b_ran )
+    {
+        printf( "FAIL: rcu grace period, the callback %s\n", b_early ? "ran before the other processor was quiescent" : "never ran" );
+        return false;
+    }
+
+    printf( "rcu grace period: callback held until every processor was quiescent\n" );
+    return true;
+}
+
+
+int main( void )
+{
+    if( !_test_grace_period() || !_stress() ) { return 1; }
+
+    printf( "rcu tests passed\n" );
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+/*==============================================================
+    Axon Kernel - Reader-Writer Lock Tests
+    2021, Zachary Berry
+    axon/test/rwlock_test.c
+==============================================================*/
+
+#include "host_kernel.h"
+#include "axon/library/rwlock.h"
+#include "axon/kernel/percpu.h"
+#include <stdio.h>
+#include <pthread.h>
+
+/*
+    Stress Test
+    * Each thread acts as its own processor, and mixes reads with the occasional write
+    * Writers update two values one after the other, readers check they always match and that no writer is inside with them
+*/
+#define TEST_THREADS        8U
+#define TEST_ITERATIONS     200000U
+
+struct test_state_t
+{
+    struct axk_rwlock_t lock;
+    volatile uint64_t value_a;
+    volatile uint64_t value_b;
+    struct axk_atomic_uint32_t readers_inside;
+    struct axk_atomic_uint32_t writers_inside;
+    struct axk_atomic_uint32_t failures;
+};
+
+static struct test_state_t* g_state;
+static struct axk_atomic_uint64_t g_writes;
+
+
+static void _check_read( struct test_state_t* state )
+{
+    if( axk_atomic_load_uint32_seq_cst( &( state->writers_inside ) ) != 0U || state->value_a != state->value_b )
+    {
+        axk_atomic_fetch_add_uint32_relaxed( &( state->failures ), 1U );
+    }
+}
+
+
+static void* _test_thread( void* param )
+{
+    uint32_t cpu_index = (uint32_t)( (uintptr_t)( param ) );
+    axk_host_attach_cpu( cpu_index );
+
+    struct test_state_t* state  = g_state;
+    uint64_t rand               = 0x9E3779B97F4A7C15UL * ( cpu_index + 1UL );
+
+    for( uint32_t i = 0; i < TEST_ITERATIONS; i++ )
+    {
+        uint64_t r = axk_host_rand( &rand );
+        if( r % 16UL == 0UL )
+        {
+            axk_rwlock_acquire_write( &( state->lock ) );
+            if( axk_atomic_fetch_add_uint32_seq_cst( &( state->writers_inside ), 1U ) != 0U ||
+                axk_atomic_load_uint32_seq_cst( &( state->readers_inside ) ) != 0U )
+            {
+                axk_atomic_fetch_add_uint32_relaxed( &( state->failures ), 1U );
+            }
+
+            state->value_a++;
+            for( uint32_t spin = 0; spin < 16U; spin++ ) { __asm__ volatile( "" ::: "memory" ); }
+            state->value_b++;
+
+            axk_atomic_fetch_sub_uint32_seq_cst( &( state->writers_inside ), 1U );
+            axk_rwlock_release_write( &( state->lock ) );
+            axk_atomic_fetch_add_uint64_relaxed( &g_writes, 1UL );
+            continue;
+        }
+
+        uint64_t rflags = axk_rwlock_acquire_read( &( state->lock ) );
+        axk_atomic_fetch_add_uint32_seq_cst( &( state->readers_inside ), 1U );
+        _check_read( state );
+        for( uint32_t spin = 0; spin < (uint32_t)( ( r >> 8 ) % 32UL ); spin++ ) { __asm__ volatile( "" ::: "memory" ); }
+        _check_read( state );
+        axk_atomic_fetch_sub_uint32_seq_cst( &( state->readers_inside ), 1U );
+        axk_rwlock_release_read( &( state->lock ), rflags );
+    }
+
+    axk_host_detach_cpu();
+    return NULL;
+}
+
+
+/*
+    _stress
+    * Runs the stress test on an initialized lock
+*/
+static bool _stress( const char* name, struct test_state_t* state )
+{
+    pthread_t threads[ TEST_THREADS ];
+
+    g_state = state;
+    axk_atomic_store_uint64_relaxed( &g_writes, 0UL );
+
+    for( uint32_t i = 0; i < TEST_THREADS; i++ )
+    {
+        if( pthread_create( threads + i, NULL, _test_thread, (void*)( (uintptr_t)( i + 1U ) ) ) != 0 ) { return false; }
+    }
+
+    for( uint32_t i = 0; i < TEST_THREADS; i++ ) { pthread_join( threads[ i ], NULL ); }
+
+    uint64_t writes     = axk_atomic_load_uint64_relaxed( &g_writes );
+    uint32_t failures   = axk_atomic_load_uint32_relaxed( &( state->failures ) );
+
+    if( failures != 0U || state->value_a != writes || state->value_b != writes )
+    {
+        printf( "FAIL: rwlock (%s), %u failed checks, %lu writes but the values are %lu and %lu\n", name, failures, writes,
+            (uint64_t)( state->value_a ), (uint64_t)( state->value_b ) );
+        return false;
+    }
+
+    printf( "rwlock (%s): %lu writes, no overlap seen\n", name, writes );
+    return true;
+}
+
+
+int main( void )
+{
+    static struct test_state_t shared_state;
+    static struct test_state_t percpu_state;
+    static struct axk_rwlock_t slot_locks[ AXK_RWLOCK_PERCPU_SLOTS ];
+
+    // Created before any per-cpu data area exists, so it counts readers in the lock itself
+    axk_rwlock_init( &( shared_state.lock ) );
+    if( shared_state.lock.slot != AXK_RWLOCK_NO_SLOT )
+    {
+        printf( "FAIL: rwlock took a per-cpu slot before the per-cpu areas existed\n" );
+        return 1;
+    }
+
+    axk_host_attach_cpu( 0U );
+    axk_rwlock_init( &( percpu_state.lock ) );
+    if( percpu_state.lock.slot == AXK_RWLOCK_NO_SLOT )
+    {
+        printf( "FAIL: rwlock didnt take a per-cpu slot\n" );
+        return 1;
+    }
+
+    if( !_stress( "shared count", &shared_state ) || !_stress( "per-cpu counts", &percpu_state ) ) { return 1; }
+
+    // Once every slot is taken, new locks fall back on the shared count, and a destroyed lock hands its slot back
+    uint32_t taken = 0U;
+    for( uint32_t i = 0; i < AXK_RWLOCK_PERCPU_SLOTS; i++ )
+    {
+        axk_rwlock_init( slot_locks + i );
+        if( slot_locks[ i ].slot != AXK_RWLOCK_NO_SLOT ) { taken++; }
+    }
+
+    struct axk_rwlock_t last_lock;
+    axk_rwlock_init( &last_lock );
+    bool b_exhausted = ( taken == AXK_RWLOCK_PERCPU_SLOTS - 1U && last_lock.slot == AXK_RWLOCK_NO_SLOT );
+
+    axk_rwlock_destroy( &( percpu_state.lock ) );
+    axk_rwlock_init( &last_lock );
+    if( !b_exhausted || last_lock.slot == AXK_RWLOCK_NO_SLOT )
+    {
+        printf( "FAIL: rwlock slots, %u taken out of %u\n", taken, AXK_RWLOCK_PERCPU_SLOTS );
+        return 1;
+    }
+
+    printf( "rwlock tests passed\n" );
+    return 0;
+}
\ No newline at end of file
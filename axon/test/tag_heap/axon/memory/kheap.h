@@ -0,0 +1,8 @@
+/*==============================================================
+    Axon Kernel - Tag Heap Baseline (Host Shim)
+    2021, Zachary Berry
+    axon/test/tag_heap/axon/memory/kheap.h
+==============================================================*/
+
+#pragma once
+#include "tag_heap_shim.h"
\ No newline at end of file
@@ -0,0 +1,27 @@
+/*==============================================================
+    Axon Kernel - Tag Heap Baseline
+    2021, Zachary Berry
+    axon/test/tag_heap/tag_heap.h
+==============================================================*/
+
+#pragma once
+#include "axon/kernel/kernel.h"
+
+/*
+    Tag Heap
+    * The kernel heap before the slab and pool allocators (source_old/memory/kheap.c), built for the host unchanged, so the heap
+      benchmark has the real thing to compare against
+    * Its functions are renamed from 'axk_kheap_*' to 'tag_heap_*' so it can be linked next to the current heap, see 'tag_heap_shim.h'
+    * It maps pages at the base of the heap region, which the host virtual address allocator leaves free (see 'axk_host_va_stats')
+*/
+bool tag_heap_init( void );
+uint64_t tag_heap_page_count( void );
+void* tag_heap_alloc( size_t sz, bool b_clear );
+void* tag_heap_realloc( void* ptr, size_t new_sz, bool b_clear );
+void tag_heap_free( void* ptr );
+
+/*
+    tag_heap_map_calls
+    * Number of pages the tag heap has mapped and unmapped, since it was initialized
+*/
+void tag_heap_map_calls( uint64_t* out_mapped, uint64_t* out_unmapped );
\ No newline at end of file
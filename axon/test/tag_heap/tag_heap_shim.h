@@ -0,0 +1,105 @@
+/*==============================================================
+    Axon Kernel - Tag Heap Baseline (Host Shim)
+    2021, Zachary Berry
+    axon/test/tag_heap/tag_heap_shim.h
+==============================================================*/
+
+#pragma once
+#include "tag_heap.h"
+#include "axon/kernel/panic.h"
+#include <sys/mman.h>
+
+/*
+    Host Shim
+    * Every header the old heap includes resolves to this file (the build puts 'test/tag_heap/' first on the include path), and
+      it is only ever included by that one source file, so the functions below are defined here directly
+    * The old page allocator and 'axk_kmap' are replaced with one reserved range at the base of the heap region, mapping and
+      unmapping a page only counts the call
+*/
+#define axk_kheap_init          tag_heap_init
+#define axk_kheap_page_count    tag_heap_page_count
+#define axk_kheap_alloc         tag_heap_alloc
+#define axk_kheap_realloc       tag_heap_realloc
+#define axk_kheap_free          tag_heap_free
+#define axk_kheap_debug         tag_heap_debug
+#define alloc_helper_expand     tag_heap_helper_expand
+#define alloc_helper_avail      tag_heap_helper_avail
+
+/*
+    Constants
+    * The old headers are gone, the alignment is 16 bytes as the tag masks require, and validation is off like a release build
+*/
+#define AXK_KHEAP_ALIGN                 16UL
+#define AXK_KHEAP_MIN_ALLOC             16UL
+#define AXK_KHEAP_VALIDATE              0
+#define TAG_HEAP_RESERVE                0x100000000UL
+
+#define AXK_FLAG_NONE                   0x00
+#define AXK_FLAG_MAP_ALLOW_OVERWRITE    0x01
+#define AXK_FLAG_PAGE_CLEAR_ON_LOCK     0x01
+#define AXK_FLAG_PAGE_TYPE_HEAP         0x10
+#define AXK_FLAG_PAGE_TYPE_PTABLE       0x20
+
+typedef uint64_t AXK_PAGE_ID;
+
+static uint64_t g_shim_mapped;
+static uint64_t g_shim_unmapped;
+
+
+static inline bool axk_page_acquire( uint64_t count, AXK_PAGE_ID* out_list, uint32_t process, uint32_t flags )
+{
+    (void)( process );
+    (void)( flags );
+    for( uint64_t i = 0; i < count; i++ ) { out_list[ i ] = 1UL; }
+    return true;
+}
+
+
+static inline bool axk_page_release( uint64_t count, AXK_PAGE_ID* list, bool b_clear )
+{
+    (void)( count );
+    (void)( list );
+    (void)( b_clear );
+    return true;
+}
+
+
+static inline bool axk_kmap( AXK_PAGE_ID page, uint64_t address, uint32_t flags )
+{
+    (void)( page );
+    (void)( flags );
+
+    // The first page mapped is always the heap base, reserve the whole range then
+    if( address == AXK_KERNEL_VA_HEAP &&
+        mmap( (void*)( address ), TAG_HEAP_RESERVE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0 ) != (void*)( address ) )
+    {
+        return false;
+    }
+
+    g_shim_mapped++;
+    return( address >= AXK_KERNEL_VA_HEAP && address < AXK_KERNEL_VA_HEAP + TAG_HEAP_RESERVE );
+}
+
+
+static inline AXK_PAGE_ID axk_kunmap( uint64_t address )
+{
+    (void)( address );
+    g_shim_unmapped++;
+    return 1UL;
+}
+
+
+void tag_heap_map_calls( uint64_t* out_mapped, uint64_t* out_unmapped )
+{
+    *out_mapped     = g_shim_mapped;
+    *out_unmapped   = g_shim_unmapped;
+}
+
+
+static inline void axk_basicout_lock( void ) {}
+static inline void axk_basicout_unlock( void ) {}
+static inline void axk_basicout_prints( const char* str ) { (void)( str ); }
+static inline void axk_basicout_printu64( uint64_t num ) { (void)( num ); }
+static inline void axk_basicout_printh64( uint64_t num, bool b_leading_zeros ) { (void)( num ); (void)( b_leading_zeros ); }
+static inline void axk_basicout_printtab( void ) {}
+static inline void axk_basicout_printnl( void ) {}
\ No newline at end of file
@@ -4,324 +4,655 @@
 ;    libk/arch_x86_64/string.asm
 ;==============================================================
 
+; Copies and fills are split into size tiers:
+;   0 - 16 bytes    Two possibly overlapping loads/stores, sized to the count, no loops
+;   17 - 32 bytes   Two overlapping 16-byte SSE loads/stores
+;   33 - 256 bytes  32-byte SSE blocks, with the last (unaligned) block written from the end of the range
+;   > 256 bytes     'rep movsb/stosb' if the processor has ERMS, otherwise 64-byte SSE blocks with aligned stores
+; Fills of a page or larger use non-temporal stores, so clearing large ranges doesnt evict everything else from the cache
+; The large copy/fill and strcmp implementations are picked once at boot through the kernel dispatch table (see axon/system/cpu_features.h)
+;
+; Strings are scanned without reading past the end of the page the terminator is in:
+;   strlen          Aligned 16-byte SSE2 blocks, an aligned block can never cross a page
+;   strcmp          8 bytes at a time (using the 'has zero byte' trick), or 16 at a time with 'pcmpistri' if the processor has SSE4.2,
+;                   falling back to single bytes whenever a load could cross into the next page
+
+; These values must match the 'AXK_CPU_FEATURE_*' flags in axon/system/cpu_features.h
+%define AXK_CPU_FEATURE_SSE42   0x0008
+%define AXK_CPU_FEATURE_ERMS    0x0200
+%define AXK_CPU_FEATURE_FSRM    0x0400
+
+%define STRING_MEDIUM_LIMIT     256
+%define STRING_NT_THRESHOLD     4096
 
 global memset
 global memmove
 global memcmp
 global strlen
+global strcmp
 global memcpy
 
+;================================== Dispatch Slots ===================================
+; Each slot starts out pointing at a baseline (SSE2) implementation, which works on every x86_64 processor
+; During boot, the kernel walks the candidates below and points each slot at the highest priority one the processor supports
+section .data
+align 8
+
+memcpy_large_slot:
+    dq memcpy_large_sse
+
+memset_large_slot:
+    dq memset_large_sse
+
+strcmp_slot:
+    dq strcmp_word
+
+;================================== Dispatch Candidates ===================================
+; Layout matches 'struct axk_dispatch_candidate_t': slot, function, required features, priority
+section .axk_dispatch progbits alloc noexec nowrite align=8
+
+    dq memcpy_large_slot, memcpy_large_erms, AXK_CPU_FEATURE_ERMS, 1
+    dq memcpy_large_slot, memcpy_large_erms, AXK_CPU_FEATURE_FSRM, 1
+    dq memset_large_slot, memset_large_erms, AXK_CPU_FEATURE_ERMS, 1
+    dq strcmp_slot, strcmp_sse42, AXK_CPU_FEATURE_SSE42, 1
+
 section .text
 bits 64
 
 ;; void* memcpy( void* dst, void* src, size_t count )
 ;; dst = rdi, src = rsi, count = rdx
 ;; return to rax, should return the dest addr
+;; Every tier loads its head and tail before storing anything over them, so forward copies are also safe for 'memmove' when dst < src
 memcpy:
 
+    mov rax, rdi
 
-    ; Setup stack
-    push rbp
-    mov rbp, rsp
+    cmp rdx, 16
+    ja .above_16
 
-    ; Push the input memory address, so when we exit we can pop it to rax
-    push rdi
+    ; 8 - 16 bytes, two qwords
+    cmp edx, 8
+    jb .below_8
+    mov rcx, qword [rsi]
+    mov r8, qword [rsi + rdx - 8]
+    mov qword [rdi], rcx
+    mov qword [rdi + rdx - 8], r8
+    ret
 
-    ; Check for nulls, and zero count
-    or rdi, rdi
-    jz .invalid_params
+    .below_8:
 
-    or rsi, rsi
-    jz .invalid_params
+    ; 4 - 7 bytes, two dwords
+    cmp edx, 4
+    jb .below_4
+    mov ecx, dword [rsi]
+    mov r8d, dword [rsi + rdx - 4]
+    mov dword [rdi], ecx
+    mov dword [rdi + rdx - 4], r8d
+    ret
 
-    cmp rdx, 0
-    je .invalid_params
+    .below_4:
+
+    ; 1 - 3 bytes, the first, middle and last byte
+    test edx, edx
+    jz .exit
+    mov r9, rdx
+    shr r9, 1
+    movzx ecx, byte [rsi]
+    movzx r8d, byte [rsi + rdx - 1]
+    movzx r10d, byte [rsi + r9]
+    mov byte [rdi], cl
+    mov byte [rdi + r9], r10b
+    mov byte [rdi + rdx - 1], r8b
+
+    .exit:
+    ret
 
-    ; Loop through memory, and copy
-    mov rcx, 0
-    .loop_begin:
+    .above_16:
 
-    mov r8b, [rsi]
-    mov [rdi], r8b
+    ; 17 - 32 bytes, two overlapping xmm registers
+    cmp rdx, 32
+    ja .above_32
+    movdqu xmm0, [rsi]
+    movdqu xmm1, [rsi + rdx - 16]
+    movdqu [rdi], xmm0
+    movdqu [rdi + rdx - 16], xmm1
+    ret
 
-    inc rcx
-    inc rsi
-    inc rdi
+    .above_32:
+
+    cmp rdx, STRING_MEDIUM_LIMIT
+    ja .large
+
+    ; 33 - 256 bytes, load the last 32 bytes up front, then copy 32 bytes at a time until theres 32 or less left
+    movdqu xmm2, [rsi + rdx - 32]
+    movdqu xmm3, [rsi + rdx - 16]
+    lea r8, [rdi + rdx - 32]
+
+    .medium_loop:
+    movdqu xmm0, [rsi]
+    movdqu xmm1, [rsi + 16]
+    movdqu [rdi], xmm0
+    movdqu [rdi + 16], xmm1
+    add rsi, 32
+    add rdi, 32
+    sub rdx, 32
+    cmp rdx, 32
+    ja .medium_loop
+
+    movdqu [r8], xmm2
+    movdqu [r8 + 16], xmm3
+    ret
 
-    cmp rcx, rdx
-    jge .loop_exit
-    jmp .loop_begin
-    
-    .loop_exit:
-    pop rax
-    pop rbp
+    .large:
+    jmp [rel memcpy_large_slot]
+
+;; memcpy for more than 256 bytes, with 'rep movsb' (ERMS or FSRM)
+;; rax already holds the return value
+memcpy_large_erms:
+
+    mov rcx, rdx
+    rep movsb
     ret
 
-    .invalid_params:
-    pop rax
-    xor rax, rax
-    pop rbp
+;; memcpy for more than 256 bytes, with SSE2
+;; rax already holds the return value
+memcpy_large_sse:
+
+    ; Load the first 16 and last 64 bytes, these are stored after the loop so the loop can use aligned stores
+    movdqu xmm4, [rsi]
+    movdqu xmm5, [rsi + rdx - 64]
+    movdqu xmm6, [rsi + rdx - 48]
+    movdqu xmm7, [rsi + rdx - 32]
+    movdqu xmm8, [rsi + rdx - 16]
+    lea r8, [rdi + rdx - 64]
+
+    ; Skip ahead to the next 16-byte boundary in the destination
+    mov rcx, rdi
+    neg rcx
+    and ecx, 15
+    add rdi, rcx
+    add rsi, rcx
+    sub rdx, rcx
+
+    .large_loop:
+    movdqu xmm0, [rsi]
+    movdqu xmm1, [rsi + 16]
+    movdqu xmm2, [rsi + 32]
+    movdqu xmm3, [rsi + 48]
+    movdqa [rdi], xmm0
+    movdqa [rdi + 16], xmm1
+    movdqa [rdi + 32], xmm2
+    movdqa [rdi + 48], xmm3
+    add rsi, 64
+    add rdi, 64
+    sub rdx, 64
+    cmp rdx, 64
+    ja .large_loop
+
+    movdqu [r8], xmm5
+    movdqu [r8 + 16], xmm6
+    movdqu [r8 + 32], xmm7
+    movdqu [r8 + 48], xmm8
+    movdqu [rax], xmm4
     ret
 
 ;; void* memset( void* addr, uint8_t val, size_t count )
 ;; addr = rdi, val = sil, count = rdx
 memset:
 
-    ; Set stack frame
-    push rbp
-    mov rbp, rsp
+    mov rax, rdi
 
-    ; Calculate the 'past end' address for the target memory range in rdx
-    push rdi
-    add rdx, rdi
+    ; Broadcast the byte to all 8 bytes of rcx
+    movzx ecx, sil
+    mov r8, 0x0101010101010101
+    imul rcx, r8
 
-    ; Loop through each address in the range, and copy the 8-bit into it, rdi is counter
-    .loop_begin:
+    cmp rdx, 16
+    ja .above_16
 
-    cmp rdi, rdx
-    jge .loop_end
+    ; 8 - 16 bytes
+    cmp edx, 8
+    jb .below_8
+    mov qword [rdi], rcx
+    mov qword [rdi + rdx - 8], rcx
+    ret
 
-    ; Write value into memory address
-    mov byte [rdi], sil
+    .below_8:
 
-    inc rdi
-    jmp .loop_begin
-    
-    .loop_end:
+    ; 4 - 7 bytes
+    cmp edx, 4
+    jb .below_4
+    mov dword [rdi], ecx
+    mov dword [rdi + rdx - 4], ecx
+    ret
+
+    .below_4:
 
-    ; Pop the starting address into the return register, and restore stack frame
-    pop rax
-    pop rbp
+    ; 2 - 3 bytes
+    cmp edx, 2
+    jb .below_2
+    mov word [rdi], cx
+    mov word [rdi + rdx - 2], cx
     ret
 
-;; void* memmove( void* dst, const void* src, size_t count );
-;; dst = rdi, src = rsi, count = rdx
-;; ret to rax
-memmove:
+    .below_2:
 
-    ; The difference between memcpy is, we properly handle overlapping memory buffers
-    ; To do this, we detect which comes first in memory, and we either copy in reverse or normal order depending
-    ; Setup stack
-    push rbp
-    mov rbp, rsp
-
-    ; Push destination to stack, so we can pop and return it
-    push rdi
-
-    ; Check for nulls and zero count
-    or rdi, rdi
-    jz .func_exit
-    or rsi, rsi
-    jz .func_exit
-    or rdx, rdx
-    jz .func_exit
-
-    ; Determine order to copy in
-    ; If the destination is later than source, we copy in reverse (rdi > rsi)
-    ; If the destination is before the source, we copy forwards (rdi < rsi)
-    cmp rdi, rsi
-    jg .do_reverse_copy
-    
-    ; Do a forward copy
-    mov rcx, 0
-
-    .fwdloop_begin:
-
-    ; Store copy of the byte in r8b then copy to dest
-    mov r8b, [rsi]
-    mov [rdi], r8b
-
-    ; Incremement everything
-    inc rsi
-    inc rdi
-    inc rcx
+    test edx, edx
+    jz .exit
+    mov byte [rdi], cl
 
-    ; Check for end of loop
-    cmp rcx, rdx
-    jge .func_exit
-    jmp .fwdloop_begin
+    .exit:
+    ret
 
-    .do_reverse_copy:
+    .above_16:
 
-    mov rcx, rdx
-    add rsi, rcx
-    add rdi, rcx
+    movq xmm0, rcx
+    punpcklqdq xmm0, xmm0
 
-    .rvloop_begin:
+    ; 17 - 32 bytes
+    cmp rdx, 32
+    ja .above_32
+    movdqu [rdi], xmm0
+    movdqu [rdi + rdx - 16], xmm0
+    ret
 
-    ; Decrement addresses and counter
-    dec rcx
-    dec rsi
-    dec rdi
+    .above_32:
 
-    ; Store copy of the byte in r8b and then copy to dest
-    mov r8b, [rsi]
-    mov [rdi], r8b
+    cmp rdx, STRING_MEDIUM_LIMIT
+    ja .large
 
-    ; Check for end of loop
-    or rcx, rcx
-    jz .func_exit
-    jmp .rvloop_begin
+    ; 33 - 256 bytes, write the last 32 bytes first, then 32 bytes at a time from the start
+    movdqu [rdi + rdx - 32], xmm0
+    movdqu [rdi + rdx - 16], xmm0
 
-    .func_exit:
-    pop rax
-    pop rbp
+    .medium_loop:
+    movdqu [rdi], xmm0
+    movdqu [rdi + 16], xmm0
+    add rdi, 32
+    sub rdx, 32
+    cmp rdx, 32
+    ja .medium_loop
     ret
 
+    .large:
 
-    ; Setup stack
-    push rbp
-    mov rbp, rsp
+    cmp rdx, STRING_NT_THRESHOLD
+    jae .nontemporal
 
-    ; Push the input memory address, so when we exit we can pop it to rax
-    push rdi
+    jmp [rel memset_large_slot]
 
-    ; Check for nulls, and zero count
-    or rdi, rdi
-    jz .invalid_params
+    .nontemporal:
 
-    or rsi, rsi
-    jz .invalid_params
+    ; Write the unaligned head and last 64 bytes, then fill the aligned middle 64 bytes at a time, bypassing the cache
+    lea r8, [rdi + rdx]
+    movdqu [rdi], xmm0
+    movdqu [r8 - 64], xmm0
+    movdqu [r8 - 48], xmm0
+    movdqu [r8 - 32], xmm0
+    movdqu [r8 - 16], xmm0
 
-    cmp rdx, 0
-    je .invalid_params
+    add rdi, 16
+    and rdi, -16
+    sub r8, 64
 
-    ; Loop through memory, and copy
-    mov rcx, 0
-    .loop_begin:
+    .nontemporal_loop:
+    movntdq [rdi], xmm0
+    movntdq [rdi + 16], xmm0
+    movntdq [rdi + 32], xmm0
+    movntdq [rdi + 48], xmm0
+    add rdi, 64
+    cmp rdi, r8
+    jb .nontemporal_loop
 
-    mov r8b, [rsi]
-    mov [rdi], r8b
+    ; Non-temporal stores are weakly ordered, so fence before anyone else can see the memory
+    sfence
+    ret
 
-    inc rcx
-    inc rsi
-    inc rdi
+;; memset for 257 - 4095 bytes, with 'rep stosb' (ERMS)
+;; rax already holds the return value
+memset_large_erms:
 
-    cmp rcx, rdx
-    jge .loop_exit
-    jmp .loop_begin
-    
-    .loop_exit:
-    pop rax
-    pop rbp
+    mov r9, rdi
+    mov eax, esi
+    mov rcx, rdx
+    rep stosb
+    mov rax, r9
     ret
 
-    .invalid_params:
-    pop rax
-    xor rax, rax
-    pop rbp
+;; memset for 257 - 4095 bytes, with SSE2
+;; rax already holds the return value, xmm0 holds the fill pattern
+memset_large_sse:
+
+    ; Write the unaligned head and last 64 bytes, then fill the aligned middle 64 bytes at a time
+    lea r8, [rdi + rdx]
+    movdqu [rdi], xmm0
+    movdqu [r8 - 64], xmm0
+    movdqu [r8 - 48], xmm0
+    movdqu [r8 - 32], xmm0
+    movdqu [r8 - 16], xmm0
+
+    add rdi, 16
+    and rdi, -16
+    sub r8, 64
+
+    .large_loop:
+    movdqa [rdi], xmm0
+    movdqa [rdi + 16], xmm0
+    movdqa [rdi + 32], xmm0
+    movdqa [rdi + 48], xmm0
+    add rdi, 64
+    cmp rdi, r8
+    jb .large_loop
+    ret
+
+;; void* memmove( void* dst, const void* src, size_t count );
+;; dst = rdi, src = rsi, count = rdx
+;; ret to rax
+memmove:
+
+    ; If the destination doesnt start inside the source range, a forward copy is safe, so just use memcpy
+    ; (dst - src) as unsigned is only less than count when src < dst < src + count
+    mov rcx, rdi
+    sub rcx, rsi
+    cmp rcx, rdx
+    jb .backward
+
+    ; 'rep movsb' falls back to single bytes when the destination is less than 64 bytes below the source, so close forward
+    ; overlaps skip the dispatch slot and always use the SSE loop
+    neg rcx
+    cmp rcx, 64
+    jae memcpy
+    cmp rdx, STRING_MEDIUM_LIMIT
+    jbe memcpy
+    mov rax, rdi
+    jmp memcpy_large_sse
+
+    .backward:
+
+    ; Copies up to 32 bytes load everything before storing, so they dont care about overlap either
+    cmp rdx, 32
+    jbe memcpy
+
+    mov rax, rdi
+
+    ; Otherwise, copy backwards in 32 byte blocks, the first 32 bytes are loaded up front and written last
+    movdqu xmm2, [rsi]
+    movdqu xmm3, [rsi + 16]
+
+    .reverse_loop:
+    movdqu xmm0, [rsi + rdx - 32]
+    movdqu xmm1, [rsi + rdx - 16]
+    movdqu [rdi + rdx - 32], xmm0
+    movdqu [rdi + rdx - 16], xmm1
+    sub rdx, 32
+    cmp rdx, 32
+    ja .reverse_loop
+
+    movdqu [rax], xmm2
+    movdqu [rax + 16], xmm3
     ret
 
 ;; int memcmp( const void* ptr_a, const void* ptr_b, size_t count );
 ;; ptr_a = rdi, ptr_b = rsi, count = rdx
-;; ret to eax
+;; ret to eax, the difference between the first pair of bytes (as unsigned) that dont match
 memcmp:
 
-    ; Setup stack
-    push rbp
-    mov rbp, rsp
-
-    xor rax, rax
+    xor eax, eax
 
     ; Check for a count of zero
-    or rdx, rdx
-    jnz .valid_count
+    test rdx, rdx
+    jz .exit
 
-    pop rbp
+    ; Check for null pointers, although this isnt part of the standard..
+    test rdi, rdi
+    jz .a_null
+    test rsi, rsi
+    jz .b_null
+
+    cmp rdx, 16
+    jb .below_16
+
+    ; 16 bytes at a time, the mask has a bit set for every byte that matched
+    .block_loop:
+    movdqu xmm0, [rdi]
+    movdqu xmm1, [rsi]
+    pcmpeqb xmm0, xmm1
+    pmovmskb ecx, xmm0
+    xor ecx, 0xFFFF
+    jnz .found_diff
+    add rdi, 16
+    add rsi, 16
+    sub rdx, 16
+    cmp rdx, 16
+    jae .block_loop
+
+    ; Compare the last 16 bytes of the range (overlapping bytes we already checked) for the remainder
+    test rdx, rdx
+    jz .exit
+    lea rdi, [rdi + rdx - 16]
+    lea rsi, [rsi + rdx - 16]
+    mov edx, 16
+    jmp .block_loop
+
+    .below_16:
+
+    ; 8 - 15 bytes, compare two overlapping qwords, and find the first different byte from the xor
+    cmp edx, 8
+    jb .below_8
+    mov rcx, qword [rdi]
+    xor rcx, qword [rsi]
+    jnz .found_diff_qword
+    lea rdi, [rdi + rdx - 8]
+    lea rsi, [rsi + rdx - 8]
+    mov rcx, qword [rdi]
+    xor rcx, qword [rsi]
+    jnz .found_diff_qword
     ret
 
-    .valid_count:
+    .below_8:
 
-    ; Check for null pointers, although this isnt part of the standard..
-    or rdi, rdi
-    jz .a_null
-    or rsi, rsi
-    jz .b_null ; If we goto 'b_null', we know a is NOT null
-    jmp .func_main
+    ; 1 - 7 bytes, a byte at a time
+    movzx eax, byte [rdi]
+    movzx ecx, byte [rsi]
+    sub eax, ecx
+    jnz .exit
+    inc rdi
+    inc rsi
+    dec edx
+    jnz .below_8
+
+    .exit:
+    ret
+
+    .found_diff_qword:
+    bsf rcx, rcx
+    shr ecx, 3
+    jmp .found_byte
 
-    .a_null: ;;;;;;; A NULL
+    .found_diff:
+    bsf ecx, ecx
+
+    .found_byte:
+    movzx eax, byte [rdi + rcx]
+    movzx ecx, byte [rsi + rcx]
+    sub eax, ecx
+    ret
+
+    .a_null:
 
     ; Check if both are null
-    or rsi, rsi
-    jz .both_null
+    test rsi, rsi
+    jz .exit
 
     ; a is null, b is not, so lets return > 1
     mov eax, 0x7FFFFFFF
-    pop rbp
     ret
 
-    .b_null: ;;;;;;; B NULL
+    .b_null:
 
     ; Return < 1
     mov eax, 0x80000000
-    pop rbp
     ret
 
-    .both_null: ;;;;;;;;; BOTH NULL 
-
-    ; Return 0
-    pop rbp
-    ret
+;; size_t strlen( const char* str );
+;; str = rdi
+;; ret to rax
+strlen:
 
-    .func_main: ;;;;;; Neither Null
+    ; Check for null ptr
+    xor eax, eax
+    test rdi, rdi
+    jz .exit
+
+    ; Start at the aligned block containing the first character, and ignore any matches from before the string
+    mov rax, rdi
+    and rax, -16
+    mov ecx, edi
+    and ecx, 15
+
+    pxor xmm0, xmm0
+    movdqa xmm1, [rax]
+    pcmpeqb xmm1, xmm0
+    pmovmskb edx, xmm1
+    shr edx, cl
+    test edx, edx
+    jnz .found_first
 
-    ; So, lets loop until we find a difference, if the byte pointed to by ptr_a is less, we return < 1, and vise versa
-    ; If we hit the end of the range, and found no difference, we return 0
-    mov rcx, 0
-    mov r8d, 0
     .loop_begin:
+    add rax, 16
+    movdqa xmm1, [rax]
+    pcmpeqb xmm1, xmm0
+    pmovmskb edx, xmm1
+    test edx, edx
+    jz .loop_begin
+
+    bsf edx, edx
+    add rax, rdx
+    sub rax, rdi
+
+    .exit:
+    ret
 
-    mov byte r8b, [rdi]
-
-    ; ptr_a = r8l, ptr_b = rsi
-    cmp r8b, [rsi]
-    jne .found_diff
+    .found_first:
+    bsf eax, edx
+    ret
 
-    ; Check if we hit the end of the range
-    inc rcx
+;; int strcmp( const char* str_a, const char* str_b );
+;; str_a = rdi, str_b = rsi
+;; ret to eax, the difference between the first pair of characters (as unsigned) that dont match
+strcmp:
+
+    jmp [rel strcmp_slot]
+
+;; strcmp, 8 bytes at a time
+strcmp_word:
+
+    mov r8, 0x0101010101010101
+    mov r9, 0x8080808080808080
+
+    ; Compare single bytes until str_a is aligned, so its 8 byte loads cant cross a page
+    mov r10, rdi
+    neg r10
+    and r10d, 7
+    jnz .word_bytes
+
+    .word_loop:
+
+    ; Only str_b can be unaligned, if this load could cross into the next page, step over the next 8 bytes one at a time
+    mov ecx, esi
+    and ecx, 0xFFF
+    cmp ecx, 0xFF8
+    ja .word_bytes_8
+
+    mov rax, qword [rdi]
+    mov rdx, qword [rsi]
+    cmp rax, rdx
+    jne .word_bytes_8
+
+    ; The words match, if they contain a null the strings are equal
+    mov rcx, rax
+    sub rcx, r8
+    not rax
+    and rcx, rax
+    test rcx, r9
+    jnz .equal
+
+    add rdi, 8
+    add rsi, 8
+    jmp .word_loop
+
+    .word_bytes_8:
+
+    ; The difference or null (if any) is within the next 8 bytes
+    mov r10d, 8
+
+    .word_bytes:
+    movzx eax, byte [rdi]
+    movzx edx, byte [rsi]
+    sub eax, edx
+    jnz .exit
+    test edx, edx
+    jz .exit
     inc rdi
     inc rsi
+    dec r10d
+    jnz .word_bytes
+    jmp .word_loop
 
-    cmp rcx, rdx
-    jge .func_exit
-    jmp .loop_begin
-
-    .found_diff:
-    xor rcx, rcx
-    mov byte cl, [rsi]
-    sub byte r8b, cl
-    movsx eax, r8b
+    .equal:
+    xor eax, eax
 
-    .func_exit:
-    pop rbp
+    .exit:
     ret
 
-;; size_t strlen( const char* str );
-;; str = rdi
-;; ret to rax
-strlen:
-
-    ; Setup stack
-    push rbp
-    mov rbp, rsp
-
-    ; Check for null ptr
-    mov rax, 0
-    or rdi, rdi
-    jnz .loop_begin
-    
-    ; Invalid ptr!
-    pop rbp
+;; strcmp, 16 bytes at a time with SSE4.2
+strcmp_sse42:
+
+    ; Same as 'strcmp_word', but both strings can be unaligned
+    mov ecx, edi
+    and ecx, 0xFFF
+    cmp ecx, 0xFF0
+    ja .sse42_bytes_16
+    mov ecx, esi
+    and ecx, 0xFFF
+    cmp ecx, 0xFF0
+    ja .sse42_bytes_16
+
+    ; Unsigned bytes, equal each, negative polarity: ecx is the index of the first byte that differs, or where only one string ended
+    ; CF is set if there was one, ZF is set if str_b ended in this block
+    movdqu xmm0, [rdi]
+    pcmpistri xmm0, [rsi], 0x18
+    jc .sse42_found
+    jz .equal
+
+    add rdi, 16
+    add rsi, 16
+    jmp strcmp_sse42
+
+    .sse42_found:
+    movzx eax, byte [rdi + rcx]
+    movzx edx, byte [rsi + rcx]
+    sub eax, edx
     ret
 
-    .loop_begin:
-    cmp byte [rdi], 0x00
-    je .loop_exit
+    .sse42_bytes_16:
+    mov r10d, 16
 
+    .sse42_bytes:
+    movzx eax, byte [rdi]
+    movzx edx, byte [rsi]
+    sub eax, edx
+    jnz .exit
+    test edx, edx
+    jz .exit
     inc rdi
-    inc rax
-    jmp .loop_begin
+    inc rsi
+    dec r10d
+    jnz .sse42_bytes
+    jmp strcmp_sse42
 
-    .loop_exit:
-    pop rbp
-    ret
+    .equal:
+    xor eax, eax
+
+    .exit:
+    ret
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*==============================================================
+    Axon Kernel Libk - stdio.h
+    2021, Zachary Berry
+    libk/public/stdio.h
+==============================================================*/
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#ifndef restrict
+#define restrict __restrict
+#endif
+
+/*
+    vsnprintf
+    * Public Function
+    * Formats a string into 'buffer', writing at most 'size' characters including the null terminator
+    * Supports the conversions d, i, u, x, X, o, p, s, c and %, the flags '-', '0', '+', ' ' and '#', a width and precision
+      (either of which can be '*'), and the lengths hh, h, l, ll, z, t and j
+    * Returns the length the formatted string would have had if 'buffer' was large enough, not counting the null terminator
+*/
+int vsnprintf( char* restrict buffer, size_t size, const char* restrict format, va_list args );
+
+/*
+    snprintf
+    * Public Function
+    * Same as 'vsnprintf', but takes the arguments directly
+*/
+int snprintf( char* restrict buffer, size_t size, const char* restrict format, ... );
+
+/*
+    vsnprintf_capture
+    * Public Function
+    * Reads the arguments a format string uses from 'args', and stores each one as a 64-bit value in 'out_args', in order
+    * Arguments narrower than 64 bits are zero extended, and a '*' width or precision takes up a value like any other argument
+    * At most 'max_args' values are stored, returns the number stored
+    * Together with 'snprintf_captured', this lets a message be formatted later, e.g. by the kernel log, as long as the format
+      string and any strings passed for %s are still valid then
+*/
+size_t vsnprintf_capture( const char* restrict format, va_list args, uint64_t* restrict out_args, size_t max_args );
+
+/*
+    snprintf_captured
+    * Public Function
+    * Same as 'vsnprintf', but reads the arguments from a list filled in by 'vsnprintf_capture'
+    * Any arguments past 'arg_count' are read as zero
+*/
+int snprintf_captured( char* restrict buffer, size_t size, const char* restrict format, const uint64_t* args, size_t arg_count );
\ No newline at end of file
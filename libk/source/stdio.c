@@ -0,0 +1,565 @@
+/*==============================================================
+    Axon Kernel Libk - stdio.c
+    2021, Zachary Berry
+    libk/source/stdio.c
+==============================================================*/
+
+#include "stdio.h"
+#include "string.h"
+#include <stdbool.h>
+
+/*
+    Formatting State
+*/
+struct format_writer_t
+{
+    char* buffer;
+    size_t size;
+    size_t length;
+};
+
+struct format_spec_t
+{
+    bool b_left;
+    bool b_zero_pad;
+    bool b_plus;
+    bool b_space;
+    bool b_alt;
+    uint32_t width;
+    int32_t precision;
+    uint32_t length;
+    char conversion;
+};
+
+enum format_length_t
+{
+    FORMAT_LENGTH_INT   = 0,
+    FORMAT_LENGTH_CHAR  = 1,
+    FORMAT_LENGTH_SHORT = 2,
+    FORMAT_LENGTH_LONG  = 3
+};
+
+/*
+    Argument Source
+    * Arguments are read from a 'va_list', or from a list of 64-bit values captured earlier by 'vsnprintf_capture', and every read
+      goes through '_next_arg', so the formatter itself doesnt care which one it has
+    * When 'capture' is set, each value read from the 'va_list' is also stored there, up to 'count' values
+*/
+enum format_arg_t
+{
+    FORMAT_ARG_INT      = 0,
+    FORMAT_ARG_LONG     = 1,
+    FORMAT_ARG_POINTER  = 2
+};
+
+struct format_args_t
+{
+    va_list* list;
+    const uint64_t* values;
+    uint64_t* capture;
+    size_t count;
+    size_t index;
+};
+
+/*
+    Digit Pairs
+    * Decimal numbers are converted two digits at a time, so there is one division by 100 per pair instead of one division per digit
+      (and since the divisor is constant, the compiler turns it into a multiply)
+*/
+static const char g_digit_pairs[ 201 ] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+
+/*
+    _next_arg
+    * Private Function
+    * Reads the next argument, 'int' sized arguments are zero extended, and captured lists return zero once they run out
+*/
+static inline uint64_t _next_arg( struct format_args_t* args, enum format_arg_t type )
+{
+    uint64_t value;
+
+    if( args->list == NULL )
+    {
+        value = ( args->index < args->count ) ? args->values[ args->index ] : 0UL;
+    }
+    else
+    {
+        switch( type )
+        {
+            case FORMAT_ARG_LONG:       value = va_arg( *( args->list ), uint64_t ); break;
+            case FORMAT_ARG_POINTER:    value = (uint64_t)( va_arg( *( args->list ), void* ) ); break;
+            default:                    value = (uint64_t)( va_arg( *( args->list ), unsigned int ) ); break;
+        }
+
+        if( args->capture != NULL && args->index < args->count ) { args->capture[ args->index ] = value; }
+    }
+
+    args->index++;
+    return value;
+}
+
+
+/*
+    _put_char / _put_repeat / _put_string
+    * Private Functions
+    * Append to the output, anything past the end of the buffer is counted but not written
+*/
+static inline void _put_char( struct format_writer_t* writer, char c )
+{
+    if( writer->length + 1UL < writer->size ) { writer->buffer[ writer->length ] = c; }
+    writer->length++;
+}
+
+static void _put_repeat( struct format_writer_t* writer, char c, size_t count )
+{
+    for( size_t i = 0; i < count; i++ ) { _put_char( writer, c ); }
+}
+
+static void _put_string( struct format_writer_t* writer, const char* str, size_t len )
+{
+    if( writer->length + 1UL < writer->size )
+    {
+        size_t space = writer->size - writer->length - 1UL;
+        memcpy( writer->buffer + writer->length, str, len < space ? len : space );
+    }
+
+    writer->length += len;
+}
+
+
+/*
+    _format_decimal
+    * Private Function
+    * Writes the digits of 'value' backwards, ending at 'end', and returns a pointer to the first digit
+*/
+static char* _format_decimal( uint64_t value, char* end )
+{
+    while( value >= 100UL )
+    {
+        uint64_t pair = value % 100UL;
+        value /= 100UL;
+
+        end -= 2;
+        memcpy( end, g_digit_pairs + ( pair * 2UL ), 2 );
+    }
+
+    if( value >= 10UL )
+    {
+        end -= 2;
+        memcpy( end, g_digit_pairs + ( value * 2UL ), 2 );
+    }
+    else
+    {
+        *( --end ) = (char)( '0' + value );
+    }
+
+    return end;
+}
+
+
+/*
+    _format_power2
+    * Private Function
+    * Writes the digits of 'value' in base 8 or 16 (selected by 'shift'), using only shifts and masks
+*/
+static char* _format_power2( uint64_t value, char* end, uint32_t shift, bool b_upper )
+{
+    const char* digit_chars = b_upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    uint64_t mask = ( 1UL << shift ) - 1UL;
+
+    do
+    {
+        *( --end ) = digit_chars[ value & mask ];
+        value >>= shift;
+    } while( value != 0UL );
+
+    return end;
+}
+
+
+/*
+    _put_integer
+    * Private Function
+    * Formats an integer with the sign, prefix, precision and padding from the specification
+*/
+static void _put_integer( struct format_writer_t* writer, const struct format_spec_t* spec, uint64_t value, bool b_negative )
+{
+    char digits[ 24 ];
+    char* end   = digits + sizeof( digits );
+    char* start = end;
+
+    // A precision of zero with a value of zero prints no digits at all
+    if( value != 0UL || spec->precision != 0 )
+    {
+        switch( spec->conversion )
+        {
+            case 'x':
+            start = _format_power2( value, end, 4U, false );
+            break;
+            case 'X':
+            start = _format_power2( value, end, 4U, true );
+            break;
+            case 'o':
+            start = _format_power2( value, end, 3U, false );
+            break;
+            default:
+            start = _format_decimal( value, end );
+            break;
+        }
+    }
+
+    size_t digit_count = (size_t)( end - start );
+
+    // Build the prefix, a sign for signed conversions and '0x' or '0' for the alternate forms
+    char prefix[ 3 ];
+    size_t prefix_len = 0UL;
+
+    if( spec->conversion == 'd' || spec->conversion == 'i' )
+    {
+        if( b_negative )            { prefix[ prefix_len++ ] = '-'; }
+        else if( spec->b_plus )     { prefix[ prefix_len++ ] = '+'; }
+        else if( spec->b_space )    { prefix[ prefix_len++ ] = ' '; }
+    }
+    else if( spec->b_alt )
+    {
+        if( ( spec->conversion == 'x' || spec->conversion == 'X' ) && value != 0UL )
+        {
+            prefix[ prefix_len++ ] = '0';
+            prefix[ prefix_len++ ] = spec->conversion;
+        }
+        else if( spec->conversion == 'o' && ( digit_count == 0UL || *start != '0' ) )
+        {
+            prefix[ prefix_len++ ] = '0';
+        }
+    }
+
+    // Zeroes come from the precision, or from the '0' flag when there is no precision
+    size_t zeroes = ( spec->precision > 0 && (size_t)( spec->precision ) > digit_count ) ? (size_t)( spec->precision ) - digit_count : 0UL;
+    size_t total = prefix_len + zeroes + digit_count;
+
+    if( spec->b_zero_pad && !spec->b_left && spec->precision < 0 && spec->width > total )
+    {
+        zeroes += spec->width - total;
+        total = spec->width;
+    }
+
+    size_t padding = spec->width > total ? spec->width - total : 0UL;
+
+    if( !spec->b_left ) { _put_repeat( writer, ' ', padding ); }
+    _put_string( writer, prefix, prefix_len );
+    _put_repeat( writer, '0', zeroes );
+    _put_string( writer, start, digit_count );
+    if( spec->b_left ) { _put_repeat( writer, ' ', padding ); }
+}
+
+
+/*
+    _parse_spec
+    * Private Function
+    * Parses the flags, width, precision and length of a conversion, 'format' points to the character following the '%'
+    * Returns a pointer to the conversion character
+*/
+static const char* _parse_spec( const char* format, struct format_spec_t* out_spec, struct format_args_t* args )
+{
+    memset( out_spec, 0, sizeof( struct format_spec_t ) );
+    out_spec->precision = -1;
+
+    // Flags
+    while( true )
+    {
+        switch( *format )
+        {
+            case '-': out_spec->b_left = true; format++; continue;
+            case '0': out_spec->b_zero_pad = true; format++; continue;
+            case '+': out_spec->b_plus = true; format++; continue;
+            case ' ': out_spec->b_space = true; format++; continue;
+            case '#': out_spec->b_alt = true; format++; continue;
+        }
+
+        break;
+    }
+
+    // Width, a negative width from '*' is a left-justify flag
+    if( *format == '*' )
+    {
+        int width = (int)( _next_arg( args, FORMAT_ARG_INT ) );
+        if( width < 0 ) { out_spec->b_left = true; width = -width; }
+        out_spec->width = (uint32_t)( width );
+        format++;
+    }
+    else
+    {
+        while( *format >= '0' && *format <= '9' )
+        {
+            out_spec->width = ( out_spec->width * 10U ) + (uint32_t)( *format - '0' );
+            format++;
+        }
+    }
+
+    // Precision, a negative precision from '*' is the same as not having one
+    if( *format == '.' )
+    {
+        format++;
+        out_spec->precision = 0;
+
+        if( *format == '*' )
+        {
+            int precision = (int)( _next_arg( args, FORMAT_ARG_INT ) );
+            out_spec->precision = precision < 0 ? -1 : precision;
+            format++;
+        }
+        else
+        {
+            while( *format >= '0' && *format <= '9' )
+            {
+                out_spec->precision = ( out_spec->precision * 10 ) + (int32_t)( *format - '0' );
+                format++;
+            }
+        }
+    }
+
+    // Length
+    switch( *format )
+    {
+        case 'h':
+        format++;
+        if( *format == 'h' ) { out_spec->length = FORMAT_LENGTH_CHAR; format++; }
+        else { out_spec->length = FORMAT_LENGTH_SHORT; }
+        break;
+
+        case 'l':
+        format++;
+        if( *format == 'l' ) { format++; }
+        out_spec->length = FORMAT_LENGTH_LONG;
+        break;
+
+        case 'z':
+        case 't':
+        case 'j':
+        format++;
+        out_spec->length = FORMAT_LENGTH_LONG;
+        break;
+    }
+
+    out_spec->conversion = *format;
+    return format;
+}
+
+
+/*
+    _format
+    * Private Function
+    * The formatter behind 'vsnprintf' and 'snprintf_captured', reads each argument from 'args'
+*/
+static int _format( char* buffer, size_t size, const char* format, struct format_args_t* args )
+{
+    struct format_writer_t writer;
+    writer.buffer   = buffer;
+    writer.size     = ( buffer == NULL ) ? 0UL : size;
+    writer.length   = 0UL;
+
+    while( *format != '\0' )
+    {
+        // Copy everything up to the next conversion in one go
+        const char* next = format;
+        while( *next != '\0' && *next != '%' ) { next++; }
+
+        if( next != format )
+        {
+            _put_string( &writer, format, (size_t)( next - format ) );
+            format = next;
+            continue;
+        }
+
+        struct format_spec_t spec;
+        format = _parse_spec( format + 1, &spec, args );
+
+        switch( spec.conversion )
+        {
+            case 'd':
+            case 'i':
+            {
+                int64_t value;
+                switch( spec.length )
+                {
+                    case FORMAT_LENGTH_CHAR:    value = (int64_t)( (signed char)( _next_arg( args, FORMAT_ARG_INT ) ) ); break;
+                    case FORMAT_LENGTH_SHORT:   value = (int64_t)( (short)( _next_arg( args, FORMAT_ARG_INT ) ) ); break;
+                    case FORMAT_LENGTH_LONG:    value = (int64_t)( _next_arg( args, FORMAT_ARG_LONG ) ); break;
+                    default:                    value = (int64_t)( (int)( _next_arg( args, FORMAT_ARG_INT ) ) ); break;
+                }
+
+                // Negate as unsigned, so the most negative value doesnt overflow
+                uint64_t magnitude = value < 0L ? ( 0UL - (uint64_t)( value ) ) : (uint64_t)( value );
+                _put_integer( &writer, &spec, magnitude, value < 0L );
+                break;
+            }
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            {
+                uint64_t value;
+                switch( spec.length )
+                {
+                    case FORMAT_LENGTH_CHAR:    value = (uint64_t)( (unsigned char)( _next_arg( args, FORMAT_ARG_INT ) ) ); break;
+                    case FORMAT_LENGTH_SHORT:   value = (uint64_t)( (unsigned short)( _next_arg( args, FORMAT_ARG_INT ) ) ); break;
+                    case FORMAT_LENGTH_LONG:    value = _next_arg( args, FORMAT_ARG_LONG ); break;
+                    default:                    value = _next_arg( args, FORMAT_ARG_INT ); break;
+                }
+
+                _put_integer( &writer, &spec, value, false );
+                break;
+            }
+
+            case 'p':
+            {
+                // Pointers print like '%#lx'
+                spec.conversion = 'x';
+                spec.b_alt      = true;
+                _put_integer( &writer, &spec, _next_arg( args, FORMAT_ARG_POINTER ), false );
+                break;
+            }
+
+            case 's':
+            {
+                const char* str = (const char*)( _next_arg( args, FORMAT_ARG_POINTER ) );
+                if( str == NULL ) { str = "(null)"; }
+
+                // With a precision, the string doesnt need to be null terminated
+                size_t len = 0UL;
+                while( ( spec.precision < 0 || len < (size_t)( spec.precision ) ) && str[ len ] != '\0' ) { len++; }
+
+                size_t padding = spec.width > len ? spec.width - len : 0UL;
+                if( !spec.b_left ) { _put_repeat( &writer, ' ', padding ); }
+                _put_string( &writer, str, len );
+                if( spec.b_left ) { _put_repeat( &writer, ' ', padding ); }
+                break;
+            }
+
+            case 'c':
+            {
+                size_t padding = spec.width > 1U ? spec.width - 1U : 0UL;
+                if( !spec.b_left ) { _put_repeat( &writer, ' ', padding ); }
+                _put_char( &writer, (char)( _next_arg( args, FORMAT_ARG_INT ) ) );
+                if( spec.b_left ) { _put_repeat( &writer, ' ', padding ); }
+                break;
+            }
+
+            case '%':
+            _put_char( &writer, '%' );
+            break;
+
+            case '\0':
+            // Format ended in the middle of a conversion, step back so the loop ends on the terminator
+            format--;
+            break;
+
+            default:
+            // Unknown conversion, print it as-is
+            _put_char( &writer, '%' );
+            _put_char( &writer, spec.conversion );
+            break;
+        }
+
+        format++;
+    }
+
+    // Null terminate, truncating if needed
+    if( writer.size > 0UL )
+    {
+        writer.buffer[ writer.length < writer.size ? writer.length : writer.size - 1UL ] = '\0';
+    }
+
+    return (int)( writer.length );
+}
+
+
+int vsnprintf( char* restrict buffer, size_t size, const char* restrict format, va_list args )
+{
+    // Copy the argument list, so we can pass it around by pointer
+    va_list arg_list;
+    va_copy( arg_list, args );
+
+    struct format_args_t source = { .list = &arg_list, .values = NULL, .capture = NULL, .count = 0UL, .index = 0UL };
+    int result = _format( buffer, size, format, &source );
+
+    va_end( arg_list );
+    return result;
+}
+
+
+int snprintf_captured( char* restrict buffer, size_t size, const char* restrict format, const uint64_t* args, size_t arg_count )
+{
+    struct format_args_t source = { .list = NULL, .values = args, .capture = NULL, .count = arg_count, .index = 0UL };
+    return _format( buffer, size, format, &source );
+}
+
+
+size_t vsnprintf_capture( const char* restrict format, va_list args, uint64_t* restrict out_args, size_t max_args )
+{
+    va_list arg_list;
+    va_copy( arg_list, args );
+
+    struct format_args_t source = { .list = &arg_list, .values = NULL, .capture = out_args, .count = max_args, .index = 0UL };
+
+    // Walk the format the same way '_format' does, reading each argument with the size its conversion says it has
+    while( *format != '\0' && source.index < max_args )
+    {
+        if( *format != '%' ) { format++; continue; }
+
+        struct format_spec_t spec;
+        format = _parse_spec( format + 1, &spec, &source );
+
+        switch( spec.conversion )
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            _next_arg( &source, spec.length == FORMAT_LENGTH_LONG ? FORMAT_ARG_LONG : FORMAT_ARG_INT );
+            break;
+
+            case 'p':
+            case 's':
+            _next_arg( &source, FORMAT_ARG_POINTER );
+            break;
+
+            case 'c':
+            _next_arg( &source, FORMAT_ARG_INT );
+            break;
+
+            case '\0':
+            format--;
+            break;
+        }
+
+        format++;
+    }
+
+    va_end( arg_list );
+    return( source.index < max_args ? source.index : max_args );
+}
+
+
+int snprintf( char* restrict buffer, size_t size, const char* restrict format, ... )
+{
+    va_list args;
+    va_start( args, format );
+    int result = vsnprintf( buffer, size, format, args );
+    va_end( args );
+
+    return result;
+}
\ No newline at end of file
@@ -15,14 +15,14 @@
 void* malloc( size_t size )
 {
     if( size == 0UL ) { return NULL; }
-    return axk_kheap_alloc( size, false );
+    return axk_kheap_alloc_caller( size, false, __builtin_return_address( 0 ) );
 }
 
 
 void* calloc( size_t num, size_t size )
 {
     if( num == 0UL || size == 0UL ) { return NULL; }
-    return axk_kheap_alloc( num * size, true );
+    return axk_kheap_alloc_caller( num * size, true, __builtin_return_address( 0 ) );
 }
 
 
@@ -36,11 +36,11 @@ void* realloc( void* ptr, size_t new_size )
 
     if( ptr == NULL )
     {
-        return axk_kheap_alloc( new_size, false );
+        return axk_kheap_alloc_caller( new_size, false, __builtin_return_address( 0 ) );
     }
     else
     {
-        return axk_kheap_realloc( ptr, new_size, false );
+        return axk_kheap_realloc_caller( ptr, new_size, false, __builtin_return_address( 0 ) );
     }
 }
 
@@ -0,0 +1,65 @@
+/*==============================================================
+    Axon Kernel Libk - Host Test Declarations
+    2021, Zachary Berry
+    libk/test/libk_host.h
+==============================================================*/
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <time.h>
+
+/*
+    Host Build
+    * The libk objects are built for the host, and every symbol gets a 'libk_' prefix (see 'test-libk-host' in the libk makefile),
+      so the test programs can compare them against the host C library in the same process
+    * The dispatch slots and the implementations behind them are made global as well, so each one can be tested directly
+*/
+void* libk_memcpy( void* dst, const void* src, size_t count );
+void* libk_memmove( void* dst, const void* src, size_t count );
+void* libk_memset( void* dst, int val, size_t count );
+int libk_memcmp( const void* ptr_a, const void* ptr_b, size_t count );
+int libk_strcmp( const char* str_a, const char* str_b );
+size_t libk_strlen( const char* str );
+
+int libk_vsnprintf( char* buffer, size_t size, const char* format, va_list args );
+int libk_snprintf( char* buffer, size_t size, const char* format, ... );
+size_t libk_vsnprintf_capture( const char* format, va_list args, uint64_t* out_args, size_t max_args );
+int libk_snprintf_captured( char* buffer, size_t size, const char* format, const uint64_t* args, size_t arg_count );
+
+extern void* libk_memcpy_large_slot;
+extern void* libk_memset_large_slot;
+extern void* libk_strcmp_slot;
+
+void libk_memcpy_large_erms( void );
+void libk_memcpy_large_sse( void );
+void libk_memset_large_erms( void );
+void libk_memset_large_sse( void );
+void libk_strcmp_word( void );
+void libk_strcmp_sse42( void );
+
+/*
+    libk_host_rand
+    * Small xorshift generator, so runs are repeatable across host C libraries
+*/
+static inline uint64_t libk_host_rand( uint64_t* state )
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/*
+    libk_host_seconds
+    * Monotonic time, for the benchmarks
+*/
+static inline double libk_host_seconds( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)( ts.tv_sec ) + (double)( ts.tv_nsec ) * 1e-9;
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+/*==============================================================
+    Axon Kernel Libk - Formatting Benchmarks
+    2021, Zachary Berry
+    libk/test/printf_bench.c
+==============================================================*/
+
+#include "libk_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/*
+    Parameters
+    * Compares libk 'snprintf' against the basic terminal's number printing (axon/source/gfx/basic_terminal.c), which is copied
+      below with the framebuffer drawing replaced by a copy into a line buffer, the same copy the console sinks get
+    * Values are spread over every magnitude, since the terminal's loops get slower as numbers get longer
+*/
+#define BENCH_VALUES        4096U
+#define BENCH_CALLS         4000000U
+#define BENCH_LINE_SIZE     512UL
+
+typedef void( *bench_fn_t )( uint64_t value );
+
+static uint64_t g_values[ BENCH_VALUES ];
+static char g_line[ BENCH_LINE_SIZE ];
+static size_t g_line_length;
+static uint64_t g_prints_calls;
+
+
+/*
+    _terminal_prints
+    * Stand-in for 'axk_basicterminal_prints', every call measures the string and copies it out
+*/
+static void _terminal_prints( const char* str )
+{
+    size_t len = strlen( str );
+    if( g_line_length + len >= BENCH_LINE_SIZE ) { g_line_length = 0UL; }
+
+    memcpy( g_line + g_line_length, str, len );
+    g_line_length += len;
+    g_prints_calls++;
+}
+
+
+/*
+    _terminal_printu32 / _terminal_printu64 / _terminal_printh64
+    * The basic terminal's number printing, one division per digit place
+*/
+static void _terminal_printu32( uint32_t num )
+{
+    if( num == 0U )
+    {
+        _terminal_prints( "0" );
+        return;
+    }
+
+    uint32_t place_value = 1000000000;
+    bool b_zero = true;
+    char str_data[ 11 ];
+    uint8_t index = 0;
+
+    for( int i = 9; i >= 0; i-- )
+    {
+        if( b_zero && place_value > num )
+        {
+            place_value /= 10;
+            continue;
+        }
+
+        b_zero = false;
+        uint32_t digit = num / place_value;
+        str_data[ index++ ] = (char)( digit + 0x30 );
+        num -= digit * place_value;
+        place_value /= 10;
+    }
+
+    str_data[ index ] = 0x00;
+    _terminal_prints( str_data );
+}
+
+
+static void _terminal_printu64( uint64_t num )
+{
+    if( num <= 0xFFFFFFFF )
+    {
+        _terminal_printu32( (uint32_t) num );
+        return;
+    }
+
+    uint64_t place_value = 10000000000000000000UL;
+    bool b_zero = true;
+    char str_data[ 21 ];
+    uint8_t index = 0;
+
+    for( int i = 19; i >= 0; i-- )
+    {
+        if( b_zero && place_value > num )
+        {
+            place_value /= 10UL;
+            continue;
+        }
+
+        b_zero = false;
+        uint64_t digit = num / place_value;
+        str_data[ index++ ] = (char)( digit + 0x30 );
+        num -= digit * place_value;
+        place_value /= 10UL;
+    }
+
+    str_data[ index ] = 0x00;
+    _terminal_prints( str_data );
+}
+
+
+static void _terminal_printh64( uint64_t num )
+{
+    static const char lookup_table[ 16 ] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+    char str_data[ 19 ];
+    uint8_t index = 0;
+
+    // Leading zeroes are always printed, like the init messages do
+    str_data[ index++ ] = '0';
+    str_data[ index++ ] = 'x';
+    for( int shift = 56; shift >= 0; shift -= 8 )
+    {
+        uint8_t byte = (uint8_t)( num >> shift );
+        str_data[ index++ ] = lookup_table[ byte >> 4 ];
+        str_data[ index++ ] = lookup_table[ byte & 0x0F ];
+    }
+
+    str_data[ index ] = 0x00;
+    _terminal_prints( str_data );
+}
+
+
+/*
+    _libk_printf
+    * Stand-in for 'axk_basicterminal_printf', formats into a stack buffer and prints it once
+*/
+static void _libk_printf( const char* format, ... )
+{
+    char str_data[ 256 ];
+    va_list args;
+
+    va_start( args, format );
+    libk_vsnprintf( str_data, sizeof( str_data ), format, args );
+    va_end( args );
+
+    _terminal_prints( str_data );
+}
+
+
+/*
+    _klog_printf
+    * The kernel log path, the arguments are captured when the message is logged, and formatted when the log is drained
+*/
+static void _klog_printf( const char* format, ... )
+{
+    uint64_t record[ 5 ];
+    va_list args;
+
+    va_start( args, format );
+    libk_vsnprintf_capture( format, args, record, 5UL );
+    va_end( args );
+
+    char str_data[ 256 ];
+    libk_snprintf_captured( str_data, sizeof( str_data ), format, record, 5UL );
+    _terminal_prints( str_data );
+}
+
+
+static void _host_printf( const char* format, ... )
+{
+    char str_data[ 256 ];
+    va_list args;
+
+    va_start( args, format );
+    vsnprintf( str_data, sizeof( str_data ), format, args );
+    va_end( args );
+
+    _terminal_prints( str_data );
+}
+
+
+static void _decimal_terminal( uint64_t value )     { _terminal_printu64( value ); }
+static void _decimal_libk( uint64_t value )         { _libk_printf( "%lu", value ); }
+static void _decimal_klog( uint64_t value )         { _klog_printf( "%lu", value ); }
+static void _decimal_host( uint64_t value )         { _host_printf( "%lu", value ); }
+static void _hex_terminal( uint64_t value )         { _terminal_printh64( value ); }
+static void _hex_libk( uint64_t value )             { _libk_printf( "0x%016lX", value ); }
+static void _hex_klog( uint64_t value )             { _klog_printf( "0x%016lX", value ); }
+static void _hex_host( uint64_t value )             { _host_printf( "0x%016lX", value ); }
+
+
+/*
+    Page Allocator Line
+    * The message 'axk_page_allocator_init' used to print with seven chained calls, against the same line formatted once
+*/
+static void _line_terminal( uint64_t value )
+{
+    _terminal_prints( "Page Allocator: Initialized successfully. Total Pages: " );
+    _terminal_printu64( value );
+    _terminal_prints( ",  Kernel Size: " );
+    _terminal_printu64( value >> 10 );
+    _terminal_prints( "KB  Available Memory: " );
+    _terminal_printu64( value >> 20 );
+    _terminal_prints( "MB\n" );
+}
+
+static void _line_libk( uint64_t value )
+{
+    _libk_printf( "Page Allocator: Initialized successfully. Total Pages: %lu,  Kernel Size: %luKB  Available Memory: %luMB\n",
+        value, value >> 10, value >> 20 );
+}
+
+static void _line_klog( uint64_t value )
+{
+    _klog_printf( "Page Allocator: Initialized successfully. Total Pages: %lu,  Kernel Size: %luKB  Available Memory: %luMB\n",
+        value, value >> 10, value >> 20 );
+}
+
+static void _line_host( uint64_t value )
+{
+    _host_printf( "Page Allocator: Initialized successfully. Total Pages: %lu,  Kernel Size: %luKB  Available Memory: %luMB\n",
+        value, value >> 10, value >> 20 );
+}
+
+
+/*
+    _measure
+    * Returns the time per call in nanoseconds, and the number of prints calls each one made
+*/
+static double _measure( bench_fn_t fn, double* out_prints )
+{
+    // One untimed pass, so cold caches arent counted
+    for( uint32_t i = 0; i < BENCH_VALUES; i++ ) { fn( g_values[ i ] ); }
+
+    g_prints_calls = 0UL;
+    double begin = libk_host_seconds();
+    for( uint32_t i = 0; i < BENCH_CALLS; i++ ) { fn( g_values[ i & ( BENCH_VALUES - 1U ) ] ); }
+    double elapsed = libk_host_seconds() - begin;
+
+    *out_prints = (double)( g_prints_calls ) / (double)( BENCH_CALLS );
+    return elapsed * 1e9 / (double)( BENCH_CALLS );
+}
+
+
+static void _run( const char* name, bench_fn_t terminal_fn, bench_fn_t libk_fn, bench_fn_t klog_fn, bench_fn_t host_fn )
+{
+    static const char* path_names[] = { "terminal", "libk", "klog", "host" };
+    bench_fn_t fns[] = { terminal_fn, libk_fn, klog_fn, host_fn };
+
+    printf( "\n%-8s %-10s %10s %10s\n", name, "path", "ns/call", "prints" );
+    for( uint32_t i = 0; i < 4U; i++ )
+    {
+        double prints = 0.0;
+        double ns = _measure( fns[ i ], &prints );
+        printf( "%-8s %-10s %10.1f %10.1f\n", name, path_names[ i ], ns, prints );
+    }
+}
+
+
+int main( void )
+{
+    uint64_t rand = 0x9E3779B97F4A7C15UL;
+    for( uint32_t i = 0; i < BENCH_VALUES; i++ )
+    {
+        g_values[ i ] = libk_host_rand( &rand ) >> ( libk_host_rand( &rand ) % 64UL );
+    }
+
+    printf( "libk formatting, %u calls per path ('terminal' is the basic terminal's printu64/printh64, 'host' is the host C library)\n", BENCH_CALLS );
+    _run( "decimal", _decimal_terminal, _decimal_libk, _decimal_klog, _decimal_host );
+    _run( "hex", _hex_terminal, _hex_libk, _hex_klog, _hex_host );
+    _run( "line", _line_terminal, _line_libk, _line_klog, _line_host );
+
+    return 0;
+}
\ No newline at end of file
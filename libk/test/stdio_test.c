@@ -0,0 +1,140 @@
+/*==============================================================
+    Axon Kernel Libk - Formatting Tests
+    2021, Zachary Berry
+    libk/test/stdio_test.c
+==============================================================*/
+
+#include "libk_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+    Parameters
+    * Every case is formatted by the host C library, by 'libk_snprintf', and by capturing the arguments and formatting them
+      later with 'libk_snprintf_captured' (the way the kernel log does), and all three have to match
+*/
+#define TEST_BUFFER_SIZE    256UL
+#define TEST_MAX_ARGS       8UL
+#define TEST_RANDOM_VALUES  200000U
+
+static uint64_t g_rand = 0x9E3779B97F4A7C15UL;
+static uint32_t g_failures;
+
+
+/*
+    _format_captured
+    * Captures the arguments into a list of 64-bit values, and formats them from that list
+*/
+static int _format_captured( char* buffer, size_t size, const char* format, ... )
+{
+    uint64_t values[ TEST_MAX_ARGS ];
+    va_list args;
+
+    va_start( args, format );
+    size_t count = libk_vsnprintf_capture( format, args, values, TEST_MAX_ARGS );
+    va_end( args );
+
+    return libk_snprintf_captured( buffer, size, format, values, count );
+}
+
+
+static void _compare( const char* format, const char* expected, int expected_ret, const char* result, int result_ret, const char* name )
+{
+    if( expected_ret == result_ret && strcmp( expected, result ) == 0 ) { return; }
+
+    if( g_failures++ < 16U )
+    {
+        printf( "FAIL: %s '%s', expected \"%s\" (%d), got \"%s\" (%d)\n", name, format, expected, expected_ret, result, result_ret );
+    }
+}
+
+
+#define TEST_FORMAT( ... ) \
+    do \
+    { \
+        char expected[ TEST_BUFFER_SIZE ]; \
+        char result[ TEST_BUFFER_SIZE ]; \
+        int expected_ret = snprintf( expected, sizeof( expected ), __VA_ARGS__ ); \
+        int result_ret = libk_snprintf( result, sizeof( result ), __VA_ARGS__ ); \
+        _compare( #__VA_ARGS__, expected, expected_ret, result, result_ret, "snprintf" ); \
+        result_ret = _format_captured( result, sizeof( result ), __VA_ARGS__ ); \
+        _compare( #__VA_ARGS__, expected, expected_ret, result, result_ret, "snprintf_captured" ); \
+    } while( 0 )
+
+
+static void _test_conversions( void )
+{
+    TEST_FORMAT( "plain text" );
+    TEST_FORMAT( "%d %i %u", -5, 7, 3000000000U );
+    TEST_FORMAT( "%5d|%-5d|%05d|%+d|% d", 42, 42, 42, 42, 42 );
+    TEST_FORMAT( "%d %d %d", 0, 2147483647, -2147483647 - 1 );
+    TEST_FORMAT( "%x %X %#x %#X %#o %o %08x %#010x", 255U, 255U, 255U, 255U, 8U, 8U, 0xBEEFU, 0xBEEFU );
+    TEST_FORMAT( "%ld %lu %lx %llu %zu %zd", -9223372036854775807L - 1L, 18446744073709551615UL, 0xDEADBEEFCAFEUL, 123456789012345ULL, (size_t)( 77 ), (ssize_t)( -3 ) );
+    TEST_FORMAT( "%hhd %hhu %hd %hu", 300, 300U, 70000, 70000U );
+    TEST_FORMAT( "%.3d %.0d %5.3d %-8.4x|", 7, 0, 7, 0xAU );
+    TEST_FORMAT( "%#.0o %#x", 0U, 0U );
+    TEST_FORMAT( "%s|%10s|%-10s|%.2s|", "abc", "abc", "abc", "abc" );
+    TEST_FORMAT( "%*s|%-*s|%.*s|%*d", 6, "ab", 6, "ab", 1, "xyz", -4, 9 );
+    TEST_FORMAT( "%c%c %3c|%-3c|", 'a', 'b', 'c', 'd' );
+    TEST_FORMAT( "100%%" );
+    TEST_FORMAT( "%p %20p|", (void*)( 0x1234UL ), (void*)( 0xFFFFUL ) );
+    TEST_FORMAT( "0x%016lX %lu %lu %lu", 0xFFFF800000000000UL, 1UL, 22UL, 333UL );
+}
+
+
+static void _test_random( void )
+{
+    for( uint32_t i = 0; i < TEST_RANDOM_VALUES; i++ )
+    {
+        uint64_t value = libk_host_rand( &g_rand );
+        value >>= libk_host_rand( &g_rand ) % 64UL;
+
+        TEST_FORMAT( "%lu %lx %ld %020lu %u %d", value, value, (int64_t)( value ), value, (uint32_t)( value ), (int32_t)( value ) );
+    }
+}
+
+
+/*
+    _test_limits
+    * Truncation, the null buffer size query, and arguments past the end of a captured list
+*/
+static void _test_limits( void )
+{
+    char small[ 5 ];
+    int ret = libk_snprintf( small, sizeof( small ), "%s", "abcdefgh" );
+    if( ret != 8 || strcmp( small, "abcd" ) != 0 )
+    {
+        printf( "FAIL: truncation, got \"%s\" (%d)\n", small, ret );
+        g_failures++;
+    }
+
+    ret = libk_snprintf( NULL, 0UL, "%d", 12345 );
+    if( ret != 5 )
+    {
+        printf( "FAIL: size query returned %d\n", ret );
+        g_failures++;
+    }
+
+    char result[ TEST_BUFFER_SIZE ];
+    uint64_t values[ 2 ] = { 7UL, 8UL };
+    ret = libk_snprintf_captured( result, sizeof( result ), "%lu %lu %lu", values, 2UL );
+    if( ret != 5 || strcmp( result, "7 8 0" ) != 0 )
+    {
+        printf( "FAIL: short captured list, got \"%s\" (%d)\n", result, ret );
+        g_failures++;
+    }
+}
+
+
+int main( void )
+{
+    _test_conversions();
+    _test_random();
+    _test_limits();
+
+    printf( g_failures == 0U ? "libk formatting tests passed\n" : "libk formatting tests failed\n" );
+    return( g_failures == 0U ? 0 : 1 );
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+/*==============================================================
+    Axon Kernel Libk - String Benchmarks
+    2021, Zachary Berry
+    libk/test/string_bench.c
+==============================================================*/
+
+#include "libk_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/*
+    Parameters
+    * Every size is repeated until about 'BENCH_BYTES_PER_SIZE' bytes have been processed (within the repeat limits), so small
+      sizes measure call overhead and the largest sizes measure memory bandwidth
+    * Both libk and the host C library are run on the same buffers, the host numbers are only a reference point
+*/
+#define BENCH_MAX_SIZE          ( 4UL * 1024UL * 1024UL )
+#define BENCH_BYTES_PER_SIZE    ( 256UL * 1024UL * 1024UL )
+#define BENCH_MIN_REPEATS       16UL
+#define BENCH_MAX_REPEATS       ( 4UL * 1024UL * 1024UL )
+
+typedef void( *bench_fn_t )( uint8_t* dst, uint8_t* src, size_t count );
+
+static uint8_t* g_dst;
+static uint8_t* g_src;
+static volatile int g_sink;
+
+
+static void _libk_memcpy( uint8_t* dst, uint8_t* src, size_t count )     { libk_memcpy( dst, src, count ); }
+static void _host_memcpy( uint8_t* dst, uint8_t* src, size_t count )     { memcpy( dst, src, count ); }
+static void _libk_memmove( uint8_t* dst, uint8_t* src, size_t count )    { libk_memmove( dst, dst + 1, count - 1UL ); (void)( src ); }
+static void _host_memmove( uint8_t* dst, uint8_t* src, size_t count )    { memmove( dst, dst + 1, count - 1UL ); (void)( src ); }
+static void _libk_memset( uint8_t* dst, uint8_t* src, size_t count )     { libk_memset( dst, 0x5A, count ); (void)( src ); }
+static void _host_memset( uint8_t* dst, uint8_t* src, size_t count )     { memset( dst, 0x5A, count ); (void)( src ); }
+static void _libk_memcmp( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += libk_memcmp( dst, src, count ); }
+static void _host_memcmp( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += memcmp( dst, src, count ); }
+static void _libk_strlen( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += (int)( libk_strlen( (char*)( src ) ) ); (void)( dst ); (void)( count ); }
+static void _host_strlen( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += (int)( strlen( (char*)( src ) ) ); (void)( dst ); (void)( count ); }
+static void _libk_strcmp( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += libk_strcmp( (char*)( dst ), (char*)( src ) ); (void)( count ); }
+static void _host_strcmp( uint8_t* dst, uint8_t* src, size_t count )     { g_sink += strcmp( (char*)( dst ), (char*)( src ) ); (void)( count ); }
+
+
+/*
+    _measure
+    * Returns the throughput in GB/s for a single function and size
+*/
+static double _measure( bench_fn_t fn, size_t count )
+{
+    size_t repeats = BENCH_BYTES_PER_SIZE / count;
+    if( repeats < BENCH_MIN_REPEATS ) { repeats = BENCH_MIN_REPEATS; }
+    if( repeats > BENCH_MAX_REPEATS ) { repeats = BENCH_MAX_REPEATS; }
+
+    // One untimed pass, so page faults and cold caches arent counted
+    fn( g_dst, g_src, count );
+
+    double begin = libk_host_seconds();
+    for( size_t i = 0; i < repeats; i++ ) { fn( g_dst, g_src, count ); }
+    double elapsed = libk_host_seconds() - begin;
+
+    return ( (double)( count ) * (double)( repeats ) ) / elapsed / 1e9;
+}
+
+
+/*
+    _sweep
+    * Measures every size from 1 byte to 'BENCH_MAX_SIZE', for the string functions both buffers hold a string of that length
+*/
+static void _sweep( const char* name, bench_fn_t libk_fn, bench_fn_t host_fn, bool b_strings )
+{
+    printf( "\n%-8s %10s %12s %12s\n", name, "size", "libk GB/s", "host GB/s" );
+    for( size_t count = 1UL; count <= BENCH_MAX_SIZE; count *= 2UL )
+    {
+        // Odd sizes as well, since the tails take a different path through every tier
+        size_t sizes[ 2 ] = { count, count + count / 2UL + 1UL };
+        for( uint32_t i = 0; i < 2U; i++ )
+        {
+            if( sizes[ i ] > BENCH_MAX_SIZE || ( i == 1U && count < 4UL ) ) { continue; }
+            if( libk_fn == _libk_memmove && sizes[ i ] < 2UL ) { continue; }
+
+            if( b_strings )
+            {
+                g_dst[ sizes[ i ] - 1UL ] = '\0';
+                g_src[ sizes[ i ] - 1UL ] = '\0';
+            }
+
+            printf( "%-8s %10zu %12.2f %12.2f\n", name, sizes[ i ], _measure( libk_fn, sizes[ i ] ), _measure( host_fn, sizes[ i ] ) );
+
+            if( b_strings )
+            {
+                g_dst[ sizes[ i ] - 1UL ] = 0x11;
+                g_src[ sizes[ i ] - 1UL ] = 0x11;
+            }
+        }
+    }
+}
+
+
+int main( void )
+{
+    g_dst = aligned_alloc( 4096UL, BENCH_MAX_SIZE + 4096UL );
+    g_src = aligned_alloc( 4096UL, BENCH_MAX_SIZE + 4096UL );
+    if( g_dst == NULL || g_src == NULL ) { return 1; }
+
+    memset( g_src, 0x11, BENCH_MAX_SIZE + 4096UL );
+    memset( g_dst, 0x11, BENCH_MAX_SIZE + 4096UL );
+
+    static const char* variant_names[] = { "sse", "erms" };
+    for( uint32_t variant = 0; variant < 2U; variant++ )
+    {
+        libk_memcpy_large_slot = variant == 0U ? (void*)( libk_memcpy_large_sse ) : (void*)( libk_memcpy_large_erms );
+        libk_memset_large_slot = variant == 0U ? (void*)( libk_memset_large_sse ) : (void*)( libk_memset_large_erms );
+
+        printf( "\n==== libk large copy/fill variant '%s' ====\n", variant_names[ variant ] );
+        _sweep( "memcpy", _libk_memcpy, _host_memcpy, false );
+        _sweep( "memset", _libk_memset, _host_memset, false );
+        _sweep( "memmove", _libk_memmove, _host_memmove, false );
+    }
+
+    // Equal buffers, so the whole range is compared
+    memset( g_dst, 0x11, BENCH_MAX_SIZE + 4096UL );
+    printf( "\n==== compare ====\n" );
+    _sweep( "memcmp", _libk_memcmp, _host_memcmp, false );
+
+    // Sizes include the terminator, so the string length is one less
+    printf( "\n==== strings ====\n" );
+    _sweep( "strlen", _libk_strlen, _host_strlen, true );
+
+    static const char* strcmp_names[] = { "word", "sse42" };
+    for( uint32_t variant = 0; variant < 2U; variant++ )
+    {
+        if( variant == 1U && !__builtin_cpu_supports( "sse4.2" ) ) { break; }
+        libk_strcmp_slot = variant == 0U ? (void*)( libk_strcmp_word ) : (void*)( libk_strcmp_sse42 );
+
+        printf( "\n==== libk strcmp variant '%s' ====\n", strcmp_names[ variant ] );
+        _sweep( "strcmp", _libk_strcmp, _host_strcmp, true );
+    }
+
+    free( g_dst );
+    free( g_src );
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,316 @@
+/*==============================================================
+    Axon Kernel Libk - String Tests
+    2021, Zachary Berry
+    libk/test/string_test.c
+==============================================================*/
+
+#include "libk_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+
+/*
+    Parameters
+    * Each operation runs inside a buffer with guard bytes on both sides, so writes outside the range are caught as well
+*/
+#define TEST_MAX_SIZE       ( 64UL * 1024UL )
+#define TEST_GUARD          256UL
+#define TEST_BUFFER_SIZE    ( TEST_MAX_SIZE + TEST_GUARD * 2UL + 64UL )
+#define TEST_ITERATIONS     100000U
+#define TEST_STRING_ITERATIONS  1000000U
+#define TEST_PAGE_SIZE      4096UL
+
+static uint8_t g_source[ TEST_BUFFER_SIZE ];
+static uint8_t g_result[ TEST_BUFFER_SIZE ];
+static uint8_t g_expected[ TEST_BUFFER_SIZE ];
+static uint64_t g_rand = 0x9E3779B97F4A7C15UL;
+
+
+/*
+    _random_size
+    * Mostly small sizes, since every tier boundary is below 4KiB, with some up to 64KiB
+*/
+static size_t _random_size( void )
+{
+    uint64_t r = libk_host_rand( &g_rand );
+    switch( r % 10UL )
+    {
+        case 0: case 1: case 2: case 3: case 4:
+        return (size_t)( ( r >> 8 ) % 40UL );
+        case 5: case 6: case 7:
+        return (size_t)( ( r >> 8 ) % 600UL );
+        case 8:
+        return (size_t)( ( r >> 8 ) % 9000UL );
+        default:
+        return (size_t)( ( r >> 8 ) % ( TEST_MAX_SIZE + 1UL ) );
+    }
+}
+
+
+static void _fill_random( uint8_t* buffer, size_t count )
+{
+    for( size_t i = 0; i < count; i++ ) { buffer[ i ] = (uint8_t)( libk_host_rand( &g_rand ) ); }
+}
+
+
+static int _sign( int value )
+{
+    return ( value > 0 ) - ( value < 0 );
+}
+
+
+/*
+    _check
+    * Compares the first 'span' bytes of the result against the host library, which covers the range and the guard bytes after it
+*/
+static bool _check( const char* name, size_t span, size_t count, size_t dst_offset, size_t src_offset, bool b_return_ok )
+{
+    if( b_return_ok && memcmp( g_result, g_expected, span ) == 0 ) { return true; }
+
+    size_t first = 0UL;
+    while( first < span && g_result[ first ] == g_expected[ first ] ) { first++; }
+
+    printf( "FAIL: %s count %zu, dst offset %zu, src offset %zu, return %s, first wrong byte at %zu\n", name, count,
+        dst_offset, src_offset, b_return_ok ? "ok" : "wrong", first );
+    return false;
+}
+
+
+/*
+    _test_memory
+    * Random copies, fills, moves and compares, at every alignment up to 64 and sizes up to 64KiB
+*/
+static bool _test_memory( void )
+{
+    for( uint32_t i = 0; i < TEST_ITERATIONS; i++ )
+    {
+        size_t count        = _random_size();
+        size_t span         = count * 2UL + TEST_GUARD * 2UL + 64UL;
+        if( span > TEST_BUFFER_SIZE ) { span = TEST_BUFFER_SIZE; }
+        size_t dst_offset   = TEST_GUARD + (size_t)( libk_host_rand( &g_rand ) % 64UL );
+        size_t src_offset   = TEST_GUARD + (size_t)( libk_host_rand( &g_rand ) % 64UL );
+
+        _fill_random( g_source, span );
+        _fill_random( g_result, span );
+        memcpy( g_expected, g_result, span );
+
+        switch( libk_host_rand( &g_rand ) % 4UL )
+        {
+            case 0:
+            {
+                void* ret = libk_memcpy( g_result + dst_offset, g_source + src_offset, count );
+                memcpy( g_expected + dst_offset, g_source + src_offset, count );
+                if( !_check( "memcpy", span, count, dst_offset, src_offset, ret == g_result + dst_offset ) ) { return false; }
+                break;
+            }
+            case 1:
+            {
+                int value = (int)( libk_host_rand( &g_rand ) );
+                void* ret = libk_memset( g_result + dst_offset, value, count );
+                memset( g_expected + dst_offset, value, count );
+                if( !_check( "memset", span, count, dst_offset, 0UL, ret == g_result + dst_offset ) ) { return false; }
+                break;
+            }
+            case 2:
+            {
+                // Moves within one buffer, so the ranges overlap, either direction
+                size_t distance = (size_t)( libk_host_rand( &g_rand ) % ( count + 2UL ) );
+                size_t move_src = TEST_GUARD + 32UL;
+                size_t move_dst = ( libk_host_rand( &g_rand ) & 1UL ) ? move_src + distance : move_src - ( distance % TEST_GUARD );
+                if( move_dst + count > span - TEST_GUARD ) { move_dst = move_src; }
+
+                void* ret = libk_memmove( g_result + move_dst, g_result + move_src, count );
+                memmove( g_expected + move_dst, g_expected + move_src, count );
+                if( !_check( "memmove", span, count, move_dst, move_src, ret == g_result + move_dst ) ) { return false; }
+                break;
+            }
+            default:
+            {
+                // Equal ranges, with a single byte changed two thirds of the time
+                memcpy( g_result + dst_offset, g_source + src_offset, count );
+                if( count > 0UL && libk_host_rand( &g_rand ) % 3UL != 0UL )
+                {
+                    g_result[ dst_offset + libk_host_rand( &g_rand ) % count ] = (uint8_t)( libk_host_rand( &g_rand ) );
+                }
+
+                int result      = libk_memcmp( g_result + dst_offset, g_source + src_offset, count );
+                int expected    = memcmp( g_result + dst_offset, g_source + src_offset, count );
+                if( _sign( result ) != _sign( expected ) )
+                {
+                    printf( "FAIL: memcmp count %zu, dst offset %zu, src offset %zu, returned %d, expected %d\n", count, dst_offset, src_offset, result, expected );
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/*
+    _test_memmove_overlap
+    * Every distance in both directions, at sizes around each tier boundary
+*/
+static bool _test_memmove_overlap( void )
+{
+    static const size_t sizes[] = { 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 256, 257, 1000, 4095, 4096, 4097, 9000 };
+
+    for( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); s++ )
+    {
+        size_t count        = sizes[ s ];
+        size_t max_distance = count < 300UL ? count + 1UL : 300UL;
+        size_t span         = count + TEST_GUARD * 2UL + max_distance;
+
+        for( size_t distance = 0; distance <= max_distance; distance++ )
+        {
+            for( uint32_t direction = 0; direction < 2U; direction++ )
+            {
+                size_t move_src = TEST_GUARD;
+                size_t move_dst = direction == 0U ? move_src + distance : move_src - ( distance > TEST_GUARD ? TEST_GUARD : distance );
+
+                _fill_random( g_result, span );
+                memcpy( g_expected, g_result, span );
+
+                void* ret = libk_memmove( g_result + move_dst, g_result + move_src, count );
+                memmove( g_expected + move_dst, g_expected + move_src, count );
+                if( !_check( "memmove (overlap)", span, count, move_dst, move_src, ret == g_result + move_dst ) ) { return false; }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/*
+    _random_string
+    * Fills 'len' non-zero bytes and a terminator, often from a small alphabet so strings share long prefixes
+*/
+static void _random_string( char* str, size_t len )
+{
+    uint64_t alphabet = ( libk_host_rand( &g_rand ) & 1UL ) ? 3UL : 255UL;
+    for( size_t i = 0; i < len; i++ ) { str[ i ] = (char)( 1UL + libk_host_rand( &g_rand ) % alphabet ); }
+    str[ len ] = '\0';
+}
+
+
+/*
+    _place_string
+    * Picks where a string of 'len' bytes starts, two thirds of the time it ends right before (or just short of) the guard page,
+      otherwise anywhere in the first half of its page pair
+*/
+static char* _place_string( uint8_t* pages, size_t len )
+{
+    uint8_t* guard = pages + TEST_PAGE_SIZE * 2UL;
+    if( libk_host_rand( &g_rand ) % 3UL != 0UL )
+    {
+        return (char*)( guard - len - 1UL - libk_host_rand( &g_rand ) % 20UL );
+    }
+
+    return (char*)( pages + libk_host_rand( &g_rand ) % TEST_PAGE_SIZE );
+}
+
+
+/*
+    _test_strings
+    * Strings are placed against a PROT_NONE page, so reading even one byte past the page holding the terminator faults
+    * Lengths, offsets and common prefixes are random, so every alignment of both strings relative to the page end is covered
+*/
+static bool _test_strings( uint8_t* pages_a, uint8_t* pages_b )
+{
+    for( uint32_t i = 0; i < TEST_STRING_ITERATIONS; i++ )
+    {
+        size_t len_a = (size_t)( libk_host_rand( &g_rand ) % ( ( libk_host_rand( &g_rand ) % 4UL ) != 0UL ? 40UL : 600UL ) );
+        char* str_a = _place_string( pages_a, len_a );
+        _random_string( str_a, len_a );
+
+        // Half the time the strings match up to the shorter one, with one byte changed now and then
+        size_t len_b    = ( libk_host_rand( &g_rand ) & 1UL ) ? len_a : (size_t)( libk_host_rand( &g_rand ) % ( len_a + 5UL ) );
+        char* str_b     = _place_string( pages_b, len_b );
+        _random_string( str_b, len_b );
+
+        size_t common = len_b < len_a ? len_b : len_a;
+        memcpy( str_b, str_a, common );
+        if( len_b > 0UL && libk_host_rand( &g_rand ) % 3UL == 0UL )
+        {
+            str_b[ libk_host_rand( &g_rand ) % len_b ] = (char)( 1UL + libk_host_rand( &g_rand ) % 255UL );
+        }
+
+        int result      = libk_strcmp( str_a, str_b );
+        int expected    = strcmp( str_a, str_b );
+        if( _sign( result ) != _sign( expected ) )
+        {
+            printf( "FAIL: strcmp lengths %zu and %zu, page offsets %zu and %zu, returned %d, expected %d\n", len_a, len_b,
+                (size_t)( str_a - (char*)( pages_a ) ) % TEST_PAGE_SIZE, (size_t)( str_b - (char*)( pages_b ) ) % TEST_PAGE_SIZE, result, expected );
+            return false;
+        }
+
+        if( libk_strlen( str_a ) != len_a || libk_strlen( str_b ) != len_b )
+        {
+            printf( "FAIL: strlen lengths %zu and %zu, returned %zu and %zu\n", len_a, len_b, libk_strlen( str_a ), libk_strlen( str_b ) );
+            return false;
+        }
+    }
+
+    // Empty strings, at the very last byte before the guard page
+    char* last_a = (char*)( pages_a + TEST_PAGE_SIZE * 2UL - 1UL );
+    char* last_b = (char*)( pages_b + TEST_PAGE_SIZE * 2UL - 1UL );
+    *last_a = '\0';
+    *last_b = '\0';
+
+    if( libk_strlen( last_a ) != 0UL || libk_strcmp( last_a, last_b ) != 0 )
+    {
+        printf( "FAIL: empty strings before the guard page\n" );
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( void )
+{
+    static const char* variant_names[] = { "sse", "erms" };
+    bool b_passed = true;
+
+    // Run everything against both large copy/fill implementations, the dispatch slots are set directly
+    for( uint32_t variant = 0; variant < 2U && b_passed; variant++ )
+    {
+        libk_memcpy_large_slot = variant == 0U ? (void*)( libk_memcpy_large_sse ) : (void*)( libk_memcpy_large_erms );
+        libk_memset_large_slot = variant == 0U ? (void*)( libk_memset_large_sse ) : (void*)( libk_memset_large_erms );
+
+        printf( "libk string tests, large variant '%s'\n", variant_names[ variant ] );
+        b_passed = _test_memory() && _test_memmove_overlap();
+    }
+
+    // Two readable pages for each string, followed by a guard page
+    uint8_t* pages = mmap( NULL, TEST_PAGE_SIZE * 6UL, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( pages == MAP_FAILED ) { return 1; }
+
+    mprotect( pages + TEST_PAGE_SIZE * 2UL, TEST_PAGE_SIZE, PROT_NONE );
+    mprotect( pages + TEST_PAGE_SIZE * 5UL, TEST_PAGE_SIZE, PROT_NONE );
+
+    static const char* strcmp_names[] = { "word", "sse42" };
+    for( uint32_t variant = 0; variant < 2U && b_passed; variant++ )
+    {
+        if( variant == 1U && !__builtin_cpu_supports( "sse4.2" ) )
+        {
+            printf( "libk string tests, skipping strcmp variant 'sse42', the host doesnt support SSE4.2\n" );
+            break;
+        }
+
+        libk_strcmp_slot = variant == 0U ? (void*)( libk_strcmp_word ) : (void*)( libk_strcmp_sse42 );
+
+        printf( "libk string tests, strcmp variant '%s'\n", strcmp_names[ variant ] );
+        b_passed = _test_strings( pages, pages + TEST_PAGE_SIZE * 3UL );
+    }
+
+    munmap( pages, TEST_PAGE_SIZE * 6UL );
+
+    printf( b_passed ? "libk string tests passed\n" : "libk string tests failed\n" );
+    return b_passed ? 0 : 1;
+}
\ No newline at end of file